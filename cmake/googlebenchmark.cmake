@@ -0,0 +1,12 @@
+FetchContent_Declare(googlebenchmark
+        GIT_REPOSITORY https://github.com/google/benchmark/
+        GIT_TAG v1.8.3
+        )
+set(BENCHMARK_ENABLE_TESTING OFF CACHE INTERNAL "")
+set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE INTERNAL "")
+set(BENCHMARK_ENABLE_INSTALL OFF CACHE INTERNAL "")
+FetchContent_MakeAvailable(googlebenchmark)
+
+# Place in a folder
+set_target_properties(benchmark PROPERTIES FOLDER "extern")
+set_target_properties(benchmark_main PROPERTIES FOLDER "extern")
@@ -1,5 +1,6 @@
 #include "physsim_window.hpp"
 #include "simulation.hpp"
+#include "simulation_registry.hpp"
 
 #include <imgui.h>
 #include <vislab/graphics/const_texture.hpp>
@@ -92,6 +93,9 @@ namespace physsim
     };
 }
 
+static physsim::SimulationRegistration<physsim::EmptySimulation> registration("empty");
+
+#ifndef PHYSSIM_HEADLESS
 int main()
 {
     physsim::PhyssimWindow window(
@@ -104,3 +108,4 @@ int main()
 
     return window.run();
 }
+#endif
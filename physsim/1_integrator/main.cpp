@@ -1,5 +1,7 @@
+#include "ode_integrator.hpp"
 #include "physsim_window.hpp"
 #include "simulation.hpp"
+#include "simulation_registry.hpp"
 
 #include <imgui.h>
 #include <vislab/graphics/const_texture.hpp>
@@ -30,6 +32,11 @@ namespace physsim
             SymplecticEuler
         };
 
+        /**
+         * @brief State of the body, consisting of position and velocity.
+         */
+        using State = Eigen::Matrix<double, 6, 1>;
+
         /**
          * @brief Initializes the scene.
          */
@@ -88,7 +95,6 @@ namespace physsim
         void advance(double elapsedTime, double totalTime, int64_t timeStep) override
         {
             Eigen::Vector3d vTime = Eigen::Vector3d(mTime, mTime, mTime);
-            Eigen::Vector3d vStepSize = Eigen::Vector3d(mStepSize, mStepSize, mStepSize);
 
             // TODO: analytical solution
             // x(t) = x_0 + v_0*t + 0.5*a*t^2
@@ -98,21 +104,32 @@ namespace physsim
             mVelocity[EMethod::Analytic] = mInitialVelocity + mGravity.cwiseProduct(vTime);
             addSphere(mPosition[EMethod::Analytic], 0.03, Spectrum(1, 0, 0));
 
-            // TODO: explicit euler
-            // x' = x + dt*v
-            // v' = v + dt*a
-            // order is important
-            mPosition[EMethod::ExplicitEuler] += mVelocity[EMethod::ExplicitEuler].cwiseProduct(vStepSize);
-            mVelocity[EMethod::ExplicitEuler] += mGravity.cwiseProduct(vStepSize);
-            addSphere(mPosition[EMethod::ExplicitEuler], 0.03, Spectrum(0, 1, 0));
-
-            // TODO: symplectic euler
-            // v' = v + dt*a
-            // x' = x + dt*v'
-            // order is important
-            mVelocity[EMethod::SymplecticEuler] += mGravity.cwiseProduct(vStepSize);
-            mPosition[EMethod::SymplecticEuler] += mVelocity[EMethod::SymplecticEuler].cwiseProduct(vStepSize);
-            addSphere(mPosition[EMethod::SymplecticEuler], 0.03, Spectrum(0, 0, 1));
+            // right-hand side of the state y = (x, v): dx/dt = v, dv/dt = a
+            auto rhs = [&](double, const State& y)
+            {
+                State dy;
+                dy << y.tail<3>(), mGravity;
+                return dy;
+            };
+
+            // explicit euler: x' = x + dt*v, v' = v + dt*a
+            // symplectic euler: v' = v + dt*a, x' = x + dt*v'
+            const EMethod methods[]       = { EMethod::ExplicitEuler, EMethod::SymplecticEuler };
+            const EOdeMethod odeMethods[] = { EOdeMethod::ExplicitEuler, EOdeMethod::SymplecticEuler };
+            const Spectrum colors[]       = { Spectrum(0, 1, 0), Spectrum(0, 0, 1) };
+            for (int i = 0; i < 2; ++i)
+            {
+                OdeIntegrator<State> integrator(odeMethods[i], mStepSize);
+                integrator.setSecondOrder(true);
+                integrator.setVelocityIndependent(true);
+                State y;
+                y << mPosition[methods[i]], mVelocity[methods[i]];
+                double t = mTime;
+                integrator.integrate(rhs, t, y, mStepSize);
+                mPosition[methods[i]] = y.head<3>();
+                mVelocity[methods[i]] = y.tail<3>();
+                addSphere(mPosition[methods[i]], 0.03, colors[i]);
+            }
 
             mTime += mStepSize;
         }
@@ -201,6 +218,9 @@ namespace physsim
     };
 }
 
+static physsim::SimulationRegistration<physsim::IntegratorSimulation> registration("integrator");
+
+#ifndef PHYSSIM_HEADLESS
 int main()
 {
     physsim::PhyssimWindow window(
@@ -213,3 +233,4 @@ int main()
 
     return window.run();
 }
+#endif
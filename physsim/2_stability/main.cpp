@@ -1,7 +1,13 @@
+#include "ode_integrator.hpp"
 #include "physsim_window.hpp"
 #include "simulation.hpp"
+#include "simulation_registry.hpp"
+#include "spring.hpp"
+#include "spring_ensemble.hpp"
 
+#include <chrono>
 #include <imgui.h>
+#include <iostream>
 #include <vislab/graphics/const_texture.hpp>
 #include <vislab/graphics/diffuse_bsdf.hpp>
 #include <vislab/graphics/perspective_camera.hpp>
@@ -14,47 +20,6 @@ using namespace vislab;
 
 namespace physsim
 {
-    /**
-     * @brief Stores parameters of a spring.
-     */
-    struct Spring
-    {
-        /**
-         * @brief Stiffness constant.
-         */
-        double stiffness;
-
-        /**
-         * @brief Rest length of the spring.
-         */
-        double length;
-
-        /**
-         * @brief Damping factor.
-         */
-        double damping;
-
-        /**
-         * @brief Mass of the end point.
-         */
-        double mass;
-
-        /**
-         * @brief (Fixed) start point of the spring.
-         */
-        Eigen::Vector3d startPosition;
-
-        /**
-         * @brief End point of the spring.
-         */
-        Eigen::Vector3d endPosition;
-
-        /**
-         * @brief Velocity of end point of the spring.
-         */
-        Eigen::Vector3d endVelocity;
-    };
-
     /**
      * @brief Stability of numerical integrators.
      */
@@ -69,10 +34,17 @@ namespace physsim
             Analytical,
             ExplicitEuler,
             SymplecticEuler,
-            ExplicitRK2,
-            ImplicitEuler
+            VelocityVerlet,
+            ImplicitEuler,
+            RungeKutta4,
+            DormandPrince45
         };
 
+        /**
+         * @brief State of the end point, consisting of position and velocity.
+         */
+        using State = Eigen::Matrix<double, 6, 1>;
+
         /**
          * @brief Initializes the scene.
          */
@@ -80,6 +52,7 @@ namespace physsim
         {
             // initial simulation parameters
             mStepSize             = 1E-2;
+            mEvaluations          = 0;
             mGravity              = Eigen::Vector3d(0, 0, -9.8065);
             mSpring.mass          = 1.;
             mSpring.length        = 5.;
@@ -88,6 +61,7 @@ namespace physsim
             mSpring.startPosition = Eigen::Vector3d(0, 0, 0);
             mSpring.endPosition   = mSpring.startPosition + Eigen::Vector3d(0, 0, -mSpring.length);
             mSpring.endVelocity   = Eigen::Vector3d(0, 0, 0);
+            mIntegrator.setSecondOrder(true);
 
             // create a sphere for the end point and assign a bsdf
             auto sphere  = std::make_shared<Sphere>();
@@ -134,74 +108,67 @@ namespace physsim
         void advance(double elapsedTime, double totalTime, int64_t timeStep) override
         {
             // grab parameters
-            Eigen::Vector3d spring_dir = (mSpring.endPosition - mSpring.startPosition).normalized();
-            double spring_norm         = (mSpring.endPosition - mSpring.startPosition).norm();
-            double k                   = mSpring.stiffness;
-            double gamma               = mSpring.damping;
-            double m                   = mSpring.mass;
-            double L                   = mSpring.length;
-
-            double alpha = -gamma / (2 * m);
-            double beta  = sqrt(4 * k * m - pow(gamma, 2) / (2 * m));
-            double c1    = -m * mGravity[2] / k;
-            double c2    = -c1 * alpha / beta;
-
-            // compute force
-            Eigen::Vector3d f_int  = -k * (spring_norm - L) * spring_dir;
-            Eigen::Vector3d f_damp = -gamma * mSpring.endVelocity;
-            Eigen::Vector3d f_ext  = m * mGravity;
-            Eigen::Vector3d f      = f_int + f_damp + f_ext;
-            // a = f / m
-            Eigen::Vector3d a = f / m;
-            Eigen::Vector3d v = mSpring.endVelocity; // previous velocity
-            Eigen::Vector3d x = mSpring.endPosition; // previous position
-
-            // note that it is required to update both m_spring.end and p_cube's position
-            switch (mMethod)
-            {
-            case EMethod::Analytical:
-            {
-                // TODO: analytical solution
-                double z            = c1 * exp(alpha * mTime) * cos(beta * mTime) + c2 * exp(alpha * mTime) * sin(beta * mTime) - L + m * mGravity[2] / k;
-                double w            = exp(alpha * mTime) * (c1 * (alpha * cos(beta * mTime) - beta * sin(beta * mTime)) + c2 * (alpha * sin(beta * mTime) + beta * cos(beta * mTime)));
-                mSpring.endPosition = mSpring.startPosition + Eigen::Vector3d(0, 0, z);
-                mSpring.endVelocity = Eigen::Vector3d(0, 0, w);
-                break;
-            }
+            double k     = mSpring.stiffness;
+            double gamma = mSpring.damping;
+            double m     = mSpring.mass;
+            double L     = mSpring.length;
 
-            case EMethod::ExplicitEuler:
-                // TODO: explicit euler
-                mSpring.endPosition = x + mStepSize * v;
-                mSpring.endVelocity = v + mStepSize * a;
-                break;
-
-            case EMethod::SymplecticEuler:
-                // TODO: symplectic euler
-                mSpring.endVelocity += mStepSize * a;
-                mSpring.endPosition += mStepSize * mSpring.endVelocity;
-                break;
-
-            case EMethod::ExplicitRK2:
+            if (mMethod == EMethod::Analytical)
             {
-                // TODO: explicit second-order Runge-Kutta
-                /*Eigen::Vector3d k1 = v;
-                Eigen::Vector3d k2 = v + mStepSize / 2 * a;
-                mSpring.endPosition += mStepSize * k2;
-                mSpring.endVelocity += mStepSize * a;*/
-                mSpring.endVelocity += mStepSize / 2 * a;
-                mSpring.endPosition += mStepSize * mSpring.endVelocity;
-                mSpring.endVelocity += mStepSize / 2 * a;
-                break;
+                Eigen::Vector2d zw  = analyticSpring(k, gamma, m, L, mGravity.z(), mTime);
+                mSpring.endPosition = mSpring.startPosition + Eigen::Vector3d(0, 0, zw.x());
+                mSpring.endVelocity = Eigen::Vector3d(0, 0, zw.y());
+                mEvaluations        = 0;
             }
-
-            case EMethod::ImplicitEuler:
+            else
             {
-                // TODO: implicit euler
-                double w = (m * v[2] - mStepSize * k * x[2] + mStepSize * mGravity[2] * m - mStepSize * L * k) / (k * pow(mStepSize, 2) + gamma * mStepSize + m);
-                mSpring.endVelocity = Eigen::Vector3d(0, 0, w);
-                mSpring.endPosition += mStepSize * mSpring.endVelocity;
-                break;
-            }
+                // right-hand side of the state y = (x, v) of the end point: dx/dt = v, dv/dt = f / m
+                auto rhs = [&](double, const State& y)
+                {
+                    Eigen::Vector3d d      = y.head<3>() - mSpring.startPosition;
+                    double spring_norm     = d.norm();
+                    Eigen::Vector3d f_int  = -k * (spring_norm - L) * d / spring_norm;
+                    Eigen::Vector3d f_damp = -gamma * y.tail<3>();
+                    Eigen::Vector3d f_ext  = m * mGravity;
+                    State dy;
+                    dy << y.tail<3>(), (f_int + f_damp + f_ext) / m;
+                    return dy;
+                };
+
+                switch (mMethod)
+                {
+                case EMethod::ExplicitEuler:
+                    mIntegrator.setMethod(EOdeMethod::ExplicitEuler);
+                    break;
+                case EMethod::SymplecticEuler:
+                    mIntegrator.setMethod(EOdeMethod::SymplecticEuler);
+                    break;
+                case EMethod::VelocityVerlet:
+                    mIntegrator.setMethod(EOdeMethod::VelocityVerlet);
+                    break;
+                case EMethod::ImplicitEuler:
+                    mIntegrator.setMethod(EOdeMethod::ImplicitEuler);
+                    break;
+                case EMethod::RungeKutta4:
+                    mIntegrator.setMethod(EOdeMethod::RungeKutta4);
+                    break;
+                case EMethod::DormandPrince45:
+                    mIntegrator.setMethod(EOdeMethod::DormandPrince45);
+                    break;
+                default:
+                    break;
+                }
+                if (mIntegrator.stepSize() != mStepSize)
+                    mIntegrator.setStepSize(mStepSize);
+
+                State y;
+                y << mSpring.endPosition, mSpring.endVelocity;
+                double t            = mTime;
+                int64_t evaluations = mIntegrator.evaluations();
+                mIntegrator.integrate(rhs, t, y, mStepSize);
+                mEvaluations        = mIntegrator.evaluations() - evaluations;
+                mSpring.endPosition = y.head<3>();
+                mSpring.endVelocity = y.tail<3>();
             }
 
             // update spring end position
@@ -217,11 +184,16 @@ namespace physsim
         {
             ImGui::PushItemWidth(100);
 
-            ImGui::Combo("method", (int*)&mMethod, "analytical\0explicit euler\0symplectic euler\0explicit RK2\0implicit euler\0\0");
+            ImGui::Combo("method", (int*)&mMethod, "analytical\0explicit euler\0symplectic euler\0velocity verlet\0implicit euler\0RK4\0adaptive RK45\0\0");
 
             double stepSizeMin = 1E-3, stepSizeMax = 1E-1;
             ImGui::SliderScalar("dt", ImGuiDataType_Double, &mStepSize, &stepSizeMin, &stepSizeMax);
 
+            double tolerance = mIntegrator.tolerance(), toleranceMin = 1E-10, toleranceMax = 1E-2;
+            if (ImGui::SliderScalar("tolerance", ImGuiDataType_Double, &tolerance, &toleranceMin, &toleranceMax, "%.1e", ImGuiSliderFlags_Logarithmic))
+                mIntegrator.setTolerance(tolerance);
+            ImGui::Text("evaluations: %d", (int)mEvaluations);
+
             double dampingMin = 0, dampingMax = 5E-1;
             ImGui::SliderScalar("damping", ImGuiDataType_Double, &mSpring.damping, &dampingMin, &dampingMax);
 
@@ -266,11 +238,50 @@ namespace physsim
          * @brief State of the spring.
          */
         Spring mSpring;
+
+        /**
+         * @brief Numerical integrator of the end point.
+         */
+        OdeIntegrator<State> mIntegrator;
+
+        /**
+         * @brief Number of evaluations of the right-hand side in the last time step.
+         */
+        int64_t mEvaluations;
     };
 }
 
-int main()
+static physsim::SimulationRegistration<physsim::StabilitySimulation> registration("stability");
+
+#ifndef PHYSSIM_HEADLESS
+int main(int argc, char** argv)
 {
+    // headless sweep over stiffness and step size for all integration methods: 2_stability --ensemble [output.csv]
+    if (argc > 1 && std::string(argv[1]) == "--ensemble")
+    {
+        std::string path = argc > 2 ? argv[2] : "2_stability_ensemble.csv";
+        const char* names[] = { "Explicit Euler", "Symplectic Euler", "Velocity Verlet", "Runge-Kutta 4", "Dormand-Prince 4(5)", "Implicit Euler" };
+        physsim::SpringEnsemble ensemble;
+        for (int method = 0; method < 6; ++method)
+        {
+            ensemble.method = (physsim::EOdeMethod)method;
+            auto start      = std::chrono::steady_clock::now();
+            ensemble.run();
+            auto end = std::chrono::steady_clock::now();
+            if (!ensemble.writeCsv(path, method != 0))
+            {
+                std::cerr << "Could not write " << path << std::endl;
+                return 1;
+            }
+            size_t numStable = 0;
+            for (const auto& cell : ensemble.cells())
+                numStable += cell.stable ? 1 : 0;
+            std::cout << names[method] << ": " << numStable << "/" << ensemble.cells().size() << " stable, "
+                      << std::chrono::duration<double>(end - start).count() << " s" << std::endl;
+        }
+        return 0;
+    }
+
     physsim::PhyssimWindow window(
         800,           // width
         600,           // height
@@ -281,3 +292,4 @@ int main()
 
     return window.run();
 }
+#endif
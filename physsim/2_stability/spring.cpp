@@ -0,0 +1,43 @@
+#include "spring.hpp"
+
+#include <cmath>
+
+namespace physsim
+{
+    Eigen::Vector2d analyticSpring(double stiffness, double damping, double mass, double length, double gravity, double t)
+    {
+        // offset u from the equilibrium solves m u'' + gamma u' + k u = 0 with u(0) = u0 and u'(0) = 0
+        double equilibrium = -length + mass * gravity / stiffness;
+        double u0          = -length - equilibrium;
+        double alpha       = -damping / (2 * mass);
+        double omega2      = stiffness / mass - alpha * alpha;
+
+        double u, w;
+        if (omega2 > 0)
+        {
+            double beta = std::sqrt(omega2);
+            double c1   = u0;
+            double c2   = -c1 * alpha / beta;
+            double e    = std::exp(alpha * t);
+            u           = e * (c1 * std::cos(beta * t) + c2 * std::sin(beta * t));
+            w           = e * (c1 * (alpha * std::cos(beta * t) - beta * std::sin(beta * t)) + c2 * (alpha * std::sin(beta * t) + beta * std::cos(beta * t)));
+        }
+        else if (omega2 < 0)
+        {
+            double r1 = alpha + std::sqrt(-omega2);
+            double r2 = alpha - std::sqrt(-omega2);
+            double c1 = -r2 * u0 / (r1 - r2);
+            double c2 = u0 - c1;
+            u         = c1 * std::exp(r1 * t) + c2 * std::exp(r2 * t);
+            w         = c1 * r1 * std::exp(r1 * t) + c2 * r2 * std::exp(r2 * t);
+        }
+        else
+        {
+            double c2 = -alpha * u0;
+            double e  = std::exp(alpha * t);
+            u         = e * (u0 + c2 * t);
+            w         = e * (alpha * (u0 + c2 * t) + c2);
+        }
+        return Eigen::Vector2d(equilibrium + u, w);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Eigen/Eigen>
+
+namespace physsim
+{
+    /**
+     * @brief Stores parameters of a spring.
+     */
+    struct Spring
+    {
+        /**
+         * @brief Stiffness constant.
+         */
+        double stiffness;
+
+        /**
+         * @brief Rest length of the spring.
+         */
+        double length;
+
+        /**
+         * @brief Damping factor.
+         */
+        double damping;
+
+        /**
+         * @brief Mass of the end point.
+         */
+        double mass;
+
+        /**
+         * @brief (Fixed) start point of the spring.
+         */
+        Eigen::Vector3d startPosition;
+
+        /**
+         * @brief End point of the spring.
+         */
+        Eigen::Vector3d endPosition;
+
+        /**
+         * @brief Velocity of end point of the spring.
+         */
+        Eigen::Vector3d endVelocity;
+    };
+
+    /**
+     * @brief Analytic solution of a damped spring that hangs along the z-axis. The end point starts at rest at the rest length below the start point.
+     * @details The end point oscillates around the equilibrium -length + mass * gravity / stiffness. Under-, critically and over-damped springs are distinguished.
+     * @param stiffness Stiffness constant.
+     * @param damping Damping factor.
+     * @param mass Mass of the end point.
+     * @param length Rest length of the spring.
+     * @param gravity Gravitational acceleration along the z-axis.
+     * @param t Time since the start.
+     * @return Offset of the end point from the start point along the z-axis and its velocity.
+     */
+    Eigen::Vector2d analyticSpring(double stiffness, double damping, double mass, double length, double gravity, double t);
+}
@@ -0,0 +1,206 @@
+#include "spring_ensemble.hpp"
+
+#include "spring.hpp"
+
+#include <vislab/core/array.hpp>
+#include <vislab/field/regular_field.hpp>
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+
+namespace physsim
+{
+    SpringEnsemble::SpringEnsemble()
+        : method(EOdeMethod::SymplecticEuler)
+        , stiffness(5.)
+        , damping(0.1)
+        , mass(1.)
+        , stepSize(1E-2)
+        , length(5.)
+        , gravity(-9.8065)
+        , duration(10.)
+        , divergenceThreshold(1.)
+        , tolerance(1E-6)
+        , batchSize(256)
+        , xAxis({ EParameter::Stiffness, 1E-1, 1E3, 64, true })
+        , yAxis({ EParameter::StepSize, 1E-4, 1E-1, 64, true })
+    {
+    }
+
+    std::shared_ptr<vislab::RegularSteadyScalarField2d> SpringEnsemble::run()
+    {
+        // set up the configuration of every grid point
+        mCells.resize((size_t)xAxis.resolution * yAxis.resolution);
+        for (int y = 0; y < yAxis.resolution; ++y)
+        {
+            for (int x = 0; x < xAxis.resolution; ++x)
+            {
+                Cell& cell     = mCells[(size_t)y * xAxis.resolution + x];
+                cell.stiffness = stiffness;
+                cell.damping   = damping;
+                cell.mass      = mass;
+                cell.stepSize  = stepSize;
+                for (const auto& [axis, index] : { std::make_pair(&xAxis, x), std::make_pair(&yAxis, y) })
+                {
+                    double value = sample(*axis, index);
+                    switch (axis->parameter)
+                    {
+                    case EParameter::Stiffness:
+                        cell.stiffness = value;
+                        break;
+                    case EParameter::Damping:
+                        cell.damping = value;
+                        break;
+                    case EParameter::Mass:
+                        cell.mass = value;
+                        break;
+                    case EParameter::StepSize:
+                        cell.stepSize = value;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // springs in a batch advance in lockstep and therefore need the same step size. Implicit and adaptive methods solve per spring.
+        bool perSpring = method == EOdeMethod::ImplicitEuler || method == EOdeMethod::DormandPrince45;
+        size_t maxBatch = perSpring ? 1 : (size_t)std::max(1, batchSize);
+        std::map<double, std::vector<size_t>> byStepSize;
+        for (size_t i = 0; i < mCells.size(); ++i)
+            byStepSize[mCells[i].stepSize].push_back(i);
+        std::vector<std::vector<size_t>> batches;
+        for (const auto& group : byStepSize)
+        {
+            for (size_t begin = 0; begin < group.second.size(); begin += maxBatch)
+            {
+                size_t end = std::min(begin + maxBatch, group.second.size());
+                batches.emplace_back(group.second.begin() + begin, group.second.begin() + end);
+            }
+        }
+
+#ifndef _DEBUG
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int64_t i = 0; i < (int64_t)batches.size(); ++i)
+            integrateBatch(batches[i]);
+
+        // store the logarithm of the error, clamped to the divergence threshold
+        auto grid = std::make_shared<vislab::RegularGrid2d>();
+        grid->setResolution(Eigen::Vector2i(xAxis.resolution, yAxis.resolution));
+        auto domainValue = [](const Axis& axis, double value) { return axis.logarithmic ? std::log10(value) : value; };
+        grid->setDomain(Eigen::AlignedBox2d(
+            Eigen::Vector2d(domainValue(xAxis, xAxis.min), domainValue(yAxis, yAxis.min)),
+            Eigen::Vector2d(domainValue(xAxis, xAxis.max), domainValue(yAxis, yAxis.max))));
+
+        auto field = std::make_shared<vislab::RegularSteadyScalarField2d>();
+        field->setGrid(grid);
+        field->setArray(std::make_shared<vislab::Array1d>());
+        field->getArray()->setSize(mCells.size());
+        double maxLog = std::log10(divergenceThreshold);
+        for (size_t i = 0; i < mCells.size(); ++i)
+        {
+            const Cell& cell = mCells[i];
+            double value     = cell.stable ? std::log10(std::max(cell.maxError, 1E-16)) : maxLog;
+            field->getArray()->setValue(i, std::min(value, maxLog));
+        }
+        return field;
+    }
+
+    const std::vector<SpringEnsemble::Cell>& SpringEnsemble::cells() const
+    {
+        return mCells;
+    }
+
+    bool SpringEnsemble::writeCsv(const std::string& path, bool append) const
+    {
+        std::ofstream file(path, append ? std::ios::app : std::ios::trunc);
+        if (!file)
+            return false;
+
+        static const char* methodNames[] = { "explicit_euler", "symplectic_euler", "velocity_verlet", "rk4", "dormand_prince45", "implicit_euler" };
+        if (!append)
+            file << "method,stiffness,damping,mass,step_size,max_error,stable,evaluations\n";
+        file.precision(9);
+        for (const Cell& cell : mCells)
+        {
+            file << methodNames[(int)method] << ',' << cell.stiffness << ',' << cell.damping << ',' << cell.mass << ',' << cell.stepSize << ','
+                 << cell.maxError << ',' << (cell.stable ? 1 : 0) << ',' << cell.evaluations << '\n';
+        }
+        return (bool)file;
+    }
+
+    double SpringEnsemble::sample(const Axis& axis, int index)
+    {
+        double s = axis.resolution > 1 ? double(index) / (axis.resolution - 1) : 0.;
+        if (axis.logarithmic)
+            return axis.min * std::pow(axis.max / axis.min, s);
+        return axis.min + (axis.max - axis.min) * s;
+    }
+
+    void SpringEnsemble::integrateBatch(const std::vector<size_t>& batch)
+    {
+        const Eigen::Index n = (Eigen::Index)batch.size();
+        const double h       = mCells[batch[0]].stepSize;
+        Eigen::ArrayXd k(n), gamma(n), m(n);
+        for (Eigen::Index i = 0; i < n; ++i)
+        {
+            k[i]     = mCells[batch[i]].stiffness;
+            gamma[i] = mCells[batch[i]].damping;
+            m[i]     = mCells[batch[i]].mass;
+        }
+
+        // state holds all offsets of the end points along z, followed by all velocities
+        auto rhs = [&](double, const Eigen::VectorXd& y)
+        {
+            Eigen::ArrayXd z = y.head(n).array();
+            Eigen::ArrayXd v = y.tail(n).array();
+            Eigen::VectorXd dy(2 * n);
+            dy.head(n) = y.tail(n);
+            dy.tail(n) = ((-k * (z.abs() - length) * z.sign() - gamma * v) / m + gravity).matrix();
+            return dy;
+        };
+
+        Eigen::VectorXd y(2 * n);
+        y.head(n).setConstant(-length);
+        y.tail(n).setZero();
+
+        OdeIntegrator<Eigen::VectorXd> integrator(method, h);
+        integrator.setTolerance(tolerance);
+        integrator.setPositionSize(n);
+        integrator.setSecondOrder(true);
+        integrator.setVelocityIndependent((gamma == 0).all());
+
+        Eigen::ArrayXd maxError = Eigen::ArrayXd::Zero(n);
+        int64_t numSteps        = std::max<int64_t>(1, (int64_t)std::ceil(duration / h - 1E-9));
+        double t                = 0;
+        for (int64_t step = 0; step < numSteps; ++step)
+        {
+            integrator.integrate(rhs, t, y, h);
+
+            bool diverged = true;
+            for (Eigen::Index i = 0; i < n; ++i)
+            {
+                const Cell& cell = mCells[batch[i]];
+                double analytic  = analyticSpring(cell.stiffness, cell.damping, cell.mass, length, gravity, t).x();
+                double error     = std::abs(y[i] - analytic) / length;
+                if (!(error <= maxError[i])) // also catches NaN
+                    maxError[i] = std::isnan(error) ? std::numeric_limits<double>::infinity() : error;
+                diverged = diverged && maxError[i] > divergenceThreshold;
+            }
+
+            // nothing left to learn once every spring in the batch blew up
+            if (diverged)
+                break;
+        }
+
+        for (Eigen::Index i = 0; i < n; ++i)
+        {
+            Cell& cell       = mCells[batch[i]];
+            cell.maxError    = maxError[i];
+            cell.stable      = std::isfinite(maxError[i]) && maxError[i] <= divergenceThreshold;
+            cell.evaluations = integrator.evaluations();
+        }
+    }
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "ode_integrator.hpp"
+
+#include <vislab/field/regular_field_fwd.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace physsim
+{
+    /**
+     * @brief Headless parameter sweep that maps the stability and accuracy of an integrator over a two-dimensional grid of spring configurations.
+     * @details Every grid cell is an independent hanging spring that is integrated along the z-axis and compared against the analytic solution. Cells with the same step size are packed into batches whose positions and velocities are stored as contiguous arrays, such that one call of the right-hand side updates the whole batch. The batches are distributed over all cores.
+     */
+    class SpringEnsemble
+    {
+    public:
+        /**
+         * @brief Parameters of the spring configurations that can be swept.
+         */
+        enum class EParameter
+        {
+            Stiffness,
+            Damping,
+            Mass,
+            StepSize
+        };
+
+        /**
+         * @brief Sampling of one parameter along an axis of the map.
+         */
+        struct Axis
+        {
+            /**
+             * @brief Parameter that varies along the axis.
+             */
+            EParameter parameter;
+
+            /**
+             * @brief Smallest parameter value.
+             */
+            double min;
+
+            /**
+             * @brief Largest parameter value.
+             */
+            double max;
+
+            /**
+             * @brief Number of samples.
+             */
+            int resolution;
+
+            /**
+             * @brief Flag that determines whether the samples are spaced logarithmically. The domain of the map then holds the base-10 logarithm.
+             */
+            bool logarithmic;
+        };
+
+        /**
+         * @brief Result of a single spring configuration.
+         */
+        struct Cell
+        {
+            /**
+             * @brief Stiffness constant.
+             */
+            double stiffness;
+
+            /**
+             * @brief Damping factor.
+             */
+            double damping;
+
+            /**
+             * @brief Mass of the end point.
+             */
+            double mass;
+
+            /**
+             * @brief Integration step size.
+             */
+            double stepSize;
+
+            /**
+             * @brief Largest deviation of the end point from the analytic solution, relative to the rest length.
+             */
+            double maxError;
+
+            /**
+             * @brief Flag that determines whether the error stayed finite and below the divergence threshold.
+             */
+            bool stable;
+
+            /**
+             * @brief Number of evaluations of the right-hand side.
+             */
+            int64_t evaluations;
+        };
+
+        /**
+         * @brief Constructor with a sweep over stiffness and step size.
+         */
+        SpringEnsemble();
+
+        /**
+         * @brief Integrates all configurations.
+         * @return Map of the base-10 logarithm of the relative error. Unstable cells are set to the logarithm of the divergence threshold.
+         */
+        std::shared_ptr<vislab::RegularSteadyScalarField2d> run();
+
+        /**
+         * @brief Gets the results of the last run in the order of the grid points, x varying fastest.
+         * @return Results of all cells.
+         */
+        const std::vector<Cell>& cells() const;
+
+        /**
+         * @brief Writes the results of the last run as comma-separated values.
+         * @param path Path of the file.
+         * @param append Appends to an existing file without writing the header again.
+         * @return True if the file was written.
+         */
+        bool writeCsv(const std::string& path, bool append = false) const;
+
+        /**
+         * @brief Numerical integration method.
+         */
+        EOdeMethod method;
+
+        /**
+         * @brief Stiffness constant, unless swept.
+         */
+        double stiffness;
+
+        /**
+         * @brief Damping factor, unless swept.
+         */
+        double damping;
+
+        /**
+         * @brief Mass of the end point, unless swept.
+         */
+        double mass;
+
+        /**
+         * @brief Integration step size, unless swept.
+         */
+        double stepSize;
+
+        /**
+         * @brief Rest length of the springs.
+         */
+        double length;
+
+        /**
+         * @brief Gravitational acceleration along the z-axis.
+         */
+        double gravity;
+
+        /**
+         * @brief Simulated time span.
+         */
+        double duration;
+
+        /**
+         * @brief Relative error above which a configuration is considered unstable.
+         */
+        double divergenceThreshold;
+
+        /**
+         * @brief Error tolerance of the adaptive method.
+         */
+        double tolerance;
+
+        /**
+         * @brief Maximum number of springs per batch. Implicit and adaptive methods integrate every spring on its own.
+         */
+        int batchSize;
+
+        /**
+         * @brief Parameter sampling along the x-axis of the map.
+         */
+        Axis xAxis;
+
+        /**
+         * @brief Parameter sampling along the y-axis of the map.
+         */
+        Axis yAxis;
+
+    private:
+        /**
+         * @brief Computes the value of a parameter at a sample of an axis.
+         * @param axis Axis to sample.
+         * @param index Index of the sample.
+         * @return Parameter value.
+         */
+        static double sample(const Axis& axis, int index);
+
+        /**
+         * @brief Integrates a batch of springs that share the step size and stores the results in their cells.
+         * @param batch Indices of the cells in the batch.
+         */
+        void integrateBatch(const std::vector<size_t>& batch);
+
+        /**
+         * @brief Results of the last run.
+         */
+        std::vector<Cell> mCells;
+    };
+}
@@ -2,6 +2,7 @@
 #include "rigid_body.hpp"
 #include "rigid_body_integrator.hpp"
 #include "simulation.hpp"
+#include "simulation_registry.hpp"
 
 #include <imgui.h>
 #include <vislab/core/array.hpp>
@@ -33,6 +34,8 @@ namespace physsim
             ExplicitEuler,
             SymplecticEuler,
             Implicit,
+            RungeKutta4,
+            DormandPrince45,
         };
 
         /**
@@ -186,6 +189,16 @@ namespace physsim
                 implicitEuler(mRigidBody, mStepSize);
                 break;
             }
+            case EMethod::RungeKutta4:
+            {
+                rungeKutta4(mRigidBody, mStepSize);
+                break;
+            }
+            case EMethod::DormandPrince45:
+            {
+                dormandPrince45(mRigidBody, mStepSize);
+                break;
+            }
             }
         }
 
@@ -196,7 +209,7 @@ namespace physsim
         {
             ImGui::PushItemWidth(100);
 
-            ImGui::Combo("method", (int*)&mMethod, "explicit euler\0symplectic euler\0implicit euler\0\0");
+            ImGui::Combo("method", (int*)&mMethod, "explicit euler\0symplectic euler\0implicit euler\0RK4\0adaptive RK45\0\0");
             
             double stepSizeMin = 1E-3, stepSizeMax = 1E-1;
             ImGui::SliderScalar("dt", ImGuiDataType_Double, &mStepSize, &stepSizeMin, &stepSizeMax);
@@ -222,6 +235,9 @@ namespace physsim
     };
 }
 
+static physsim::SimulationRegistration<physsim::GyroscopeSimulation> registration("gyroscope");
+
+#ifndef PHYSSIM_HEADLESS
 int main()
 {
     physsim::PhyssimWindow window(
@@ -234,3 +250,4 @@ int main()
 
     return window.run();
 }
+#endif
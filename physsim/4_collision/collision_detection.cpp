@@ -4,6 +4,7 @@
 #include "transformed_mesh.hpp"
 
 #include <vislab/core/array.hpp>
+#include <algorithm>
 #include <string>
 #include <iostream>
 
@@ -35,7 +36,7 @@ namespace physsim
                 {
                     for (size_t j = i + 1; j < mObjects.size(); j++)
                     {
-                        if (mObjects[i]->type() == RigidBody::EType::Dynamic || mObjects[j]->type() == RigidBody::EType::Dynamic)
+                        if (isActive(i) || isActive(j))
                             mOverlappingBodys.push_back(std::make_pair(i, j));
                     }
                 }
@@ -55,7 +56,7 @@ namespace physsim
                     for (size_t j = i + 1; j < mObjects.size(); j++)
                     {
                         // add pair of objects to possible collision if their bounding boxes overlap
-                        if (mObjects[i]->type() == RigidBody::EType::Dynamic || mObjects[j]->type() == RigidBody::EType::Dynamic)
+                        if (isActive(i) || isActive(j))
                         {
                             if (aabbs[i].intersects(aabbs[j]))
                             {
@@ -69,160 +70,58 @@ namespace physsim
 
             case EBroadPhaseMethod::SweepAndPrune:
             {
-                // TODO: compute bounding boxes and create intervals on the 3 main axes
-                std::vector<Eigen::AlignedBox3d> aabbs(mObjects.size()); // 5 boxes + 1 plane
-                //printf("%d\n", mObjects.size());
-                std::vector<std::pair<size_t, size_t>> x_interval;
-                std::vector<std::pair<size_t, size_t>> y_interval;
-                std::vector<std::pair<size_t, size_t>> z_interval;
+                // compute bounding boxes and let the persistent sweep and prune update the overlaps incrementally
+                std::vector<Eigen::AlignedBox3d> aabbs(mObjects.size());
                 for (size_t i = 0; i < aabbs.size(); i++)
                 {
                     aabbs[i] = mObjects[i]->shape()->worldBounds();
-                    //printf("%d\n", aabbs);
-                    x_interval.push_back({ aabbs[i].min()[0], aabbs[i].max()[0] });
-                    //printf("%d\n", aabbs[i].min()[0]);
-                    //printf("%d\n", aabbs[i].max()[0]);
-                    y_interval.push_back({ aabbs[i].min()[1], aabbs[i].max()[1] });
-                    z_interval.push_back({ aabbs[i].min()[2], aabbs[i].max()[2] });
                 }
+                mSweepAndPrune.update(aabbs);
 
-                 // Compute AABBs for all objects
-                std::vector<Eigen::AlignedBox3d> aabbs(mObjects.size());
-                for (size_t i = 0; i < mObjects.size(); ++i)
+                for (const auto& pair : mSweepAndPrune.overlappingPairs())
                 {
-                    aabbs[i] = mObjects[i]->shape()->worldBounds();
+                    if (isActive(pair.first) || isActive(pair.second))
+                    {
+                        mOverlappingBodys.push_back(pair);
+                    }
                 }
+                break;
+            }
 
-                // Define interval structure to track original indices
-                struct Interval
-                {
-                    double min;
-                    double max;
-                    size_t original_idx;
-                };
-
-                // Create sorted intervals for each axis
-                std::vector<Interval> x_intervals, y_intervals, z_intervals;
-                for (size_t i = 0; i < mObjects.size(); ++i)
+            case EBroadPhaseMethod::DynamicTree:
+            {
+                // (re)create the proxies if the set of bodies changed
+                if (mProxies.size() != mObjects.size())
                 {
-                    const auto& aabb = aabbs[i];
-                    x_intervals.push_back({ aabb.min()[0], aabb.max()[0], i });
-                    y_intervals.push_back({ aabb.min()[1], aabb.max()[1], i });
-                    z_intervals.push_back({ aabb.min()[2], aabb.max()[2], i });
+                    mDynamicTree.clear();
+                    mProxies.resize(mObjects.size());
+                    for (size_t i = 0; i < mObjects.size(); i++)
+                        mProxies[i] = mDynamicTree.createProxy(mObjects[i]->shape()->worldBounds(), i);
                 }
 
-
-                // TODO: sort intervals in ascending order by beginning of interval
-                // maybe implement insertion sort here
-                /*std::sort(x_interval.begin(), x_interval.end(), [](const auto& a, const auto& b)
-                          { return a.first < b.first; });
-                std::sort(y_interval.begin(), y_interval.end(), [](const auto& a, const auto& b)
-                          { return a.first < b.first; });
-                std::sort(z_interval.begin(), z_interval.end(), [](const auto& a, const auto& b)
-                          { return a.first < b.first; });*/
-
-                // Sort intervals by their minimum value
-                auto sort_by_min = [](const Interval& a, const Interval& b)
-                { return a.min < b.min; };
-                std::sort(x_intervals.begin(), x_intervals.end(), sort_by_min);
-                std::sort(y_intervals.begin(), y_intervals.end(), sort_by_min);
-                std::sort(z_intervals.begin(), z_intervals.end(), sort_by_min);
-
-                // TODO: iterate and place overlaps in a set
-                //std::set<std::pair<size_t, size_t>> overlaps;
-                //std::set<std::pair<size_t, size_t>> x_overlaps;
-                //std::set<std::pair<size_t, size_t>> y_overlaps;
-                //std::set<std::pair<size_t, size_t>> z_overlaps;
-                //// mOjects.size() == x_interval.size() == y_interval.size() == z_interval.size()
-                //for (size_t i = 0; i < mObjects.size(); i++)
-                //{
-                //    for (size_t j = i + 1; j < mObjects.size(); j++)
-                //    {
-                //        if (mObjects[i]->type() == RigidBody::EType::Dynamic || mObjects[j]->type() == RigidBody::EType::Dynamic)
-                //        {
-                //            if (x_interval[i].second > x_interval[j].first)
-                //            {
-                //                overlaps.insert(std::make_pair(i, j));
-                //                x_overlaps.insert(std::make_pair(i, j));
-                //                //printf("X got it");
-                //            }
-                //            if (y_interval[i].second > y_interval[j].first)
-                //            {
-                //                overlaps.insert(std::make_pair(i, j));  
-                //                y_overlaps.insert(std::make_pair(i, j));
-                //                //printf("Y got it");
-                //            }
-                //            if (z_interval[i].second > z_interval[j].first)
-                //            {
-                //                overlaps.insert(std::make_pair(i, j));
-                //                z_overlaps.insert(std::make_pair(i, j));
-                //                printf("Z got it");
-                //            }
-                //        }
-                //    }
-                //}
-            
-                auto compute_axis_overlaps = [](const std::vector<Interval>& sorted_axis)
+                // only bodies that left their fattened box are reinserted. Sleeping bodies do not move.
+                std::vector<Eigen::AlignedBox3d> aabbs(mObjects.size());
+                for (size_t i = 0; i < mObjects.size(); i++)
                 {
-                    std::set<std::pair<size_t, size_t>> overlaps;
-                    for (size_t i = 0; i < sorted_axis.size(); ++i)
-                    {
-                        const auto& current = sorted_axis[i];
-                        // Check all previous intervals for overlap
-                        for (size_t j = 0; j < i; ++j)
-                        {
-                            const auto& other = sorted_axis[j];
-                            if (other.max > current.min)
-                            {
-                                // Ensure ordered pair (a < b)
-                                size_t a = other.original_idx;
-                                size_t b = current.original_idx;
-                                if (a > b)
-                                    std::swap(a, b);
-                                overlaps.insert({ a, b });
-                            }
-                            else
-                            {
-                                break; // No further overlaps due to sorting
-                            }
-                        }
-                    }
-                    return overlaps;
-                };
-
-                // Compute overlaps for each axis
-                std::set<std::pair<size_t, size_t>> x_overlaps = compute_axis_overlaps(x_intervals);
-                std::set<std::pair<size_t, size_t>> y_overlaps = compute_axis_overlaps(y_intervals);
-                std::set<std::pair<size_t, size_t>> z_overlaps = compute_axis_overlaps(z_intervals);
-
-            
-                // TODO: grab elements that occurred in all containers for the narrow test
-                //for (const std::pair<size_t, size_t>& overlap : overlaps)
-                //{
-                //    if (std::find(x_overlaps.begin(), x_overlaps.end(), overlap) != x_overlaps.end() && 
-                //        std::find(y_overlaps.begin(), y_overlaps.end(), overlap) != y_overlaps.end() &&
-                //        std::find(z_overlaps.begin(), z_overlaps.end(), overlap) != z_overlaps.end())
-                //    {
-                //        // TODO: pass the intersections on to the narrow phase
-                //        printf("%d, %d", (int)overlap.first, (int)overlap.second);
-
-                //        mOverlappingBodys.push_back(overlap);
-                //    }
-                //}
-                //break;
-
-                // Intersect overlaps from all three axes
-                for (const auto& pair : x_overlaps)
+                    aabbs[i] = mObjects[i]->shape()->worldBounds();
+                    if (mObjects[i]->isAwake())
+                        mDynamicTree.moveProxy(mProxies[i], aabbs[i]);
+                }
+
+                // query the tree with every moving body
+                for (size_t i = 0; i < mObjects.size(); i++)
                 {
-                    if (y_overlaps.count(pair) && z_overlaps.count(pair))
+                    if (!isActive(i))
+                        continue;
+                    auto reportPair = [&](size_t j)
                     {
-                        // Check if at least one body is dynamic
-                        if (mObjects[pair.first]->type() == RigidBody::EType::Dynamic ||
-                            mObjects[pair.second]->type() == RigidBody::EType::Dynamic)
-                        {
-                            mOverlappingBodys.push_back(pair);
-                        }
-                    }
+                        // pairs of moving bodies are reported once by the body with the smaller index
+                        bool report = j != i && (!isActive(j) || i < j);
+                        if (report && aabbs[i].intersects(aabbs[j]))
+                            mOverlappingBodys.push_back(std::make_pair(std::min(i, j), std::max(i, j)));
+                        return true;
+                    };
+                    mDynamicTree.query(aabbs[i], reportPair);
                 }
                 break;
             }
@@ -231,192 +130,220 @@ namespace physsim
 
     void CollisionDetection::computeNarrowPhase(ENarrowPhaseMethod narrowPhaseMethod)
     {
-        // iterate through all pairs of possible collisions
-        for (auto overlap : mOverlappingBodys)
+        // make sure all meshes have their edge lists and ray traversal trees, since they are shared between the threads below
+        for (const auto& object : mObjects)
+        {
+            const vislab::Triangle* tri = dynamic_cast<const vislab::Triangle*>(object->shape().get());
+            if (!tri || !tri->mesh)
+                continue;
+            if (!tri->mesh->edges || !tri->mesh->edgeFaces || !tri->mesh->faceEdges)
+                tri->mesh->recomputeEdges();
+            if (!tri->mesh->hasAccelerationTree())
+                tri->mesh->buildAccelerationTree();
+            auto& hull = mSupportMappings[tri->mesh.get()];
+            if (!hull)
+                hull = std::make_unique<HillClimbingSupport>(*tri->mesh);
+        }
+
+        // keep the warm start data of pairs that still overlap and drop the others
+        if (narrowPhaseMethod == ENarrowPhaseMethod::GilbertJohnsonKeerthi)
+        {
+            std::unordered_map<uint64_t, std::array<GilbertJohnsonKeerthi::WarmStart, 2>> warmStarts;
+            for (const auto& overlap : mOverlappingBodys)
+            {
+                uint64_t key    = (uint64_t(overlap.first) << 32) | uint64_t(overlap.second);
+                auto it         = mWarmStarts.find(key);
+                warmStarts[key] = it != mWarmStarts.end() ? it->second : std::array<GilbertJohnsonKeerthi::WarmStart, 2>();
+            }
+            mWarmStarts.swap(warmStarts);
+        }
+
+        // iterate through all pairs of possible collisions, the contacts are collected per pair, such that their order does not depend on the thread scheduling
+        std::vector<std::vector<Contact>> pairContacts(mOverlappingBodys.size());
+#ifndef _DEBUG
+#pragma omp parallel
+#endif
+        {
+            std::vector<bool> penetratingVertices;
+#ifndef _DEBUG
+#pragma omp for schedule(dynamic)
+#endif
+            for (int64_t i = 0; i < (int64_t)mOverlappingBodys.size(); ++i)
+            {
+                const auto& overlap = mOverlappingBodys[i];
+                auto warmStart      = mWarmStarts.find((uint64_t(overlap.first) << 32) | uint64_t(overlap.second));
+                computeNarrowPhase(overlap, narrowPhaseMethod, warmStart != mWarmStarts.end() ? warmStart->second.data() : nullptr, penetratingVertices, pairContacts[i]);
+            }
+        }
+        for (const std::vector<Contact>& contacts : pairContacts)
+            mContacts.insert(mContacts.end(), contacts.begin(), contacts.end());
+    }
+
+    void CollisionDetection::computeNarrowPhase(const std::pair<size_t, size_t>& overlap, ENarrowPhaseMethod narrowPhaseMethod, GilbertJohnsonKeerthi::WarmStart* warmStarts, std::vector<bool>& penetratingVertices, std::vector<Contact>& contacts) const
+    {
+        std::vector<Contact> temp_contacts[2];
+        // compute intersection of a with b first and intersection
+        // of b with a and store results in temp_contacts
+        for (int switcher = 0; switcher < 2; switcher++)
         {
-            mPenetratingVertices.clear();
-            mPenetratingEdges.clear();
-            std::vector<Contact> temp_contacts[2];
-            // compute intersection of a with b first and intersection
-            // of b with a and store results in temp_contacts
-            for (int switcher = 0; switcher < 2; switcher++)
+            RigidBody* a =
+                mObjects[(!switcher) ? overlap.first
+                                     : overlap.second]
+                    .get();
+            RigidBody* b =
+                mObjects[(!switcher) ? overlap.second
+                                     : overlap.first]
+                    .get();
+
+            const vislab::Triangle* a_tri = dynamic_cast<const vislab::Triangle*>(a->shape().get());
+            const vislab::Triangle* b_tri = dynamic_cast<const vislab::Triangle*>(b->shape().get());
+
+            TransformedMesh a_tmesh(a_tri->transform, *a_tri->mesh, mSupportMappings.at(a_tri->mesh.get()).get());
+            TransformedMesh b_tmesh(b_tri->transform, *b_tri->mesh, mSupportMappings.at(b_tri->mesh.get()).get());
+
+            switch (narrowPhaseMethod)
             {
-                RigidBody* a =
-                    mObjects[(!switcher) ? overlap.first
-                                         : overlap.second]
-                        .get();
-                RigidBody* b =
-                    mObjects[(!switcher) ? overlap.second
-                                         : overlap.first]
-                        .get();
-
-                const vislab::Triangle* a_tri = dynamic_cast<const vislab::Triangle*>(a->shape().get());
-                const vislab::Triangle* b_tri = dynamic_cast<const vislab::Triangle*>(b->shape().get());
-
-                TransformedMesh a_tmesh(
-                    a_tri->transform,
-                    *a_tri->mesh->positions.get(),
-                    *a_tri->mesh->indices.get());
-
-                TransformedMesh b_tmesh(
-                    b_tri->transform,
-                    *b_tri->mesh->positions.get(),
-                    *b_tri->mesh->indices.get());
-
-                switch (narrowPhaseMethod)
-                {
-                    // exhaustive
-                case ENarrowPhaseMethod::Exhaustive:
+                // exhaustive
+            case ENarrowPhaseMethod::Exhaustive:
+            {
+                // flat bitset of vertices of A that were already reported as penetrating
+                penetratingVertices.assign(a_tmesh.vertices.getSize(), false);
+
+                // penetration of the convex hulls, which orients the normals of edgeEdge contacts
+                Contact penetration;
+                bool penetrationComputed = false;
+
+                // iterate through all unique edges of the first object
+                for (Eigen::Index edge = 0; edge < a_tmesh.edges.getSize(); edge++)
                 {
-                    // iterate through all faces of first object
-                    for (Eigen::Index face = 0; face < a_tmesh.indices.getSize(); face++)
+                    int start = a_tmesh.getEdge(edge)[0];
+                    int end   = a_tmesh.getEdge(edge)[1];
+
+                    // check if there is a collision
+                    Eigen::Vector3d v_start   = a_tmesh.getVertex(start);
+                    Eigen::Vector3d v_end     = a_tmesh.getVertex(end);
+                    Eigen::Vector3d origin    = v_start;
+                    Eigen::Vector3d direction = v_end - v_start;
+                    vislab::Ray3d ray(
+                        origin,
+                        direction.normalized(),
+                        0, direction.norm());
+                    ContactType ct = isColliding(ray, b_tri);
+
+                    // find collision and check for duplicates
+                    switch (ct)
                     {
-                        // iterate through all edges of given face
-                        for (size_t j = 0; j < 3; j++)
+                    case ContactType::Vertex_Face:
+                    {
+                        auto si = b_tri->closestHit(ray);
+                        if (si.isValid())
                         {
-                            int start = a_tmesh.getPrimitive(face)[j];
-                            int end   = a_tmesh.getPrimitive(face)[(j + 1) % 3];
-
-                            // check if there is a collision
-                            Eigen::Vector3d v_start   = a_tmesh.getVertex(start);
-                            Eigen::Vector3d v_end     = a_tmesh.getVertex(end);
-                            Eigen::Vector3d origin    = v_start;
-                            Eigen::Vector3d direction = v_end - v_start;
-                            vislab::Ray3d ray(
-                                origin,
-                                direction.normalized(),
-                                0, direction.norm());
-                            ContactType ct = isColliding(ray, b_tri);
-
-                            // find collision and check for duplicates
-                            switch (ct)
-                            {
-                            case ContactType::Vertex_Face:
-                            {
-                                auto si = b_tri->closestHit(ray);
-                                if (si.isValid())
-                                {
-                                    double penetration_depth_start = si.normal.dot(v_start - si.position);
-                                    double penetration_depth_end   = si.normal.dot(v_end - si.position);
-                                    int penetrating_vertex =
-                                        penetration_depth_start < penetration_depth_end ? start : end;
-
-                                    if (mPenetratingVertices.find(penetrating_vertex) == mPenetratingVertices.end())
-                                    {
-                                        Contact temp_col;
-                                        temp_col.n     = si.normal.stableNormalized();
-                                        temp_col.p     = si.position;
-                                        temp_col.a     = a;
-                                        temp_col.b     = b;
-                                        temp_col.depth = std::min(penetration_depth_start, penetration_depth_end);
-                                        temp_col.type  = ContactType::Vertex_Face;
-                                        temp_contacts[switcher].push_back(temp_col);
-                                        mPenetratingVertices.insert(penetrating_vertex);
-                                    }
-                                }
-                                break;
-                            }
-                            case ContactType::Edge_Edge:
-                            {
-                                int orderedStart = std::min(start, end);
-                                int orderedEnd   = std::max(start, end);
-                                auto pair        = std::make_pair(orderedStart,
-                                                                  orderedEnd);
-                                // if not already in set
-                                if (mPenetratingEdges.find(pair) == mPenetratingEdges.end())
-                                {
-                                    Contact temp_col =
-                                        findEdgeEdgeCollision(
-                                            a_tmesh.getVertex(orderedStart),
-                                            a_tmesh.getVertex(orderedEnd), b_tmesh);
-                                    temp_col.a    = a;
-                                    temp_col.b    = b;
-                                    temp_col.type = ContactType::Edge_Edge;
-                                    temp_contacts[switcher].push_back(temp_col);
-                                    mPenetratingEdges.insert(pair);
-                                }
-                                break;
-                            }
-                            case ContactType::None:
+                            double penetration_depth_start = si.normal.dot(v_start - si.position);
+                            double penetration_depth_end   = si.normal.dot(v_end - si.position);
+                            int penetrating_vertex =
+                                penetration_depth_start < penetration_depth_end ? start : end;
+
+                            if (!penetratingVertices[penetrating_vertex])
                             {
-                                break;
-                            }
+                                Contact temp_col;
+                                temp_col.n       = si.normal.stableNormalized();
+                                temp_col.p       = si.position;
+                                temp_col.a       = a;
+                                temp_col.b       = b;
+                                temp_col.depth   = std::min(penetration_depth_start, penetration_depth_end);
+                                temp_col.type    = ContactType::Vertex_Face;
+                                temp_col.feature = 2 * uint32_t(penetrating_vertex);
+                                temp_contacts[switcher].push_back(temp_col);
+                                penetratingVertices[penetrating_vertex] = true;
                             }
                         }
+                        break;
                     }
-                    break;
-                }
-                case ENarrowPhaseMethod::GilbertJohnsonKeerthi: // TODO: implement narrow-phase collision detection method. Here, a starting point for a GJK algorithm is written.
-                {
-                    Contact contact = GilbertJohnsonKeerthi::findCollisionGJK(a_tmesh, b_tmesh);
-                    if (contact.type != ContactType::None)
+                    case ContactType::Edge_Edge:
                     {
-                        contact.a = a;
-                        contact.b = b;
-                        temp_contacts[switcher].push_back(contact);
+                        // edges are unique, hence no duplicates can occur
+                        Contact temp_col =
+                            findEdgeEdgeCollision(v_start, v_end, b_tmesh);
+                        if (temp_col.depth == 0)
+                            break; // no valid pair of edges found
+                        temp_col.a       = a;
+                        temp_col.b       = b;
+                        temp_col.type    = ContactType::Edge_Edge;
+                        temp_col.feature = 2 * uint32_t(edge) + 1;
+
+                        // the cross product of the edges has no defined sign, let the normal point from b to a like for vertexFace contacts.
+                        // the penetration direction of the convex hulls is found once per pair by GJK and EPA, and the body centers are only a fallback if EPA does not converge.
+                        if (!penetrationComputed)
+                        {
+                            penetration         = GilbertJohnsonKeerthi::findCollisionGJK(a_tmesh, b_tmesh);
+                            penetrationComputed = true;
+                        }
+                        Eigen::Vector3d b_to_a = penetration.type != ContactType::None && !penetration.n.isZero() ? penetration.n : Eigen::Vector3d(a->position() - b->position());
+                        if (temp_col.n.dot(b_to_a) < 0)
+                            temp_col.n = -temp_col.n;
+                        temp_contacts[switcher].push_back(temp_col);
+                        break;
                     }
-                }
-                }
-            }
-            // look for vertexFace
-            bool found = false;
-            for (int i = 0; i < 2; i++)
-            {
-                for (const auto& cont : temp_contacts[i])
-                {
-                    if (cont.type == ContactType::Vertex_Face)
+                    case ContactType::None:
                     {
-                        mContacts.push_back(cont);
-                        found = true;
                         break;
                     }
+                    }
                 }
-                if (found)
-                {
-                    break;
-                }
-            }
-            if (found)
-            {
-                continue;
-            }
-
-            // take single edgeedge if possible
-            if (temp_contacts[0].size() > 0 &&
-                temp_contacts[0].size() < temp_contacts[1].size())
-            {
-                for (int i = 0; i < temp_contacts[0].size(); i++)
-                {
-                    mContacts.push_back(temp_contacts[0][i]);
-                }
+                break;
             }
-            else if (temp_contacts[1].size() > 0 &&
-                     temp_contacts[0].size() >
-                         temp_contacts[1].size())
+            case ENarrowPhaseMethod::GilbertJohnsonKeerthi: // penetration of the convex hulls, expanded by EPA
             {
-                for (int i = 0; i < temp_contacts[1].size(); i++)
+                Contact contact = warmStarts ? GilbertJohnsonKeerthi::findCollisionGJK(a_tmesh, b_tmesh, warmStarts[switcher])
+                                             : GilbertJohnsonKeerthi::findCollisionGJK(a_tmesh, b_tmesh);
+                if (contact.type != ContactType::None)
                 {
-                    mContacts.push_back(temp_contacts[1][i]);
+                    contact.a = a;
+                    contact.b = b;
+                    temp_contacts[switcher].push_back(contact);
                 }
             }
-            else if (temp_contacts[0].size() > 0)
-            {
-                for (int i = 0; i < temp_contacts[0].size(); i++)
-                {
-                    mContacts.push_back(temp_contacts[0][i]);
-                }
             }
-            else if (temp_contacts[1].size() > 0)
+        }
+        // look for vertexFace and take all of them from the first direction that has any, since the contact solver handles the whole manifold at once
+        for (int i = 0; i < 2; i++)
+        {
+            bool found = false;
+            for (const auto& cont : temp_contacts[i])
             {
-                for (int i = 0; i < temp_contacts[1].size(); i++)
+                if (cont.type == ContactType::Vertex_Face)
                 {
-                    mContacts.push_back(temp_contacts[1][i]);
+                    contacts.push_back(cont);
+                    found = true;
                 }
             }
+            if (found)
+                return;
+        }
+
+        // take single edgeedge if possible
+        if (temp_contacts[0].size() > 0 &&
+            temp_contacts[0].size() < temp_contacts[1].size())
+        {
+            contacts.insert(contacts.end(), temp_contacts[0].begin(), temp_contacts[0].end());
+        }
+        else if (temp_contacts[1].size() > 0 &&
+                 temp_contacts[0].size() >
+                     temp_contacts[1].size())
+        {
+            contacts.insert(contacts.end(), temp_contacts[1].begin(), temp_contacts[1].end());
+        }
+        else if (temp_contacts[0].size() > 0)
+        {
+            contacts.insert(contacts.end(), temp_contacts[0].begin(), temp_contacts[0].end());
+        }
+        else if (temp_contacts[1].size() > 0)
+        {
+            contacts.insert(contacts.end(), temp_contacts[1].begin(), temp_contacts[1].end());
         }
     }
 
-    ContactType CollisionDetection::isColliding(const vislab::Ray3d& ray, const vislab::Shape* shape)
+    ContactType CollisionDetection::isColliding(const vislab::Ray3d& ray, const vislab::Shape* shape) const
     {
         int32_t hits = shape->countHits(ray);
 
@@ -437,32 +364,56 @@ namespace physsim
         return ret;
     }
 
-    Contact CollisionDetection::findEdgeEdgeCollision(const Eigen::Vector3d& start, const Eigen::Vector3d& end, const TransformedMesh& mesh)
+    Contact CollisionDetection::findEdgeEdgeCollision(const Eigen::Vector3d& start, const Eigen::Vector3d& end, const TransformedMesh& mesh) const
     {
+        // the penetrating edge bounds the faces that the given edge passes through, which are found among the faces overlapping its box in object space
+        Eigen::AlignedBox3d box(mesh.transform.transformPointInverse(start));
+        box.extend(mesh.transform.transformPointInverse(end));
+        std::vector<uint32_t> faces;
+        mesh.mesh.findOverlappingFaces(box, faces);
+        std::vector<uint32_t> candidates;
+        candidates.reserve(3 * faces.size());
+        for (uint32_t face : faces)
+            for (int j = 0; j < 3; j++)
+                candidates.push_back(mesh.faceEdges.getValue(face)[j]);
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
         double minDist = std::numeric_limits<double>::infinity();
         Contact ret;
-        for (int i = 0; i < mesh.indices.getSize(); i++)
+        for (uint32_t i : candidates)
         {
-            Eigen::Vector3d a = mesh.getVertex(mesh.getPrimitive(i)[0]);
-            Eigen::Vector3d b = mesh.getVertex(mesh.getPrimitive(i)[1]);
-            Eigen::Vector3d c = mesh.getVertex(mesh.getPrimitive(i)[2]);
-
-            Eigen::Vector3d n_face = -(b - a).cross(c - a).normalized();
-
-            for (int j = 0; j < 3; j++)
+            Eigen::Vector3d s = mesh.getVertex(mesh.getEdge(i)[0]);
+            Eigen::Vector3d e = mesh.getVertex(mesh.getEdge(i)[1]);
+
+            Eigen::Vector3d ea = end - start;
+            Eigen::Vector3d eb = e - s;
+            Eigen::Vector3d n  = (ea).cross(eb); // direction of shortest distance
+            double distance    = n.dot(start - s) / n.norm();
+
+            // parameters of the closest points on both edges, which have to lie within the edges
+            Eigen::Vector3d plane_normal   = n.cross(eb).normalized();
+            Eigen::Vector3d plane_normal_a = n.cross(ea).normalized();
+            double t                       = (s - start).dot(plane_normal) / (ea.dot(plane_normal));
+            double u                       = (start - s).dot(plane_normal_a) / (eb.dot(plane_normal_a));
+            if (distance < 0 && -distance < minDist && t >= 0 && t <= 1 && u >= 0 && u <= 1)
             {
-                Eigen::Vector3d s = mesh.getVertex(mesh.getPrimitive(i)[j]);
-                Eigen::Vector3d e = mesh.getVertex(mesh.getPrimitive(i)[(j + 1) % 3]);
-
-                Eigen::Vector3d ea = end - start;
-                Eigen::Vector3d eb = e - s;
-                Eigen::Vector3d n  = (ea).cross(eb); // direction of shortest distance
-                double distance    = n.dot(start - s) / n.norm();
-
-                Eigen::Vector3d plane_normal = n.cross(eb).normalized();
-                double t                     = (s - start).dot(plane_normal) / (ea.dot(plane_normal));
-                if (n_face.dot(n) < 0 && distance < 0 && -distance < minDist &&
-                    t >= 0 && t <= 1)
+                // the shortest distance has to point against the normal of one of the adjacent faces
+                bool facing = false;
+                Eigen::Vector3d n_faces[2];
+                for (int j = 0; j < 2; j++)
+                {
+                    auto face          = mesh.getPrimitive(mesh.edgeFaces.getValue(i)[j]);
+                    Eigen::Vector3d fa = mesh.getVertex(face[0]);
+                    Eigen::Vector3d fb = mesh.getVertex(face[1]);
+                    Eigen::Vector3d fc = mesh.getVertex(face[2]);
+                    n_faces[j]         = -(fb - fa).cross(fc - fa).normalized();
+                    facing |= n_faces[j].dot(n) < 0;
+                }
+
+                // edges between coplanar faces, such as the diagonals of a quad, are no features of the surface
+                bool flat = n_faces[0].dot(n_faces[1]) > 1 - 1E-6;
+                if (facing && !flat)
                 {
                     ret.ea    = ea;
                     ret.eb    = eb;
@@ -478,49 +429,34 @@ namespace physsim
 
     void CollisionDetection::applyImpulse(double eps, double stepSize)
     {
-        // see here fore more information: https://en.wikipedia.org/wiki/Collision_response
-        if (mContacts.empty())
-            return;
-
-        // compute impulse for all contacts
-        for (auto& contact : mContacts)
-        {
-            // compute relative velocity and skip if the bodies are already moving apart
-            Eigen::Vector3d vrel_vec = contact.b->velocity(contact.p) - contact.a->velocity(contact.p);
-            double vrel              = contact.n.dot(vrel_vec);
-            if (vrel < 0)
-            {
-                // bodies are moving apart
-                continue;
-            }
-
-            // vectors ra and rb from the centers of mass to the contact point (in world space)
-            Eigen::Vector3d ra = contact.p - contact.a->position();
-            Eigen::Vector3d rb = contact.p - contact.b->position();
-
-            // TODO: compute impulse response
-            double ima = contact.a->massInverse();
-            double imb = contact.b->massInverse();
-            Eigen::Matrix3d iia = contact.a->inertiaWorldInverse();
-            Eigen::Matrix3d iib = contact.b->inertiaWorldInverse();
-
-            double j_mag = (-(1 + eps) * vrel) / (ima + imb + (iia * ra.cross(contact.n)).cross(ra).dot(contact.n) + (iib * rb.cross(contact.n)).cross(rb).dot(contact.n));
+        // solve all contacts together with sequential impulses, warm started from the last step
+        mContactSolver.solve(mContacts, eps, stepSize);
+    }
 
-            // TODO: apply impulse forces to the bodies at the contact point
-            //Eigen::Vector3d force = j_mag * contact.n;
-            Eigen::Vector3d force = j_mag * contact.n / stepSize;
+    ContactSolver& CollisionDetection::contactSolver()
+    {
+        return mContactSolver;
+    }
 
-            contact.a->applyForce(-force, contact.p);
-            contact.b->applyForce(force, contact.p);
-            //contact.a->applyTorque(ra.cross(force));
-            //contact.b->applyTorque(-ra.cross(force));
+    std::vector<std::pair<size_t, size_t>> CollisionDetection::touchingBodies() const
+    {
+        std::vector<std::pair<size_t, size_t>> touching;
+        touching.reserve(mContacts.size());
+        for (const Contact& contact : mContacts)
+        {
+            if (contact.a && contact.b)
+                touching.push_back(std::make_pair(contact.a->index(), contact.b->index()));
         }
+        return touching;
+    }
+
+    bool CollisionDetection::isActive(size_t index) const
+    {
+        return mObjects[index]->type() == RigidBody::EType::Dynamic && mObjects[index]->isAwake();
     }
 
     void CollisionDetection::clearDataStructures()
     {
-        mPenetratingEdges.clear();
-        mPenetratingVertices.clear();
         mOverlappingBodys.clear();
         mContacts.clear();
     }
@@ -1,14 +1,21 @@
 #pragma once
 
 #include "contact.hpp"
+#include "contact_solver.hpp"
+#include "dynamic_aabb_tree.hpp"
+#include "gilbert_johnson_keerthi.hpp"
+#include "hill_climbing_support.hpp"
 #include "rigid_body.hpp"
+#include "sweep_and_prune.hpp"
 
 #include <vislab/core/array.hpp>
 #include <vislab/graphics/mesh.hpp>
 #include <vislab/graphics/triangle.hpp>
 
 #include <Eigen/Eigen>
-#include <set>
+#include <array>
+#include <memory>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -23,7 +30,8 @@ namespace physsim
     {
         None,
         AABB,
-        SweepAndPrune
+        SweepAndPrune,
+        DynamicTree
     };
 
     /**
@@ -52,7 +60,26 @@ namespace physsim
          */
         void computeCollisionDetection(EBroadPhaseMethod broadPhaseMethod, ENarrowPhaseMethod narrowPhaseMethod, double eps, double stepSize);
 
+        /**
+         * @brief Gets the contact solver, e.g., to change the number of iterations or the friction coefficient.
+         * @return Contact solver.
+         */
+        ContactSolver& contactSolver();
+
+        /**
+         * @brief Gets the pairs of bodies that were found to be in contact during the last collision detection, e.g., to form sleeping islands.
+         * @return Pairs of bodies given by their indices in the rigid body world.
+         */
+        std::vector<std::pair<size_t, size_t>> touchingBodies() const;
+
     private:
+        /**
+         * @brief Checks whether a body moves and has to be tested for collisions. Pairs of bodies that are static or sleeping are skipped.
+         * @param index Index of the body.
+         * @return True if the body is dynamic and awake.
+         */
+        bool isActive(size_t index) const;
+
         /**
          * @brief Perform the broad phase collision detection.
          * @param broadPhaseMethod Broad phase method to apply.
@@ -65,22 +92,31 @@ namespace physsim
          */
         void computeNarrowPhase(ENarrowPhaseMethod narrowPhaseMethod);
 
+        /**
+         * @brief Perform narrow phase collision detection for a single pair of overlapping bodies. Safe to call concurrently.
+         * @param overlap Indices of the two overlapping bodies.
+         * @param narrowPhaseMethod Narrow phase method to apply.
+         * @param warmStarts GJK warm start data of the pair for both directions, or nullptr to start from scratch.
+         * @param penetratingVertices Scratch buffer that flags vertices that were already reported, used to avoid duplicates.
+         * @param contacts Contact list to append the found contacts to.
+         */
+        void computeNarrowPhase(const std::pair<size_t, size_t>& overlap, ENarrowPhaseMethod narrowPhaseMethod, GilbertJohnsonKeerthi::WarmStart* warmStarts, std::vector<bool>& penetratingVertices, std::vector<Contact>& contacts) const;
+
         // test if ray from start towards end intersects object with vertices V and faces F
-        ContactType isColliding(const vislab::Ray3d& ray, const vislab::Shape* shape);
+        ContactType isColliding(const vislab::Ray3d& ray, const vislab::Shape* shape) const;
 
         /**
-         * @brief Loop over edges of faces and compute closest to given edge.
-         * @param start Start of given edge.
-         * @param end End of given edge.
-         * @param V Set of vertices.
-         * @param F Set of face indices.
+         * @brief Finds the edge of a mesh with the smallest penetration of the given edge. Only the edges of faces that overlap the bounding box of the given edge in object space are tested, which are found with the acceleration tree of the mesh.
+         * @param start Start of given edge in world space.
+         * @param end End of given edge in world space.
+         * @param mesh Mesh with its object to world transformation. The edge buffers have to be computed with recomputeEdges().
          * @return Contact information.
          */
-        Contact findEdgeEdgeCollision(const Eigen::Vector3d& start, const Eigen::Vector3d& end, const TransformedMesh& mesh);
+        Contact findEdgeEdgeCollision(const Eigen::Vector3d& start, const Eigen::Vector3d& end, const TransformedMesh& mesh) const;
 
         /**
-         * @brief Apply impulses for the found contacts.
-         * @param eps Impulse epsilon.
+         * @brief Apply impulses for the found contacts by changing the velocities of the bodies.
+         * @param eps Impulse epsilon, used as coefficient of restitution.
          * @param stepSize Numerical integration step size.
          */
         void applyImpulse(double eps, double stepSize);
@@ -101,18 +137,38 @@ namespace physsim
         std::vector<std::pair<size_t, size_t>> mOverlappingBodys;
 
         /**
-         * @brief Set of vertex indices that penetrate a face, used to avoid duplicates.
+         * @brief Sorted interval endpoints that persist across time steps for the sweep and prune broad phase.
          */
-        std::set<int> mPenetratingVertices;
+        SweepAndPrune mSweepAndPrune;
 
         /**
-         * @brief Set of pairs of vertex indices that represent a penetrating edge, used to avoid duplicates.
+         * @brief Bounding volume tree over fattened boxes that persists across time steps for the dynamic tree broad phase.
          */
-        std::set<std::pair<int, int>> mPenetratingEdges;
+        DynamicAabbTree mDynamicTree;
+
+        /**
+         * @brief Proxy identifier in the dynamic tree for each rigid body.
+         */
+        std::vector<int> mProxies;
+
+        /**
+         * @brief Hill climbing support mapping for each mesh, shared by all bodies that use the mesh.
+         */
+        std::unordered_map<const vislab::Mesh*, std::unique_ptr<HillClimbingSupport>> mSupportMappings;
+
+        /**
+         * @brief GJK warm start data for each overlapping pair, indexed by the pair of body indices. Holds one entry per direction.
+         */
+        std::unordered_map<uint64_t, std::array<GilbertJohnsonKeerthi::WarmStart, 2>> mWarmStarts;
 
         /**
          * @brief Computed contact points.
          */
         std::vector<Contact> mContacts;
+
+        /**
+         * @brief Sequential impulse solver that keeps the accumulated impulses of the contacts across time steps.
+         */
+        ContactSolver mContactSolver;
     };
 }
@@ -2,6 +2,8 @@
 
 #include <Eigen/Eigen>
 
+#include <cstdint>
+
 namespace physsim
 {
     class RigidBody;
@@ -30,6 +32,9 @@ namespace physsim
             , eb(0, 0, 0)
             , depth(0)
             , type(ContactType::Vertex_Face)
+            , feature(0)
+            , normalImpulse(0)
+            , tangentImpulse(0, 0)
         {
         }
 
@@ -72,5 +77,20 @@ namespace physsim
          * @brief Type of contact.
          */
         ContactType type;
+
+        /**
+         * @brief Identifies the vertex or edge that caused the contact, such that the contact can be found again in the next time step.
+         */
+        uint32_t feature;
+
+        /**
+         * @brief Accumulated impulse along the normal, computed by the contact solver.
+         */
+        double normalImpulse;
+
+        /**
+         * @brief Accumulated friction impulse in the tangent plane, computed by the contact solver.
+         */
+        Eigen::Vector2d tangentImpulse;
     };
 }
@@ -0,0 +1,271 @@
+#include "contact_solver.hpp"
+
+#include "rigid_body.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+namespace physsim
+{
+    ContactSolver::ContactSolver()
+        : mIterations(10)
+        , mFriction(0.5)
+        , mBaumgarte(0.2)
+        , mSlop(0.005)
+        , mRestitutionThreshold(0.5)
+        , mMaxCorrectionVelocity(2.0)
+    {
+    }
+
+    void ContactSolver::solve(std::vector<Contact>& contacts, double restitution, double stepSize)
+    {
+        // assign a state to each body that participates in a contact
+        std::unordered_map<RigidBody*, int> bodyIndex;
+        std::vector<RigidBody*> bodyPtrs;
+        std::vector<BodyState> bodies;
+        auto addBody = [&](RigidBody* body)
+        {
+            auto it = bodyIndex.find(body);
+            if (it != bodyIndex.end())
+                return it->second;
+
+            BodyState state;
+            state.v = body->linearVelocity();
+            state.w = body->angularVelocity();
+            if (body->type() == RigidBody::EType::Dynamic)
+            {
+                state.invMass    = body->massInverse();
+                state.invInertia = body->inertiaWorldInverse();
+            }
+            else
+            {
+                state.invMass    = 0;
+                state.invInertia = Eigen::Matrix3d::Zero();
+            }
+            int index       = int(bodies.size());
+            bodyIndex[body] = index;
+            bodyPtrs.push_back(body);
+            bodies.push_back(state);
+            return index;
+        };
+
+        // union-find over dynamic bodies. Static bodies do not connect islands, since they are not changed by the solver.
+        std::vector<int> parent;
+        auto find = [&](int i)
+        {
+            while (parent[i] != i)
+            {
+                parent[i] = parent[parent[i]];
+                i         = parent[i];
+            }
+            return i;
+        };
+
+        std::vector<Constraint> constraints;
+        constraints.reserve(contacts.size());
+        for (size_t i = 0; i < contacts.size(); ++i)
+        {
+            Contact& contact = contacts[i];
+            if (contact.type == ContactType::None || !contact.a || !contact.b)
+                continue;
+            if (contact.a->type() != RigidBody::EType::Dynamic && contact.b->type() != RigidBody::EType::Dynamic)
+                continue;
+
+            Constraint c{};
+            c.contact = i;
+            c.a       = addBody(contact.a);
+            c.b       = addBody(contact.b);
+            constraints.push_back(c);
+        }
+        if (constraints.empty())
+        {
+            mImpulses.clear();
+            return;
+        }
+
+        parent.resize(bodies.size());
+        std::iota(parent.begin(), parent.end(), 0);
+        for (const Constraint& c : constraints)
+        {
+            if (bodies[c.a].invMass != 0 && bodies[c.b].invMass != 0)
+                parent[find(c.a)] = find(c.b);
+        }
+
+        // group the constraints by island
+        std::vector<int> islandOfRoot(bodies.size(), -1);
+        std::vector<std::vector<Constraint>> islands;
+        for (const Constraint& c : constraints)
+        {
+            int root = find(bodies[c.a].invMass != 0 ? c.a : c.b);
+            if (islandOfRoot[root] < 0)
+            {
+                islandOfRoot[root] = int(islands.size());
+                islands.emplace_back();
+            }
+            islands[islandOfRoot[root]].push_back(c);
+        }
+
+        // prepare the constraints and fetch the impulses of the last step
+        for (auto& island : islands)
+        {
+            for (Constraint& c : island)
+            {
+                Contact& contact         = contacts[c.contact];
+                const BodyState& A       = bodies[c.a];
+                const BodyState& B       = bodies[c.b];
+                const Eigen::Vector3d& n = contact.n;
+                c.ra                     = contact.p - contact.a->position();
+                c.rb                     = contact.p - contact.b->position();
+
+                auto effectiveMass = [&](const Eigen::Vector3d& dir)
+                {
+                    Eigen::Vector3d rna = c.ra.cross(dir);
+                    Eigen::Vector3d rnb = c.rb.cross(dir);
+                    double k            = A.invMass + B.invMass + rna.dot(A.invInertia * rna) + rnb.dot(B.invInertia * rnb);
+                    return k > 0 ? 1.0 / k : 0.0;
+                };
+                c.normalMass = effectiveMass(n);
+
+                // orthonormal basis of the friction plane
+                c.tangent[0]     = std::abs(n.x()) < 0.57735 ? n.cross(Eigen::Vector3d::UnitX()).normalized() : n.cross(Eigen::Vector3d::UnitY()).normalized();
+                c.tangent[1]     = n.cross(c.tangent[0]);
+                c.tangentMass[0] = effectiveMass(c.tangent[0]);
+                c.tangentMass[1] = effectiveMass(c.tangent[1]);
+
+                // restitution for fast approaching contacts, otherwise push out the penetration
+                Eigen::Vector3d vrel = (A.v + A.w.cross(c.ra)) - (B.v + B.w.cross(c.rb));
+                double vn            = vrel.dot(n);
+                double bounce        = vn < -mRestitutionThreshold ? -restitution * vn : 0.0;
+                double push          = std::min(mBaumgarte / stepSize * std::max(std::abs(contact.depth) - mSlop, 0.0), mMaxCorrectionVelocity);
+                c.bias               = std::max(bounce, push);
+
+                auto it = mImpulses.find({ contact.a, contact.b, contact.feature });
+                if (it != mImpulses.end())
+                {
+                    contact.normalImpulse  = it->second.normal;
+                    contact.tangentImpulse = it->second.tangent;
+                }
+                else
+                {
+                    contact.normalImpulse  = 0;
+                    contact.tangentImpulse = Eigen::Vector2d::Zero();
+                }
+            }
+        }
+
+        // islands share no dynamic body and can be solved concurrently
+#ifndef _DEBUG
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int64_t i = 0; i < (int64_t)islands.size(); ++i)
+        {
+            solveIsland(islands[i], contacts, bodies);
+        }
+
+        // write back the velocities and keep the impulses for the next step
+        for (size_t i = 0; i < bodies.size(); ++i)
+        {
+            if (bodies[i].invMass == 0)
+                continue;
+            bodyPtrs[i]->setLinearVelocity(bodies[i].v);
+            bodyPtrs[i]->setAngularVelocity(bodies[i].w);
+        }
+        mImpulses.clear();
+        for (const Constraint& c : constraints)
+        {
+            const Contact& contact                               = contacts[c.contact];
+            mImpulses[{ contact.a, contact.b, contact.feature }] = { contact.normalImpulse, contact.tangentImpulse };
+        }
+    }
+
+    void ContactSolver::clear()
+    {
+        mImpulses.clear();
+    }
+
+    int ContactSolver::iterations() const
+    {
+        return mIterations;
+    }
+
+    void ContactSolver::setIterations(int iterations)
+    {
+        mIterations = iterations;
+    }
+
+    double ContactSolver::friction() const
+    {
+        return mFriction;
+    }
+
+    void ContactSolver::setFriction(double friction)
+    {
+        mFriction = friction;
+    }
+
+    size_t ContactSolver::ContactKeyHash::operator()(const ContactKey& key) const
+    {
+        size_t h = std::hash<const RigidBody*>()(key.a);
+        h ^= std::hash<const RigidBody*>()(key.b) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<uint32_t>()(key.feature) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+
+    void ContactSolver::solveIsland(std::vector<Constraint>& constraints, std::vector<Contact>& contacts, std::vector<BodyState>& bodies) const
+    {
+        // warm start with the impulses of the last step
+        for (const Constraint& c : constraints)
+        {
+            const Contact& contact  = contacts[c.contact];
+            Eigen::Vector3d impulse = contact.normalImpulse * contact.n + contact.tangentImpulse[0] * c.tangent[0] + contact.tangentImpulse[1] * c.tangent[1];
+            applyImpulse(c, impulse, bodies);
+        }
+
+        for (int iteration = 0; iteration < mIterations; ++iteration)
+        {
+            for (const Constraint& c : constraints)
+            {
+                Contact& contact   = contacts[c.contact];
+                const BodyState& A = bodies[c.a];
+                const BodyState& B = bodies[c.b];
+
+                // friction, limited by the current normal impulse
+                Eigen::Vector3d vrel = (A.v + A.w.cross(c.ra)) - (B.v + B.w.cross(c.rb));
+                Eigen::Vector2d old  = contact.tangentImpulse;
+                for (int t = 0; t < 2; ++t)
+                    contact.tangentImpulse[t] -= c.tangentMass[t] * vrel.dot(c.tangent[t]);
+                double maxFriction = mFriction * contact.normalImpulse;
+                double norm        = contact.tangentImpulse.norm();
+                if (norm > maxFriction)
+                    contact.tangentImpulse *= maxFriction / norm;
+                Eigen::Vector2d delta = contact.tangentImpulse - old;
+                applyImpulse(c, delta[0] * c.tangent[0] + delta[1] * c.tangent[1], bodies);
+
+                // normal impulse, the accumulated impulse may only push
+                vrel                  = (A.v + A.w.cross(c.ra)) - (B.v + B.w.cross(c.rb));
+                double lambda         = c.normalMass * (c.bias - vrel.dot(contact.n));
+                double oldNormal      = contact.normalImpulse;
+                contact.normalImpulse = std::max(oldNormal + lambda, 0.0);
+                applyImpulse(c, (contact.normalImpulse - oldNormal) * contact.n, bodies);
+            }
+        }
+    }
+
+    void ContactSolver::applyImpulse(const Constraint& c, const Eigen::Vector3d& impulse, std::vector<BodyState>& bodies)
+    {
+        // static bodies may be shared between islands and are never written
+        BodyState& A = bodies[c.a];
+        BodyState& B = bodies[c.b];
+        if (A.invMass != 0)
+        {
+            A.v += A.invMass * impulse;
+            A.w += A.invInertia * c.ra.cross(impulse);
+        }
+        if (B.invMass != 0)
+        {
+            B.v -= B.invMass * impulse;
+            B.w -= B.invInertia * c.rb.cross(impulse);
+        }
+    }
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+#include "contact.hpp"
+
+#include <Eigen/Eigen>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace physsim
+{
+    /**
+     * @brief Sequential impulse solver (projected Gauss-Seidel) for contacts with Coulomb friction.
+     * @details All contacts are solved together on the velocity level by iteratively applying impulses and clamping the accumulated impulse of each contact, such that contacts only push and friction stays inside the friction cone. The accumulated impulses are stored per contact feature and used as initial guess in the next time step (warm starting). Bodies that touch each other form islands that do not interact and are solved in parallel.
+     */
+    class ContactSolver
+    {
+    public:
+        /**
+         * @brief Constructor with default settings.
+         */
+        ContactSolver();
+
+        /**
+         * @brief Solves the contacts by changing the linear and angular velocities of the dynamic bodies.
+         * @param contacts Contacts of the current time step. Receives the accumulated impulses.
+         * @param restitution Coefficient of restitution in [0,1]. A value of 1 is energy conserving.
+         * @param stepSize Numerical integration step size.
+         */
+        void solve(std::vector<Contact>& contacts, double restitution, double stepSize);
+
+        /**
+         * @brief Removes all stored impulses.
+         */
+        void clear();
+
+        /**
+         * @brief Gets the number of Gauss-Seidel iterations.
+         * @return Number of iterations.
+         */
+        int iterations() const;
+
+        /**
+         * @brief Sets the number of Gauss-Seidel iterations.
+         * @param iterations Number of iterations.
+         */
+        void setIterations(int iterations);
+
+        /**
+         * @brief Gets the Coulomb friction coefficient.
+         * @return Friction coefficient.
+         */
+        double friction() const;
+
+        /**
+         * @brief Sets the Coulomb friction coefficient.
+         * @param friction Friction coefficient.
+         */
+        void setFriction(double friction);
+
+    private:
+        /**
+         * @brief Velocities and inverse masses of a body during the solve.
+         */
+        struct BodyState
+        {
+            /**
+             * @brief Linear velocity.
+             */
+            Eigen::Vector3d v;
+
+            /**
+             * @brief Angular velocity.
+             */
+            Eigen::Vector3d w;
+
+            /**
+             * @brief Inverse mass. Zero for static bodies.
+             */
+            double invMass;
+
+            /**
+             * @brief Inverse inertia tensor in world space. Zero for static bodies.
+             */
+            Eigen::Matrix3d invInertia;
+        };
+
+        /**
+         * @brief Precomputed data of a contact during the solve.
+         */
+        struct Constraint
+        {
+            /**
+             * @brief Constructor, which zero-initializes all data.
+             */
+            Constraint()
+                : contact(0)
+                , a(-1)
+                , b(-1)
+                , ra(0, 0, 0)
+                , rb(0, 0, 0)
+                , tangent{ Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(0, 0, 0) }
+                , normalMass(0)
+                , tangentMass{ 0, 0 }
+                , bias(0)
+            {
+            }
+
+            /**
+             * @brief Index of the contact.
+             */
+            size_t contact;
+
+            /**
+             * @brief Body state index of A.
+             */
+            int a;
+
+            /**
+             * @brief Body state index of B.
+             */
+            int b;
+
+            /**
+             * @brief Vector from the center of mass of A to the contact point.
+             */
+            Eigen::Vector3d ra;
+
+            /**
+             * @brief Vector from the center of mass of B to the contact point.
+             */
+            Eigen::Vector3d rb;
+
+            /**
+             * @brief Two tangent directions that span the friction plane.
+             */
+            Eigen::Vector3d tangent[2];
+
+            /**
+             * @brief Effective mass along the normal.
+             */
+            double normalMass;
+
+            /**
+             * @brief Effective masses along the tangents.
+             */
+            double tangentMass[2];
+
+            /**
+             * @brief Target separating velocity from restitution and penetration correction.
+             */
+            double bias;
+        };
+
+        /**
+         * @brief Identifies a contact across time steps by its bodies and feature.
+         */
+        struct ContactKey
+        {
+            /**
+             * @brief Checks whether two keys are equal.
+             * @param other Key to compare with.
+             * @return True if the keys are equal.
+             */
+            bool operator==(const ContactKey& other) const
+            {
+                return a == other.a && b == other.b && feature == other.feature;
+            }
+
+            /**
+             * @brief First body.
+             */
+            const RigidBody* a;
+
+            /**
+             * @brief Second body.
+             */
+            const RigidBody* b;
+
+            /**
+             * @brief Feature identifier of the contact.
+             */
+            uint32_t feature;
+        };
+
+        /**
+         * @brief Hash function for contact keys.
+         */
+        struct ContactKeyHash
+        {
+            /**
+             * @brief Computes the hash of a key.
+             * @param key Key to hash.
+             * @return Hash value.
+             */
+            size_t operator()(const ContactKey& key) const;
+        };
+
+        /**
+         * @brief Accumulated impulses of a contact.
+         */
+        struct Impulse
+        {
+            /**
+             * @brief Accumulated impulse along the normal.
+             */
+            double normal;
+
+            /**
+             * @brief Accumulated friction impulse along the two tangents.
+             */
+            Eigen::Vector2d tangent;
+        };
+
+        /**
+         * @brief Solves the contacts of one island.
+         * @param constraints Constraints of the island.
+         * @param contacts All contacts.
+         * @param bodies All body states.
+         */
+        void solveIsland(std::vector<Constraint>& constraints, std::vector<Contact>& contacts, std::vector<BodyState>& bodies) const;
+
+        /**
+         * @brief Applies an impulse to the two bodies of a constraint.
+         * @param c Constraint.
+         * @param impulse Impulse that is applied to A, B receives the negative.
+         * @param bodies All body states.
+         */
+        static void applyImpulse(const Constraint& c, const Eigen::Vector3d& impulse, std::vector<BodyState>& bodies);
+
+        /**
+         * @brief Accumulated impulses of the last time step.
+         */
+        std::unordered_map<ContactKey, Impulse, ContactKeyHash> mImpulses;
+
+        /**
+         * @brief Number of Gauss-Seidel iterations.
+         */
+        int mIterations;
+
+        /**
+         * @brief Coulomb friction coefficient.
+         */
+        double mFriction;
+
+        /**
+         * @brief Fraction of the penetration that is removed per time step.
+         */
+        double mBaumgarte;
+
+        /**
+         * @brief Penetration depth that is tolerated without correction, which avoids jitter of resting contacts.
+         */
+        double mSlop;
+
+        /**
+         * @brief Approaching velocity below which no restitution is applied, such that resting contacts come to rest.
+         */
+        double mRestitutionThreshold;
+
+        /**
+         * @brief Upper bound for the separating velocity that removes penetration, which keeps deep or misclassified contacts from launching bodies.
+         */
+        double mMaxCorrectionVelocity;
+    };
+}
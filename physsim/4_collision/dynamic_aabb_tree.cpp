@@ -0,0 +1,334 @@
+#include "dynamic_aabb_tree.hpp"
+
+#include <algorithm>
+
+namespace physsim
+{
+    DynamicAabbTree::DynamicAabbTree(double margin)
+        : mRoot(NullNode)
+        , mFreeList(NullNode)
+        , mProxyCount(0)
+        , mMargin(margin)
+    {
+    }
+
+    int DynamicAabbTree::createProxy(const Eigen::AlignedBox3d& bounds, size_t userData)
+    {
+        int proxyId              = allocateNode();
+        Eigen::Vector3d margin   = Eigen::Vector3d::Constant(mMargin);
+        mNodes[proxyId].bounds   = Eigen::AlignedBox3d(bounds.min() - margin, bounds.max() + margin);
+        mNodes[proxyId].userData = userData;
+        mNodes[proxyId].height   = 0;
+        insertLeaf(proxyId);
+        mProxyCount++;
+        return proxyId;
+    }
+
+    void DynamicAabbTree::destroyProxy(int proxyId)
+    {
+        removeLeaf(proxyId);
+        freeNode(proxyId);
+        mProxyCount--;
+    }
+
+    bool DynamicAabbTree::moveProxy(int proxyId, const Eigen::AlignedBox3d& bounds)
+    {
+        // the fat box still encloses the object, nothing to do
+        if (mNodes[proxyId].bounds.contains(bounds))
+            return false;
+
+        removeLeaf(proxyId);
+        Eigen::Vector3d margin = Eigen::Vector3d::Constant(mMargin);
+        mNodes[proxyId].bounds = Eigen::AlignedBox3d(bounds.min() - margin, bounds.max() + margin);
+        insertLeaf(proxyId);
+        return true;
+    }
+
+    const Eigen::AlignedBox3d& DynamicAabbTree::fatBounds(int proxyId) const
+    {
+        return mNodes[proxyId].bounds;
+    }
+
+    size_t DynamicAabbTree::userData(int proxyId) const
+    {
+        return mNodes[proxyId].userData;
+    }
+
+    void DynamicAabbTree::clear()
+    {
+        mNodes.clear();
+        mRoot       = NullNode;
+        mFreeList   = NullNode;
+        mProxyCount = 0;
+    }
+
+    size_t DynamicAabbTree::size() const
+    {
+        return mProxyCount;
+    }
+
+    int DynamicAabbTree::height() const
+    {
+        return mRoot == NullNode ? 0 : mNodes[mRoot].height;
+    }
+
+    double DynamicAabbTree::margin() const
+    {
+        return mMargin;
+    }
+
+    int DynamicAabbTree::allocateNode()
+    {
+        int index;
+        if (mFreeList != NullNode)
+        {
+            index     = mFreeList;
+            mFreeList = mNodes[index].parent;
+        }
+        else
+        {
+            index = int(mNodes.size());
+            mNodes.emplace_back();
+        }
+        Node& node    = mNodes[index];
+        node.parent   = NullNode;
+        node.left     = NullNode;
+        node.right    = NullNode;
+        node.height   = 0;
+        node.userData = 0;
+        node.bounds.setEmpty();
+        return index;
+    }
+
+    void DynamicAabbTree::freeNode(int index)
+    {
+        mNodes[index].parent = mFreeList;
+        mNodes[index].height = -1;
+        mFreeList            = index;
+    }
+
+    void DynamicAabbTree::insertLeaf(int leaf)
+    {
+        if (mRoot == NullNode)
+        {
+            mRoot               = leaf;
+            mNodes[leaf].parent = NullNode;
+            return;
+        }
+
+        // descend to the sibling that causes the smallest increase in surface area
+        const Eigen::AlignedBox3d leafBounds = mNodes[leaf].bounds;
+        int index                            = mRoot;
+        while (!mNodes[index].isLeaf())
+        {
+            const Node& node     = mNodes[index];
+            double nodeArea      = area(node.bounds);
+            double combinedArea  = area(node.bounds.merged(leafBounds));
+            double cost          = 2.0 * combinedArea;              // cost of creating a new parent for this node and the leaf
+            double inheritedCost = 2.0 * (combinedArea - nodeArea); // minimum cost of pushing the leaf further down
+
+            auto descendCost = [&](int child)
+            {
+                const Node& c = mNodes[child];
+                double merged = area(c.bounds.merged(leafBounds));
+                return c.isLeaf() ? merged + inheritedCost : merged - area(c.bounds) + inheritedCost;
+            };
+            double costLeft  = descendCost(node.left);
+            double costRight = descendCost(node.right);
+
+            if (cost < costLeft && cost < costRight)
+                break;
+
+            index = costLeft < costRight ? node.left : node.right;
+        }
+        int sibling = index;
+
+        // create a new parent for the sibling and the leaf
+        int oldParent            = mNodes[sibling].parent;
+        int newParent            = allocateNode();
+        mNodes[newParent].parent = oldParent;
+        mNodes[newParent].bounds = mNodes[sibling].bounds.merged(leafBounds);
+        mNodes[newParent].height = mNodes[sibling].height + 1;
+        mNodes[newParent].left   = sibling;
+        mNodes[newParent].right  = leaf;
+        mNodes[sibling].parent   = newParent;
+        mNodes[leaf].parent      = newParent;
+
+        if (oldParent != NullNode)
+        {
+            if (mNodes[oldParent].left == sibling)
+                mNodes[oldParent].left = newParent;
+            else
+                mNodes[oldParent].right = newParent;
+        }
+        else
+        {
+            mRoot = newParent;
+        }
+
+        refitAncestors(newParent);
+    }
+
+    void DynamicAabbTree::removeLeaf(int leaf)
+    {
+        if (leaf == mRoot)
+        {
+            mRoot = NullNode;
+            return;
+        }
+
+        int parent      = mNodes[leaf].parent;
+        int grandParent = mNodes[parent].parent;
+        int sibling     = mNodes[parent].left == leaf ? mNodes[parent].right : mNodes[parent].left;
+
+        if (grandParent != NullNode)
+        {
+            // splice the sibling into the place of the parent
+            if (mNodes[grandParent].left == parent)
+                mNodes[grandParent].left = sibling;
+            else
+                mNodes[grandParent].right = sibling;
+            mNodes[sibling].parent = grandParent;
+            freeNode(parent);
+            refitAncestors(grandParent);
+        }
+        else
+        {
+            mRoot                  = sibling;
+            mNodes[sibling].parent = NullNode;
+            freeNode(parent);
+        }
+        mNodes[leaf].parent = NullNode;
+    }
+
+    void DynamicAabbTree::refitAncestors(int index)
+    {
+        while (index != NullNode)
+        {
+            index = balance(index);
+
+            Node& node        = mNodes[index];
+            const Node& left  = mNodes[node.left];
+            const Node& right = mNodes[node.right];
+            node.height       = 1 + std::max(left.height, right.height);
+            node.bounds       = left.bounds.merged(right.bounds);
+
+            index = node.parent;
+        }
+    }
+
+    int DynamicAabbTree::balance(int iA)
+    {
+        Node& A = mNodes[iA];
+        if (A.isLeaf() || A.height < 2)
+            return iA;
+
+        int iB        = A.left;
+        int iC        = A.right;
+        Node& B       = mNodes[iB];
+        Node& C       = mNodes[iC];
+        int imbalance = C.height - B.height;
+
+        // rotate C up
+        if (imbalance > 1)
+        {
+            int iF  = C.left;
+            int iG  = C.right;
+            Node& F = mNodes[iF];
+            Node& G = mNodes[iG];
+
+            C.left   = iA;
+            C.parent = A.parent;
+            A.parent = iC;
+
+            if (C.parent != NullNode)
+            {
+                if (mNodes[C.parent].left == iA)
+                    mNodes[C.parent].left = iC;
+                else
+                    mNodes[C.parent].right = iC;
+            }
+            else
+            {
+                mRoot = iC;
+            }
+
+            if (F.height > G.height)
+            {
+                C.right  = iF;
+                A.right  = iG;
+                G.parent = iA;
+                A.bounds = B.bounds.merged(G.bounds);
+                C.bounds = A.bounds.merged(F.bounds);
+                A.height = 1 + std::max(B.height, G.height);
+                C.height = 1 + std::max(A.height, F.height);
+            }
+            else
+            {
+                C.right  = iG;
+                A.right  = iF;
+                F.parent = iA;
+                A.bounds = B.bounds.merged(F.bounds);
+                C.bounds = A.bounds.merged(G.bounds);
+                A.height = 1 + std::max(B.height, F.height);
+                C.height = 1 + std::max(A.height, G.height);
+            }
+            return iC;
+        }
+
+        // rotate B up
+        if (imbalance < -1)
+        {
+            int iD  = B.left;
+            int iE  = B.right;
+            Node& D = mNodes[iD];
+            Node& E = mNodes[iE];
+
+            B.left   = iA;
+            B.parent = A.parent;
+            A.parent = iB;
+
+            if (B.parent != NullNode)
+            {
+                if (mNodes[B.parent].left == iA)
+                    mNodes[B.parent].left = iB;
+                else
+                    mNodes[B.parent].right = iB;
+            }
+            else
+            {
+                mRoot = iB;
+            }
+
+            if (D.height > E.height)
+            {
+                B.right  = iD;
+                A.left   = iE;
+                E.parent = iA;
+                A.bounds = C.bounds.merged(E.bounds);
+                B.bounds = A.bounds.merged(D.bounds);
+                A.height = 1 + std::max(C.height, E.height);
+                B.height = 1 + std::max(A.height, D.height);
+            }
+            else
+            {
+                B.right  = iE;
+                A.left   = iD;
+                D.parent = iA;
+                A.bounds = C.bounds.merged(D.bounds);
+                B.bounds = A.bounds.merged(E.bounds);
+                A.height = 1 + std::max(C.height, D.height);
+                B.height = 1 + std::max(A.height, E.height);
+            }
+            return iB;
+        }
+
+        return iA;
+    }
+
+    double DynamicAabbTree::area(const Eigen::AlignedBox3d& bounds)
+    {
+        Eigen::Vector3d delta = bounds.max() - bounds.min();
+        return 2.0 * (delta.x() * delta.y() + delta.x() * delta.z() + delta.y() * delta.z());
+    }
+}
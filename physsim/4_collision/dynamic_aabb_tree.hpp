@@ -0,0 +1,239 @@
+#pragma once
+
+#include <Eigen/Eigen>
+
+#include <vector>
+
+namespace physsim
+{
+    /**
+     * @brief Dynamic bounding volume tree over fattened axis-aligned bounding boxes.
+     * @details Each proxy stores an enlarged (fat) box. As long as the tight box of a moving object stays inside its fat box, the tree is left untouched. Only proxies that escape their fat box are removed and reinserted, using a surface area heuristic to pick the sibling and tree rotations to keep the hierarchy balanced.
+     */
+    class DynamicAabbTree
+    {
+    public:
+        /**
+         * @brief Index that marks the absence of a node.
+         */
+        static const int NullNode = -1;
+
+        /**
+         * @brief Constructor of an empty tree.
+         * @param margin Amount by which the boxes of the proxies are enlarged on each side.
+         */
+        explicit DynamicAabbTree(double margin = 0.1);
+
+        /**
+         * @brief Inserts a new proxy into the tree.
+         * @param bounds Tight bounding box of the object.
+         * @param userData Index of the object that is represented by the proxy.
+         * @return Identifier of the proxy.
+         */
+        int createProxy(const Eigen::AlignedBox3d& bounds, size_t userData);
+
+        /**
+         * @brief Removes a proxy from the tree.
+         * @param proxyId Identifier of the proxy to remove.
+         */
+        void destroyProxy(int proxyId);
+
+        /**
+         * @brief Updates the bounding box of a proxy. The proxy is only reinserted if the tight box left its fat box.
+         * @param proxyId Identifier of the proxy to move.
+         * @param bounds New tight bounding box of the object.
+         * @return True if the proxy was reinserted.
+         */
+        bool moveProxy(int proxyId, const Eigen::AlignedBox3d& bounds);
+
+        /**
+         * @brief Gets the fattened bounding box of a proxy.
+         * @param proxyId Identifier of the proxy.
+         * @return Fattened bounding box.
+         */
+        const Eigen::AlignedBox3d& fatBounds(int proxyId) const;
+
+        /**
+         * @brief Gets the object index that is associated with a proxy.
+         * @param proxyId Identifier of the proxy.
+         * @return Object index.
+         */
+        size_t userData(int proxyId) const;
+
+        /**
+         * @brief Calls a callback for each proxy whose fat box overlaps the given box.
+         * @tparam TCallback Callable with signature bool(size_t userData). Returning false stops the query.
+         * @param bounds Box to test against.
+         * @param callback Callback that is invoked for every overlapping proxy.
+         */
+        template <typename TCallback>
+        void query(const Eigen::AlignedBox3d& bounds, TCallback&& callback) const
+        {
+            if (mRoot == NullNode)
+                return;
+
+            mQueryStack.clear();
+            mQueryStack.push_back(mRoot);
+            while (!mQueryStack.empty())
+            {
+                int index = mQueryStack.back();
+                mQueryStack.pop_back();
+
+                const Node& node = mNodes[index];
+                if (!node.bounds.intersects(bounds))
+                    continue;
+
+                if (node.isLeaf())
+                {
+                    if (!callback(node.userData))
+                        return;
+                }
+                else
+                {
+                    mQueryStack.push_back(node.left);
+                    mQueryStack.push_back(node.right);
+                }
+            }
+        }
+
+        /**
+         * @brief Removes all proxies from the tree.
+         */
+        void clear();
+
+        /**
+         * @brief Gets the number of proxies in the tree.
+         * @return Number of proxies.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Gets the height of the tree.
+         * @return Height of the root node, or zero for an empty tree.
+         */
+        int height() const;
+
+        /**
+         * @brief Gets the margin by which the proxy boxes are enlarged.
+         * @return Margin on each side.
+         */
+        double margin() const;
+
+    private:
+        /**
+         * @brief Node of the tree. Leaves hold a proxy, inner nodes always have two children.
+         */
+        struct Node
+        {
+            /**
+             * @brief Checks whether the node is a leaf.
+             * @return True if the node has no children.
+             */
+            bool isLeaf() const { return left == NullNode; }
+
+            /**
+             * @brief Fattened bounding box for leaves, union of the children for inner nodes.
+             */
+            Eigen::AlignedBox3d bounds;
+
+            /**
+             * @brief Object index stored in a leaf.
+             */
+            size_t userData;
+
+            /**
+             * @brief Parent node, or the next free node if the node is in the free list.
+             */
+            int parent;
+
+            /**
+             * @brief Left child.
+             */
+            int left;
+
+            /**
+             * @brief Right child.
+             */
+            int right;
+
+            /**
+             * @brief Height of the subtree. Leaves have height 0, free nodes have height -1.
+             */
+            int height;
+        };
+
+        /**
+         * @brief Takes a node from the free list or grows the node pool.
+         * @return Index of the allocated node.
+         */
+        int allocateNode();
+
+        /**
+         * @brief Returns a node to the free list.
+         * @param index Index of the node to release.
+         */
+        void freeNode(int index);
+
+        /**
+         * @brief Inserts a leaf into the tree, choosing the sibling with the lowest surface area cost.
+         * @param leaf Index of the leaf to insert.
+         */
+        void insertLeaf(int leaf);
+
+        /**
+         * @brief Removes a leaf from the tree.
+         * @param leaf Index of the leaf to remove.
+         */
+        void removeLeaf(int leaf);
+
+        /**
+         * @brief Walks from a node up to the root and refits bounds and heights, rebalancing along the way.
+         * @param index Index of the first node to refit.
+         */
+        void refitAncestors(int index);
+
+        /**
+         * @brief Performs a left or right rotation if the subtree rooted at the given node is unbalanced.
+         * @param index Index of the subtree root.
+         * @return Index of the new subtree root.
+         */
+        int balance(int index);
+
+        /**
+         * @brief Computes the surface area of a box.
+         * @param bounds Box to compute the surface area for.
+         * @return Surface area.
+         */
+        static double area(const Eigen::AlignedBox3d& bounds);
+
+        /**
+         * @brief Pool of nodes.
+         */
+        std::vector<Node> mNodes;
+
+        /**
+         * @brief Root node of the tree.
+         */
+        int mRoot;
+
+        /**
+         * @brief Head of the list of free nodes.
+         */
+        int mFreeList;
+
+        /**
+         * @brief Number of proxies in the tree.
+         */
+        size_t mProxyCount;
+
+        /**
+         * @brief Amount by which the proxy boxes are enlarged.
+         */
+        double mMargin;
+
+        /**
+         * @brief Traversal stack that is reused between queries to avoid allocations.
+         */
+        mutable std::vector<int> mQueryStack;
+    };
+}
@@ -7,25 +7,35 @@
 namespace physsim
 {
     Contact GilbertJohnsonKeerthi::findCollisionGJK(const TransformedMesh& A, const TransformedMesh& B)
+    {
+        WarmStart warmStart;
+        return findCollisionGJK(A, B, warmStart);
+    }
+
+    Contact GilbertJohnsonKeerthi::findCollisionGJK(const TransformedMesh& A, const TransformedMesh& B, WarmStart& warmStart)
     {
         Contact ret;
         ret.type = ContactType::None;
 
-        SupportVec a, b, c, d;        // set of coordinates of the simplex S
-        Eigen::Vector3d dir(1, 0, 0); // initial direction
+        SupportVec a, b, c, d; // set of coordinates of the simplex S
+        Eigen::Vector3d dir = warmStart.direction.isZero() ? Eigen::Vector3d(1, 0, 0) : warmStart.direction; // initial direction, taken from the last query
 
         // TODO: find first point on Minkoswki difference (store in c)
-        c = support(A, B, dir);
+        c = support(A, B, dir, warmStart);
 
         // TODO: revert search direction
         dir = -dir;
 
         // TODO: find second point on Minkoswki difference (store in b)
-        b = support(A, B, dir);
+        b = support(A, B, dir, warmStart);
 
         // TODO: early out, if we cannot contain the origin (dot product)
         if (b.P.dot(dir) < 0)
+        {
+            // the reverted direction separates the shapes, start there in the next query
+            warmStart.direction = -dir;
             return ret;
+        }
 
         // the next direction is perpendicular to line towards origin
         dir = (c.P - b.P).cross(-b.P).cross(c.P - b.P);
@@ -41,11 +51,14 @@ namespace physsim
         for (int iterations = 0; iterations < GJK_MAX_NUM_ITERATIONS; iterations++)
         {
             // TODO: find next point (store in a)
-            a = support(A, B, dir);
+            a = support(A, B, dir, warmStart);
 
             // TODO: early out, if we cannot contain the origin (dot product)
             if (a.P.dot(dir) < 0)
+            {
+                warmStart.direction = -dir;
                 return ret;
+            }
 
             // virtually add point a to simplex (technically, we have always allocate the memory for it)
             dim++;
@@ -54,32 +67,23 @@ namespace physsim
             if (nearestSimplex(a, b, c, d, dim, dir))
             {
                 // call the EPA algorithm to locate the contact
-                return EPA(a, b, c, d, A, B);
+                return EPA(a, b, c, d, A, B, warmStart);
             }
         }
         return ret;
     }
 
-    Eigen::Vector3d GilbertJohnsonKeerthi::support(const TransformedMesh& mesh, const Eigen::Vector3d& d)
+    Eigen::Vector3d GilbertJohnsonKeerthi::support(const TransformedMesh& mesh, const Eigen::Vector3d& d, Eigen::Index& vertex)
     {
-        // TODO: find the vertex of V that is farthest into direction d.
-        Eigen::Vector3d farthest_vertex = mesh.getVertex(0);
-        
-        for (int i = 0; i < mesh.vertices.getSize(); i++)
-        {
-            Eigen::Vector3d vertex = mesh.getVertex(i);
-            if (vertex.dot(d) > farthest_vertex.dot(d))
-            {
-                farthest_vertex = vertex;
-            }
-        }
-        return farthest_vertex;
+        // hill climb in object space, warm started from the previous support vertex
+        vertex = mesh.findSupport(d, vertex);
+        return mesh.getVertex(vertex);
     }
 
-    GilbertJohnsonKeerthi::SupportVec GilbertJohnsonKeerthi::support(const TransformedMesh& A, const TransformedMesh& B, const Eigen::Vector3d& d)
+    GilbertJohnsonKeerthi::SupportVec GilbertJohnsonKeerthi::support(const TransformedMesh& A, const TransformedMesh& B, const Eigen::Vector3d& d, WarmStart& warmStart)
     {
-        Eigen::Vector3d sup_A = support(A, d);
-        Eigen::Vector3d sup_B = support(B, -d);
+        Eigen::Vector3d sup_A = support(A, d, warmStart.vertexA);
+        Eigen::Vector3d sup_B = support(B, -d, warmStart.vertexB);
         return SupportVec(sup_A, sup_B, sup_A - sup_B);
     }
 
@@ -156,7 +160,7 @@ namespace physsim
         return false;
     }
 
-    Contact GilbertJohnsonKeerthi::EPA(const SupportVec& a, const SupportVec& b, const SupportVec& c, const SupportVec& d, const TransformedMesh& A, const TransformedMesh& B)
+    Contact GilbertJohnsonKeerthi::EPA(const SupportVec& a, const SupportVec& b, const SupportVec& c, const SupportVec& d, const TransformedMesh& A, const TransformedMesh& B, WarmStart& warmStart)
     {
         const double EPA_TOLERANCE        = 0.0001;
         const int EPA_MAX_NUM_FACES       = 64;
@@ -201,7 +205,7 @@ namespace physsim
 
             // search normal to face that's closest to origin
             Eigen::Vector3d search_dir = faces[closest_face][3].P;
-            SupportVec p               = support(A, B, search_dir);
+            SupportVec p               = support(A, B, search_dir, warmStart);
 
             if (p.P.dot(search_dir) - min_dist < EPA_TOLERANCE)
             {
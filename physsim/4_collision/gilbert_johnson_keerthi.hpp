@@ -2,6 +2,8 @@
 
 #include "contact.hpp"
 
+#include <Eigen/Eigen>
+
 namespace physsim
 {
     struct TransformedMesh;
@@ -12,6 +14,37 @@ namespace physsim
     class GilbertJohnsonKeerthi
     {
     public:
+        /**
+         * @brief Data of a pair of shapes that is kept across time steps to warm start the next query.
+         */
+        struct WarmStart
+        {
+            /**
+             * @brief Empty constructor.
+             */
+            WarmStart()
+                : direction(1, 0, 0)
+                , vertexA(0)
+                , vertexB(0)
+            {
+            }
+
+            /**
+             * @brief Initial search direction. Holds the separating direction after a query without collision.
+             */
+            Eigen::Vector3d direction;
+
+            /**
+             * @brief Last support vertex on A, where the next support query on A starts.
+             */
+            Eigen::Index vertexA;
+
+            /**
+             * @brief Last support vertex on B, where the next support query on B starts.
+             */
+            Eigen::Index vertexB;
+        };
+
         /**
          * @brief Determines whether there is a collision between two sets of vertices.
          * @param A Vertex set A.
@@ -20,6 +53,15 @@ namespace physsim
          */
         static Contact findCollisionGJK(const TransformedMesh& A, const TransformedMesh& B);
 
+        /**
+         * @brief Determines whether there is a collision between two sets of vertices, starting from the result of a previous query.
+         * @param A Vertex set A.
+         * @param B Vertex set B.
+         * @param warmStart Search direction and support vertices of the previous query. Updated for the next query.
+         * @return Contact information.
+         */
+        static Contact findCollisionGJK(const TransformedMesh& A, const TransformedMesh& B, WarmStart& warmStart);
+
     private:
         /**
          * @brief Stores the support function results of both shapes and the Minkowski differences.
@@ -67,20 +109,22 @@ namespace physsim
 
         /**
          * @brief Locates the vertex from a set of vertices V furthest into a direction d.
-         * @param V Matrix that contains the vertices.
+         * @param mesh Mesh that contains the vertices.
          * @param d Direction vector.
+         * @param vertex Vertex to start the search from. Receives the index of the farthest vertex.
          * @return Coordinate of the farthest vertex in direction.
          */
-        static Eigen::Vector3d support(const TransformedMesh& mesh, const Eigen::Vector3d& d);
+        static Eigen::Vector3d support(const TransformedMesh& mesh, const Eigen::Vector3d& d, Eigen::Index& vertex);
 
         /**
          * @brief Locates the vertex on the Minkowski difference of sets of vertices A and B furthest into a direction d
          * @param A First vertex set.
          * @param B Second vertex set.
          * @param d Direction to compute difference for.
+         * @param warmStart Support vertices to start the search from. Receives the new support vertices.
          * @return Support vector.
          */
-        static SupportVec support(const TransformedMesh& A, const TransformedMesh& B, const Eigen::Vector3d& d);
+        static SupportVec support(const TransformedMesh& A, const TransformedMesh& B, const Eigen::Vector3d& d, WarmStart& warmStart);
 
         /**
          * @brief Calculates the closest simplex of a simplex S=(a,b,c,d), where dim is the number of dimensions and a is the last added vertex. Based on: https://github.com/kevinmoran/GJK
@@ -102,8 +146,9 @@ namespace physsim
          * @param d Fourth point of simplex.
          * @param A Vertex set A.
          * @param B Vertex set B.
+         * @param warmStart Support vertices to start the searches from.
          * @return Contact information.
          */
-        static Contact EPA(const SupportVec& a, const SupportVec& b, const SupportVec& c, const SupportVec& d, const TransformedMesh& A, const TransformedMesh& B);
+        static Contact EPA(const SupportVec& a, const SupportVec& b, const SupportVec& c, const SupportVec& d, const TransformedMesh& A, const TransformedMesh& B, WarmStart& warmStart);
     };
 }
@@ -0,0 +1,155 @@
+#include "hill_climbing_support.hpp"
+
+#include <vislab/core/array.hpp>
+#include <vislab/graphics/mesh.hpp>
+
+#include <cmath>
+
+namespace physsim
+{
+    HillClimbingSupport::HillClimbingSupport(const vislab::Mesh& mesh)
+        : mConvex(false)
+    {
+        const vislab::Array3f& positions = *mesh.positions;
+        const vislab::Array2ui& edges    = *mesh.edges;
+
+        mVertices.resize(positions.getSize());
+        for (Eigen::Index i = 0; i < positions.getSize(); ++i)
+            mVertices[i] = positions.getValueDouble(i);
+
+        // count the neighbors per vertex and turn the counts into offsets
+        mNeighborOffsets.assign(mVertices.size() + 1, 0);
+        for (Eigen::Index i = 0; i < edges.getSize(); ++i)
+        {
+            mNeighborOffsets[edges.getValue(i).x() + 1]++;
+            mNeighborOffsets[edges.getValue(i).y() + 1]++;
+        }
+        for (size_t i = 1; i < mNeighborOffsets.size(); ++i)
+            mNeighborOffsets[i] += mNeighborOffsets[i - 1];
+
+        // scatter the edges into the neighbor lists
+        mNeighbors.resize(mNeighborOffsets.back());
+        std::vector<uint32_t> fill(mNeighborOffsets.begin(), mNeighborOffsets.end() - 1);
+        for (Eigen::Index i = 0; i < edges.getSize(); ++i)
+        {
+            Eigen::Vector2u edge         = edges.getValue(i);
+            mNeighbors[fill[edge.x()]++] = edge.y();
+            mNeighbors[fill[edge.y()]++] = edge.x();
+        }
+
+        mConvex = checkConvexity(mesh);
+    }
+
+    Eigen::Index HillClimbingSupport::findSupport(const Eigen::Vector3d& d, Eigen::Index start) const
+    {
+        Eigen::Index best = (start >= 0 && start < (Eigen::Index)mVertices.size()) ? start : 0;
+        double bestDot    = mVertices[best].dot(d);
+
+        if (!mConvex)
+        {
+            for (Eigen::Index i = 0; i < (Eigen::Index)mVertices.size(); ++i)
+            {
+                double dot = mVertices[i].dot(d);
+                if (dot > bestDot)
+                {
+                    bestDot = dot;
+                    best    = i;
+                }
+            }
+            return best;
+        }
+
+        // steepest ascent until no neighbor is better
+        for (;;)
+        {
+            Eigen::Index next = best;
+            for (uint32_t j = mNeighborOffsets[best]; j < mNeighborOffsets[best + 1]; ++j)
+            {
+                double dot = mVertices[mNeighbors[j]].dot(d);
+                if (dot > bestDot)
+                {
+                    bestDot = dot;
+                    next    = mNeighbors[j];
+                }
+            }
+            if (next == best)
+                return best;
+            best = next;
+        }
+    }
+
+    bool HillClimbingSupport::isConvex() const
+    {
+        return mConvex;
+    }
+
+    bool HillClimbingSupport::checkConvexity(const vislab::Mesh& mesh) const
+    {
+        const vislab::Array3ui& indices   = *mesh.indices;
+        const vislab::Array2ui& edges     = *mesh.edges;
+        const vislab::Array2ui& edgeFaces = *mesh.edgeFaces;
+        if (mVertices.empty() || edges.getSize() == 0)
+            return false;
+
+        // all vertices have to be reachable from the first one
+        std::vector<bool> visited(mVertices.size(), false);
+        std::vector<uint32_t> stack(1, 0);
+        visited[0]        = true;
+        size_t numVisited = 1;
+        while (!stack.empty())
+        {
+            uint32_t v = stack.back();
+            stack.pop_back();
+            for (uint32_t j = mNeighborOffsets[v]; j < mNeighborOffsets[v + 1]; ++j)
+            {
+                if (!visited[mNeighbors[j]])
+                {
+                    visited[mNeighbors[j]] = true;
+                    numVisited++;
+                    stack.push_back(mNeighbors[j]);
+                }
+            }
+        }
+        if (numVisited != mVertices.size())
+            return false;
+
+        Eigen::AlignedBox3d bounds;
+        bounds.setEmpty();
+        for (const Eigen::Vector3d& v : mVertices)
+            bounds.extend(v);
+        double tolerance = 1E-6 * bounds.diagonal().norm(); // positions are stored in single precision
+
+        // for each edge, the opposite corner of one adjacent face has to lie on the same side of the other face
+        // for all edges. For a closed and connected surface, local convexity at every edge implies global convexity.
+        int side = 0;
+        for (Eigen::Index i = 0; i < edges.getSize(); ++i)
+        {
+            Eigen::Vector2u faces = edgeFaces.getValue(i);
+            if (faces.x() == faces.y())
+                return false; // boundary edge
+
+            Eigen::Vector3u f0 = indices.getValue(faces.x());
+            Eigen::Vector3u f1 = indices.getValue(faces.y());
+            Eigen::Vector3d a  = mVertices[f0.x()];
+            Eigen::Vector3d n  = (mVertices[f0.y()] - a).cross(mVertices[f0.z()] - a);
+            if (n.isZero())
+                continue; // degenerate face
+            n.normalize();
+
+            Eigen::Vector2u edge = edges.getValue(i);
+            for (int j = 0; j < 3; ++j)
+            {
+                if (f1[j] == edge.x() || f1[j] == edge.y())
+                    continue;
+                double distance = n.dot(mVertices[f1[j]] - a);
+                if (std::abs(distance) <= tolerance)
+                    continue; // coplanar faces
+                int s = distance > 0 ? 1 : -1;
+                if (side != 0 && s != side)
+                    return false;
+                side = s;
+            }
+        }
+        return true;
+    }
+}
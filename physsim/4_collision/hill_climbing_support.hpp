@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Eigen/Eigen>
+
+#include <vector>
+
+namespace vislab
+{
+    class Mesh;
+}
+
+namespace physsim
+{
+    /**
+     * @brief Support mapping of a convex mesh that walks along the vertex adjacency.
+     * @details Since a linear function has no local maxima on a convex polytope other than the global one, the farthest vertex in a direction can be found by greedily moving to the best neighbor. Starting from the result of the previous query, only a few vertices are visited when the direction changes little. Meshes that are not closed, not connected or not convex fall back to a linear scan over all vertices.
+     */
+    class HillClimbingSupport
+    {
+    public:
+        /**
+         * @brief Builds the vertex adjacency from the unique edges of a mesh and checks whether hill climbing is applicable.
+         * @param mesh Mesh in object space. The edge buffers must have been computed with recomputeEdges().
+         */
+        explicit HillClimbingSupport(const vislab::Mesh& mesh);
+
+        /**
+         * @brief Locates the vertex that is farthest into a direction.
+         * @param d Direction in object space.
+         * @param start Vertex to start the search from, typically the result of the previous query. Invalid indices start at the first vertex.
+         * @return Index of the farthest vertex.
+         */
+        Eigen::Index findSupport(const Eigen::Vector3d& d, Eigen::Index start) const;
+
+        /**
+         * @brief Checks whether queries hill-climb along the adjacency or scan all vertices.
+         * @return True if the mesh is closed, connected and convex.
+         */
+        bool isConvex() const;
+
+    private:
+        /**
+         * @brief Checks that the mesh is closed, connected and locally convex at every edge.
+         * @param mesh Mesh with edge buffers.
+         * @return True if hill climbing finds the global maximum.
+         */
+        bool checkConvexity(const vislab::Mesh& mesh) const;
+
+        /**
+         * @brief Vertex positions in object space.
+         */
+        std::vector<Eigen::Vector3d> mVertices;
+
+        /**
+         * @brief Start of the neighbor list of each vertex in mNeighbors. Has one more entry than there are vertices.
+         */
+        std::vector<uint32_t> mNeighborOffsets;
+
+        /**
+         * @brief Concatenated neighbor lists of all vertices.
+         */
+        std::vector<uint32_t> mNeighbors;
+
+        /**
+         * @brief Flag that determines whether hill climbing is applicable.
+         */
+        bool mConvex;
+    };
+}
@@ -1,8 +1,9 @@
 #include "collision_detection.hpp"
 #include "physsim_window.hpp"
 #include "rigid_body.hpp"
-#include "rigid_body_integrator.hpp"
+#include "rigid_body_world.hpp"
 #include "simulation.hpp"
+#include "simulation_registry.hpp"
 
 #include <imgui.h>
 #include <vislab/core/array.hpp>
@@ -77,6 +78,7 @@ namespace physsim
                 { 5, 7, 6 },
             });
 
+            mWorld = std::make_shared<RigidBodyWorld>();
             mRigidBodies.resize(NUM_CUBES + 1);
             Eigen::Vector3d c0(204.0 / 255.0, 0, 0);
             Eigen::Vector3d c1(0, 128.0 / 255.0, 204.0 / 255.0);
@@ -88,7 +90,7 @@ namespace physsim
                 shape->bsdf = std::make_shared<DiffuseBSDF>(std::make_shared<ConstTexture>(c0 * a + c1 * (1 - a)));
                 scene->shapes.push_back(shape);
 
-                mRigidBodies[i] = std::make_shared<RigidBody>();
+                mRigidBodies[i] = mWorld->addBody();
                 mRigidBodies[i]->setMass(1.);
                 mRigidBodies[i]->setInertiaBody(mRigidBodies[i]->mass() * 2.0 / 6.0 * Eigen::Matrix3d::Identity());
                 mRigidBodies[i]->setShape(shape);
@@ -115,7 +117,7 @@ namespace physsim
             ground->bsdf = std::make_shared<DiffuseBSDF>(std::make_shared<ConstTexture>(Spectrum(1, 1, 1)));
             ground->mesh = groundMesh;
             scene->shapes.push_back(ground);
-            mRigidBodies[NUM_CUBES] = std::make_shared<RigidBody>();
+            mRigidBodies[NUM_CUBES] = mWorld->addBody();
             mRigidBodies[NUM_CUBES]->setType(RigidBody::EType::Static);
             mRigidBodies[NUM_CUBES]->setScale(20);
             mRigidBodies[NUM_CUBES]->setPosition({ 0, -5, 0 });
@@ -163,6 +165,10 @@ namespace physsim
                 mRigidBodies[i]->setLinearVelocity(Eigen::Vector3d::Zero());
                 mRigidBodies[i]->setAngularVelocity(Eigen::Vector3d::Zero());
             }
+
+            // impulses and sleep states of the previous run do not apply anymore
+            mCollisionDetection->contactSolver().clear();
+            mWorld->wakeAll();
         }
 
         /**
@@ -191,33 +197,33 @@ namespace physsim
             for (int i = 0; i < NUM_CUBES; ++i)
             {
                 auto body = mRigidBodies[i];
-                if (body->type() == RigidBody::EType::Static)
+                if (body->type() == RigidBody::EType::Static || !body->isAwake())
                     continue;
                 body->applyForceToCenterOfMass(mGravity * body->mass());
             }
 
-            // numerically integrate the bodies
-            for (auto body : mRigidBodies)
+            // numerically integrate all bodies in one pass
+            switch (mIntegrationMethod)
+            {
+            case EIntegrationMethod::ExplicitEuler:
+            {
+                mWorld->integrate(RigidBodyWorld::EIntegrator::ExplicitEuler, mStepSize);
+                break;
+            }
+            case EIntegrationMethod::SymplecticEuler:
+            {
+                mWorld->integrate(RigidBodyWorld::EIntegrator::SymplecticEuler, mStepSize);
+                break;
+            }
+            case EIntegrationMethod::Implicit:
             {
-                switch (mIntegrationMethod)
-                {
-                case EIntegrationMethod::ExplicitEuler:
-                {
-                    explicitEuler(*body.get(), mStepSize);
-                    break;
-                }
-                case EIntegrationMethod::SymplecticEuler:
-                {
-                    symplecticEuler(*body.get(), mStepSize);
-                    break;
-                }
-                case EIntegrationMethod::Implicit:
-                {
-                    implicitEuler(*body.get(), mStepSize);
-                    break;
-                }
-                }
+                mWorld->integrate(RigidBodyWorld::EIntegrator::ImplicitEuler, mStepSize);
+                break;
+            }
             }
+
+            // islands that came to rest are skipped from now on until something hits them
+            mWorld->updateSleeping(mCollisionDetection->touchingBodies());
         }
 
         /**
@@ -228,7 +234,7 @@ namespace physsim
             ImGui::PushItemWidth(100);
 
             ImGui::Combo("method", (int*)&mIntegrationMethod, "explicit euler\0symplectic euler\0implicit euler\0\0");
-            ImGui::Combo("broad phase", (int*)&mBroadPhaseMethod, "none\0aabb\0sap\0\0");
+            ImGui::Combo("broad phase", (int*)&mBroadPhaseMethod, "none\0aabb\0sap\0dynamic tree\0\0");
             ImGui::Combo("narrow phase", (int*)&mNarrowPhaseMethod, "exhaustive\0gjk\0\0");
             
             double stepSizeMin = 1E-3, stepSizeMax = 1E-1;
@@ -237,6 +243,20 @@ namespace physsim
             double epsilonMin = 1E-3, epsilonMax = 1;
             ImGui::SliderScalar("eps", ImGuiDataType_Double, &mEpsilon, &epsilonMin, &epsilonMax);
 
+            ContactSolver& solver = mCollisionDetection->contactSolver();
+            double friction = solver.friction(), frictionMin = 0, frictionMax = 1;
+            if (ImGui::SliderScalar("friction", ImGuiDataType_Double, &friction, &frictionMin, &frictionMax))
+                solver.setFriction(friction);
+
+            int iterations = solver.iterations();
+            if (ImGui::SliderInt("iterations", &iterations, 1, 50))
+                solver.setIterations(iterations);
+
+            bool sleeping = mWorld->isSleepingEnabled();
+            if (ImGui::Checkbox("sleeping", &sleeping))
+                mWorld->setSleepingEnabled(sleeping);
+            ImGui::Text("awake: %d / %d", (int)mWorld->numAwake(), NUM_CUBES);
+
             ImGui::PopItemWidth();
         }
 
@@ -261,6 +281,11 @@ namespace physsim
          */
         ENarrowPhaseMethod mNarrowPhaseMethod;
 
+        /**
+         * @brief Storage of the rigid body states.
+         */
+        std::shared_ptr<RigidBodyWorld> mWorld;
+
         /**
          * @brief Rigid bodies in the scene.
          */
@@ -288,6 +313,9 @@ namespace physsim
     };
 }
 
+static physsim::SimulationRegistration<physsim::CollisionSimulation> registration("collision");
+
+#ifndef PHYSSIM_HEADLESS
 int main()
 {
     physsim::PhyssimWindow window(
@@ -300,3 +328,4 @@ int main()
 
     return window.run();
 }
+#endif
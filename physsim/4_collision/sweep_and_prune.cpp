@@ -0,0 +1,154 @@
+#include "sweep_and_prune.hpp"
+
+#include <algorithm>
+
+namespace physsim
+{
+    SweepAndPrune::SweepAndPrune()
+        : mNumBodies(0)
+    {
+    }
+
+    void SweepAndPrune::update(const std::vector<Eigen::AlignedBox3d>& bounds)
+    {
+        if (bounds.size() != mNumBodies)
+        {
+            initialize(bounds);
+            return;
+        }
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            // refresh the coordinates, the order is kept from the last step
+            for (Endpoint& endpoint : mEndpoints[axis])
+                endpoint.value = endpoint.isMin ? bounds[endpoint.body].min()[axis] : bounds[endpoint.body].max()[axis];
+            sortAxis(axis);
+        }
+    }
+
+    const std::vector<std::pair<size_t, size_t>>& SweepAndPrune::overlappingPairs() const
+    {
+        return mOverlappingPairs;
+    }
+
+    void SweepAndPrune::clear()
+    {
+        for (int axis = 0; axis < 3; ++axis)
+            mEndpoints[axis].clear();
+        mPairs.clear();
+        mOverlappingPairs.clear();
+        mNumBodies = 0;
+    }
+
+    void SweepAndPrune::initialize(const std::vector<Eigen::AlignedBox3d>& bounds)
+    {
+        clear();
+        mNumBodies = bounds.size();
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            std::vector<Endpoint>& endpoints = mEndpoints[axis];
+            endpoints.resize(2 * mNumBodies);
+            for (size_t i = 0; i < mNumBodies; ++i)
+            {
+                endpoints[2 * i]     = { bounds[i].min()[axis], uint32_t(i), true };
+                endpoints[2 * i + 1] = { bounds[i].max()[axis], uint32_t(i), false };
+            }
+
+            std::sort(endpoints.begin(), endpoints.end(), isBefore);
+
+            // sweep once over the axis and record all overlaps
+            std::vector<uint32_t> open;
+            for (const Endpoint& endpoint : endpoints)
+            {
+                if (endpoint.isMin)
+                {
+                    for (uint32_t other : open)
+                        addOverlap(endpoint.body, other);
+                    open.push_back(endpoint.body);
+                }
+                else
+                {
+                    open.erase(std::find(open.begin(), open.end(), endpoint.body));
+                }
+            }
+        }
+    }
+
+    void SweepAndPrune::sortAxis(int axis)
+    {
+        std::vector<Endpoint>& endpoints = mEndpoints[axis];
+        for (size_t i = 1; i < endpoints.size(); ++i)
+        {
+            Endpoint key = endpoints[i];
+            size_t j     = i;
+            while (j > 0 && isBefore(key, endpoints[j - 1]))
+            {
+                const Endpoint& other = endpoints[j - 1];
+                if (key.isMin && !other.isMin)
+                {
+                    // lower end moves below the upper end of the other interval
+                    addOverlap(key.body, other.body);
+                }
+                else if (!key.isMin && other.isMin)
+                {
+                    // upper end moves below the lower end of the other interval
+                    removeOverlap(key.body, other.body);
+                }
+                endpoints[j] = other;
+                j--;
+            }
+            endpoints[j] = key;
+        }
+    }
+
+    void SweepAndPrune::addOverlap(uint32_t a, uint32_t b)
+    {
+        auto it          = mPairs.try_emplace(pairKey(a, b), PairState{ 0, -1 }).first;
+        PairState& state = it->second;
+        state.numAxes++;
+        if (state.numAxes == 3)
+        {
+            state.pairIndex = int(mOverlappingPairs.size());
+            mOverlappingPairs.push_back(std::make_pair(size_t(std::min(a, b)), size_t(std::max(a, b))));
+        }
+    }
+
+    void SweepAndPrune::removeOverlap(uint32_t a, uint32_t b)
+    {
+        auto it = mPairs.find(pairKey(a, b));
+        if (it == mPairs.end())
+            return;
+
+        PairState& state = it->second;
+        if (state.pairIndex >= 0)
+        {
+            // swap with the last pair and pop
+            const std::pair<size_t, size_t>& last = mOverlappingPairs.back();
+            mPairs[pairKey(uint32_t(last.first), uint32_t(last.second))].pairIndex = state.pairIndex;
+            mOverlappingPairs[state.pairIndex]                                      = last;
+            mOverlappingPairs.pop_back();
+            state.pairIndex = -1;
+        }
+
+        state.numAxes--;
+        if (state.numAxes == 0)
+            mPairs.erase(it);
+    }
+
+    bool SweepAndPrune::isBefore(const Endpoint& a, const Endpoint& b)
+    {
+        if (a.value != b.value)
+            return a.value < b.value;
+        if (a.isMin != b.isMin)
+            return a.isMin;
+        return a.body < b.body;
+    }
+
+    uint64_t SweepAndPrune::pairKey(uint32_t a, uint32_t b)
+    {
+        if (a > b)
+            std::swap(a, b);
+        return (uint64_t(a) << 32) | uint64_t(b);
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <Eigen/Eigen>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace physsim
+{
+    /**
+     * @brief Persistent sweep and prune over the three main axes.
+     * @details The interval endpoints of all boxes are kept sorted per axis across time steps. Since objects move only little between steps, an insertion sort restores the order in nearly linear time. Each swap of a lower and an upper endpoint starts or ends the overlap of two intervals on that axis, which is tracked in a pair table. A pair overlaps if its intervals overlap on all three axes.
+     */
+    class SweepAndPrune
+    {
+    public:
+        /**
+         * @brief Constructor of an empty sweep and prune structure.
+         */
+        SweepAndPrune();
+
+        /**
+         * @brief Updates the endpoints with new bounding boxes and incrementally updates the overlapping pairs. The structure is rebuilt if the number of boxes changed.
+         * @param bounds World-space bounding boxes of all objects.
+         */
+        void update(const std::vector<Eigen::AlignedBox3d>& bounds);
+
+        /**
+         * @brief Gets the pairs of objects whose boxes currently overlap. The first index is always smaller than the second.
+         * @return Overlapping pairs.
+         */
+        const std::vector<std::pair<size_t, size_t>>& overlappingPairs() const;
+
+        /**
+         * @brief Removes all boxes.
+         */
+        void clear();
+
+    private:
+        /**
+         * @brief Lower or upper end of the interval of an object on one axis.
+         */
+        struct Endpoint
+        {
+            /**
+             * @brief Coordinate of the endpoint.
+             */
+            double value;
+
+            /**
+             * @brief Index of the object.
+             */
+            uint32_t body;
+
+            /**
+             * @brief True for the lower end of the interval.
+             */
+            bool isMin;
+        };
+
+        /**
+         * @brief Overlap state of a pair of objects.
+         */
+        struct PairState
+        {
+            /**
+             * @brief Number of axes on which the intervals overlap.
+             */
+            int numAxes;
+
+            /**
+             * @brief Index in the list of overlapping pairs, or -1 if the pair does not overlap on all axes.
+             */
+            int pairIndex;
+        };
+
+        /**
+         * @brief Order of the endpoints on an axis, used by the initial sort and the incremental sort alike. On ties, lower ends go first, such that touching intervals count as overlapping, and then the object with the smaller index.
+         * @param a First endpoint.
+         * @param b Second endpoint.
+         * @return True if a goes before b.
+         */
+        static bool isBefore(const Endpoint& a, const Endpoint& b);
+
+        /**
+         * @brief Sorts all endpoints from scratch and computes the initial overlaps.
+         * @param bounds World-space bounding boxes of all objects.
+         */
+        void initialize(const std::vector<Eigen::AlignedBox3d>& bounds);
+
+        /**
+         * @brief Restores the order of the endpoints on one axis by insertion sort and reports the resulting overlap changes.
+         * @param axis Axis to sort.
+         */
+        void sortAxis(int axis);
+
+        /**
+         * @brief Records that the intervals of two objects started to overlap on one axis.
+         * @param a First object.
+         * @param b Second object.
+         */
+        void addOverlap(uint32_t a, uint32_t b);
+
+        /**
+         * @brief Records that the intervals of two objects stopped to overlap on one axis.
+         * @param a First object.
+         * @param b Second object.
+         */
+        void removeOverlap(uint32_t a, uint32_t b);
+
+        /**
+         * @brief Computes the key of an unordered pair for the pair table.
+         * @param a First object.
+         * @param b Second object.
+         * @return Key of the pair.
+         */
+        static uint64_t pairKey(uint32_t a, uint32_t b);
+
+        /**
+         * @brief Sorted endpoints for each axis.
+         */
+        std::array<std::vector<Endpoint>, 3> mEndpoints;
+
+        /**
+         * @brief Overlap state of all pairs that overlap on at least one axis.
+         */
+        std::unordered_map<uint64_t, PairState> mPairs;
+
+        /**
+         * @brief Pairs that overlap on all three axes.
+         */
+        std::vector<std::pair<size_t, size_t>> mOverlappingPairs;
+
+        /**
+         * @brief Number of objects in the structure.
+         */
+        size_t mNumBodies;
+    };
+}
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "hill_climbing_support.hpp"
+
 #include <vislab/core/array.hpp>
+#include <vislab/graphics/mesh.hpp>
 #include <vislab/graphics/transform.hpp>
 
 #include <Eigen/Eigen>
@@ -15,15 +18,20 @@ namespace physsim
         /**
          * @brief Constructor.
          * @param t Object to world transformation.
-         * @param v Vertices in object space.
-         * @param i Triangle indices.
+         * @param mesh Mesh in object space. The edge buffers must have been computed with recomputeEdges().
+         * @param hull Optional support mapping of the mesh that accelerates findSupport().
          */
         TransformedMesh(const vislab::Transform& t,
-                        const vislab::Array3f& v,
-                        const vislab::Array3ui& i)
+                        const vislab::Mesh& mesh,
+                        const HillClimbingSupport* hull = nullptr)
             : transform(t)
-            , vertices(v)
-            , indices(i)
+            , mesh(mesh)
+            , vertices(*mesh.positions)
+            , indices(*mesh.indices)
+            , edges(*mesh.edges)
+            , edgeFaces(*mesh.edgeFaces)
+            , faceEdges(*mesh.faceEdges)
+            , hull(hull)
         {
         }
 
@@ -37,6 +45,33 @@ namespace physsim
             return transform.transformPoint(vertices.getValueDouble(index));
         }
 
+        /**
+         * @brief Locates the vertex that is farthest into a world space direction. Only the direction is transformed into object space.
+         * @param d Direction in world space.
+         * @param start Vertex to start the search from if a hill climbing support mapping is available.
+         * @return Index of the farthest vertex.
+         */
+        Eigen::Index findSupport(const Eigen::Vector3d& d, Eigen::Index start = 0) const
+        {
+            // d . (L x + t) is maximized by the same vertex as (L^T d) . x
+            Eigen::Vector3d localDir = transform.getMatrix().topLeftCorner<3, 3>().transpose() * d;
+            if (hull)
+                return hull->findSupport(localDir, start);
+
+            Eigen::Index best = 0;
+            double bestDot    = vertices.getValueDouble(0).dot(localDir);
+            for (Eigen::Index i = 1; i < vertices.getSize(); i++)
+            {
+                double dot = vertices.getValueDouble(i).dot(localDir);
+                if (dot > bestDot)
+                {
+                    bestDot = dot;
+                    best    = i;
+                }
+            }
+            return best;
+        }
+
         /**
          * @brief Gets a primitive by its triangle index.
          * @param index Triangle index.
@@ -47,11 +82,26 @@ namespace physsim
             return indices.getValue(index);
         }
 
+        /**
+         * @brief Gets a unique edge.
+         * @param index Edge index.
+         * @return Pair of vertex indices.
+         */
+        typename vislab::Array2ui::ConstElementRef getEdge(const Eigen::Index& index) const
+        {
+            return edges.getValue(index);
+        }
+
         /**
          * @brief Object to world transformation.
          */
         const vislab::Transform& transform;
 
+        /**
+         * @brief Mesh in object space, which answers the queries of its acceleration tree.
+         */
+        const vislab::Mesh& mesh;
+
         /**
          * @brief Vertices in object space.
          */
@@ -61,5 +111,25 @@ namespace physsim
          * @brief Triangle indices.
          */
         const vislab::Array3ui& indices;
+
+        /**
+         * @brief Unique edges.
+         */
+        const vislab::Array2ui& edges;
+
+        /**
+         * @brief Indices of the two faces adjacent to each edge.
+         */
+        const vislab::Array2ui& edgeFaces;
+
+        /**
+         * @brief Indices of the three edges of each face.
+         */
+        const vislab::Array3ui& faceEdges;
+
+        /**
+         * @brief Support mapping with vertex adjacency, or nullptr to scan all vertices.
+         */
+        const HillClimbingSupport* hull;
     };
 }
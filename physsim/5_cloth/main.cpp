@@ -1,5 +1,6 @@
 #include "physsim_window.hpp"
 #include "simulation.hpp"
+#include "simulation_registry.hpp"
 #include "cloth.hpp"
 
 #include <imgui.h>
@@ -165,6 +166,9 @@ namespace physsim
     };
 }
 
+static physsim::SimulationRegistration<physsim::ClothSimulation> registration("cloth");
+
+#ifndef PHYSSIM_HEADLESS
 int main()
 {
     physsim::PhyssimWindow window(
@@ -177,3 +181,4 @@ int main()
 
     return window.run();
 }
+#endif
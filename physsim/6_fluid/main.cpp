@@ -1,6 +1,7 @@
 #include "fluid_solver.hpp"
 #include "physsim_window.hpp"
 #include "simulation.hpp"
+#include "simulation_registry.hpp"
 
 #include <imgui.h>
 #include <vislab/graphics/colormap_texture.hpp>
@@ -124,6 +125,9 @@ namespace physsim
     };
 }
 
+static physsim::SimulationRegistration<physsim::FluidSimulation> registration("fluid");
+
+#ifndef PHYSSIM_HEADLESS
 int main()
 {
     physsim::PhyssimWindow window(
@@ -136,3 +140,4 @@ int main()
 
     return window.run();
 }
+#endif
@@ -1,5 +1,6 @@
 #include "physsim_window.hpp"
 #include "simulation.hpp"
+#include "simulation_registry.hpp"
 
 #include <imgui.h>
 #include <vislab/graphics/const_texture.hpp>
@@ -585,6 +586,9 @@ namespace physsim
     };
 }
 
+static physsim::SimulationRegistration<physsim::SmoothedParticleHydrodynamicsSimulation> registration("sph");
+
+#ifndef PHYSSIM_HEADLESS
 int main()
 {
     physsim::PhyssimWindow window(
@@ -597,3 +601,4 @@ int main()
 
     return window.run();
 }
+#endif
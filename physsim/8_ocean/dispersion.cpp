@@ -1,5 +1,8 @@
 #include "dispersion.hpp"
 
+#include <Eigen/Eigen>
+
+#include <algorithm>
 #include <cmath>
 
 namespace physsim
@@ -21,4 +24,15 @@ namespace physsim
         );
         return cp;
     }
+
+    double Dispersion::angularFrequency(double waveNumber, double loopPeriod) const
+    {
+        double omega = waveNumber * phaseSpeed(waveNumber);
+        if (loopPeriod > 0)
+        {
+            double omega0 = 2 * EIGEN_PI / loopPeriod;
+            omega         = std::max(1., std::round(omega / omega0)) * omega0;
+        }
+        return omega;
+    }
 }
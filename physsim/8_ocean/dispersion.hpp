@@ -1,3 +1,5 @@
+#pragma once
+
 namespace physsim
 {
     /**
@@ -18,6 +20,14 @@ namespace physsim
          */
         double phaseSpeed(double waveNumber) const;
 
+        /**
+         * @brief Computes the angular frequency omega = k * c_p for a given wave number k.
+         * @param waveNumber wave number k
+         * @param loopPeriod If positive, omega is rounded to the closest non-zero multiple of 2 pi / loopPeriod, such that the wave repeats after loopPeriod seconds.
+         * @return angular frequency omega [rad/s]
+         */
+        double angularFrequency(double waveNumber, double loopPeriod = 0) const;
+
         /**
          * @brief Gravity [m/s^2]
          */
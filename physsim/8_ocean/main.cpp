@@ -1,6 +1,9 @@
 #include "ocean.hpp"
+#include "ocean_cache.hpp"
+#include "ocean_clipmap.hpp"
 #include "physsim_window.hpp"
 #include "simulation.hpp"
+#include "simulation_registry.hpp"
 
 #include <imgui.h>
 #include <vislab/core/array.hpp>
@@ -54,11 +57,26 @@ namespace physsim
                 });
             }
 
+            // statistical spectrum for the FFT models, used once selected in the gui
+            mSpectrum = std::make_shared<OceanSpectrum>();
+            mSpectrum->initialize();
+            mModel = EModel::Gerstner;
+
+            // camera-centered level-of-detail grids that reach far beyond the uniform grid, 6 levels of 64x64 cells
+            mClipmap    = std::make_shared<OceanClipmap>(6, 64, 0.02, 0.2);
+            mUseClipmap = false;
+
+            // looping animation that can be baked to disk and replayed
+            mCache      = std::make_shared<OceanCache>();
+            mUseCache   = false;
+            mLoopPeriod = 10;
+
             // create triangle shape
             auto shape  = std::make_shared<Triangle>();
             shape->bsdf = std::make_shared<DiffuseBSDF>(std::make_shared<ConstTexture>(Spectrum(0.5, 1, 1)));
             shape->mesh = mOcean->mesh;
             scene->shapes.push_back(shape);
+            mOceanShape = shape;
 
             // create ground plane
             auto ground  = std::make_shared<Rectangle>();
@@ -99,7 +117,20 @@ namespace physsim
         void advance(double elapsedTime, double totalTime, int64_t timeStep) override
         {
             // update ocean mesh
-            mOcean->advance(timeStep * 16.667);
+            if (mUseClipmap && mModel == EModel::Gerstner)
+            {
+                mClipmap->advance(mOcean->waves, scene->camera->getPosition(), timeStep * 16.667);
+                mOceanShape->mesh = mClipmap->mesh;
+            }
+            else if (mUseCache && mCache->apply(timeStep * 16.667, *mOcean->mesh))
+            {
+                mOceanShape->mesh = mOcean->mesh;
+            }
+            else
+            {
+                mOcean->advance(timeStep * 16.667);
+                mOceanShape->mesh = mOcean->mesh;
+            }
         }
 
         /**
@@ -107,9 +138,125 @@ namespace physsim
          */
         void gui() override
         {
+            ImGui::PushItemWidth(100);
+
+            if (ImGui::Combo("model", (int*)&mModel, "gerstner\0phillips fft\0jonswap fft\0\0"))
+            {
+                switch (mModel)
+                {
+                case EModel::Gerstner:
+                {
+                    mOcean->spectrum = nullptr;
+                    break;
+                }
+                case EModel::Phillips:
+                {
+                    mSpectrum->spectrum = OceanSpectrum::ESpectrum::Phillips;
+                    mSpectrum->initialize();
+                    mOcean->spectrum = mSpectrum;
+                    break;
+                }
+                case EModel::Jonswap:
+                {
+                    mSpectrum->spectrum = OceanSpectrum::ESpectrum::Jonswap;
+                    mSpectrum->initialize();
+                    mOcean->spectrum = mSpectrum;
+                    break;
+                }
+                }
+            }
+
+            if (mModel == EModel::Gerstner)
+            {
+                ImGui::Checkbox("clipmap", &mUseClipmap);
+                if (mUseClipmap)
+                {
+                    for (int level = 0; level < mClipmap->levels(); ++level)
+                        ImGui::Text("level %d: %d waves", level, (int)mClipmap->numWaves(level));
+                }
+            }
+            else
+            {
+                double windSpeedMin = 0.5, windSpeedMax = 10;
+                if (ImGui::SliderScalar("wind speed", ImGuiDataType_Double, &mSpectrum->windSpeed, &windSpeedMin, &windSpeedMax))
+                    mSpectrum->initialize();
+
+                double choppinessMin = 0, choppinessMax = 2;
+                ImGui::SliderScalar("choppiness", ImGuiDataType_Double, &mSpectrum->choppiness, &choppinessMin, &choppinessMax);
+            }
+
+            double loopPeriodMin = 1, loopPeriodMax = 60;
+            ImGui::SliderScalar("loop period", ImGuiDataType_Double, &mLoopPeriod, &loopPeriodMin, &loopPeriodMax);
+            if (ImGui::Button("bake cache"))
+            {
+                // make the ocean repeat in time and store one period at 60 fps
+                mCache->close();
+                mOcean->loopPeriod    = mLoopPeriod;
+                mSpectrum->loopPeriod = mLoopPeriod;
+                mSpectrum->initialize();
+                if (OceanCache::bake(*mOcean, "ocean_cache.bin", (int)std::round(mLoopPeriod * 60)))
+                    mCache->open("ocean_cache.bin");
+            }
+            if (mCache->isOpen())
+            {
+                ImGui::SameLine();
+                ImGui::Checkbox("play cache", &mUseCache);
+            }
+
+            ImGui::PopItemWidth();
         }
 
     private:
+        /**
+         * @brief Ocean models that can be selected in the gui.
+         */
+        enum class EModel
+        {
+            Gerstner,
+            Phillips,
+            Jonswap
+        };
+
+        /**
+         * @brief Currently selected ocean model.
+         */
+        EModel mModel;
+
+        /**
+         * @brief Wave spectrum of the FFT models.
+         */
+        std::shared_ptr<OceanSpectrum> mSpectrum;
+
+        /**
+         * @brief Level-of-detail grids around the camera for the Gerstner model.
+         */
+        std::shared_ptr<OceanClipmap> mClipmap;
+
+        /**
+         * @brief Flag that determines whether the clipmap replaces the uniform grid.
+         */
+        bool mUseClipmap;
+
+        /**
+         * @brief Shape that displays the ocean surface.
+         */
+        std::shared_ptr<Triangle> mOceanShape;
+
+        /**
+         * @brief Memory-mapped looping animation.
+         */
+        std::shared_ptr<OceanCache> mCache;
+
+        /**
+         * @brief Flag that determines whether the surface is replayed from the cache.
+         */
+        bool mUseCache;
+
+        /**
+         * @brief Loop period of the next baked cache in seconds.
+         */
+        double mLoopPeriod;
+
         /**
          * @brief Ocean simualtion.
          */
@@ -117,6 +264,9 @@ namespace physsim
     };
 }
 
+static physsim::SimulationRegistration<physsim::OceanSimulation> registration("ocean");
+
+#ifndef PHYSSIM_HEADLESS
 int main()
 {
     physsim::PhyssimWindow window(
@@ -129,3 +279,4 @@ int main()
 
     return window.run();
 }
+#endif
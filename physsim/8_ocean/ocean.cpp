@@ -6,7 +6,8 @@
 namespace physsim
 {
     Ocean::Ocean(const Eigen::Vector2i& resolution, const Eigen::Vector3d& origin, const Eigen::Vector3d& axis1, const Eigen::Vector3d& axis2)
-        : mResolution(resolution)
+        : loopPeriod(0)
+        , mResolution(resolution)
         , mOrigin(origin)
         , mAxis1(axis1)
         , mAxis2(axis2)
@@ -36,6 +37,63 @@ namespace physsim
 
     void Ocean::advance(double totalTime)
     {
+        if (spectrum)
+        {
+            advanceSpectrum(totalTime);
+            return;
+        }
+
+        // bake the wave constants once, then evaluate all waves for one grid row at a time
+        mWaveTable.bake(waves, loopPeriod);
+        double t = totalTime / 1000; // conversion from milliseconds to seconds
+
+        if (!mesh->normals)
+            mesh->normals = std::make_shared<vislab::Array3f>();
+        mesh->normals->setSize(mResolution.prod());
+
+#ifndef _DEBUG
+#pragma omp parallel for
+#endif
+        for (int iy = 0; iy < mResolution.y(); ++iy)
+        {
+            double y = iy / (mResolution.y() - 1.);
+
+            Eigen::ArrayXf px(mResolution.x()), py(mResolution.x()), pz(mResolution.x());
+            for (int ix = 0; ix < mResolution.x(); ++ix)
+            {
+                double x            = ix / (mResolution.x() - 1.);
+                Eigen::Vector3d pos = mOrigin + x * mAxis1 + y * mAxis2;
+                px[ix]              = pos.x();
+                py[ix]              = pos.y();
+                pz[ix]              = pos.z();
+            }
+
+            Eigen::ArrayXf height, slopeX, slopeY;
+            mWaveTable.evaluate(px, py, t, height, slopeX, slopeY);
+
+            for (int ix = 0; ix < mResolution.x(); ++ix)
+            {
+                int64_t i = (int64_t)iy * mResolution.x() + ix;
+                mesh->positions->setValue(i, Eigen::Vector3f(px[ix], py[ix], pz[ix] + height[ix]));
+
+                // normal of the height field from its analytic gradient
+                mesh->normals->setValue(i, Eigen::Vector3f(-slopeX[ix], -slopeY[ix], 1).normalized());
+            }
+        }
+
+        // raise event that geometry changed
+        mesh->positionsChanged.notify(mesh.get());
+    }
+
+    void Ocean::advanceSpectrum(double totalTime)
+    {
+        // synthesize the periodic patch once, then sample it at the vertices
+        spectrum->evaluate(totalTime / 1000); // conversion from milliseconds to seconds
+
+        if (!mesh->normals)
+            mesh->normals = std::make_shared<vislab::Array3f>();
+        mesh->normals->setSize(mResolution.prod());
+
 #ifndef _DEBUG
 #pragma omp parallel for
 #endif
@@ -50,12 +108,13 @@ namespace physsim
 
             Eigen::Vector3d pos = mOrigin + x * mAxis1 + y * mAxis2;
 
-            Eigen::Vector3d surfacePosition = position(pos, totalTime / 1000); // conversion from milliseconds to seconds
+            Eigen::Vector3d surfacePosition = pos + spectrum->displacement(pos.xy());
             mesh->positions->setValue(i, surfacePosition.cast<float>());
-        }
 
-        // recompute the vertex normals
-        mesh->recomputeVertexNormals();
+            // normal of the height field from its gradient
+            Eigen::Vector2d slope = spectrum->slope(pos.xy());
+            mesh->normals->setValue(i, Eigen::Vector3d(-slope.x(), -slope.y(), 1).normalized().cast<float>());
+        }
 
         // raise event that geometry changed
         mesh->positionsChanged.notify(mesh.get());
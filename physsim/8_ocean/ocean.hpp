@@ -1,4 +1,8 @@
-#include <wave.hpp>
+#pragma once
+
+#include "ocean_spectrum.hpp"
+#include "wave.hpp"
+#include "wave_table.hpp"
 
 #include <vislab/core/array_fwd.hpp>
 
@@ -49,6 +53,16 @@ namespace physsim
          */
         std::vector<Wave> waves;
 
+        /**
+         * @brief Optional statistical wave spectrum. If set, the surface is synthesized by FFT and the Gerstner waves are ignored.
+         */
+        std::shared_ptr<OceanSpectrum> spectrum;
+
+        /**
+         * @brief If positive, the frequencies of the waves are rounded such that the surface repeats after this many seconds. [s]
+         */
+        double loopPeriod;
+
         /**
          * @brief Evaluates the displaced position at a specific domain position.
          * @param pos Domain position of the vertex.
@@ -58,6 +72,17 @@ namespace physsim
         Eigen::Vector3d position(const Eigen::Vector3d& pos, double t) const;
 
     private:
+        /**
+         * @brief Advances the surface by sampling the FFT patch of the spectrum.
+         * @param totalTime Total time in milliseconds since the beginning of the first frame.
+         */
+        void advanceSpectrum(double totalTime);
+
+        /**
+         * @brief Per-frame copy of the wave constants for the vectorized evaluation.
+         */
+        WaveTable mWaveTable;
+
         /**
          * @brief Resolution of the grid.
          */
@@ -0,0 +1,254 @@
+#include "ocean_cache.hpp"
+
+#include "ocean.hpp"
+
+#include <vislab/core/array.hpp>
+#include <vislab/graphics/mesh.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace physsim
+{
+    static const char cacheMagic[8] = { 'O', 'C', 'E', 'A', 'N', 'C', '0', '1' };
+
+    /**
+     * @brief Maps a unit vector to the octahedron, unfolded onto [-1,1]^2.
+     * @param n Unit vector.
+     * @return Octahedron coordinates.
+     */
+    static Eigen::Vector2f encodeNormal(const Eigen::Vector3f& n)
+    {
+        Eigen::Vector2f p = n.head<2>() / (std::abs(n.x()) + std::abs(n.y()) + std::abs(n.z()));
+        if (n.z() < 0)
+            p = Eigen::Vector2f((1 - std::abs(p.y())) * (p.x() >= 0 ? 1 : -1), (1 - std::abs(p.x())) * (p.y() >= 0 ? 1 : -1));
+        return p;
+    }
+
+    /**
+     * @brief Inverse of encodeNormal.
+     * @param p Octahedron coordinates.
+     * @return Unit vector.
+     */
+    static Eigen::Vector3f decodeNormal(const Eigen::Vector2f& p)
+    {
+        Eigen::Vector3f n(p.x(), p.y(), 1 - std::abs(p.x()) - std::abs(p.y()));
+        float t = std::max(-n.z(), 0.f);
+        n.x() += n.x() >= 0 ? -t : t;
+        n.y() += n.y() >= 0 ? -t : t;
+        return n.normalized();
+    }
+
+    OceanCache::OceanCache()
+        : mData(nullptr)
+        , mSize(0)
+#ifdef _WIN32
+        , mFile(nullptr)
+        , mMapping(nullptr)
+#else
+        , mFile(-1)
+#endif
+    {
+    }
+
+    OceanCache::~OceanCache()
+    {
+        close();
+    }
+
+    bool OceanCache::bake(Ocean& ocean, const std::string& path, int numFrames)
+    {
+        double period = ocean.spectrum ? ocean.spectrum->loopPeriod : ocean.loopPeriod;
+        if (period <= 0 || numFrames <= 0)
+            return false;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        int64_t numVertices = ocean.resolution().prod();
+        Header header;
+        std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+        header.numVertices = numVertices;
+        header.numFrames   = numFrames;
+        header.period      = period;
+        file.write((const char*)&header, sizeof(Header));
+
+        std::vector<uint8_t> frame(frameSize(numVertices), 0);
+        for (int f = 0; f < numFrames; ++f)
+        {
+            ocean.advance(f * period / numFrames * 1000); // conversion from seconds to milliseconds
+            const vislab::Array3f& positions = *ocean.mesh->positions;
+            const vislab::Array3f& normals   = *ocean.mesh->normals;
+
+            // quantize the positions relative to the bounding box of the frame
+            Eigen::Vector3f min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+            Eigen::Vector3f max = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+            for (int64_t i = 0; i < numVertices; ++i)
+            {
+                min = min.cwiseMin(positions.getValue(i));
+                max = max.cwiseMax(positions.getValue(i));
+            }
+            Eigen::Vector3f step = (max - min) / 65535.f;
+            std::memcpy(frame.data(), min.data(), 3 * sizeof(float));
+            std::memcpy(frame.data() + 3 * sizeof(float), step.data(), 3 * sizeof(float));
+
+            uint16_t* quantizedPositions = (uint16_t*)(frame.data() + 6 * sizeof(float));
+            int16_t* quantizedNormals    = (int16_t*)(quantizedPositions + 3 * numVertices);
+            for (int64_t i = 0; i < numVertices; ++i)
+            {
+                for (int c = 0; c < 3; ++c)
+                    quantizedPositions[3 * i + c] = step[c] > 0 ? (uint16_t)std::lround((positions.getValue(i)[c] - min[c]) / step[c]) : 0;
+                Eigen::Vector2f p           = encodeNormal(normals.getValue(i));
+                quantizedNormals[2 * i + 0] = (int16_t)std::lround(p.x() * 32767);
+                quantizedNormals[2 * i + 1] = (int16_t)std::lround(p.y() * 32767);
+            }
+            file.write((const char*)frame.data(), frame.size());
+        }
+        return (bool)file;
+    }
+
+    bool OceanCache::open(const std::string& path)
+    {
+        close();
+
+#ifdef _WIN32
+        mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (mFile == INVALID_HANDLE_VALUE)
+        {
+            mFile = nullptr;
+            return false;
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(mFile, &size);
+        mSize    = size.QuadPart;
+        mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mMapping)
+            mData = (const uint8_t*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        mFile = ::open(path.c_str(), O_RDONLY);
+        if (mFile < 0)
+            return false;
+        struct stat status;
+        fstat(mFile, &status);
+        mSize      = status.st_size;
+        void* data = mSize > 0 ? mmap(nullptr, mSize, PROT_READ, MAP_SHARED, mFile, 0) : MAP_FAILED;
+        if (data != MAP_FAILED)
+            mData = (const uint8_t*)data;
+#endif
+
+        // validate the header and the file size. The counts are bounded by the payload size before frameSize() is evaluated and the frames are counted by a division, such that corrupt counts cannot overflow.
+        const Header* header = (const Header*)mData;
+        if (!mData || mSize < (int64_t)sizeof(Header) || std::memcmp(header->magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+            header->numVertices <= 0 || header->numFrames <= 0 ||
+            header->numVertices > (mSize - (int64_t)sizeof(Header)) / int64_t(3 * sizeof(uint16_t) + 2 * sizeof(int16_t)) ||
+            header->numFrames > (mSize - (int64_t)sizeof(Header)) / frameSize(header->numVertices))
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void OceanCache::close()
+    {
+#ifdef _WIN32
+        if (mData)
+            UnmapViewOfFile(mData);
+        if (mMapping)
+            CloseHandle(mMapping);
+        if (mFile)
+            CloseHandle(mFile);
+        mMapping = nullptr;
+        mFile    = nullptr;
+#else
+        if (mData)
+            munmap((void*)mData, mSize);
+        if (mFile >= 0)
+            ::close(mFile);
+        mFile = -1;
+#endif
+        mData = nullptr;
+        mSize = 0;
+    }
+
+    bool OceanCache::isOpen() const
+    {
+        return mData != nullptr;
+    }
+
+    int OceanCache::numFrames() const
+    {
+        return mData ? (int)((const Header*)mData)->numFrames : 0;
+    }
+
+    int64_t OceanCache::numVertices() const
+    {
+        return mData ? ((const Header*)mData)->numVertices : 0;
+    }
+
+    double OceanCache::period() const
+    {
+        return mData ? ((const Header*)mData)->period : 0;
+    }
+
+    bool OceanCache::apply(double totalTime, vislab::Mesh& mesh) const
+    {
+        // the cache only fits the mesh it was baked from
+        if (!mData || !mesh.positions || mesh.positions->getSize() != numVertices())
+            return false;
+
+        // locate the closest frame within the period
+        int64_t n     = numVertices();
+        int64_t index = std::llround(totalTime / 1000 / period() * numFrames()) % numFrames();
+        if (index < 0)
+            index += numFrames();
+        const uint8_t* frame = mData + sizeof(Header) + index * frameSize(n);
+
+        Eigen::Vector3f min, step;
+        std::memcpy(min.data(), frame, 3 * sizeof(float));
+        std::memcpy(step.data(), frame + 3 * sizeof(float), 3 * sizeof(float));
+        const uint16_t* quantizedPositions = (const uint16_t*)(frame + 6 * sizeof(float));
+        const int16_t* quantizedNormals    = (const int16_t*)(quantizedPositions + 3 * n);
+
+        if (!mesh.normals)
+            mesh.normals = std::make_shared<vislab::Array3f>();
+        mesh.normals->setSize(n);
+
+#ifndef _DEBUG
+#pragma omp parallel for
+#endif
+        for (int64_t i = 0; i < n; ++i)
+        {
+            Eigen::Vector3f q(quantizedPositions[3 * i + 0], quantizedPositions[3 * i + 1], quantizedPositions[3 * i + 2]);
+            mesh.positions->setValue(i, min + step.cwiseProduct(q));
+            mesh.normals->setValue(i, decodeNormal(Eigen::Vector2f(quantizedNormals[2 * i + 0], quantizedNormals[2 * i + 1]) / 32767.f));
+        }
+
+        // raise event that geometry changed
+        mesh.positionsChanged.notify(&mesh);
+        return true;
+    }
+
+    int64_t OceanCache::frameSize(int64_t numVertices)
+    {
+        // bounding box, 16-bit positions and normals, padded to keep the next frame aligned
+        int64_t size = 6 * sizeof(float) + numVertices * (3 * sizeof(uint16_t) + 2 * sizeof(int16_t));
+        return (size + 7) & ~int64_t(7);
+    }
+}
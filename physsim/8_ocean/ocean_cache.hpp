@@ -0,0 +1,151 @@
+#pragma once
+
+#include <Eigen/Eigen>
+
+#include <cstdint>
+#include <string>
+
+namespace vislab
+{
+    class Mesh;
+}
+
+namespace physsim
+{
+    struct Ocean;
+
+    /**
+     * @brief Precomputed animation of an ocean surface that repeats in time, stored in a quantized binary file and memory-mapped for playback.
+     * @details Every frame stores its bounding box, followed by 16-bit positions relative to that box and octahedron-encoded 16-bit normals, i.e., 10 bytes per vertex. Playback maps the file and decodes a frame found by pointer arithmetic, without evaluating any waves.
+     */
+    class OceanCache
+    {
+    public:
+        /**
+         * @brief Constructor.
+         */
+        OceanCache();
+
+        /**
+         * @brief Destructor. Unmaps the file.
+         */
+        ~OceanCache();
+
+        OceanCache(const OceanCache&)            = delete;
+        OceanCache& operator=(const OceanCache&) = delete;
+
+        /**
+         * @brief Samples one period of the ocean and writes it to a file. The loop period of the ocean (and its spectrum, if any) has to be set.
+         * @param ocean Ocean to sample. Its mesh is overwritten.
+         * @param path Path of the file.
+         * @param numFrames Number of frames per period.
+         * @return True if the file was written.
+         */
+        static bool bake(Ocean& ocean, const std::string& path, int numFrames);
+
+        /**
+         * @brief Maps a baked file into memory.
+         * @param path Path of the file.
+         * @return True if the file was mapped and is valid.
+         */
+        bool open(const std::string& path);
+
+        /**
+         * @brief Unmaps the file.
+         */
+        void close();
+
+        /**
+         * @brief Checks whether a file is mapped.
+         * @return True if a file is mapped.
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief Number of frames per period.
+         * @return Number of frames.
+         */
+        int numFrames() const;
+
+        /**
+         * @brief Number of vertices per frame.
+         * @return Number of vertices.
+         */
+        int64_t numVertices() const;
+
+        /**
+         * @brief Time after which the animation repeats.
+         * @return Loop period in seconds.
+         */
+        double period() const;
+
+        /**
+         * @brief Decodes the frame closest to a point in time into the positions and normals of a mesh.
+         * @param totalTime Total time in milliseconds since the beginning of the first frame.
+         * @param mesh Mesh to update. Needs to have the number of vertices of the cache.
+         * @return True if the mesh was updated, false if no file is mapped or the number of vertices differs.
+         */
+        bool apply(double totalTime, vislab::Mesh& mesh) const;
+
+    private:
+        /**
+         * @brief Layout of the beginning of the file.
+         */
+        struct Header
+        {
+            /**
+             * @brief File identifier and version.
+             */
+            char magic[8];
+
+            /**
+             * @brief Number of vertices per frame.
+             */
+            int64_t numVertices;
+
+            /**
+             * @brief Number of frames per period.
+             */
+            int64_t numFrames;
+
+            /**
+             * @brief Loop period in seconds.
+             */
+            double period;
+        };
+
+        /**
+         * @brief Number of bytes of a frame.
+         * @param numVertices Number of vertices per frame.
+         * @return Size of a frame in bytes.
+         */
+        static int64_t frameSize(int64_t numVertices);
+
+        /**
+         * @brief Beginning of the mapped file.
+         */
+        const uint8_t* mData;
+
+        /**
+         * @brief Size of the mapped file in bytes.
+         */
+        int64_t mSize;
+
+#ifdef _WIN32
+        /**
+         * @brief Handle of the opened file.
+         */
+        void* mFile;
+
+        /**
+         * @brief Handle of the file mapping.
+         */
+        void* mMapping;
+#else
+        /**
+         * @brief Descriptor of the opened file.
+         */
+        int mFile;
+#endif
+    };
+}
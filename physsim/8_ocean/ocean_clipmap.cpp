@@ -0,0 +1,216 @@
+#include "ocean_clipmap.hpp"
+
+#include <vislab/core/array.hpp>
+#include <vislab/graphics/mesh.hpp>
+
+#include <cassert>
+
+namespace physsim
+{
+    /**
+     * @brief Halves lattice coordinates and rounds towards negative infinity, which maps a position to the vertex of the next coarser level at or below it.
+     * @param v Lattice coordinates.
+     * @return Coordinates on the coarser lattice.
+     */
+    static Eigen::Vector2i floorHalf(const Eigen::Vector2i& v)
+    {
+        return v.unaryExpr([](int x)
+                           { return (x - (x < 0)) / 2; });
+    }
+
+    OceanClipmap::OceanClipmap(int levels, int resolution, double cellSize, double height)
+        : mLevels(levels)
+        , mResolution(resolution)
+        , mCellSize(cellSize)
+        , mHeight(height)
+        , mNumWaves(levels, 0)
+    {
+        // the hole of a level starts n/4 cells inside it, and the origins have to stay even to coincide with vertices of the next coarser level
+        assert(resolution > 0 && resolution % 4 == 0 && "The resolution has to be a multiple of four.");
+
+        // allocate mesh
+        mesh            = std::make_shared<vislab::Mesh>();
+        mesh->positions = std::make_shared<vislab::Array3f>();
+        mesh->normals   = std::make_shared<vislab::Array3f>();
+        mesh->indices   = std::make_shared<vislab::Array3ui>();
+    }
+
+    void OceanClipmap::advance(const std::vector<Wave>& waves, const Eigen::Vector3d& cameraPosition, double totalTime)
+    {
+        // snap every level to even multiples of its spacing, which keeps the vertices on a fixed lattice while the camera moves
+        std::vector<Eigen::Vector2i> centers(mLevels);
+        for (int level = 0; level < mLevels; ++level)
+        {
+            Eigen::Vector2d center = cameraPosition.xy() / (2 * spacing(level));
+            centers[level]         = 2 * Eigen::Vector2i((int)std::round(center.x()), (int)std::round(center.y()));
+        }
+        if (centers != mCenters)
+        {
+            mCenters = centers;
+            rebuild();
+        }
+
+        mWaveTable.bake(waves);
+        for (int level = 0; level < mLevels; ++level)
+            mNumWaves[level] = mWaveTable.numResolved(spacing(level));
+        double t = totalTime / 1000; // conversion from milliseconds to seconds
+
+#ifndef _DEBUG
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int64_t c = 0; c < (int64_t)mChunks.size(); ++c)
+        {
+            const Chunk& chunk = mChunks[c];
+            Eigen::Index size  = chunk.end - chunk.begin;
+            Eigen::ArrayXf x   = mVertexX.segment(chunk.begin, size);
+            Eigen::ArrayXf y   = mVertexY.segment(chunk.begin, size);
+
+            Eigen::ArrayXf height, slopeX, slopeY;
+            mWaveTable.evaluate(x, y, t, height, slopeX, slopeY, mNumWaves[chunk.level]);
+
+            for (Eigen::Index i = 0; i < size; ++i)
+            {
+                mesh->positions->setValue(chunk.begin + i, Eigen::Vector3f(x[i], y[i], mHeight + height[i]));
+                mesh->normals->setValue(chunk.begin + i, Eigen::Vector3f(-slopeX[i], -slopeY[i], 1).normalized());
+            }
+        }
+
+        // the boundary vertices take the values of the next coarser level, either of the coinciding vertex or interpolated along the coarse edge
+        for (const Eigen::Vector3i& stitch : mStitches)
+        {
+            if (stitch.y() == stitch.z())
+            {
+                mesh->positions->setValue(stitch.x(), mesh->positions->getValue(stitch.y()));
+                mesh->normals->setValue(stitch.x(), mesh->normals->getValue(stitch.y()));
+            }
+            else
+            {
+                mesh->positions->setValue(stitch.x(), 0.5f * (mesh->positions->getValue(stitch.y()) + mesh->positions->getValue(stitch.z())));
+                mesh->normals->setValue(stitch.x(), (mesh->normals->getValue(stitch.y()) + mesh->normals->getValue(stitch.z())).normalized());
+            }
+        }
+
+        // raise event that geometry changed
+        mesh->positionsChanged.notify(mesh.get());
+    }
+
+    int OceanClipmap::levels() const
+    {
+        return mLevels;
+    }
+
+    int OceanClipmap::resolution() const
+    {
+        return mResolution;
+    }
+
+    double OceanClipmap::spacing(int level) const
+    {
+        return mCellSize * (1 << level);
+    }
+
+    Eigen::Index OceanClipmap::numWaves(int level) const
+    {
+        return mNumWaves[level];
+    }
+
+    void OceanClipmap::rebuild()
+    {
+        const int n = mResolution;
+        std::vector<Eigen::Vector2f> vertices;
+        std::vector<Eigen::Vector3u> triangles;
+        mChunks.clear();
+        mStitches.clear();
+
+        // vertex indices of the grid positions of each level, or -1 inside the hole
+        std::vector<std::vector<int>> locals(mLevels);
+        std::vector<Eigen::Vector2i> origins(mLevels);
+        for (int level = 0; level < mLevels; ++level)
+        {
+            Eigen::Vector2i& origin = origins[level];
+            origin                  = mCenters[level] - Eigen::Vector2i::Constant(n / 2);
+
+            // the previous level covers the cells [holeBegin, holeEnd) of this level
+            bool hasHole              = level > 0;
+            Eigen::Vector2i holeBegin = hasHole ? Eigen::Vector2i(floorHalf(mCenters[level - 1]) - mCenters[level] + Eigen::Vector2i::Constant(n / 4)) : Eigen::Vector2i::Zero();
+            Eigen::Vector2i holeEnd   = holeBegin + Eigen::Vector2i::Constant(n / 2);
+            bool hasBoundary          = level + 1 < mLevels;
+
+            auto insideHole = [&](int i, int j)
+            { return hasHole && i > holeBegin.x() && i < holeEnd.x() && j > holeBegin.y() && j < holeEnd.y(); };
+            auto onBoundary = [&](int i, int j)
+            { return hasBoundary && (i == 0 || j == 0 || i == n || j == n); };
+
+            // boundary vertices first, they are copied from the next level and only the interior vertices are evaluated
+            std::vector<int>& local = locals[level];
+            local.assign((n + 1) * (n + 1), -1);
+            for (bool boundary : { true, false })
+            {
+                Eigen::Index begin = (Eigen::Index)vertices.size();
+                for (int j = 0; j <= n; ++j)
+                    for (int i = 0; i <= n; ++i)
+                    {
+                        if (insideHole(i, j) || onBoundary(i, j) != boundary)
+                            continue;
+                        local[j * (n + 1) + i] = (int)vertices.size();
+
+                        // coordinates are multiples of the finest spacing, so coinciding vertices of different levels are bitwise equal
+                        Eigen::Vector2d lattice = ((origin + Eigen::Vector2i(i, j)) * (1 << level)).cast<double>();
+                        vertices.push_back((lattice * mCellSize).cast<float>());
+                    }
+                if (boundary)
+                    continue;
+                for (Eigen::Index b = begin; b < (Eigen::Index)vertices.size(); b += 256)
+                    mChunks.push_back({ b, std::min(b + 256, (Eigen::Index)vertices.size()), level });
+            }
+
+            // two triangles per cell outside the hole
+            for (int j = 0; j < n; ++j)
+                for (int i = 0; i < n; ++i)
+                {
+                    if (hasHole && i >= holeBegin.x() && i < holeEnd.x() && j >= holeBegin.y() && j < holeEnd.y())
+                        continue;
+                    unsigned int i00 = local[(j + 0) * (n + 1) + (i + 0)];
+                    unsigned int i01 = local[(j + 1) * (n + 1) + (i + 0)];
+                    unsigned int i10 = local[(j + 0) * (n + 1) + (i + 1)];
+                    unsigned int i11 = local[(j + 1) * (n + 1) + (i + 1)];
+                    triangles.push_back(Eigen::Vector3u(i00, i10, i01));
+                    triangles.push_back(Eigen::Vector3u(i10, i11, i01));
+                }
+        }
+
+        // boundary vertices at even positions coincide with a vertex of the next level, those at odd positions lie in the middle of one of its edges
+        for (int level = 0; level + 1 < mLevels; ++level)
+        {
+            auto coarse = [&](int i, int j)
+            {
+                Eigen::Vector2i c = floorHalf(origins[level] + Eigen::Vector2i(i, j)) - origins[level + 1];
+                return locals[level + 1][c.y() * (n + 1) + c.x()];
+            };
+            for (int k = 0; k <= n; ++k)
+            {
+                int lower = k - k % 2, upper = k + k % 2;
+                for (int side : { 0, n })
+                {
+                    mStitches.push_back(Eigen::Vector3i(locals[level][side * (n + 1) + k], coarse(lower, side), coarse(upper, side)));
+                    if (k > 0 && k < n)
+                        mStitches.push_back(Eigen::Vector3i(locals[level][k * (n + 1) + side], coarse(side, lower), coarse(side, upper)));
+                }
+            }
+        }
+
+        mVertexX.resize(vertices.size());
+        mVertexY.resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            mVertexX[i] = vertices[i].x();
+            mVertexY[i] = vertices[i].y();
+        }
+
+        mesh->positions->setSize(vertices.size());
+        mesh->normals->setSize(vertices.size());
+        mesh->indices->setSize(triangles.size());
+        for (size_t i = 0; i < triangles.size(); ++i)
+            mesh->indices->setValue(i, triangles[i]);
+    }
+}
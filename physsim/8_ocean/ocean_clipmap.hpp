@@ -0,0 +1,155 @@
+#pragma once
+
+#include "wave.hpp"
+#include "wave_table.hpp"
+
+#include <Eigen/Eigen>
+
+#include <memory>
+#include <vector>
+
+namespace vislab
+{
+    class Mesh;
+}
+
+namespace physsim
+{
+    /**
+     * @brief Geometry clipmap of the ocean surface that follows the camera with nested square grids of doubling vertex spacing.
+     * @details Level 0 is a full grid around the camera. Every further level is a ring around the previous one with twice the spacing, so the covered area grows by four per level while the vertex count grows linearly. Each level only sums the waves that its spacing resolves. The outermost vertices of a level use the waves of the next coarser level, and the vertices between two coarse vertices are placed on the coarse edge, such that neighboring levels meet without cracks.
+     */
+    class OceanClipmap
+    {
+    public:
+        /**
+         * @brief Constructor.
+         * @param levels Number of nested grids.
+         * @param resolution Number of cells along each side of a level. Has to be a multiple of four.
+         * @param cellSize Vertex spacing of the finest level. [m]
+         * @param height Height of the surface at rest. [m]
+         */
+        OceanClipmap(int levels, int resolution, double cellSize, double height);
+
+        /**
+         * @brief Recenters the grids around the camera and evaluates the waves.
+         * @param waves Waves to add up.
+         * @param cameraPosition Position of the camera. Only the horizontal components are used.
+         * @param totalTime Total time in milliseconds since the beginning of the first frame.
+         */
+        void advance(const std::vector<Wave>& waves, const Eigen::Vector3d& cameraPosition, double totalTime);
+
+        /**
+         * @brief Number of nested grids.
+         * @return Number of levels.
+         */
+        int levels() const;
+
+        /**
+         * @brief Number of cells along each side of a level.
+         * @return Resolution of a level.
+         */
+        int resolution() const;
+
+        /**
+         * @brief Vertex spacing of a level.
+         * @param level Level of the grid.
+         * @return Vertex spacing. [m]
+         */
+        double spacing(int level) const;
+
+        /**
+         * @brief Number of waves that were summed on a level in the last frame.
+         * @param level Level of the grid.
+         * @return Number of resolved waves.
+         */
+        Eigen::Index numWaves(int level) const;
+
+        /**
+         * @brief Mesh that stores the geometry of all levels.
+         */
+        std::shared_ptr<vislab::Mesh> mesh;
+
+    private:
+        /**
+         * @brief Consecutive interior vertices of one level that are evaluated with the same number of waves.
+         */
+        struct Chunk
+        {
+            /**
+             * @brief Index of the first vertex.
+             */
+            Eigen::Index begin;
+
+            /**
+             * @brief Index after the last vertex.
+             */
+            Eigen::Index end;
+
+            /**
+             * @brief Level of the vertices.
+             */
+            int level;
+        };
+
+        /**
+         * @brief Regenerates vertex coordinates and triangles after the grids moved.
+         */
+        void rebuild();
+
+        /**
+         * @brief Number of nested grids.
+         */
+        int mLevels;
+
+        /**
+         * @brief Number of cells along each side of a level.
+         */
+        int mResolution;
+
+        /**
+         * @brief Vertex spacing of the finest level.
+         */
+        double mCellSize;
+
+        /**
+         * @brief Height of the surface at rest.
+         */
+        double mHeight;
+
+        /**
+         * @brief Centers of the levels in multiples of their spacing. Always even, so that every level starts on a vertex of the next coarser level.
+         */
+        std::vector<Eigen::Vector2i> mCenters;
+
+        /**
+         * @brief Number of resolved waves per level in the last frame.
+         */
+        std::vector<Eigen::Index> mNumWaves;
+
+        /**
+         * @brief Horizontal x-coordinates of all vertices.
+         */
+        Eigen::ArrayXf mVertexX;
+
+        /**
+         * @brief Horizontal y-coordinates of all vertices.
+         */
+        Eigen::ArrayXf mVertexY;
+
+        /**
+         * @brief Work items of the evaluation.
+         */
+        std::vector<Chunk> mChunks;
+
+        /**
+         * @brief Boundary vertices of each level, followed by the two vertices at the ends of the edge of the next level they lie on. Both are the same vertex if the boundary vertex coincides with it.
+         */
+        std::vector<Eigen::Vector3i> mStitches;
+
+        /**
+         * @brief Per-frame copy of the wave constants, sorted by decreasing wavelength.
+         */
+        WaveTable mWaveTable;
+    };
+}
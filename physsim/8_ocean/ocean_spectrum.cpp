@@ -0,0 +1,215 @@
+#include "ocean_spectrum.hpp"
+
+#include <unsupported/Eigen/FFT>
+
+#include <cmath>
+#include <random>
+
+namespace physsim
+{
+    OceanSpectrum::OceanSpectrum()
+        : spectrum(ESpectrum::Jonswap)
+        , resolution(128)
+        , size(2)
+        , windSpeed(2)
+        , windAngle(0)
+        , amplitude(2E-4)
+        , fetch(1000)
+        , peakEnhancement(3.3)
+        , minWaveLength(0.02)
+        , choppiness(1)
+        , seed(0)
+        , loopPeriod(0)
+        , mResolution(0)
+        , mSize(0)
+    {
+    }
+
+    void OceanSpectrum::initialize()
+    {
+        mResolution = resolution;
+        mSize       = size;
+        int N       = mResolution;
+        double dk   = 2 * EIGEN_PI / mSize;
+
+        mAmplitudes.resize(N * N);
+        mFrequencies.resize(N * N);
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> normal;
+        for (int j = 0; j < N; ++j)
+            for (int i = 0; i < N; ++i)
+            {
+                std::complex<double> xi(normal(rng), normal(rng));
+                Eigen::Vector2d k = waveVector(i, j);
+                double kn         = k.norm();
+
+                // the mean and the Nyquist frequencies are left out to keep the fields real
+                if (kn == 0 || i == N / 2 || j == N / 2)
+                {
+                    mAmplitudes[j * N + i]  = 0;
+                    mFrequencies[j * N + i] = 0;
+                    continue;
+                }
+
+                // E|h0|^2 = density * dk^2 / 2, since h0(k) and h0(-k) both contribute to the variance of the mode
+                mAmplitudes[j * N + i]  = xi * std::sqrt(density(k) * dk * dk / 4);
+                mFrequencies[j * N + i] = dispersion.angularFrequency(kn, loopPeriod);
+            }
+
+        mSpectra.resize(5 * (N / 2 + 1) * N);
+        mDisplacements.assign(N * N, Eigen::Vector3d::Zero());
+        mSlopes.assign(N * N, Eigen::Vector2d::Zero());
+    }
+
+    void OceanSpectrum::evaluate(double t)
+    {
+        if (mResolution != resolution || mSize != size)
+            initialize();
+
+        const int N = mResolution;
+        const int H = N / 2 + 1;
+
+#ifndef _DEBUG
+#pragma omp parallel
+#endif
+        {
+            // plans are cached inside the FFT object, which is therefore not shared between threads
+            Eigen::FFT<double> fft;
+            fft.SetFlag(Eigen::FFT<double>::Unscaled);
+            std::vector<std::complex<double>> columns(5 * N), row(H);
+            std::vector<double> values(N);
+
+            // propagate the half spectrum with non-negative x-frequencies and transform along y
+#ifndef _DEBUG
+#pragma omp for
+#endif
+            for (int i = 0; i < H; ++i)
+            {
+                for (int j = 0; j < N; ++j)
+                {
+                    const int index     = j * N + i;
+                    const int conjugate = ((N - j) % N) * N + (N - i) % N;
+                    Eigen::Vector2d k   = waveVector(i, j);
+                    double kn           = k.norm();
+
+                    // waves travel along k, i.e., h(x,t) = h0 exp(i (k.x - omega t)) + c.c.
+                    std::complex<double> phase = std::polar(1., -mFrequencies[index] * t);
+                    std::complex<double> h     = mAmplitudes[index] * phase + std::conj(mAmplitudes[conjugate] * phase);
+                    std::complex<double> ih    = std::complex<double>(0, 1) * h;
+
+                    // horizontal displacement towards the crests, as for Gerstner waves with positive steepness
+                    double scale       = kn == 0 ? 0 : choppiness / kn;
+                    columns[0 * N + j] = ih * (k.x() * scale);
+                    columns[1 * N + j] = ih * (k.y() * scale);
+                    columns[2 * N + j] = h;
+                    columns[3 * N + j] = ih * k.x();
+                    columns[4 * N + j] = ih * k.y();
+                }
+                for (int f = 0; f < 5; ++f)
+                    fft.inv(&mSpectra[(f * H + i) * N], &columns[f * N], N);
+            }
+
+            // complex-to-real transform along x
+#ifndef _DEBUG
+#pragma omp for
+#endif
+            for (int y = 0; y < N; ++y)
+            {
+                for (int f = 0; f < 5; ++f)
+                {
+                    for (int i = 0; i < H; ++i)
+                        row[i] = mSpectra[(f * H + i) * N + y];
+                    fft.inv(values.data(), row.data(), N);
+                    for (int x = 0; x < N; ++x)
+                    {
+                        if (f < 3)
+                            mDisplacements[y * N + x][f] = values[x];
+                        else
+                            mSlopes[y * N + x][f - 3] = values[x];
+                    }
+                }
+            }
+        }
+    }
+
+    double OceanSpectrum::density(const Eigen::Vector2d& waveVector) const
+    {
+        double k = waveVector.norm();
+        if (k == 0)
+            return 0;
+
+        // cosine-squared spreading around the wind direction, normalized over the half plane
+        double cosTheta = waveVector.dot(Eigen::Vector2d(std::cos(windAngle), std::sin(windAngle))) / k;
+        if (cosTheta <= 0)
+            return 0;
+        double spreading = 2 / EIGEN_PI * cosTheta * cosTheta;
+
+        double g      = dispersion.gravity;
+        double result = 0;
+        switch (spectrum)
+        {
+        case ESpectrum::Phillips:
+        {
+            double L = windSpeed * windSpeed / g;
+            result   = amplitude * std::exp(-1 / (k * L * k * L)) / (k * k * k * k);
+            break;
+        }
+        case ESpectrum::Jonswap:
+        {
+            // frequency spectrum S(omega), converted to wave numbers by S(omega) d(omega)/dk / k
+            auto angularFrequency = [&](double k) { return k * dispersion.phaseSpeed(k); };
+            double omega          = angularFrequency(k);
+            double dk             = 1E-4 * k;
+            double domega         = (angularFrequency(k + dk) - angularFrequency(k - dk)) / (2 * dk);
+
+            double omegaPeak = 22 * std::cbrt(g * g / (windSpeed * fetch));
+            double alpha     = 0.076 * std::pow(windSpeed * windSpeed / (fetch * g), 0.22);
+            double sigma     = omega <= omegaPeak ? 0.07 : 0.09;
+            double r         = std::exp(-(omega - omegaPeak) * (omega - omegaPeak) / (2 * sigma * sigma * omegaPeak * omegaPeak));
+            double S         = alpha * g * g / std::pow(omega, 5) * std::exp(-1.25 * std::pow(omegaPeak / omega, 4)) * std::pow(peakEnhancement, r);
+            result           = S * domega / k;
+            break;
+        }
+        }
+
+        double l = minWaveLength / (2 * EIGEN_PI);
+        return result * spreading * std::exp(-k * k * l * l);
+    }
+
+    Eigen::Vector3d OceanSpectrum::displacement(const Eigen::Vector2d& position) const
+    {
+        return interpolate(mDisplacements, position);
+    }
+
+    Eigen::Vector2d OceanSpectrum::slope(const Eigen::Vector2d& position) const
+    {
+        return interpolate(mSlopes, position);
+    }
+
+    Eigen::Vector2d OceanSpectrum::waveVector(int i, int j) const
+    {
+        int n = i < mResolution / 2 ? i : i - mResolution;
+        int m = j < mResolution / 2 ? j : j - mResolution;
+        return Eigen::Vector2d(n, m) * (2 * EIGEN_PI / mSize);
+    }
+
+    template <typename TValue>
+    TValue OceanSpectrum::interpolate(const std::vector<TValue>& field, const Eigen::Vector2d& position) const
+    {
+        const int N = mResolution;
+        if (field.empty())
+            return TValue::Zero();
+
+        Eigen::Vector2d p = position / mSize * N;
+        double fx         = std::floor(p.x());
+        double fy         = std::floor(p.y());
+        double tx         = p.x() - fx;
+        double ty         = p.y() - fy;
+        int x0            = ((int64_t)fx % N + N) % N;
+        int y0            = ((int64_t)fy % N + N) % N;
+        int x1            = (x0 + 1) % N;
+        int y1            = (y0 + 1) % N;
+        return (1 - ty) * ((1 - tx) * field[y0 * N + x0] + tx * field[y0 * N + x1]) +
+               ty * ((1 - tx) * field[y1 * N + x0] + tx * field[y1 * N + x1]);
+    }
+}
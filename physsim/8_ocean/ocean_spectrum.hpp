@@ -0,0 +1,192 @@
+#pragma once
+
+#include "dispersion.hpp"
+
+#include <Eigen/Eigen>
+
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+namespace physsim
+{
+    /**
+     * @brief Statistical ocean model after Tessendorf that synthesizes the surface on a periodic patch with inverse FFTs.
+     * @details Random amplitudes are drawn once from a directional wave spectrum. Every frame, they are propagated in time with the angular frequency of the dispersion model and transformed into height, horizontal displacement and slope fields. The cost is O(N^2 log N) for an N x N grid, independent of the number of spectral components.
+     */
+    class OceanSpectrum
+    {
+    public:
+        /**
+         * @brief Shape of the wave spectrum.
+         */
+        enum class ESpectrum
+        {
+            /**
+             * @brief Phillips spectrum for a fully developed sea.
+             */
+            Phillips,
+
+            /**
+             * @brief JONSWAP spectrum for a fetch-limited sea.
+             */
+            Jonswap
+        };
+
+        /**
+         * @brief Constructor.
+         */
+        OceanSpectrum();
+
+        /**
+         * @brief Draws the random initial amplitudes. Has to be called after changing the resolution, size, seed, loop period or spectrum parameters.
+         */
+        void initialize();
+
+        /**
+         * @brief Synthesizes the displacement and slope fields at a given time.
+         * @param t Time in seconds.
+         */
+        void evaluate(double t);
+
+        /**
+         * @brief Evaluates the variance density of the surface height for a wave vector.
+         * @param waveVector Wave vector k. [rad/m]
+         * @return Spectral density [m^4].
+         */
+        double density(const Eigen::Vector2d& waveVector) const;
+
+        /**
+         * @brief Bilinearly interpolates the displacement of the last evaluation. The patch repeats periodically.
+         * @param position Horizontal position on the undisplaced surface. [m]
+         * @return Horizontal displacement in x and y, and height in z. [m]
+         */
+        Eigen::Vector3d displacement(const Eigen::Vector2d& position) const;
+
+        /**
+         * @brief Bilinearly interpolates the height gradient of the last evaluation. The patch repeats periodically.
+         * @param position Horizontal position on the undisplaced surface. [m]
+         * @return Partial derivatives of the height in x and y.
+         */
+        Eigen::Vector2d slope(const Eigen::Vector2d& position) const;
+
+        /**
+         * @brief Shape of the spectrum.
+         */
+        ESpectrum spectrum;
+
+        /**
+         * @brief Number of grid points along each side of the patch. Has to be a multiple of four.
+         */
+        int resolution;
+
+        /**
+         * @brief Side length of the periodic patch. [m]
+         */
+        double size;
+
+        /**
+         * @brief Wind speed at 10m above the surface. [m/s]
+         */
+        double windSpeed;
+
+        /**
+         * @brief Wind direction expressed by an angle. [rad]
+         */
+        double windAngle;
+
+        /**
+         * @brief Scale A of the Phillips spectrum.
+         */
+        double amplitude;
+
+        /**
+         * @brief Distance over which the wind blew over the water, used by JONSWAP. [m]
+         */
+        double fetch;
+
+        /**
+         * @brief Peak enhancement factor gamma of JONSWAP.
+         */
+        double peakEnhancement;
+
+        /**
+         * @brief Waves shorter than this are suppressed. [m]
+         */
+        double minWaveLength;
+
+        /**
+         * @brief Scaling of the horizontal displacement. Zero gives a pure height field, larger values sharpen the crests.
+         */
+        double choppiness;
+
+        /**
+         * @brief Seed of the random amplitudes.
+         */
+        uint32_t seed;
+
+        /**
+         * @brief If positive, the angular frequencies are rounded such that the surface repeats after this many seconds. [s]
+         */
+        double loopPeriod;
+
+        /**
+         * @brief Dispersion model that provides the angular frequency of each wave vector.
+         */
+        Dispersion dispersion;
+
+    private:
+        /**
+         * @brief Wave vector of a frequency index pair.
+         * @param i Frequency index along x.
+         * @param j Frequency index along y.
+         * @return Wave vector k. [rad/m]
+         */
+        Eigen::Vector2d waveVector(int i, int j) const;
+
+        /**
+         * @brief Fetches the bilinearly interpolated value of a periodic grid field.
+         * @tparam TValue Type of the values.
+         * @param field Values of the grid points, x varying fastest.
+         * @param position Horizontal position. [m]
+         * @return Interpolated value.
+         */
+        template <typename TValue>
+        TValue interpolate(const std::vector<TValue>& field, const Eigen::Vector2d& position) const;
+
+        /**
+         * @brief Resolution of the patch at the last initialization.
+         */
+        int mResolution;
+
+        /**
+         * @brief Side length of the patch at the last initialization.
+         */
+        double mSize;
+
+        /**
+         * @brief Initial amplitudes h0(k) of all frequency index pairs, i varying fastest.
+         */
+        std::vector<std::complex<double>> mAmplitudes;
+
+        /**
+         * @brief Angular frequencies omega(k) of all frequency index pairs, i varying fastest.
+         */
+        std::vector<double> mFrequencies;
+
+        /**
+         * @brief Half spectra of height, displacements and slopes, stored per x-frequency along the y-frequencies, which are then transformed in place.
+         */
+        std::vector<std::complex<double>> mSpectra;
+
+        /**
+         * @brief Displacements of the grid points, x varying fastest.
+         */
+        std::vector<Eigen::Vector3d> mDisplacements;
+
+        /**
+         * @brief Height gradients of the grid points, x varying fastest.
+         */
+        std::vector<Eigen::Vector2d> mSlopes;
+    };
+}
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "dispersion.hpp"
 
 #include <Eigen/Eigen>
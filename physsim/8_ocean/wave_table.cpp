@@ -0,0 +1,76 @@
+#include "wave_table.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace physsim
+{
+    void WaveTable::bake(const std::vector<Wave>& waves, double loopPeriod)
+    {
+        // sort from long to short waves, such that every sampling rate resolves a prefix of the table
+        Eigen::Index n = (Eigen::Index)waves.size();
+        std::vector<Eigen::Index> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&waves](Eigen::Index a, Eigen::Index b)
+                         { return waves[a].waveLength > waves[b].waveLength; });
+
+        mWaveLengths.resize(n);
+        mWaveVectorsX.resize(n);
+        mWaveVectorsY.resize(n);
+        mAngularFrequencies.resize(n);
+        mAmplitudes.resize(n);
+        mSteepnesses.resize(n);
+        mPhases.resize(n);
+        for (Eigen::Index i = 0; i < n; ++i)
+        {
+            const Wave& wave       = waves[order[i]];
+            Eigen::Vector2d k      = wave.waveVector();
+            mWaveLengths[i]        = wave.waveLength;
+            mWaveVectorsX[i]       = k.x();
+            mWaveVectorsY[i]       = k.y();
+            mAngularFrequencies[i] = wave.dispersion.angularFrequency(wave.waveNumber(), loopPeriod);
+            mAmplitudes[i]         = wave.amplitude;
+            mSteepnesses[i]        = wave.steepness * wave.amplitude * wave.waveNumber();
+            mPhases[i]             = wave.phase;
+        }
+    }
+
+    Eigen::Index WaveTable::size() const
+    {
+        return mAmplitudes.size();
+    }
+
+    Eigen::Index WaveTable::numResolved(double spacing) const
+    {
+        // waves shorter than two samples alias
+        auto end = std::partition_point(mWaveLengths.data(), mWaveLengths.data() + size(), [spacing](double waveLength)
+                                        { return waveLength >= 2 * spacing; });
+        return end - mWaveLengths.data();
+    }
+
+    void WaveTable::evaluate(const Eigen::ArrayXf& x, const Eigen::ArrayXf& y, double t, Eigen::ArrayXf& height, Eigen::ArrayXf& slopeX, Eigen::ArrayXf& slopeY, Eigen::Index count) const
+    {
+        if (count < 0 || count > size())
+            count = size();
+
+        height.setZero(x.size());
+        slopeX.setZero(x.size());
+        slopeY.setZero(x.size());
+
+        Eigen::ArrayXf theta(x.size()), psi(x.size()), gradient(x.size());
+        for (Eigen::Index i = 0; i < count; ++i)
+        {
+            // Wave::offset evaluates A cos(psi) with psi = theta - Q A k sin(theta), where theta = k.x - omega t + phi
+            float phase = (float)std::remainder(mPhases[i] - mAngularFrequencies[i] * t, 2 * EIGEN_PI);
+            theta       = mWaveVectorsX[i] * x + mWaveVectorsY[i] * y + phase;
+            psi   = theta - mSteepnesses[i] * theta.sin();
+            height += mAmplitudes[i] * psi.cos();
+
+            // d psi / dx = k (1 - Q A k cos(theta))
+            gradient = -mAmplitudes[i] * psi.sin() * (1 - mSteepnesses[i] * theta.cos());
+            slopeX += gradient * mWaveVectorsX[i];
+            slopeY += gradient * mWaveVectorsY[i];
+        }
+    }
+}
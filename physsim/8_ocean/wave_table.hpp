@@ -0,0 +1,86 @@
+#pragma once
+
+#include "wave.hpp"
+
+#include <Eigen/Eigen>
+
+#include <vector>
+
+namespace physsim
+{
+    /**
+     * @brief Structure-of-arrays copy of the per-wave constants that Wave recomputes on every call, such that a block of vertices can be evaluated against all waves with array operations.
+     * @details The evaluation runs in single precision, for which Eigen vectorizes sine and cosine. The time-dependent phase is reduced in double precision first, so accuracy does not degrade over time.
+     */
+    class WaveTable
+    {
+    public:
+        /**
+         * @brief Computes the constants of all waves, including their dispersion, and sorts them by decreasing wavelength.
+         * @param waves Waves to bake.
+         * @param loopPeriod If positive, the angular frequencies are rounded such that the sum repeats after this many seconds.
+         */
+        void bake(const std::vector<Wave>& waves, double loopPeriod = 0);
+
+        /**
+         * @brief Number of baked waves.
+         * @return Number of waves.
+         */
+        Eigen::Index size() const;
+
+        /**
+         * @brief Number of waves that a grid with the given vertex spacing resolves. The table is sorted by decreasing wavelength, so these are the first waves.
+         * @param spacing Distance between neighboring vertices. [m]
+         * @return Number of waves that are at least twice as long as the spacing.
+         */
+        Eigen::Index numResolved(double spacing) const;
+
+        /**
+         * @brief Evaluates the sum of the waves and its analytic gradient for a block of positions. Matches the sum of Wave::offset.
+         * @param x Horizontal x-coordinates of the block.
+         * @param y Horizontal y-coordinates of the block.
+         * @param t Time in seconds.
+         * @param height Resulting vertical offsets.
+         * @param slopeX Resulting partial derivatives of the offset in x.
+         * @param slopeY Resulting partial derivatives of the offset in y.
+         * @param count Number of waves to sum, starting with the longest. Negative values sum all waves.
+         */
+        void evaluate(const Eigen::ArrayXf& x, const Eigen::ArrayXf& y, double t, Eigen::ArrayXf& height, Eigen::ArrayXf& slopeX, Eigen::ArrayXf& slopeY, Eigen::Index count = -1) const;
+
+    private:
+        /**
+         * @brief Wavelengths lambda in decreasing order. [m]
+         */
+        Eigen::ArrayXd mWaveLengths;
+
+        /**
+         * @brief x-components of the wave vectors. [rad/m]
+         */
+        Eigen::ArrayXf mWaveVectorsX;
+
+        /**
+         * @brief y-components of the wave vectors. [rad/m]
+         */
+        Eigen::ArrayXf mWaveVectorsY;
+
+        /**
+         * @brief Angular frequencies omega, kept in double precision for the phase reduction. [rad/s]
+         */
+        Eigen::ArrayXd mAngularFrequencies;
+
+        /**
+         * @brief Amplitudes A. [m]
+         */
+        Eigen::ArrayXf mAmplitudes;
+
+        /**
+         * @brief Steepness Q multiplied by amplitude and wave number, i.e., the phase shift caused by the horizontal displacement.
+         */
+        Eigen::ArrayXf mSteepnesses;
+
+        /**
+         * @brief Phases phi.
+         */
+        Eigen::ArrayXd mPhases;
+    };
+}
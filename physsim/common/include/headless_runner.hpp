@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace vislab
+{
+    class Scene;
+}
+
+namespace physsim
+{
+    class Simulation;
+
+    /**
+     * @brief Drives a simulation without a window. Every step advances by a fixed time, independent of the wall clock, and is timed individually.
+     */
+    class HeadlessRunner
+    {
+    public:
+        /**
+         * @brief Timing of a run.
+         */
+        struct Report
+        {
+            /**
+             * @brief Number of timed steps.
+             */
+            int64_t numSteps;
+
+            /**
+             * @brief Wall-clock time of all timed steps in seconds.
+             */
+            double seconds;
+
+            /**
+             * @brief Throughput of the timed steps.
+             */
+            double stepsPerSecond;
+
+            /**
+             * @brief Median latency of a step in milliseconds.
+             */
+            double p50;
+
+            /**
+             * @brief 90th percentile of the step latency in milliseconds.
+             */
+            double p90;
+
+            /**
+             * @brief 99th percentile of the step latency in milliseconds.
+             */
+            double p99;
+
+            /**
+             * @brief Largest step latency in milliseconds.
+             */
+            double max;
+        };
+
+        /**
+         * @brief Constructor.
+         * @param simulation Simulation to run. It gets its own scene.
+         */
+        explicit HeadlessRunner(std::shared_ptr<Simulation> simulation);
+
+        /**
+         * @brief Initializes and restarts the simulation, then performs the warmup and the timed steps.
+         * @return Timing of the timed steps.
+         */
+        Report run();
+
+        /**
+         * @brief Writes the transformations of all shapes and the vertices of all triangle meshes of a scene as text, such that snapshots can be diffed.
+         * @param scene Scene to write.
+         * @param path Path of the file.
+         * @param timeStep Time step to record in the file.
+         * @return True if the file was written.
+         */
+        static bool writeSnapshot(const vislab::Scene& scene, const std::string& path, int64_t timeStep);
+
+        /**
+         * @brief Command line entry point that runs a registered simulation and prints the report.
+         * @details Usage: <simulation> [--steps N] [--warmup N] [--dt milliseconds] [--snapshot prefix] [--every N], or --list.
+         * @param argc Number of arguments.
+         * @param argv Arguments.
+         * @return Exit code.
+         */
+        static int main(int argc, char** argv);
+
+        /**
+         * @brief Number of timed steps.
+         */
+        int64_t numSteps;
+
+        /**
+         * @brief Number of untimed steps before the timed ones.
+         */
+        int64_t warmupSteps;
+
+        /**
+         * @brief Simulated time per step in milliseconds.
+         */
+        double stepTime;
+
+        /**
+         * @brief Number of steps between two snapshots. Zero disables the snapshots.
+         */
+        int64_t snapshotInterval;
+
+        /**
+         * @brief Path prefix of the snapshots, which are numbered by their time step.
+         */
+        std::string snapshotPrefix;
+
+    private:
+        /**
+         * @brief Simulation to run.
+         */
+        std::shared_ptr<Simulation> mSimulation;
+    };
+}
@@ -0,0 +1,499 @@
+#pragma once
+
+#include <Eigen/Eigen>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace physsim
+{
+    /**
+     * @brief Numerical integration methods for ordinary differential equations.
+     */
+    enum class EOdeMethod
+    {
+        /**
+         * @brief First-order explicit Euler.
+         */
+        ExplicitEuler,
+
+        /**
+         * @brief First-order symplectic Euler that updates the velocities before the positions.
+         */
+        SymplecticEuler,
+
+        /**
+         * @brief Second-order velocity Verlet (leapfrog) with half steps of the velocities.
+         */
+        VelocityVerlet,
+
+        /**
+         * @brief Classic fourth-order Runge-Kutta.
+         */
+        RungeKutta4,
+
+        /**
+         * @brief Embedded Runge-Kutta 5(4) of Dormand and Prince with error-controlled step size.
+         */
+        DormandPrince45,
+
+        /**
+         * @brief First-order implicit Euler, solved with Newton's method.
+         */
+        ImplicitEuler
+    };
+
+    /**
+     * @brief Integrator for ordinary differential equations dy/dt = f(t, y).
+     * @details The right-hand side is any callable with signature TState(double t, const TState& y). The partitioned methods (symplectic Euler and velocity Verlet) treat the first positionSize() coefficients of the state as positions and the remaining ones as velocities, and require that the rate of change of the positions only depends on the velocities. They skip evaluations if the system is declared second order or its velocity rates independent of the velocities. The Dormand-Prince method adapts the step size such that the estimated local error stays below the tolerance. All other methods use the fixed step size.
+     * @tparam TState Eigen column vector type of the state.
+     */
+    template <typename TState>
+    class OdeIntegrator
+    {
+    public:
+        /**
+         * @brief Square matrix type of the Jacobian of the right-hand side.
+         */
+        using Matrix = Eigen::Matrix<typename TState::Scalar, TState::RowsAtCompileTime, TState::RowsAtCompileTime>;
+
+        /**
+         * @brief Constructor.
+         * @param method Numerical integration method.
+         * @param stepSize Fixed step size, or initial step size of the adaptive method.
+         */
+        OdeIntegrator(EOdeMethod method = EOdeMethod::RungeKutta4, double stepSize = 1E-2)
+            : mMethod(method)
+            , mStepSize(stepSize)
+            , mAdaptiveStepSize(stepSize)
+            , mTolerance(1E-6)
+            , mPositionSize(-1)
+            , mNewtonIterations(5)
+            , mSecondOrder(false)
+            , mVelocityIndependent(false)
+            , mEvaluations(0)
+            , mCachedTime(std::numeric_limits<double>::quiet_NaN())
+        {
+        }
+
+        /**
+         * @brief Advances the state over a time interval. Fixed-step methods divide the interval into equal steps no longer than the step size.
+         * @tparam TFunction Type of the right-hand side.
+         * @param f Right-hand side f(t, y).
+         * @param t Current time, which is advanced by the duration.
+         * @param y Current state, which is replaced by the state at the end of the interval.
+         * @param duration Length of the time interval.
+         */
+        template <typename TFunction>
+        void integrate(const TFunction& f, double& t, TState& y, double duration)
+        {
+            if (duration <= 0)
+                return;
+
+            if (mMethod != EOdeMethod::DormandPrince45)
+            {
+                int64_t numSteps = std::max<int64_t>(1, (int64_t)std::ceil(duration / mStepSize - 1E-9));
+                double h         = duration / numSteps;
+                for (int64_t i = 0; i < numSteps; ++i)
+                {
+                    step(f, t, y, h);
+                    t += h;
+                }
+                return;
+            }
+
+            // the last stage of an accepted step is the first stage of the next one (first same as last)
+            const double end = t + duration;
+            TState k1        = f(t, y);
+            mEvaluations++;
+            while (t < end)
+            {
+                double h = std::min(mAdaptiveStepSize, end - t);
+                TState k7, y5;
+                double error = stepDormandPrince(f, t, y, h, k1, k7, y5);
+
+                // the step size follows the error estimate of the fourth-order solution
+                double factor = error == 0 ? 5.0 : std::clamp(0.9 * std::pow(error, -0.2), 0.2, 5.0);
+                if (error <= 1 || h <= mMinStepSize)
+                {
+                    t  = (end - t - h) <= 1E-12 * std::abs(end) ? end : t + h;
+                    y  = y5;
+                    k1 = k7;
+                    if (h == mAdaptiveStepSize || factor < 1)
+                        mAdaptiveStepSize = std::max(h * factor, mMinStepSize);
+                }
+                else
+                {
+                    mAdaptiveStepSize = std::max(h * factor, mMinStepSize);
+                }
+            }
+        }
+
+        /**
+         * @brief Performs a single step with the given step size. The adaptive method takes the step without checking the error.
+         * @tparam TFunction Type of the right-hand side.
+         * @param f Right-hand side f(t, y).
+         * @param t Current time.
+         * @param y Current state, which is replaced by the state at time t + h.
+         * @param h Step size.
+         */
+        template <typename TFunction>
+        void step(const TFunction& f, double t, TState& y, double h)
+        {
+            switch (mMethod)
+            {
+            case EOdeMethod::ExplicitEuler:
+            {
+                y += h * f(t, y);
+                mEvaluations++;
+                break;
+            }
+            case EOdeMethod::SymplecticEuler:
+            {
+                // velocities with the old state, positions with the new velocities
+                Eigen::Index p = numPositions(y);
+                Eigen::Index n = y.size() - p;
+                y.tail(n) += h * velocityRate(f, t, y, p).tail(n);
+                drift(f, t, y, h, p);
+                break;
+            }
+            case EOdeMethod::VelocityVerlet:
+            {
+                // half step of the velocities, full step of the positions, half step of the velocities
+                Eigen::Index p = numPositions(y);
+                Eigen::Index n = y.size() - p;
+                y.tail(n) += 0.5 * h * velocityRate(f, t, y, p).tail(n);
+                drift(f, t + 0.5 * h, y, h, p);
+                y.tail(n) += 0.5 * h * velocityRate(f, t + h, y, p).tail(n);
+                break;
+            }
+            case EOdeMethod::RungeKutta4:
+            {
+                TState k1 = f(t, y);
+                TState k2 = f(t + 0.5 * h, y + 0.5 * h * k1);
+                TState k3 = f(t + 0.5 * h, y + 0.5 * h * k2);
+                TState k4 = f(t + h, y + h * k3);
+                y += h / 6. * (k1 + 2 * k2 + 2 * k3 + k4);
+                mEvaluations += 4;
+                break;
+            }
+            case EOdeMethod::DormandPrince45:
+            {
+                TState k1 = f(t, y);
+                mEvaluations++;
+                TState k7, y5;
+                stepDormandPrince(f, t, y, h, k1, k7, y5);
+                y = y5;
+                break;
+            }
+            case EOdeMethod::ImplicitEuler:
+            {
+                stepImplicitEuler(f, t, y, h);
+                break;
+            }
+            }
+        }
+
+        /**
+         * @brief Gets the numerical integration method.
+         * @return Numerical integration method.
+         */
+        EOdeMethod method() const { return mMethod; }
+
+        /**
+         * @brief Sets the numerical integration method.
+         * @param method Numerical integration method.
+         */
+        void setMethod(EOdeMethod method) { mMethod = method; }
+
+        /**
+         * @brief Gets the fixed step size.
+         * @return Fixed step size.
+         */
+        double stepSize() const { return mStepSize; }
+
+        /**
+         * @brief Sets the fixed step size, which is also used as initial step size of the adaptive method.
+         * @param stepSize Fixed step size.
+         */
+        void setStepSize(double stepSize)
+        {
+            mStepSize         = stepSize;
+            mAdaptiveStepSize = stepSize;
+        }
+
+        /**
+         * @brief Gets the step size that the adaptive method will try next.
+         * @return Current adaptive step size.
+         */
+        double adaptiveStepSize() const { return mAdaptiveStepSize; }
+
+        /**
+         * @brief Gets the tolerance of the local error of the adaptive method, used both as absolute and relative tolerance.
+         * @return Error tolerance.
+         */
+        double tolerance() const { return mTolerance; }
+
+        /**
+         * @brief Sets the tolerance of the local error of the adaptive method, used both as absolute and relative tolerance.
+         * @param tolerance Error tolerance.
+         */
+        void setTolerance(double tolerance) { mTolerance = tolerance; }
+
+        /**
+         * @brief Gets the number of leading state coefficients that are positions. Negative values split the state in half.
+         * @return Number of position coefficients.
+         */
+        Eigen::Index positionSize() const { return mPositionSize; }
+
+        /**
+         * @brief Sets the number of leading state coefficients that are positions. Negative values split the state in half.
+         * @param positionSize Number of position coefficients.
+         */
+        void setPositionSize(Eigen::Index positionSize) { mPositionSize = positionSize; }
+
+        /**
+         * @brief Gets the maximum number of Newton iterations of the implicit method.
+         * @return Maximum number of Newton iterations.
+         */
+        int newtonIterations() const { return mNewtonIterations; }
+
+        /**
+         * @brief Sets the maximum number of Newton iterations of the implicit method.
+         * @param iterations Maximum number of Newton iterations.
+         */
+        void setNewtonIterations(int iterations) { mNewtonIterations = iterations; }
+
+        /**
+         * @brief Checks whether the rate of change of the positions is declared to be the velocities, i.e., dx/dt = v.
+         * @return True if the system is second order.
+         */
+        bool secondOrder() const { return mSecondOrder; }
+
+        /**
+         * @brief Declares that the rate of change of the positions is the velocities, i.e., dx/dt = v, which requires as many positions as velocities. The partitioned methods then take the position update from the state instead of evaluating the right-hand side.
+         * @param secondOrder True if the system is second order.
+         */
+        void setSecondOrder(bool secondOrder) { mSecondOrder = secondOrder; }
+
+        /**
+         * @brief Checks whether the rate of change of the velocities is declared to only depend on time and positions.
+         * @return True if the velocity rates are independent of the velocities.
+         */
+        bool velocityIndependent() const { return mVelocityIndependent; }
+
+        /**
+         * @brief Declares that the rate of change of the velocities only depends on time and positions, as for undamped forces. The partitioned methods then reuse the last evaluation if it was taken at the same time and positions, such as the closing half step of velocity Verlet for the opening half step of the next one. The right-hand side must not change between calls, otherwise call reset().
+         * @param velocityIndependent True if the velocity rates are independent of the velocities.
+         */
+        void setVelocityIndependent(bool velocityIndependent)
+        {
+            mVelocityIndependent = velocityIndependent;
+            mCachedTime          = std::numeric_limits<double>::quiet_NaN();
+        }
+
+        /**
+         * @brief Gets the number of evaluations of the right-hand side since the last reset.
+         * @return Number of function evaluations.
+         */
+        int64_t evaluations() const { return mEvaluations; }
+
+        /**
+         * @brief Resets the counter of function evaluations, the adaptive step size and the last evaluation that the partitioned methods reuse.
+         */
+        void reset()
+        {
+            mEvaluations      = 0;
+            mAdaptiveStepSize = mStepSize;
+            mCachedTime       = std::numeric_limits<double>::quiet_NaN();
+        }
+
+    private:
+        /**
+         * @brief Computes the number of position coefficients of a state.
+         * @param y State.
+         * @return Number of position coefficients.
+         */
+        Eigen::Index numPositions(const TState& y) const
+        {
+            return mPositionSize < 0 ? y.size() / 2 : std::min(mPositionSize, (Eigen::Index)y.size());
+        }
+
+        /**
+         * @brief Evaluates the right-hand side for a velocity update of the partitioned methods. Velocity rates that are independent of the velocities are taken from the last evaluation if it was at the same time and positions.
+         * @tparam TFunction Type of the right-hand side.
+         * @param f Right-hand side f(t, y).
+         * @param t Current time.
+         * @param y Current state.
+         * @param p Number of position coefficients.
+         * @return Derivative, of which only the velocity coefficients are used.
+         */
+        template <typename TFunction>
+        const TState& velocityRate(const TFunction& f, double t, const TState& y, Eigen::Index p)
+        {
+            if (!mVelocityIndependent || t != mCachedTime || mCachedState.size() != y.size() || mCachedState.head(p) != y.head(p))
+            {
+                mCachedRate  = f(t, y);
+                mCachedState = y;
+                mCachedTime  = t;
+                mEvaluations++;
+            }
+            return mCachedRate;
+        }
+
+        /**
+         * @brief Advances the positions of the partitioned methods with the current velocities.
+         * @tparam TFunction Type of the right-hand side.
+         * @param f Right-hand side f(t, y).
+         * @param t Current time.
+         * @param y Current state, whose positions are advanced.
+         * @param h Step size.
+         * @param p Number of position coefficients.
+         */
+        template <typename TFunction>
+        void drift(const TFunction& f, double t, TState& y, double h, Eigen::Index p)
+        {
+            if (mSecondOrder)
+            {
+                y.head(p) += h * y.tail(y.size() - p);
+                return;
+            }
+            y.head(p) += h * f(t, y).head(p);
+            mEvaluations++;
+        }
+
+        /**
+         * @brief Takes one Dormand-Prince step.
+         * @tparam TFunction Type of the right-hand side.
+         * @param f Right-hand side f(t, y).
+         * @param t Current time.
+         * @param y Current state.
+         * @param h Step size.
+         * @param k1 Derivative at the current state.
+         * @param k7 Receives the derivative at the new state.
+         * @param y5 Receives the fifth-order solution.
+         * @return Norm of the error estimate relative to the tolerance. Values below one are accepted.
+         */
+        template <typename TFunction>
+        double stepDormandPrince(const TFunction& f, double t, const TState& y, double h, const TState& k1, TState& k7, TState& y5)
+        {
+            TState k2 = f(t + h / 5., y + h * (1. / 5. * k1));
+            TState k3 = f(t + h * 3. / 10., y + h * (3. / 40. * k1 + 9. / 40. * k2));
+            TState k4 = f(t + h * 4. / 5., y + h * (44. / 45. * k1 - 56. / 15. * k2 + 32. / 9. * k3));
+            TState k5 = f(t + h * 8. / 9., y + h * (19372. / 6561. * k1 - 25360. / 2187. * k2 + 64448. / 6561. * k3 - 212. / 729. * k4));
+            TState k6 = f(t + h, y + h * (9017. / 3168. * k1 - 355. / 33. * k2 + 46732. / 5247. * k3 + 49. / 176. * k4 - 5103. / 18656. * k5));
+            y5        = y + h * (35. / 384. * k1 + 500. / 1113. * k3 + 125. / 192. * k4 - 2187. / 6784. * k5 + 11. / 84. * k6);
+            k7        = f(t + h, y5);
+            mEvaluations += 6;
+
+            // difference between the fifth- and the embedded fourth-order solution
+            TState error = h * (71. / 57600. * k1 - 71. / 16695. * k3 + 71. / 1920. * k4 - 17253. / 339200. * k5 + 22. / 525. * k6 - 1. / 40. * k7);
+            TState scale = (mTolerance * (1 + y.cwiseAbs().cwiseMax(y5.cwiseAbs()).array())).matrix();
+            return std::sqrt(error.cwiseQuotient(scale).squaredNorm() / std::max<Eigen::Index>(1, y.size()));
+        }
+
+        /**
+         * @brief Takes one implicit Euler step by solving y1 = y + h f(t + h, y1) with Newton's method and a finite-difference Jacobian.
+         * @tparam TFunction Type of the right-hand side.
+         * @param f Right-hand side f(t, y).
+         * @param t Current time.
+         * @param y Current state, which is replaced by the new state.
+         * @param h Step size.
+         */
+        template <typename TFunction>
+        void stepImplicitEuler(const TFunction& f, double t, TState& y, double h)
+        {
+            const Eigen::Index n = y.size();
+            const double eps     = std::sqrt(std::numeric_limits<double>::epsilon());
+            TState y1            = y;
+            for (int iteration = 0; iteration < mNewtonIterations; ++iteration)
+            {
+                // residual g(y1) = y1 - y - h f(t + h, y1) and its Jacobian I - h df/dy
+                TState fy = f(t + h, y1);
+                TState g  = y1 - y - h * fy;
+                Matrix J  = Matrix::Identity(n, n);
+                for (Eigen::Index j = 0; j < n; ++j)
+                {
+                    double dj = eps * std::max(1.0, std::abs((double)y1[j]));
+                    TState yj = y1;
+                    yj[j] += dj;
+                    J.col(j) -= h / dj * (f(t + h, yj) - fy);
+                }
+                mEvaluations += 1 + n;
+
+                TState delta = J.partialPivLu().solve(-g);
+                y1 += delta;
+                if (delta.norm() <= 1E-12 * (1 + y1.norm()))
+                    break;
+            }
+            y = y1;
+        }
+
+        /**
+         * @brief Numerical integration method.
+         */
+        EOdeMethod mMethod;
+
+        /**
+         * @brief Fixed step size.
+         */
+        double mStepSize;
+
+        /**
+         * @brief Step size that the adaptive method tries next.
+         */
+        double mAdaptiveStepSize;
+
+        /**
+         * @brief Tolerance of the local error of the adaptive method.
+         */
+        double mTolerance;
+
+        /**
+         * @brief Number of leading state coefficients that are positions, or negative to split the state in half.
+         */
+        Eigen::Index mPositionSize;
+
+        /**
+         * @brief Maximum number of Newton iterations of the implicit method.
+         */
+        int mNewtonIterations;
+
+        /**
+         * @brief Flag that determines whether the rate of change of the positions is the velocities.
+         */
+        bool mSecondOrder;
+
+        /**
+         * @brief Flag that determines whether the rate of change of the velocities only depends on time and positions.
+         */
+        bool mVelocityIndependent;
+
+        /**
+         * @brief Number of evaluations of the right-hand side.
+         */
+        int64_t mEvaluations;
+
+        /**
+         * @brief Time of the last evaluation of the partitioned methods, or NaN if there is none.
+         */
+        double mCachedTime;
+
+        /**
+         * @brief State of the last evaluation of the partitioned methods.
+         */
+        TState mCachedState;
+
+        /**
+         * @brief Derivative of the last evaluation of the partitioned methods.
+         */
+        TState mCachedRate;
+
+        /**
+         * @brief Smallest step size of the adaptive method, which guarantees progress.
+         */
+        static constexpr double mMinStepSize = 1E-12;
+    };
+}
@@ -10,11 +10,16 @@ namespace vislab
 
 namespace physsim
 {
+    class RigidBodyWorld;
+
     /**
      * @brief Class that represents the state of a rigid body.
+     * @details The state is stored in a RigidBodyWorld and this class is a view onto one of its bodies. Views are not copyable, since a copy would alias the storage of the same body instead of duplicating its state; share them through std::shared_ptr instead. A default-constructed body owns a world of its own.
      */
     class RigidBody
     {
+        friend class RigidBodyWorld;
+
     public:
         /**
          * @brief Identifies whether a rigid body is static or dynamic.
@@ -37,6 +42,16 @@ namespace physsim
          */
         RigidBody();
 
+        /**
+         * @brief Views are not copyable, since copies would alias the state of the same body.
+         */
+        RigidBody(const RigidBody&) = delete;
+
+        /**
+         * @brief Views are not assignable, since assignments would alias the state of the same body.
+         */
+        RigidBody& operator=(const RigidBody&) = delete;
+
         /**
          * @brief Gets the position of the center of mass in world space.
          * @return Position of the center of mass in world space.
@@ -225,76 +240,47 @@ namespace physsim
          */
         void setScale(const double& scale);
 
-    private:
         /**
-         * @brief Updates the transformation of the associated shape.
+         * @brief Checks whether the body is awake. Sleeping bodies are not integrated.
+         * @return True if the body is awake.
          */
-        void updateTransform();
+        bool isAwake() const;
 
         /**
-         * @brief Position of the center of mass in world space.
+         * @brief Wakes the body up or puts it to sleep. Waking restarts the rest time, sleeping stops the body.
+         * @param awake True to wake the body up.
          */
-        Eigen::Vector3d mPosition;
+        void setAwake(bool awake);
 
         /**
-         * @brief Rotation quaternion of the center of mass to world space.
-         */
-        Eigen::Quaterniond mRotation;
-
-        /**
-         * @brief Gets the linear velocity of the center of mass.
-         */
-        Eigen::Vector3d mLinearVelocity;
-
-        /**
-         * @brief Gets the angular velocity of the center of mass.
+         * @brief Gets the world that stores the state of this body.
+         * @return World that stores the state of this body.
          */
-        Eigen::Vector3d mAngularVelocity;
+        RigidBodyWorld& world() const;
 
         /**
-         * @brief Moment of inertia tensor in local body coordinates.
+         * @brief Gets the index of this body in its world.
+         * @return Index of this body in its world.
          */
-        Eigen::Matrix3d mInertiaBody;
-
-        /**
-         * @brief Inverse of the moment of interia tensor in local body coordinates.
-         */
-        Eigen::Matrix3d mInertiaBodyInverse;
-
-        /**
-         * @brief Mass of the rigid body.
-         */
-        double mMass;
-
-        /**
-         * @brief Inverse of the mass of the rigid body.
-         */
-        double mMassInverse;
-
-        /**
-         * @brief Body force that is currently applied to the body.
-         */
-        Eigen::Vector3d mForce;
-
-        /**
-         * @brief Body torque that is currently applied to the body.
-         */
-        Eigen::Vector3d mTorque;
+        size_t index() const;
 
+    private:
         /**
-         * @brief Type of object.
+         * @brief Constructor of a view onto a body of a world.
+         * @param world World that stores the state.
+         * @param index Index of the body in the world.
          */
-        EType mType;
+        RigidBody(std::shared_ptr<RigidBodyWorld> world, size_t index);
 
         /**
-         * @brief Shape that is associated with this rigid body.
+         * @brief World that stores the state.
          */
-        std::shared_ptr<vislab::Shape> mShape;
+        std::shared_ptr<RigidBodyWorld> mWorld;
 
         /**
-         * @brief Uniform scaling of the shape.
+         * @brief Index of the body in the world.
          */
-        double mScale;
+        size_t mIndex;
     };
 
     /**
@@ -24,4 +24,18 @@ namespace physsim
      * @param stepSize Numerical integration step size.
      */
     void implicitEuler(RigidBody& body, double stepSize);
+
+    /**
+     * @brief Fourth-order Runge-Kutta integration for a rigid body.
+     * @param body Rigid body to integrate.
+     * @param stepSize Numerical integration step size.
+     */
+    void rungeKutta4(RigidBody& body, double stepSize);
+
+    /**
+     * @brief Adaptive Dormand-Prince integration for a rigid body, which takes error-controlled substeps.
+     * @param body Rigid body to integrate.
+     * @param stepSize Numerical integration step size.
+     */
+    void dormandPrince45(RigidBody& body, double stepSize);
 }
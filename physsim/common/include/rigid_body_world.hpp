@@ -0,0 +1,344 @@
+#pragma once
+
+#include "ode_integrator.hpp"
+#include "rigid_body.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace physsim
+{
+    /**
+     * @brief Container that stores the state of many rigid bodies in structure-of-arrays layout and integrates them in one pass.
+     * @details Each quantity is kept in its own contiguous array, such that batched integration streams through memory and runs in parallel over the bodies. The RigidBody objects returned by addBody() are views onto one slot of the arrays and stay valid as long as they are held, since they keep the world alive.
+     * Bodies that stayed slow for a while are put to sleep together with all bodies they touch and are skipped by the integration until a moving body touches their island again.
+     */
+    class RigidBodyWorld : public std::enable_shared_from_this<RigidBodyWorld>
+    {
+        friend class RigidBody;
+
+    public:
+        /**
+         * @brief Numerical integration method for the rigid bodies.
+         */
+        enum class EIntegrator
+        {
+            /**
+             * @brief Explicit Euler integration.
+             */
+            ExplicitEuler,
+
+            /**
+             * @brief Symplectic Euler integration.
+             */
+            SymplecticEuler,
+
+            /**
+             * @brief Implicit Euler integration of the gyroscopic term.
+             */
+            ImplicitEuler,
+
+            /**
+             * @brief Classic fourth-order Runge-Kutta integration of the full state.
+             */
+            RungeKutta4,
+
+            /**
+             * @brief Dormand-Prince integration of the full state with error-controlled substeps.
+             */
+            DormandPrince45
+        };
+
+        /**
+         * @brief Constructor of an empty world.
+         */
+        RigidBodyWorld();
+
+        /**
+         * @brief Adds a unit body at the origin. The world has to be owned by a shared pointer, otherwise std::logic_error is thrown.
+         * @return View onto the new body.
+         */
+        std::shared_ptr<RigidBody> addBody();
+
+        /**
+         * @brief Reserves memory for a number of bodies.
+         * @param capacity Number of bodies to reserve memory for.
+         */
+        void reserve(size_t capacity);
+
+        /**
+         * @brief Gets the number of bodies.
+         * @return Number of bodies.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Integrates all awake dynamic bodies in parallel, updates the transformations of their shapes and tracks how long they have been resting.
+         * @param method Numerical integration method.
+         * @param stepSize Numerical integration step size.
+         */
+        void integrate(EIntegrator method, double stepSize);
+
+        /**
+         * @brief Integrates a single body if it is dynamic and awake, and updates the transformation of its shape.
+         * @param method Numerical integration method.
+         * @param stepSize Numerical integration step size.
+         * @param index Index of the body.
+         */
+        void integrate(EIntegrator method, double stepSize, size_t index);
+
+        /**
+         * @brief Puts islands of resting bodies to sleep and wakes islands that are touched by moving bodies.
+         * @details Dynamic bodies that touch each other form an island. An island falls asleep once all of its bodies stayed below the velocity thresholds for the sleep time. An island wakes up as soon as one of its bodies is awake and has not rested long enough, for example a body that hit a sleeping pile.
+         * @param touching Indices of pairs of bodies that are in contact.
+         */
+        void updateSleeping(const std::vector<std::pair<size_t, size_t>>& touching);
+
+        /**
+         * @brief Wakes up all bodies.
+         */
+        void wakeAll();
+
+        /**
+         * @brief Gets the number of dynamic bodies that are awake.
+         * @return Number of awake dynamic bodies.
+         */
+        size_t numAwake() const;
+
+        /**
+         * @brief Checks whether bodies are allowed to fall asleep.
+         * @return True if sleeping is enabled.
+         */
+        bool isSleepingEnabled() const;
+
+        /**
+         * @brief Sets whether bodies are allowed to fall asleep. Disabling wakes all bodies.
+         * @param enabled True if sleeping is enabled.
+         */
+        void setSleepingEnabled(bool enabled);
+
+        /**
+         * @brief Gets the time a body has to rest before it may fall asleep.
+         * @return Sleep time.
+         */
+        double sleepTime() const;
+
+        /**
+         * @brief Sets the time a body has to rest before it may fall asleep.
+         * @param time Sleep time.
+         */
+        void setSleepTime(double time);
+
+        /**
+         * @brief Gets the linear velocity below which a body is considered to be resting.
+         * @return Linear velocity threshold.
+         */
+        double sleepLinearVelocity() const;
+
+        /**
+         * @brief Sets the linear velocity below which a body is considered to be resting.
+         * @param velocity Linear velocity threshold.
+         */
+        void setSleepLinearVelocity(double velocity);
+
+        /**
+         * @brief Gets the angular velocity below which a body is considered to be resting.
+         * @return Angular velocity threshold.
+         */
+        double sleepAngularVelocity() const;
+
+        /**
+         * @brief Sets the angular velocity below which a body is considered to be resting.
+         * @param velocity Angular velocity threshold.
+         */
+        void setSleepAngularVelocity(double velocity);
+
+        /**
+         * @brief Gets the tolerance of the local error of the adaptive integration.
+         * @return Error tolerance.
+         */
+        double tolerance() const;
+
+        /**
+         * @brief Sets the tolerance of the local error of the adaptive integration.
+         * @param tolerance Error tolerance.
+         */
+        void setTolerance(double tolerance);
+
+        /**
+         * @brief Gets the positions of the centers of mass in world space.
+         * @return Positions of all bodies.
+         */
+        const std::vector<Eigen::Vector3d>& positions() const;
+
+        /**
+         * @brief Gets the rotation quaternions to world space.
+         * @return Rotations of all bodies.
+         */
+        const std::vector<Eigen::Quaterniond>& rotations() const;
+
+        /**
+         * @brief Gets the linear velocities of the centers of mass.
+         * @return Linear velocities of all bodies.
+         */
+        const std::vector<Eigen::Vector3d>& linearVelocities() const;
+
+        /**
+         * @brief Gets the angular velocities of the centers of mass.
+         * @return Angular velocities of all bodies.
+         */
+        const std::vector<Eigen::Vector3d>& angularVelocities() const;
+
+    private:
+        /**
+         * @brief State of a body for the generic ODE integrator, consisting of position, rotation (w, x, y, z), linear and angular velocity.
+         */
+        using OdeState = Eigen::Matrix<double, 13, 1>;
+
+        /**
+         * @brief Appends a slot with the state of a unit body at the origin.
+         * @return Index of the new slot.
+         */
+        size_t allocate();
+
+        /**
+         * @brief Accumulates the rest time of a body or resets it if the body moves.
+         * @param stepSize Numerical integration step size.
+         * @param index Index of the body.
+         */
+        void updateRestTime(double stepSize, size_t index);
+
+        /**
+         * @brief Advances the state of one body without touching its shape.
+         * @param method Numerical integration method.
+         * @param stepSize Numerical integration step size.
+         * @param index Index of the body.
+         */
+        void step(EIntegrator method, double stepSize, size_t index);
+
+        /**
+         * @brief Advances the state of one body with a generic ODE integrator. The state consists of position, rotation, linear and angular velocity.
+         * @param method Numerical integration method.
+         * @param stepSize Numerical integration step size.
+         * @param index Index of the body.
+         */
+        void stepOde(EOdeMethod method, double stepSize, size_t index);
+
+        /**
+         * @brief Updates the transformation of the shape of a body.
+         * @param index Index of the body.
+         */
+        void updateTransform(size_t index);
+
+        /**
+         * @brief Positions of the centers of mass in world space.
+         */
+        std::vector<Eigen::Vector3d> mPositions;
+
+        /**
+         * @brief Rotation quaternions of the centers of mass to world space.
+         */
+        std::vector<Eigen::Quaterniond> mRotations;
+
+        /**
+         * @brief Linear velocities of the centers of mass.
+         */
+        std::vector<Eigen::Vector3d> mLinearVelocities;
+
+        /**
+         * @brief Angular velocities of the centers of mass.
+         */
+        std::vector<Eigen::Vector3d> mAngularVelocities;
+
+        /**
+         * @brief Moment of inertia tensors in local body coordinates.
+         */
+        std::vector<Eigen::Matrix3d> mInertiaBody;
+
+        /**
+         * @brief Inverses of the moment of inertia tensors in local body coordinates.
+         */
+        std::vector<Eigen::Matrix3d> mInertiaBodyInverse;
+
+        /**
+         * @brief Masses of the bodies.
+         */
+        std::vector<double> mMasses;
+
+        /**
+         * @brief Inverses of the masses of the bodies.
+         */
+        std::vector<double> mMassInverses;
+
+        /**
+         * @brief Body forces that are currently applied.
+         */
+        std::vector<Eigen::Vector3d> mForces;
+
+        /**
+         * @brief Body torques that are currently applied.
+         */
+        std::vector<Eigen::Vector3d> mTorques;
+
+        /**
+         * @brief Types of the bodies.
+         */
+        std::vector<RigidBody::EType> mTypes;
+
+        /**
+         * @brief Shapes that are associated with the bodies.
+         */
+        std::vector<std::shared_ptr<vislab::Shape>> mShapes;
+
+        /**
+         * @brief Uniform scalings of the shapes.
+         */
+        std::vector<double> mScales;
+
+        /**
+         * @brief Flags that determine whether the bodies are awake. Stored as bytes, since bodies are updated concurrently.
+         */
+        std::vector<uint8_t> mAwake;
+
+        /**
+         * @brief Time that each body has been resting.
+         */
+        std::vector<double> mRestTimes;
+
+        /**
+         * @brief Representative body of the island that each sleeping body fell asleep with.
+         */
+        std::vector<size_t> mSleepIslands;
+
+        /**
+         * @brief Generic ODE integrators of the bodies, which keep the adaptive step size from one step to the next.
+         */
+        std::vector<OdeIntegrator<OdeState>> mOdeIntegrators;
+
+        /**
+         * @brief Flag that determines whether bodies are allowed to fall asleep.
+         */
+        bool mSleepingEnabled;
+
+        /**
+         * @brief Time a body has to rest before it may fall asleep.
+         */
+        double mSleepTime;
+
+        /**
+         * @brief Linear velocity below which a body is considered to be resting.
+         */
+        double mSleepLinearVelocity;
+
+        /**
+         * @brief Angular velocity below which a body is considered to be resting.
+         */
+        double mSleepAngularVelocity;
+
+        /**
+         * @brief Tolerance of the local error of the adaptive integration.
+         */
+        double mTolerance;
+    };
+}
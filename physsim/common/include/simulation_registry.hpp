@@ -0,0 +1,74 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace physsim
+{
+    class Simulation;
+
+    /**
+     * @brief Global table of named simulation factories, such that simulations can be instantiated without knowing their type.
+     */
+    class SimulationRegistry
+    {
+    public:
+        /**
+         * @brief Factory function that creates a new simulation.
+         */
+        using Factory = std::function<std::shared_ptr<Simulation>()>;
+
+        /**
+         * @brief Gets the registry that all simulations are added to.
+         * @return Global registry.
+         */
+        static SimulationRegistry& instance();
+
+        /**
+         * @brief Adds a simulation. An existing entry with the same name is replaced.
+         * @param name Name of the simulation.
+         * @param factory Function that creates the simulation.
+         */
+        void add(const std::string& name, Factory factory);
+
+        /**
+         * @brief Creates a registered simulation.
+         * @param name Name of the simulation.
+         * @return New simulation or nullptr if the name is unknown.
+         */
+        std::shared_ptr<Simulation> create(const std::string& name) const;
+
+        /**
+         * @brief Gets the names of all registered simulations.
+         * @return Sorted names.
+         */
+        std::vector<std::string> names() const;
+
+    private:
+        /**
+         * @brief Factories by name.
+         */
+        std::map<std::string, Factory> mFactories;
+    };
+
+    /**
+     * @brief Helper that registers a simulation type when it is constructed. Intended to be used for static objects.
+     * @tparam TSimulation Type of the simulation, which needs to be default-constructible.
+     */
+    template <typename TSimulation>
+    class SimulationRegistration
+    {
+    public:
+        /**
+         * @brief Adds the simulation type to the global registry.
+         * @param name Name of the simulation.
+         */
+        explicit SimulationRegistration(const std::string& name)
+        {
+            SimulationRegistry::instance().add(name, []() { return std::make_shared<TSimulation>(); });
+        }
+    };
+}
@@ -0,0 +1,192 @@
+#include "headless_runner.hpp"
+
+#include "simulation.hpp"
+#include "simulation_registry.hpp"
+
+#include <vislab/core/array.hpp>
+#include <vislab/graphics/mesh.hpp>
+#include <vislab/graphics/scene.hpp>
+#include <vislab/graphics/triangle.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace physsim
+{
+    HeadlessRunner::HeadlessRunner(std::shared_ptr<Simulation> simulation)
+        : numSteps(1000)
+        , warmupSteps(10)
+        , stepTime(16.666666) // 60 fps, as in PhyssimWindow::exportVideo
+        , snapshotInterval(0)
+        , snapshotPrefix("snapshot")
+        , mSimulation(simulation)
+    {
+    }
+
+    HeadlessRunner::Report HeadlessRunner::run()
+    {
+        mSimulation->scene = std::make_shared<vislab::Scene>();
+        mSimulation->init();
+        mSimulation->restart();
+
+        std::vector<double> latencies;
+        latencies.reserve(numSteps);
+        for (int64_t timeStep = 0; timeStep < warmupSteps + numSteps; ++timeStep)
+        {
+            // the time only depends on the step count, which makes runs reproducible
+            auto start = std::chrono::steady_clock::now();
+            mSimulation->advance(stepTime, timeStep * stepTime, timeStep);
+            auto end = std::chrono::steady_clock::now();
+            if (timeStep >= warmupSteps)
+                latencies.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+            if (snapshotInterval > 0 && (timeStep + 1) % snapshotInterval == 0)
+                writeSnapshot(*mSimulation->scene, snapshotPrefix + "_" + std::to_string(timeStep + 1) + ".txt", timeStep + 1);
+        }
+
+        Report report = {};
+        report.numSteps = (int64_t)latencies.size();
+        if (latencies.empty())
+            return report;
+        for (double latency : latencies)
+            report.seconds += latency / 1000;
+        report.stepsPerSecond = report.numSteps / report.seconds;
+
+        // nearest-rank percentiles
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&latencies](double p)
+        { return latencies[std::max<size_t>((size_t)std::ceil(p * latencies.size()), 1) - 1]; };
+        report.p50 = percentile(0.5);
+        report.p90 = percentile(0.9);
+        report.p99 = percentile(0.99);
+        report.max = latencies.back();
+        return report;
+    }
+
+    bool HeadlessRunner::writeSnapshot(const vislab::Scene& scene, const std::string& path, int64_t timeStep)
+    {
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (!file)
+            return false;
+
+        std::fprintf(file, "timestep %lld\nshapes %zu\n", (long long)timeStep, scene.shapes.size());
+        for (size_t i = 0; i < scene.shapes.size(); ++i)
+        {
+            const Eigen::Matrix4d& matrix = scene.shapes[i]->transform.getMatrix();
+            std::fprintf(file, "shape %zu\n", i);
+            for (int r = 0; r < 3; ++r)
+                std::fprintf(file, "%.9g %.9g %.9g %.9g\n", matrix(r, 0), matrix(r, 1), matrix(r, 2), matrix(r, 3));
+
+            auto triangle = std::dynamic_pointer_cast<vislab::Triangle>(scene.shapes[i]);
+            if (triangle && triangle->mesh && triangle->mesh->positions)
+            {
+                const vislab::Array3f& positions = *triangle->mesh->positions;
+                std::fprintf(file, "vertices %lld\n", (long long)positions.getSize());
+                for (Eigen::Index v = 0; v < positions.getSize(); ++v)
+                {
+                    Eigen::Vector3f p = positions.getValue(v);
+                    std::fprintf(file, "%.9g %.9g %.9g\n", p.x(), p.y(), p.z());
+                }
+            }
+        }
+        return std::fclose(file) == 0;
+    }
+
+    int HeadlessRunner::main(int argc, char** argv)
+    {
+        std::vector<std::string> args(argv + 1, argv + argc);
+        auto printUsage = [&](std::ostream& stream)
+        {
+            stream << "usage: " << (argc > 0 ? argv[0] : "physsim_headless") << " <simulation> [--steps N] [--warmup N] [--dt milliseconds] [--snapshot prefix] [--every N]" << std::endl;
+            stream << "simulations:";
+            for (const std::string& name : SimulationRegistry::instance().names())
+                stream << " " << name;
+            stream << std::endl;
+        };
+        if (args.empty() || args[0] == "--list" || args[0] == "--help")
+        {
+            printUsage(args.empty() ? std::cerr : std::cout);
+            return args.empty() ? 1 : 0;
+        }
+
+        auto simulation = SimulationRegistry::instance().create(args[0]);
+        if (!simulation)
+        {
+            std::cerr << "unknown simulation: " << args[0] << std::endl;
+            return 1;
+        }
+
+        // numbers must be consumed entirely, such that typos like "--steps 10k" are not silently truncated
+        auto parseInteger = [](const std::string& value)
+        {
+            size_t length    = 0;
+            long long result = std::stoll(value, &length);
+            if (length != value.size())
+                throw std::invalid_argument(value);
+            return result;
+        };
+        auto parseReal = [](const std::string& value)
+        {
+            size_t length = 0;
+            double result = std::stod(value, &length);
+            if (length != value.size())
+                throw std::invalid_argument(value);
+            return result;
+        };
+
+        HeadlessRunner runner(simulation);
+        for (size_t i = 1; i < args.size(); i += 2)
+        {
+            const std::string& key = args[i];
+            if (i + 1 == args.size())
+            {
+                std::cerr << "missing value for option: " << key << std::endl;
+                printUsage(std::cerr);
+                return 1;
+            }
+
+            const std::string& value = args[i + 1];
+            try
+            {
+                if (key == "--steps")
+                    runner.numSteps = parseInteger(value);
+                else if (key == "--warmup")
+                    runner.warmupSteps = parseInteger(value);
+                else if (key == "--dt")
+                    runner.stepTime = parseReal(value);
+                else if (key == "--snapshot")
+                    runner.snapshotPrefix = value;
+                else if (key == "--every")
+                    runner.snapshotInterval = parseInteger(value);
+                else
+                {
+                    std::cerr << "unknown option: " << key << std::endl;
+                    printUsage(std::cerr);
+                    return 1;
+                }
+            }
+            catch (const std::invalid_argument&)
+            {
+                std::cerr << "invalid value for option " << key << ": " << value << std::endl;
+                printUsage(std::cerr);
+                return 1;
+            }
+            catch (const std::out_of_range&)
+            {
+                std::cerr << "value out of range for option " << key << ": " << value << std::endl;
+                printUsage(std::cerr);
+                return 1;
+            }
+        }
+
+        Report report = runner.run();
+        std::printf("%s: %lld steps in %.3f s, %.1f steps/s, latency [ms] p50 %.3f p90 %.3f p99 %.3f max %.3f\n",
+                    args[0].c_str(), (long long)report.numSteps, report.seconds, report.stepsPerSecond, report.p50, report.p90, report.p99, report.max);
+        return 0;
+    }
+}
@@ -170,6 +170,9 @@ namespace physsim
         for (int i = 0; i < resolution.prod(); ++i)
             image->setValue(i, Eigen::Vector3d::Ones());
 
+        // bring the acceleration tree up to date with the simulated geometry
+        mScene->updateAccelerationTree();
+
         // create a light transport integrator and render the image.
         auto integrator = std::make_unique<vislab::PathRadianceIntegrator>();
         integrator->setSamplesPerPixel(std::max(0, mSamplesPerPixel));
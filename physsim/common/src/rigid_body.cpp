@@ -1,116 +1,108 @@
 #include "rigid_body.hpp"
 
-#include <vislab/graphics/shape.hpp>
-#include <vislab/graphics/transform.hpp>
-#include <vislab/graphics/triangle.hpp>
-#include <vislab/graphics/mesh.hpp>
-#include <vislab/core/array.hpp>
+#include "rigid_body_world.hpp"
 
 namespace physsim
 {
     RigidBody::RigidBody()
-        : mPosition(Eigen::Vector3d::Zero())
-        , mRotation(Eigen::Quaterniond::Identity())
-        , mLinearVelocity(Eigen::Vector3d::Zero())
-        , mAngularVelocity(Eigen::Vector3d::Zero())
-        , mInertiaBody(Eigen::Matrix3d::Identity())
-        , mInertiaBodyInverse(Eigen::Matrix3d::Identity())
-        , mMass(1)
-        , mMassInverse(1)
-        , mForce(Eigen::Vector3d::Zero())
-        , mTorque(Eigen::Vector3d::Zero())
-        , mType(EType::Dynamic)
-        , mShape(nullptr)
-        , mScale(1)
+        : mWorld(std::make_shared<RigidBodyWorld>())
+        , mIndex(0)
     {
+        mIndex = mWorld->allocate();
     }
 
-    const Eigen::Vector3d& RigidBody::position() const { return mPosition; }
+    RigidBody::RigidBody(std::shared_ptr<RigidBodyWorld> world, size_t index)
+        : mWorld(world)
+        , mIndex(index)
+    {
+    }
+
+    const Eigen::Vector3d& RigidBody::position() const { return mWorld->mPositions[mIndex]; }
 
     void RigidBody::setPosition(const Eigen::Vector3d& x)
     {
-        mPosition = x;
-        updateTransform();
+        mWorld->mPositions[mIndex] = x;
+        mWorld->updateTransform(mIndex);
     }
 
-    const Eigen::Quaterniond& RigidBody::rotation() const { return mRotation; }
+    const Eigen::Quaterniond& RigidBody::rotation() const { return mWorld->mRotations[mIndex]; }
 
     void RigidBody::setRotation(const Eigen::Quaterniond& q)
     {
-        mRotation = q;
-        updateTransform();
+        mWorld->mRotations[mIndex] = q;
+        mWorld->updateTransform(mIndex);
     }
 
     Eigen::Vector3d RigidBody::linearMomentum() const
     {
-        return mMass * mLinearVelocity;
+        return mass() * linearVelocity();
     }
 
     Eigen::Vector3d RigidBody::angularMomentum() const
     {
-        return inertiaWorld() * mAngularVelocity;
+        return inertiaWorld() * angularVelocity();
     }
 
-    const Eigen::Matrix3d& RigidBody::inertiaBody() const { return mInertiaBody; }
+    const Eigen::Matrix3d& RigidBody::inertiaBody() const { return mWorld->mInertiaBody[mIndex]; }
 
     void RigidBody::setInertiaBody(const Eigen::Matrix3d& Ib)
     {
-        mInertiaBody        = Ib;
-        mInertiaBodyInverse = Ib.inverse();
+        mWorld->mInertiaBody[mIndex]        = Ib;
+        mWorld->mInertiaBodyInverse[mIndex] = Ib.inverse();
     }
 
-    const Eigen::Matrix3d& RigidBody::inertiaBodyInverse() const { return mInertiaBodyInverse; }
+    const Eigen::Matrix3d& RigidBody::inertiaBodyInverse() const { return mWorld->mInertiaBodyInverse[mIndex]; }
 
-    const double& RigidBody::mass() const { return mMass; }
+    const double& RigidBody::mass() const { return mWorld->mMasses[mIndex]; }
 
     void RigidBody::setMass(const double& m)
     {
-        mMass        = m;
-        mMassInverse = 1. / m;
+        mWorld->mMasses[mIndex]       = m;
+        mWorld->mMassInverses[mIndex] = 1. / m;
     }
 
-    const double& RigidBody::massInverse() const { return mMassInverse; }
+    const double& RigidBody::massInverse() const { return mWorld->mMassInverses[mIndex]; }
 
-    const Eigen::Vector3d& RigidBody::force() const { return mForce; }
+    const Eigen::Vector3d& RigidBody::force() const { return mWorld->mForces[mIndex]; }
 
-    const Eigen::Vector3d& RigidBody::torque() const { return mTorque; }
+    const Eigen::Vector3d& RigidBody::torque() const { return mWorld->mTorques[mIndex]; }
 
-    const RigidBody::EType& RigidBody::type() const { return mType; }
+    const RigidBody::EType& RigidBody::type() const { return mWorld->mTypes[mIndex]; }
 
-    void RigidBody::setType(const EType& type) { mType = type; }
+    void RigidBody::setType(const EType& type) { mWorld->mTypes[mIndex] = type; }
 
     Eigen::Matrix3d RigidBody::inertiaWorld() const
     {
-        return mRotation * mInertiaBody * mRotation.inverse();
+        return rotation() * inertiaBody() * rotation().inverse();
     }
 
     Eigen::Matrix3d RigidBody::inertiaWorldInverse() const
     {
-        return mRotation * mInertiaBodyInverse * mRotation.inverse();
+        return rotation() * inertiaBodyInverse() * rotation().inverse();
     }
 
     const Eigen::Vector3d& RigidBody::linearVelocity() const
     {
-        return mLinearVelocity;
+        return mWorld->mLinearVelocities[mIndex];
     }
 
     void RigidBody::setLinearVelocity(const Eigen::Vector3d& v)
     {
-        if (mType != EType::Dynamic)
+        if (type() != EType::Dynamic)
             return;
-        mLinearVelocity = v;
+        mWorld->mLinearVelocities[mIndex] = v;
     }
 
     const Eigen::Vector3d& RigidBody::angularVelocity() const
     {
-        return mAngularVelocity;
+        return mWorld->mAngularVelocities[mIndex];
     }
 
     void RigidBody::setAngularVelocity(const Eigen::Vector3d& w)
     {
-        if (mType != EType::Dynamic)
+        if (type() != EType::Dynamic)
             return;
-        mAngularVelocity = w;
+        mWorld->mAngularVelocities[mIndex] = w;
     }
 
     Eigen::Vector3d RigidBody::velocity(const Eigen::Vector3d& point) const
@@ -121,70 +113,86 @@ namespace physsim
 
     void RigidBody::applyForceToCenterOfMass(const Eigen::Vector3d& f)
     {
-        if (mType != EType::Dynamic)
+        if (type() != EType::Dynamic)
             return;
-        mForce += f;
+        mWorld->mForces[mIndex] += f;
     }
 
     void RigidBody::applyForce(const Eigen::Vector3d& f, const Eigen::Vector3d& p)
     {
-        if (mType != EType::Dynamic)
+        if (type() != EType::Dynamic)
             return;
-        mForce += f;
-        mTorque += (p - mPosition).cross(f);
+        mWorld->mForces[mIndex] += f;
+        mWorld->mTorques[mIndex] += (p - position()).cross(f);
     }
 
     void RigidBody::applyTorque(const Eigen::Vector3d& t)
     {
-        if (mType != EType::Dynamic)
+        if (type() != EType::Dynamic)
             return;
-        mTorque += t;
+        mWorld->mTorques[mIndex] += t;
     }
 
     void RigidBody::resetForce()
     {
-        if (mType != EType::Dynamic)
+        if (type() != EType::Dynamic)
             return;
-        mForce = Eigen::Vector3d::Zero();
+        mWorld->mForces[mIndex] = Eigen::Vector3d::Zero();
     }
 
     void RigidBody::resetTorque()
     {
-        if (mType != EType::Dynamic)
+        if (type() != EType::Dynamic)
             return;
-        mTorque = Eigen::Vector3d::Zero();
+        mWorld->mTorques[mIndex] = Eigen::Vector3d::Zero();
     }
 
     std::shared_ptr<const vislab::Shape> RigidBody::shape() const
     {
-        return mShape;
+        return mWorld->mShapes[mIndex];
     }
 
     void RigidBody::setShape(std::shared_ptr<vislab::Shape> shape)
     {
-        mShape = shape;
-        updateTransform();
+        mWorld->mShapes[mIndex] = shape;
+        mWorld->updateTransform(mIndex);
     }
 
     const double& RigidBody::scale() const
     {
-        return mScale;
+        return mWorld->mScales[mIndex];
     }
 
     void RigidBody::setScale(const double& scale)
     {
-        mScale = scale;
-        updateTransform();
+        mWorld->mScales[mIndex] = scale;
+        mWorld->updateTransform(mIndex);
+    }
+
+    bool RigidBody::isAwake() const
+    {
+        return mWorld->mAwake[mIndex] != 0;
     }
 
-    void RigidBody::updateTransform()
+    void RigidBody::setAwake(bool awake)
     {
-        if (mShape)
+        mWorld->mAwake[mIndex]     = awake;
+        mWorld->mRestTimes[mIndex] = 0;
+        if (!awake)
         {
-            Eigen::Matrix4d transform   = Eigen::Matrix4d::Identity();
-            transform.block(0, 0, 3, 3) = mRotation.toRotationMatrix();
-            transform.block(0, 3, 3, 1) = mPosition;
-            mShape->transform.setMatrix(transform * Eigen::Matrix4d::scale({ mScale, mScale, mScale }));
+            mWorld->mSleepIslands[mIndex]      = mIndex;
+            mWorld->mLinearVelocities[mIndex]  = Eigen::Vector3d::Zero();
+            mWorld->mAngularVelocities[mIndex] = Eigen::Vector3d::Zero();
         }
     }
+
+    RigidBodyWorld& RigidBody::world() const
+    {
+        return *mWorld;
+    }
+
+    size_t RigidBody::index() const
+    {
+        return mIndex;
+    }
 }
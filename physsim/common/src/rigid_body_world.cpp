@@ -0,0 +1,365 @@
+#include "rigid_body_world.hpp"
+
+#include <vislab/graphics/shape.hpp>
+#include <vislab/graphics/transform.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace physsim
+{
+    RigidBodyWorld::RigidBodyWorld()
+        : mSleepingEnabled(true)
+        , mSleepTime(0.5)
+        , mSleepLinearVelocity(0.05)
+        , mSleepAngularVelocity(0.05)
+        , mTolerance(1E-6)
+    {
+    }
+
+    std::shared_ptr<RigidBody> RigidBodyWorld::addBody()
+    {
+        // the views keep the world alive, which requires shared ownership of the world
+        std::shared_ptr<RigidBodyWorld> world = weak_from_this().lock();
+        if (!world)
+            throw std::logic_error("RigidBodyWorld::addBody() requires the world to be owned by a std::shared_ptr.");
+        size_t index = allocate();
+        return std::shared_ptr<RigidBody>(new RigidBody(world, index));
+    }
+
+    void RigidBodyWorld::reserve(size_t capacity)
+    {
+        mPositions.reserve(capacity);
+        mRotations.reserve(capacity);
+        mLinearVelocities.reserve(capacity);
+        mAngularVelocities.reserve(capacity);
+        mInertiaBody.reserve(capacity);
+        mInertiaBodyInverse.reserve(capacity);
+        mMasses.reserve(capacity);
+        mMassInverses.reserve(capacity);
+        mForces.reserve(capacity);
+        mTorques.reserve(capacity);
+        mTypes.reserve(capacity);
+        mShapes.reserve(capacity);
+        mScales.reserve(capacity);
+        mAwake.reserve(capacity);
+        mRestTimes.reserve(capacity);
+        mSleepIslands.reserve(capacity);
+        mOdeIntegrators.reserve(capacity);
+    }
+
+    size_t RigidBodyWorld::size() const
+    {
+        return mPositions.size();
+    }
+
+    void RigidBodyWorld::integrate(EIntegrator method, double stepSize)
+    {
+        int64_t numBodies = (int64_t)size();
+#ifndef _DEBUG
+#pragma omp parallel for
+#endif
+        for (int64_t i = 0; i < numBodies; ++i)
+        {
+            if (mTypes[i] == RigidBody::EType::Dynamic && mAwake[i])
+            {
+                step(method, stepSize, i);
+                updateRestTime(stepSize, i);
+            }
+        }
+
+        // shapes notify their listeners when the transformation changes, which is not thread-safe
+        for (size_t i = 0; i < size(); ++i)
+        {
+            if (mTypes[i] == RigidBody::EType::Dynamic && mAwake[i])
+                updateTransform(i);
+        }
+    }
+
+    void RigidBodyWorld::integrate(EIntegrator method, double stepSize, size_t index)
+    {
+        if (mTypes[index] != RigidBody::EType::Dynamic || !mAwake[index])
+            return;
+        step(method, stepSize, index);
+        updateRestTime(stepSize, index);
+        updateTransform(index);
+    }
+
+    void RigidBodyWorld::updateSleeping(const std::vector<std::pair<size_t, size_t>>& touching)
+    {
+        if (!mSleepingEnabled)
+            return;
+
+        // union-find over the contact graph. Static bodies do not connect islands.
+        std::vector<size_t> parent(size());
+        std::iota(parent.begin(), parent.end(), 0);
+        auto find = [&](size_t i)
+        {
+            while (parent[i] != i)
+            {
+                parent[i] = parent[parent[i]];
+                i         = parent[i];
+            }
+            return i;
+        };
+        for (const auto& pair : touching)
+        {
+            if (mTypes[pair.first] == RigidBody::EType::Dynamic && mTypes[pair.second] == RigidBody::EType::Dynamic)
+                parent[find(pair.first)] = find(pair.second);
+        }
+
+        // contacts between sleeping bodies are not detected, hence sleeping bodies stay connected to the island they fell asleep with
+        for (size_t i = 0; i < size(); ++i)
+        {
+            if (mTypes[i] == RigidBody::EType::Dynamic && !mAwake[i])
+                parent[find(i)] = find(mSleepIslands[i]);
+        }
+
+        // an island may sleep if all of its bodies rested long enough, and it is active if any of its bodies is awake
+        std::vector<uint8_t> restful(size(), 1);
+        std::vector<uint8_t> active(size(), 0);
+        for (size_t i = 0; i < size(); ++i)
+        {
+            if (mTypes[i] != RigidBody::EType::Dynamic)
+                continue;
+            size_t root = find(i);
+            if (mRestTimes[i] < mSleepTime)
+                restful[root] = 0;
+            if (mAwake[i])
+                active[root] = 1;
+        }
+
+        for (size_t i = 0; i < size(); ++i)
+        {
+            if (mTypes[i] != RigidBody::EType::Dynamic)
+                continue;
+            size_t root = find(i);
+            if (!active[root])
+                continue;
+            if (restful[root])
+            {
+                mAwake[i]             = 0;
+                mSleepIslands[i]      = root;
+                mLinearVelocities[i]  = Eigen::Vector3d::Zero();
+                mAngularVelocities[i] = Eigen::Vector3d::Zero();
+            }
+            else
+            {
+                mAwake[i] = 1;
+            }
+        }
+    }
+
+    void RigidBodyWorld::wakeAll()
+    {
+        std::fill(mAwake.begin(), mAwake.end(), 1);
+        std::fill(mRestTimes.begin(), mRestTimes.end(), 0.);
+    }
+
+    size_t RigidBodyWorld::numAwake() const
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < size(); ++i)
+        {
+            if (mTypes[i] == RigidBody::EType::Dynamic && mAwake[i])
+                count++;
+        }
+        return count;
+    }
+
+    bool RigidBodyWorld::isSleepingEnabled() const { return mSleepingEnabled; }
+
+    void RigidBodyWorld::setSleepingEnabled(bool enabled)
+    {
+        mSleepingEnabled = enabled;
+        if (!enabled)
+            wakeAll();
+    }
+
+    double RigidBodyWorld::sleepTime() const { return mSleepTime; }
+
+    void RigidBodyWorld::setSleepTime(double time) { mSleepTime = time; }
+
+    double RigidBodyWorld::sleepLinearVelocity() const { return mSleepLinearVelocity; }
+
+    void RigidBodyWorld::setSleepLinearVelocity(double velocity) { mSleepLinearVelocity = velocity; }
+
+    double RigidBodyWorld::sleepAngularVelocity() const { return mSleepAngularVelocity; }
+
+    void RigidBodyWorld::setSleepAngularVelocity(double velocity) { mSleepAngularVelocity = velocity; }
+
+    double RigidBodyWorld::tolerance() const { return mTolerance; }
+
+    void RigidBodyWorld::setTolerance(double tolerance) { mTolerance = tolerance; }
+
+    const std::vector<Eigen::Vector3d>& RigidBodyWorld::positions() const { return mPositions; }
+
+    const std::vector<Eigen::Quaterniond>& RigidBodyWorld::rotations() const { return mRotations; }
+
+    const std::vector<Eigen::Vector3d>& RigidBodyWorld::linearVelocities() const { return mLinearVelocities; }
+
+    const std::vector<Eigen::Vector3d>& RigidBodyWorld::angularVelocities() const { return mAngularVelocities; }
+
+    size_t RigidBodyWorld::allocate()
+    {
+        mPositions.push_back(Eigen::Vector3d::Zero());
+        mRotations.push_back(Eigen::Quaterniond::Identity());
+        mLinearVelocities.push_back(Eigen::Vector3d::Zero());
+        mAngularVelocities.push_back(Eigen::Vector3d::Zero());
+        mInertiaBody.push_back(Eigen::Matrix3d::Identity());
+        mInertiaBodyInverse.push_back(Eigen::Matrix3d::Identity());
+        mMasses.push_back(1);
+        mMassInverses.push_back(1);
+        mForces.push_back(Eigen::Vector3d::Zero());
+        mTorques.push_back(Eigen::Vector3d::Zero());
+        mTypes.push_back(RigidBody::EType::Dynamic);
+        mShapes.push_back(nullptr);
+        mScales.push_back(1);
+        mAwake.push_back(1);
+        mRestTimes.push_back(0);
+        mSleepIslands.push_back(mPositions.size() - 1);
+        mOdeIntegrators.emplace_back();
+        mOdeIntegrators.back().setPositionSize(7);
+        return mPositions.size() - 1;
+    }
+
+    void RigidBodyWorld::updateRestTime(double stepSize, size_t index)
+    {
+        if (mLinearVelocities[index].squaredNorm() < mSleepLinearVelocity * mSleepLinearVelocity &&
+            mAngularVelocities[index].squaredNorm() < mSleepAngularVelocity * mSleepAngularVelocity)
+            mRestTimes[index] += stepSize;
+        else
+            mRestTimes[index] = 0;
+    }
+
+    void RigidBodyWorld::step(EIntegrator method, double stepSize, size_t i)
+    {
+        Eigen::Vector3d& x         = mPositions[i];
+        Eigen::Quaterniond& q      = mRotations[i];
+        Eigen::Vector3d& v         = mLinearVelocities[i];
+        Eigen::Vector3d& w         = mAngularVelocities[i];
+        const Eigen::Matrix3d& Ib  = mInertiaBody[i];
+        const Eigen::Matrix3d& Ibi = mInertiaBodyInverse[i];
+        const Eigen::Vector3d& f   = mForces[i];
+        const Eigen::Vector3d& t   = mTorques[i];
+
+        // the world-space inertia R * Ib * R^T is never formed, it is applied as three matrix-vector products instead
+        switch (method)
+        {
+        case EIntegrator::ExplicitEuler:
+        {
+            // update position and rotation with the old velocities
+            x += stepSize * v;
+            Eigen::Quaterniond wq(0, w.x(), w.y(), w.z());
+            q = (q + 0.5 * stepSize * wq * q).normalized();
+
+            // update the velocities with the momenta evaluated at the new rotation
+            Eigen::Matrix3d R  = q.toRotationMatrix();
+            Eigen::Vector3d Iw = R * (Ib * (R.transpose() * w));
+            v += stepSize * mMassInverses[i] * f;
+            w += stepSize * (R * (Ibi * (R.transpose() * (t - w.cross(Iw)))));
+            break;
+        }
+        case EIntegrator::SymplecticEuler:
+        {
+            // update the velocities first
+            Eigen::Matrix3d R  = q.toRotationMatrix();
+            Eigen::Vector3d Iw = R * (Ib * (R.transpose() * w));
+            v += stepSize * mMassInverses[i] * f;
+            w += stepSize * (R * (Ibi * (R.transpose() * (t - w.cross(Iw)))));
+
+            // update position and rotation with the new velocities
+            x += stepSize * v;
+            Eigen::Quaterniond wq(0, w.x(), w.y(), w.z());
+            q = (q + 0.5 * stepSize * wq * q).normalized();
+            break;
+        }
+        case EIntegrator::ImplicitEuler:
+        {
+            v += stepSize * mMassInverses[i] * f;
+
+            // one Newton-Raphson step on the gyroscopic term in body coordinates
+            Eigen::Matrix3d R        = q.toRotationMatrix();
+            Eigen::Vector3d wb0      = R.transpose() * w;
+            Eigen::Vector3d f_wb0    = stepSize * wb0.cross(Ib * wb0);
+            Eigen::Matrix3d J        = Ib + stepSize * ((skew(wb0) * Ib) - skew(Ib * wb0));
+            Eigen::Vector3d delta_wb = J.inverse() * -f_wb0;
+
+            // transform back to world coordinates and explicitly integrate the torque
+            w = R * (wb0 + delta_wb) + stepSize * (R * (Ibi * (R.transpose() * t)));
+
+            x += stepSize * v;
+            Eigen::Quaterniond wq(0, w.x(), w.y(), w.z());
+            q = (q + 0.5 * stepSize * wq * q).normalized();
+            break;
+        }
+        case EIntegrator::RungeKutta4:
+        {
+            stepOde(EOdeMethod::RungeKutta4, stepSize, i);
+            break;
+        }
+        case EIntegrator::DormandPrince45:
+        {
+            stepOde(EOdeMethod::DormandPrince45, stepSize, i);
+            break;
+        }
+        }
+    }
+
+    void RigidBodyWorld::stepOde(EOdeMethod method, double stepSize, size_t i)
+    {
+        // state y = (x, q, v, w) with the quaternion stored as (w, x, y, z)
+        using State                = OdeState;
+        const Eigen::Matrix3d& Ib  = mInertiaBody[i];
+        const Eigen::Matrix3d& Ibi = mInertiaBodyInverse[i];
+        const Eigen::Vector3d a    = mMassInverses[i] * mForces[i];
+        const Eigen::Vector3d& t   = mTorques[i];
+        auto rhs                   = [&](double, const State& y)
+        {
+            Eigen::Quaterniond q(y[3], y[4], y[5], y[6]);
+            q.normalize();
+            Eigen::Vector3d w = y.tail<3>();
+            Eigen::Matrix3d R = q.toRotationMatrix();
+            Eigen::Quaterniond dq(0, w.x(), w.y(), w.z());
+            dq = 0.5 * dq * q;
+
+            State dy;
+            dy.head<3>()     = y.segment<3>(7);
+            dy.segment<4>(3) = Eigen::Vector4d(dq.w(), dq.x(), dq.y(), dq.z());
+            dy.segment<3>(7) = a;
+            dy.tail<3>()     = R * (Ibi * (R.transpose() * (t - w.cross(R * (Ib * (R.transpose() * w))))));
+            return dy;
+        };
+
+        Eigen::Quaterniond& q = mRotations[i];
+        State y;
+        y << mPositions[i], q.w(), q.x(), q.y(), q.z(), mLinearVelocities[i], mAngularVelocities[i];
+
+        OdeIntegrator<State>& integrator = mOdeIntegrators[i];
+        integrator.setMethod(method);
+        integrator.setTolerance(mTolerance);
+        if (integrator.stepSize() != stepSize)
+            integrator.setStepSize(stepSize);
+        double time = 0;
+        integrator.integrate(rhs, time, y, stepSize);
+
+        mPositions[i]         = y.head<3>();
+        q                     = Eigen::Quaterniond(y[3], y[4], y[5], y[6]).normalized();
+        mLinearVelocities[i]  = y.segment<3>(7);
+        mAngularVelocities[i] = y.tail<3>();
+    }
+
+    void RigidBodyWorld::updateTransform(size_t index)
+    {
+        const std::shared_ptr<vislab::Shape>& shape = mShapes[index];
+        if (shape)
+        {
+            double scale                = mScales[index];
+            Eigen::Matrix4d transform   = Eigen::Matrix4d::Identity();
+            transform.block(0, 0, 3, 3) = mRotations[index].toRotationMatrix();
+            transform.block(0, 3, 3, 1) = mPositions[index];
+            shape->transform.setMatrix(transform * Eigen::Matrix4d::scale({ scale, scale, scale }));
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#include "simulation_registry.hpp"
+
+#include "simulation.hpp"
+
+namespace physsim
+{
+    SimulationRegistry& SimulationRegistry::instance()
+    {
+        // constructed on first use, since registrations run during static initialization of other translation units
+        static SimulationRegistry registry;
+        return registry;
+    }
+
+    void SimulationRegistry::add(const std::string& name, Factory factory)
+    {
+        mFactories[name] = std::move(factory);
+    }
+
+    std::shared_ptr<Simulation> SimulationRegistry::create(const std::string& name) const
+    {
+        auto it = mFactories.find(name);
+        if (it == mFactories.end())
+            return nullptr;
+        return it->second();
+    }
+
+    std::vector<std::string> SimulationRegistry::names() const
+    {
+        std::vector<std::string> result;
+        for (const auto& entry : mFactories)
+            result.push_back(entry.first);
+        return result;
+    }
+}
@@ -0,0 +1,6 @@
+#include "headless_runner.hpp"
+
+int main(int argc, char** argv)
+{
+    return physsim::HeadlessRunner::main(argc, argv);
+}
@@ -0,0 +1,50 @@
+#include <vislab/core/array.hpp>
+
+#include <Eigen/Eigen>
+#include <benchmark/benchmark.h>
+
+namespace vislab
+{
+    static void array_getValue(benchmark::State& state)
+    {
+        Array3f array;
+        array.setSize(state.range(0));
+        array.setZero();
+        for (auto _ : state)
+        {
+            Eigen::Vector3f sum = Eigen::Vector3f::Zero();
+            for (Eigen::Index i = 0; i < array.getSize(); ++i)
+                sum += array.getValue(i);
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(array_getValue)->ArgName("size")->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+    static void array_setValue(benchmark::State& state)
+    {
+        Array3f array;
+        array.setSize(state.range(0));
+        for (auto _ : state)
+        {
+            for (Eigen::Index i = 0; i < array.getSize(); ++i)
+                array.setValue(i, Eigen::Vector3f(i, i, i));
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(array_setValue)->ArgName("size")->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+    static void array_append(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            Array3f array;
+            for (int64_t i = 0; i < state.range(0); ++i)
+                array.append(Eigen::Vector3f(i, i, i));
+            benchmark::DoNotOptimize(array.getSize());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(array_append)->ArgName("size")->RangeMultiplier(8)->Range(1 << 8, 1 << 14);
+}
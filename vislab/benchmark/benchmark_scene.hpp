@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vislab/core/array.hpp>
+#include <vislab/graphics/mesh.hpp>
+#include <vislab/graphics/ray.hpp>
+
+#include <Eigen/Eigen>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace vislab
+{
+    /**
+     * @brief Creates a unit sphere as a latitude-longitude triangle mesh.
+     * @param resolution Number of latitude bands. The mesh has 2*resolution*resolution triangles.
+     * @return Sphere mesh.
+     */
+    inline std::shared_ptr<Mesh> createSphereMesh(int resolution)
+    {
+        int numTheta = resolution;
+        int numPhi   = 2 * resolution;
+        auto mesh    = std::make_shared<Mesh>();
+        mesh->positions = std::make_shared<Array3f>();
+        mesh->indices   = std::make_shared<Array3ui>();
+        mesh->positions->setSize((numTheta + 1) * (numPhi + 1));
+        mesh->indices->setSize(2 * numTheta * numPhi);
+        for (int i = 0; i <= numTheta; ++i)
+            for (int j = 0; j <= numPhi; ++j)
+            {
+                double theta = EIGEN_PI * i / numTheta;
+                double phi   = 2 * EIGEN_PI * j / numPhi;
+                mesh->positions->setValue(i * (numPhi + 1) + j, Eigen::Vector3f(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)));
+            }
+        Eigen::Index face = 0;
+        for (int i = 0; i < numTheta; ++i)
+            for (int j = 0; j < numPhi; ++j)
+            {
+                uint32_t v00 = i * (numPhi + 1) + j;
+                uint32_t v01 = v00 + 1;
+                uint32_t v10 = v00 + numPhi + 1;
+                uint32_t v11 = v10 + 1;
+                mesh->indices->setValue(face++, Eigen::Vector3u(v00, v10, v11));
+                mesh->indices->setValue(face++, Eigen::Vector3u(v00, v11, v01));
+            }
+        return mesh;
+    }
+
+    /**
+     * @brief Creates reproducible rays that start on a sphere of radius 3 and point to random locations in [-1,1]^3, such that most of them hit the unit sphere.
+     * @param count Number of rays.
+     * @param seed Seed of the random number generator.
+     * @return Rays.
+     */
+    inline std::vector<Ray3d> createRays(int count, uint32_t seed = 0)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        std::vector<Ray3d> rays(count);
+        for (Ray3d& ray : rays)
+        {
+            Eigen::Vector3d origin = Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)).normalized() * 3;
+            Eigen::Vector3d target(uniform(rng), uniform(rng), uniform(rng));
+            ray = Ray3d(origin, (target - origin).normalized());
+        }
+        return rays;
+    }
+}
@@ -0,0 +1,24 @@
+#include <vislab/graphics/bmp_writer.hpp>
+#include <vislab/graphics/image.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace vislab
+{
+    static void bmpWriter_update(benchmark::State& state)
+    {
+        auto image = std::make_shared<Image3d>();
+        image->setResolution(state.range(0), state.range(0));
+        for (int x = 0; x < state.range(0); ++x)
+            for (int y = 0; y < state.range(0); ++y)
+                image->setValue(x, y, Eigen::Vector3d(x, y, x + y) / (2. * state.range(0)));
+
+        BmpWriter writer;
+        writer.paramPath.setValue("benchmark.bmp");
+        writer.inputImage.setData(image);
+        for (auto _ : state)
+            writer.update();
+        state.SetBytesProcessed(state.iterations() * state.range(0) * state.range(0) * 3);
+    }
+    BENCHMARK(bmpWriter_update)->ArgName("resolution")->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMillisecond);
+}
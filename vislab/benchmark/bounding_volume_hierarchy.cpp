@@ -0,0 +1,144 @@
+#include "benchmark_scene.hpp"
+
+#include <vislab/graphics/mesh.hpp>
+#include <vislab/graphics/scene.hpp>
+#include <vislab/graphics/triangle.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace vislab
+{
+    static void boundingVolumeHierarchy_build(benchmark::State& state)
+    {
+        auto mesh = createSphereMesh(state.range(0));
+        for (auto _ : state)
+            mesh->buildAccelerationTree();
+        state.counters["triangles"] = (double)mesh->indices->getSize();
+        state.SetItemsProcessed(state.iterations() * mesh->indices->getSize());
+    }
+    BENCHMARK(boundingVolumeHierarchy_build)->ArgName("resolution")->RangeMultiplier(4)->Range(16, 256)->Unit(benchmark::kMillisecond);
+
+    static void boundingVolumeHierarchy_refit(benchmark::State& state)
+    {
+        auto mesh = createSphereMesh(state.range(0));
+        mesh->buildAccelerationTree();
+        for (auto _ : state)
+            mesh->updateAccelerationTree();
+        state.counters["triangles"] = (double)mesh->indices->getSize();
+        state.SetItemsProcessed(state.iterations() * mesh->indices->getSize());
+    }
+    BENCHMARK(boundingVolumeHierarchy_refit)->ArgName("resolution")->RangeMultiplier(4)->Range(16, 256)->Unit(benchmark::kMillisecond);
+
+    static void preliminaryHit(benchmark::State& state, EAccelerationTreeType type, bool packTriangles)
+    {
+        auto mesh                  = createSphereMesh(state.range(0));
+        mesh->accelerationTreeType = type;
+        mesh->packTriangles        = packTriangles;
+        mesh->buildAccelerationTree();
+        auto rays = createRays(1024);
+        for (auto _ : state)
+        {
+            int hits = 0;
+            for (const Ray3d& ray : rays)
+                hits += mesh->preliminaryHit(ray).isValid();
+            benchmark::DoNotOptimize(hits);
+        }
+        state.counters["triangles"] = (double)mesh->indices->getSize();
+        state.SetItemsProcessed(state.iterations() * rays.size());
+    }
+
+    static void boundingVolumeHierarchy_preliminaryHit(benchmark::State& state)
+    {
+        preliminaryHit(state, EAccelerationTreeType::Binary, false);
+    }
+    BENCHMARK(boundingVolumeHierarchy_preliminaryHit)->ArgName("resolution")->RangeMultiplier(4)->Range(16, 256);
+
+    static void wideBoundingVolumeHierarchy_preliminaryHit(benchmark::State& state)
+    {
+        preliminaryHit(state, EAccelerationTreeType::Wide, false);
+    }
+    BENCHMARK(wideBoundingVolumeHierarchy_preliminaryHit)->ArgName("resolution")->RangeMultiplier(4)->Range(16, 256);
+
+    static void packedTriangles_preliminaryHit(benchmark::State& state)
+    {
+        preliminaryHit(state, EAccelerationTreeType::Wide, true);
+    }
+    BENCHMARK(packedTriangles_preliminaryHit)->ArgName("resolution")->RangeMultiplier(4)->Range(16, 256);
+
+    static void sceneAccelerationTree_build(benchmark::State& state)
+    {
+        // instances of one mesh in a grid, as in scenes with many rigid bodies
+        auto mesh = createSphereMesh(32);
+        Scene scene;
+        int size = (int)std::ceil(std::cbrt((double)state.range(0)));
+        for (int i = 0; i < state.range(0); ++i)
+        {
+            auto shape  = std::make_shared<Triangle>();
+            shape->mesh = mesh;
+            shape->transform.setMatrix(Eigen::Affine3d(Eigen::Translation3d(i % size, (i / size) % size, i / (size * size)) * Eigen::Scaling(0.4)).matrix());
+            scene.shapes.push_back(shape);
+        }
+        mesh->buildAccelerationTree();
+        for (auto _ : state)
+            scene.buildAccelerationTree();
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(sceneAccelerationTree_build)->ArgName("instances")->RangeMultiplier(10)->Range(10, 1000)->Unit(benchmark::kMillisecond);
+
+    static void sceneIntersect(benchmark::State& state, bool packets)
+    {
+        // grid of instances seen from a pinhole, whose primary rays are traced in tiles of 8x8
+        auto mesh = createSphereMesh(16);
+        Scene scene;
+        int size = (int)std::ceil(std::cbrt((double)state.range(0)));
+        for (int i = 0; i < state.range(0); ++i)
+        {
+            auto shape  = std::make_shared<Triangle>();
+            shape->mesh = mesh;
+            shape->transform.setMatrix(Eigen::Affine3d(Eigen::Translation3d(i % size, (i / size) % size, i / (size * size)) * Eigen::Scaling(0.4)).matrix());
+            scene.shapes.push_back(shape);
+        }
+        scene.buildAccelerationTree();
+
+        const int resolution = 128, tileSize = 8;
+        Eigen::Vector3d eye(-2 * size, 0.5 * size, 0.5 * size);
+        std::vector<Ray3d> rays;
+        for (int ty = 0; ty < resolution; ty += tileSize)
+            for (int tx = 0; tx < resolution; tx += tileSize)
+                for (int y = ty; y < ty + tileSize; ++y)
+                    for (int x = tx; x < tx + tileSize; ++x)
+                    {
+                        Eigen::Vector3d target(0, (x + 0.5) / resolution * size, (y + 0.5) / resolution * size);
+                        rays.push_back(Ray3d(eye, (target - eye).normalized(), 0, 10 * size));
+                    }
+
+        std::vector<SurfaceInteraction> si(rays.size());
+        for (auto _ : state)
+        {
+            if (packets)
+            {
+                for (size_t i = 0; i < rays.size(); i += tileSize * tileSize)
+                    scene.intersect(rays.data() + i, tileSize * tileSize, si.data() + i);
+            }
+            else
+            {
+                for (size_t i = 0; i < rays.size(); ++i)
+                    si[i] = scene.intersect(rays[i]);
+            }
+            benchmark::DoNotOptimize(si.data());
+        }
+        state.SetItemsProcessed(state.iterations() * rays.size());
+    }
+
+    static void scene_intersect(benchmark::State& state)
+    {
+        sceneIntersect(state, false);
+    }
+    BENCHMARK(scene_intersect)->ArgName("instances")->RangeMultiplier(10)->Range(10, 1000)->Unit(benchmark::kMillisecond);
+
+    static void scene_intersectPackets(benchmark::State& state)
+    {
+        sceneIntersect(state, true);
+    }
+    BENCHMARK(scene_intersectPackets)->ArgName("instances")->RangeMultiplier(10)->Range(10, 1000)->Unit(benchmark::kMillisecond);
+}
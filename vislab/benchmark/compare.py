@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Compares two Google Benchmark JSON files and fails if a benchmark got slower than the threshold.
+
+Usage:
+    vislab_benchmarks --benchmark_out=current.json --benchmark_out_format=json
+    python3 compare.py baseline.json current.json [--threshold 0.15] [--metric cpu_time]
+
+To refresh the baseline, copy a run on a quiet machine over baseline.json.
+"""
+
+import argparse
+import json
+import sys
+
+# conversion of the Google Benchmark time units to nanoseconds
+TIME_UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    """Reads the per-benchmark time in nanoseconds. If repetitions were run, the mean aggregate is used."""
+    with open(path) as file:
+        data = json.load(file)
+    times = {}
+    for benchmark in data["benchmarks"]:
+        if benchmark.get("run_type") == "aggregate" and benchmark.get("aggregate_name") != "mean":
+            continue
+        name = benchmark.get("run_name", benchmark["name"])
+        if benchmark.get("run_type") == "iteration" and name in times:
+            continue
+        times[name] = benchmark[metric] * TIME_UNITS[benchmark.get("time_unit", "ns")]
+    return times
+
+
+def format_time(nanoseconds):
+    for unit in ["s", "ms", "us"]:
+        if nanoseconds >= TIME_UNITS[unit]:
+            return "%.3f %s" % (nanoseconds / TIME_UNITS[unit], unit)
+    return "%.1f ns" % nanoseconds
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline", help="JSON output of the reference run")
+    parser.add_argument("current", help="JSON output of the run to check")
+    parser.add_argument("--threshold", type=float, default=0.15, help="relative slowdown that counts as a regression (default: 0.15)")
+    parser.add_argument("--metric", choices=["cpu_time", "real_time"], default="cpu_time", help="time to compare (default: cpu_time)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline, args.metric)
+    current = load(args.current, args.metric)
+
+    regressions = []
+    width = max([len(name) for name in list(baseline) + list(current)] + [9])
+    print("%-*s %12s %12s %8s" % (width, "benchmark", "baseline", "current", "change"))
+    for name, time in current.items():
+        if name not in baseline:
+            print("%-*s %12s %12s %8s" % (width, name, "-", format_time(time), "new"))
+            continue
+        change = time / baseline[name] - 1
+        flag = ""
+        if change > args.threshold:
+            regressions.append(name)
+            flag = "  REGRESSION"
+        print("%-*s %12s %12s %+7.1f%%%s" % (width, name, format_time(baseline[name]), format_time(time), 100 * change, flag))
+    for name in baseline:
+        if name not in current:
+            print("%-*s %12s %12s %8s" % (width, name, format_time(baseline[name]), "-", "missing"))
+
+    if regressions:
+        print("\n%d benchmark(s) slower than the baseline by more than %.0f%%" % (len(regressions), 100 * args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
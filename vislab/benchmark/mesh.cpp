@@ -0,0 +1,25 @@
+#include "benchmark_scene.hpp"
+
+#include <vislab/graphics/mesh.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace vislab
+{
+    static void mesh_rayTriangleIntersection(benchmark::State& state)
+    {
+        // brute force over all faces, which isolates the intersection kernel from the traversal
+        auto mesh = createSphereMesh(state.range(0));
+        auto rays = createRays(64);
+        for (auto _ : state)
+        {
+            int hits = 0;
+            for (const Ray3d& ray : rays)
+                for (uint32_t face = 0; face < (uint32_t)mesh->indices->getSize(); ++face)
+                    hits += mesh->rayTriangleIntersection(face, ray).isValid();
+            benchmark::DoNotOptimize(hits);
+        }
+        state.SetItemsProcessed(state.iterations() * rays.size() * mesh->indices->getSize());
+    }
+    BENCHMARK(mesh_rayTriangleIntersection)->ArgName("resolution")->RangeMultiplier(4)->Range(4, 64);
+}
@@ -0,0 +1,64 @@
+#include <vislab/graphics/area_light.hpp>
+#include <vislab/graphics/const_texture.hpp>
+#include <vislab/graphics/diffuse_bsdf.hpp>
+#include <vislab/graphics/image.hpp>
+#include <vislab/graphics/path_radiance_integrator.hpp>
+#include <vislab/graphics/perspective_camera.hpp>
+#include <vislab/graphics/rectangle.hpp>
+#include <vislab/graphics/scene.hpp>
+#include <vislab/graphics/sphere.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace vislab
+{
+    static void pathRadianceIntegrator_render(benchmark::State& state)
+    {
+        // floor and sphere below an area light, seen such that the upper half of the image is empty and cheap
+        const int resolution = 128;
+        Scene scene;
+        auto camera = std::make_shared<PerspectiveCamera>();
+        camera->setLookAt(Eigen::Vector3d(1, 0, -1));
+        camera->setPosition(Eigen::Vector3d(-3.5, 0, 0));
+        camera->setUp(Eigen::Vector3d(0, 0, 1));
+        camera->setNear(0.01);
+        camera->setFar(10);
+        camera->setWidth(resolution);
+        camera->setHeight(resolution);
+        scene.camera = camera;
+
+        auto lightShape           = std::make_shared<Rectangle>();
+        lightShape->bsdf          = std::make_shared<DiffuseBSDF>(std::make_shared<ConstTexture>(Spectrum(0, 0, 0)));
+        Eigen::Matrix4d transform = Eigen::Matrix4d::scale(Eigen::Vector3d(0.3, 0.3, 0.3));
+        transform.block(0, 0, 3, 3) *= Eigen::Quaterniond(Eigen::AngleAxisd(EIGEN_PI, Eigen::Vector3d(1, 0, 0))).toRotationMatrix();
+        transform.block(0, 3, 3, 1) = Eigen::Vector3d(0, 0, 1);
+        lightShape->transform.setMatrix(transform);
+        scene.shapes.push_back(lightShape);
+        auto light        = std::make_shared<AreaLight>();
+        light->radiance   = Eigen::Vector3d(1, 1, 1) * 10;
+        light->shape      = lightShape;
+        lightShape->light = light;
+        scene.lights.push_back(light);
+
+        auto floor  = std::make_shared<Rectangle>();
+        floor->bsdf = std::make_shared<DiffuseBSDF>(std::make_shared<ConstTexture>(Spectrum(1, 1, 1)));
+        floor->transform.setMatrix(Eigen::Matrix4d::translate(Eigen::Vector3d(0, 0, -1)) * Eigen::Matrix4d::scale(Eigen::Vector3d(3, 3, 3)));
+        scene.shapes.push_back(floor);
+        auto sphere  = std::make_shared<Sphere>();
+        sphere->bsdf = std::make_shared<DiffuseBSDF>(std::make_shared<ConstTexture>(Spectrum(0.3, 1, 0.3)));
+        sphere->transform.setMatrix(Eigen::Matrix4d::translate(Eigen::Vector3d(0, 0, -0.6)) * Eigen::Matrix4d::scale(Eigen::Vector3d(0.4, 0.4, 0.4)));
+        scene.shapes.push_back(sphere);
+        scene.buildAccelerationTree();
+
+        Image3d image;
+        image.setResolution(resolution, resolution);
+        PathRadianceIntegrator integrator;
+        integrator.maxDepth      = 3;
+        integrator.packetTracing = state.range(0) != 0;
+        integrator.setSamplesPerPixel(4);
+        for (auto _ : state)
+            integrator.render(&scene, &image);
+        state.SetItemsProcessed(state.iterations() * resolution * resolution * integrator.getSamplesPerPixel());
+    }
+    BENCHMARK(pathRadianceIntegrator_render)->ArgName("packets")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+}
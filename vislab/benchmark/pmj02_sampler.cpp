@@ -0,0 +1,21 @@
+#include <vislab/graphics/pmj02_sampler.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace vislab
+{
+    static void pmj02Sampler_next_2d(benchmark::State& state)
+    {
+        PMJ02Sampler sampler;
+        sampler.seed(0);
+        for (auto _ : state)
+        {
+            Eigen::Vector2d sum = Eigen::Vector2d::Zero();
+            for (int64_t i = 0; i < state.range(0); ++i)
+                sum += sampler.next_2d();
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(pmj02Sampler_next_2d)->ArgName("samples")->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+}
@@ -0,0 +1,85 @@
+#include <vislab/core/array.hpp>
+#include <vislab/field/regular_field.hpp>
+
+#include <Eigen/Eigen>
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+namespace vislab
+{
+    /**
+     * @brief Number of sample locations per benchmark iteration.
+     */
+    static const int numSamples = 1024;
+
+    /**
+     * @brief Creates a smooth scalar field on [0,1]^2.
+     * @param resolution Number of grid points per axis.
+     * @param accuracy Accuracy of the Newton interpolation.
+     * @return Scalar field.
+     */
+    static std::shared_ptr<RegularSteadyScalarField2d> createField(int resolution, int accuracy)
+    {
+        auto grid = std::make_shared<RegularGrid2d>();
+        grid->setResolution(Eigen::Vector2i(resolution, resolution));
+        grid->setDomain(Eigen::AlignedBox2d(Eigen::Vector2d(0, 0), Eigen::Vector2d(1, 1)));
+
+        auto field = std::make_shared<RegularSteadyScalarField2d>();
+        field->setGrid(grid);
+        field->setArray(std::make_shared<Array1d>());
+        field->getArray()->setSize(grid->getNumGridPoints());
+        field->setAccuracy(accuracy);
+        for (Eigen::Index i = 0; i < grid->getNumGridPoints(); ++i)
+        {
+            Eigen::Vector2d coord = grid->getCoordAt(i);
+            field->getArray()->setValue(i, std::sin(10 * coord.x()) * std::cos(7 * coord.y()));
+        }
+        return field;
+    }
+
+    /**
+     * @brief Creates reproducible sample locations in [0,1]^2.
+     * @return Sample locations.
+     */
+    static std::vector<Eigen::Vector2d> createSampleLocations()
+    {
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> uniform(0, 1);
+        std::vector<Eigen::Vector2d> locations(numSamples);
+        for (Eigen::Vector2d& location : locations)
+            location = Eigen::Vector2d(uniform(rng), uniform(rng));
+        return locations;
+    }
+
+    static void regularField_sample(benchmark::State& state)
+    {
+        auto field     = createField(state.range(0), state.range(1));
+        auto locations = createSampleLocations();
+        for (auto _ : state)
+        {
+            double sum = 0;
+            for (const Eigen::Vector2d& location : locations)
+                sum += field->sample(location).x();
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * numSamples);
+    }
+    BENCHMARK(regularField_sample)->ArgNames({ "resolution", "accuracy" })->ArgsProduct({ { 64, 512 }, { 2, 4 } });
+
+    static void regularField_sampleGradient(benchmark::State& state)
+    {
+        auto field     = createField(state.range(0), state.range(1));
+        auto locations = createSampleLocations();
+        for (auto _ : state)
+        {
+            Eigen::Vector2d sum = Eigen::Vector2d::Zero();
+            for (const Eigen::Vector2d& location : locations)
+                sum += field->sampleGradient(location);
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * numSamples);
+    }
+    BENCHMARK(regularField_sampleGradient)->ArgNames({ "resolution", "accuracy" })->ArgsProduct({ { 64, 512 }, { 2, 4 } });
+}
@@ -0,0 +1,38 @@
+#include "benchmark_scene.hpp"
+
+#include <vislab/graphics/sphere.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace vislab
+{
+    static void sphere_preliminaryHit(benchmark::State& state)
+    {
+        Sphere sphere;
+        auto rays = createRays(state.range(0));
+        for (auto _ : state)
+        {
+            int hits = 0;
+            for (const Ray3d& ray : rays)
+                hits += sphere.preliminaryHit(ray).isValid();
+            benchmark::DoNotOptimize(hits);
+        }
+        state.SetItemsProcessed(state.iterations() * rays.size());
+    }
+    BENCHMARK(sphere_preliminaryHit)->ArgName("rays")->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+
+    static void sphere_anyHit(benchmark::State& state)
+    {
+        Sphere sphere;
+        auto rays = createRays(state.range(0));
+        for (auto _ : state)
+        {
+            int hits = 0;
+            for (const Ray3d& ray : rays)
+                hits += sphere.anyHit(ray);
+            benchmark::DoNotOptimize(hits);
+        }
+        state.SetItemsProcessed(state.iterations() * rays.size());
+    }
+    BENCHMARK(sphere_anyHit)->ArgName("rays")->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+}
@@ -0,0 +1,28 @@
+#include <vislab/core/transfer_function.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace vislab
+{
+    static void transferFunction_map(benchmark::State& state)
+    {
+        // evenly spaced control points with varying colors
+        TransferFunction4d transferFunction(0, 1);
+        for (int64_t i = 0; i < state.range(0); ++i)
+        {
+            double t                   = i / (state.range(0) - 1.);
+            transferFunction.values[t] = Eigen::Vector4d(t, 1 - t, t * t, 1);
+        }
+
+        const int numValues = 4096;
+        for (auto _ : state)
+        {
+            Eigen::Vector4d sum = Eigen::Vector4d::Zero();
+            for (int i = 0; i < numValues; ++i)
+                sum += transferFunction.map(i / (numValues - 1.));
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * numValues);
+    }
+    BENCHMARK(transferFunction_map)->ArgName("controlPoints")->RangeMultiplier(4)->Range(2, 128);
+}
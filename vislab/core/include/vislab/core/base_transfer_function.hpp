@@ -3,6 +3,8 @@
 #include "base_transfer_function_fwd.hpp"
 #include "itransfer_function.hpp"
 
+#include <Eigen/Eigen>
+
 namespace vislab
 {
     /**
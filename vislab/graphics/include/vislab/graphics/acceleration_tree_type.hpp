@@ -0,0 +1,20 @@
+#pragma once
+
+namespace vislab
+{
+    /**
+     * @brief Layout of the bounding volume hierarchy that is used for ray traversal.
+     */
+    enum class EAccelerationTreeType
+    {
+        /**
+         * @brief Binary tree that tests one bounding box per node.
+         */
+        Binary,
+
+        /**
+         * @brief Tree with four children per node, whose bounding boxes are tested at once with SIMD instructions.
+         */
+        Wide
+    };
+}
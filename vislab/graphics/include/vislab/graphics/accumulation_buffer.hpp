@@ -0,0 +1,137 @@
+#pragma once
+
+#include "image_fwd.hpp"
+#include "spectrum.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace vislab
+{
+    /**
+     * @brief Accumulates Monte Carlo samples per pixel in linear radiance. Along with the mean, it keeps the running variance of the luminance (Welford's algorithm), from which the relative error of each pixel is estimated.
+     */
+    class AccumulationBuffer
+    {
+    public:
+        /**
+         * @brief Luminance below which the error is measured relative to this value instead, such that dark pixels do not receive an unbounded number of samples.
+         */
+        static constexpr double MinLuminance = 1E-3;
+
+        /**
+         * @brief Constructor of an empty buffer.
+         */
+        AccumulationBuffer();
+
+        /**
+         * @brief Resizes the buffer and removes all samples.
+         * @param resolution Resolution of the image.
+         */
+        void setResolution(const Eigen::Vector2i& resolution);
+
+        /**
+         * @brief Gets the resolution of the image.
+         * @return Resolution of the image.
+         */
+        const Eigen::Vector2i& getResolution() const;
+
+        /**
+         * @brief Removes all samples.
+         */
+        void clear();
+
+        /**
+         * @brief Adds a sample to a pixel.
+         * @param pixel Linear index of the pixel.
+         * @param radiance Radiance of the sample.
+         * @param isValid If false, the sample only counts as taken, but does not contribute to the mean.
+         */
+        void addSample(int64_t pixel, const Spectrum& radiance, bool isValid);
+
+        /**
+         * @brief Gets the number of samples that were taken for a pixel, including invalid ones.
+         * @param pixel Linear index of the pixel.
+         * @return Number of samples.
+         */
+        uint32_t getSampleCount(int64_t pixel) const;
+
+        /**
+         * @brief Gets the mean radiance of the valid samples of a pixel.
+         * @param pixel Linear index of the pixel.
+         * @return Mean radiance, which is zero if there is no valid sample.
+         */
+        Spectrum getRadiance(int64_t pixel) const;
+
+        /**
+         * @brief Gets the unbiased sample variance of the luminance of a pixel.
+         * @param pixel Linear index of the pixel.
+         * @return Variance, which is zero if there are less than two valid samples.
+         */
+        double getVariance(int64_t pixel) const;
+
+        /**
+         * @brief Estimates the relative error of a pixel as the standard error of the mean luminance, divided by the mean luminance.
+         * @param pixel Linear index of the pixel.
+         * @return Relative error, which is infinite if only one sample was valid and zero if none was valid.
+         */
+        double getRelativeError(int64_t pixel) const;
+
+        /**
+         * @brief Writes the mean radiance of a pixel into an image, if the pixel has valid samples.
+         * @param image Image to write into.
+         * @param pixel Linear index of the pixel.
+         * @param gammaCorrect If true, the radiance is gamma corrected and clamped to [0,1] for display.
+         */
+        void resolve(Image3d* image, int64_t pixel, bool gammaCorrect = true) const;
+
+        /**
+         * @brief Writes the mean radiance of all pixels with valid samples into an image.
+         * @param image Image to write into, which has the resolution of the buffer.
+         * @param gammaCorrect If true, the radiance is gamma corrected and clamped to [0,1] for display.
+         */
+        void resolve(Image3d* image, bool gammaCorrect = true) const;
+
+    private:
+        /**
+         * @brief Samples of a pixel.
+         */
+        struct Pixel
+        {
+            /**
+             * @brief Sum of the radiance of the valid samples.
+             */
+            Spectrum sum;
+
+            /**
+             * @brief Running mean of the luminance of the valid samples.
+             */
+            double mean;
+
+            /**
+             * @brief Running sum of squared differences of the luminance from the mean.
+             */
+            double m2;
+
+            /**
+             * @brief Number of valid samples.
+             */
+            uint32_t numValid;
+
+            /**
+             * @brief Number of samples, including invalid ones.
+             */
+            uint32_t numSamples;
+        };
+
+        /**
+         * @brief Resolution of the image.
+         */
+        Eigen::Vector2i mResolution;
+
+        /**
+         * @brief Samples of each pixel.
+         */
+        std::vector<Pixel> mPixels;
+    };
+}
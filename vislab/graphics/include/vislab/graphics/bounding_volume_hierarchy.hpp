@@ -154,6 +154,23 @@ namespace vislab
                 return false;
         }
 
+        /**
+         * @brief Counts the number of shapes that are intersected by the ray within [tMin, tMax].
+         * @param ray Ray to test against.
+         * @return Number of intersected shapes.
+         */
+        int32_t countHits(const Ray3d& ray) const
+        {
+            if (mShapes.size() == 0)
+                return 0;
+            if (mShapes.size() == 1)
+                return mShapes[0]->preliminaryHit(ray).isValid() ? 1 : 0;
+            if (mRoot)
+                return mRoot->countHits(ray);
+            else
+                return 0;
+        }
+
     private:
         /**
          * @brief Shape that is inserted into the BVH tree (a leaf). Class T must have a "getBoundingBox" function.
@@ -326,6 +343,29 @@ namespace vislab
                 return false;
             }
 
+            /**
+             * @brief Counts the number of shapes below this node that are intersected by the ray.
+             * @param ray Ray to test against.
+             * @return Number of intersected shapes.
+             */
+            int32_t countHits(const Ray3d& ray) const
+            {
+                // Does the ray hit the bounding box?
+                if (!RayBoxIntersection::anyHit(ray, mBounds))
+                    return 0;
+
+                int32_t hits = 0;
+                for (int i = 0; i < 2; ++i)
+                    if (mLeaf[i] && mLeaf[i]->shape->preliminaryHit(ray).isValid())
+                        hits++;
+
+                if (mLeft)
+                    hits += mLeft->countHits(ray);
+                if (mRight)
+                    hits += mRight->countHits(ray);
+                return hits;
+            }
+
         private:
             /**
              * @brief Left child node.
@@ -0,0 +1,973 @@
+#pragma once
+
+#include "preliminary_interaction.hpp"
+#include "ray.hpp"
+
+#include <Eigen/Eigen>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace vislab
+{
+    /**
+     * @brief Bounding volume hierarchy over shapes of type TShape that is stored as an array of compact nodes in depth-first order. The tree is traversed iteratively with a small stack and visits the nearer child first.
+     * @tparam TShape Type of shapes stored in the hierarchy. Needs the functions worldBounds(), preliminaryHit() and anyHit().
+     */
+    template <class TShape>
+    class FlatBoundingVolumeHierarchy
+    {
+    public:
+        /**
+         * @brief Node of the linearized tree. The first child of an inner node directly follows its parent, the second child is stored at an offset.
+         */
+        struct alignas(32) Node
+        {
+            /**
+             * @brief Lower corner of the bounding box.
+             */
+            float min[3];
+
+            /**
+             * @brief Index of the second child for inner nodes, or index of the first primitive for leaves.
+             */
+            uint32_t offset;
+
+            /**
+             * @brief Upper corner of the bounding box.
+             */
+            float max[3];
+
+            /**
+             * @brief Number of primitives in a leaf. Zero for inner nodes.
+             */
+            uint16_t count;
+
+            /**
+             * @brief Axis along which the children of an inner node were split.
+             */
+            uint8_t axis;
+
+            /**
+             * @brief Unused.
+             */
+            uint8_t padding;
+
+            /**
+             * @brief Checks if this node is a leaf.
+             * @return True if the node stores primitives.
+             */
+            bool isLeaf() const { return count > 0; }
+        };
+        static_assert(sizeof(Node) == 32, "Nodes are expected to fill half a cache line.");
+
+        /**
+         * @brief Maximum number of primitives in a leaf.
+         */
+        static constexpr int MaxLeafSize = 8;
+
+        /**
+         * @brief Maximum depth of the tree, which bounds the size of the traversal stack.
+         */
+        static constexpr int MaxDepth = 64;
+
+        /**
+         * @brief Default factor by which the cost of a refitted tree may exceed the cost after the last build before update() rebuilds the tree.
+         */
+        static constexpr double DefaultRebuildThreshold = 1.5;
+
+        /**
+         * @brief Constructor of an empty tree.
+         */
+        FlatBoundingVolumeHierarchy()
+            : mCost(0)
+            , mBuildCost(0)
+        {
+        }
+
+        /**
+         * @brief Gets the shapes that are stored in this tree.
+         * @return Vector of shapes.
+         */
+        const std::vector<TShape*>& getShapes() const { return mShapes; }
+
+        /**
+         * @brief Gets the shapes that are stored in this tree.
+         * @return Writable vector of shapes.
+         */
+        std::vector<TShape*>& getShapes() { return mShapes; }
+
+        /**
+         * @brief Gets the nodes in depth-first order. The root is the first node.
+         * @return Vector of nodes.
+         */
+        const std::vector<Node>& getNodes() const { return mNodes; }
+
+        /**
+         * @brief Gets the shapes in the order in which the leaves reference them.
+         * @return Vector of shapes.
+         */
+        const std::vector<TShape*>& getOrderedShapes() const { return mOrderedShapes; }
+
+        /**
+         * @brief Gets the expected cost of a ray query according to the surface area heuristic, in units of primitive intersections.
+         * @return Cost of the current tree, or zero if the tree is empty.
+         */
+        double getCost() const { return mCost; }
+
+        /**
+         * @brief Builds the tree from formerly added shapes with the surface area heuristic, evaluated on bins along each axis. Large subtrees are built in parallel.
+         */
+        void build()
+        {
+            mNodes.clear();
+            mOrderedShapes.clear();
+            mCost      = 0;
+            mBuildCost = 0;
+            if (mShapes.empty())
+                return;
+
+            // compute the bounds of each shape only once
+            int64_t numShapes = (int64_t)mShapes.size();
+            std::vector<BuildPrimitive> primitives(numShapes);
+#ifndef _DEBUG
+#pragma omp parallel for
+#endif
+            for (int64_t i = 0; i < numShapes; ++i)
+            {
+                Eigen::AlignedBox3d bounds = mShapes[i]->worldBounds();
+                primitives[i].bounds.min()[3] = primitives[i].bounds.max()[3] = 0;
+                for (int k = 0; k < 3; ++k)
+                {
+                    primitives[i].bounds.min()[k] = roundDown(bounds.min()[k]);
+                    primitives[i].bounds.max()[k] = roundUp(bounds.max()[k]);
+                }
+                primitives[i].centroid = primitives[i].bounds.center();
+                primitives[i].index    = (uint32_t)i;
+            }
+
+            // a binary tree with at least one primitive per leaf has less than twice as many nodes as primitives
+            std::unique_ptr<BuildNode[]> buildNodes(new BuildNode[2 * numShapes]);
+            std::atomic<uint32_t> numBuildNodes(1);
+            Eigen::AlignedBox4f bounds, centroidBounds;
+            computeBounds(primitives.data(), 0, (uint32_t)numShapes, bounds, centroidBounds);
+            buildNodes[0].min = bounds.min();
+            buildNodes[0].max = bounds.max();
+#ifndef _DEBUG
+#pragma omp parallel
+#pragma omp single
+#endif
+            {
+                buildRecursive(primitives.data(), buildNodes.get(), &numBuildNodes, 0, 0, (uint32_t)numShapes, centroidBounds, 0);
+                mNodes.resize(buildNodes[0].size);
+                flatten(buildNodes.get(), 0, 0);
+            }
+
+            // store the shapes in the order of the leaves
+            mOrderedShapes.resize(numShapes);
+#ifndef _DEBUG
+#pragma omp parallel for
+#endif
+            for (int64_t i = 0; i < numShapes; ++i)
+                mOrderedShapes[i] = mShapes[primitives[i].index];
+
+            mCost      = computeCost();
+            mBuildCost = mCost;
+        }
+
+        /**
+         * @brief Recomputes the bounding boxes bottom-up after the shapes moved, while keeping the topology of the tree. Large subtrees are refitted in parallel.
+         */
+        void refit()
+        {
+            if (mNodes.empty())
+                return;
+
+            double cost = 0;
+#ifndef _DEBUG
+#pragma omp parallel
+#pragma omp single
+#endif
+            cost = refitRecursive(0, (uint32_t)mNodes.size());
+            mCost = cost / surfaceArea(mNodes[0]);
+        }
+
+        /**
+         * @brief Refits the tree and rebuilds it if its cost grew too much compared to the last build, e.g., because the shapes moved far apart.
+         * @param rebuildThreshold Factor by which the cost may exceed the cost after the last build.
+         * @return True if the tree was rebuilt.
+         */
+        bool update(double rebuildThreshold = DefaultRebuildThreshold)
+        {
+            refit();
+            if (!(mCost > rebuildThreshold * mBuildCost))
+                return false;
+            build();
+            return true;
+        }
+
+        /**
+         * @brief Fast ray intersection test. To obtain further information about the intersection, use ComputeSurfaceInteraction().
+         * @param ray Ray to test against.
+         * @return Intersection result.
+         */
+        PreliminaryIntersection preliminaryHit(const Ray3d& ray) const
+        {
+            return preliminaryHit(ray, [this](uint32_t offset, uint32_t count, Ray3d& ray, PreliminaryIntersection& result)
+                                  {
+                                      for (uint32_t i = offset; i < offset + count; ++i)
+                                      {
+                                          PreliminaryIntersection pi = mOrderedShapes[i]->preliminaryHit(ray);
+                                          if (pi.isValid() && pi.t < result.t)
+                                          {
+                                              result   = pi;
+                                              ray.tMax = pi.t;
+                                          }
+                                      }
+                                  });
+        }
+
+        /**
+         * @brief Fast ray intersection test with a custom test for the primitives of the leaves, e.g., for primitives that are stored in the order of getOrderedShapes().
+         * @tparam TLeafIntersector Function that receives the offset and count of the leaf primitives, the ray and the closest intersection so far. Closer hits replace the intersection and shorten the ray.
+         * @param ray Ray to test against.
+         * @param intersectLeaf Function to call for each intersected leaf.
+         * @return Intersection result.
+         */
+        template <typename TLeafIntersector>
+        PreliminaryIntersection preliminaryHit(const Ray3d& ray, TLeafIntersector&& intersectLeaf) const
+        {
+            PreliminaryIntersection result;
+            if (mNodes.empty())
+                return result;
+
+            Ray3d ray_ = ray;
+            TraversalRay traversalRay(ray);
+            float tMax = roundUp(ray_.tMax);
+            uint32_t stack[MaxDepth];
+            int stackSize    = 0;
+            uint32_t current = 0;
+            while (true)
+            {
+                const Node& node = mNodes[current];
+                if (intersect(node, traversalRay, tMax))
+                {
+                    if (node.isLeaf())
+                    {
+                        intersectLeaf(node.offset, (uint32_t)node.count, ray_, result);
+                        tMax = roundUp(ray_.tMax);
+                    }
+                    else
+                    {
+                        // descend into the child that is closer along the ray and postpone the other one
+                        if (traversalRay.negative[node.axis])
+                        {
+                            stack[stackSize++] = current + 1;
+                            current            = node.offset;
+                        }
+                        else
+                        {
+                            stack[stackSize++] = node.offset;
+                            current            = current + 1;
+                        }
+                        continue;
+                    }
+                }
+                if (stackSize == 0)
+                    break;
+                current = stack[--stackSize];
+            }
+            return result;
+        }
+
+        /**
+         * @brief Fast ray shadow test.
+         * @param ray Ray to test against.
+         * @return True if there was a hit.
+         */
+        bool anyHit(const Ray3d& ray) const
+        {
+            bool hit = false;
+            traverse(ray, [&hit](const TShape* shape, const Ray3d& ray)
+                     { hit = shape->anyHit(ray); return !hit; });
+            return hit;
+        }
+
+        /**
+         * @brief Counts the number of shapes that are intersected by the ray within [tMin, tMax].
+         * @param ray Ray to test against.
+         * @return Number of intersected shapes.
+         */
+        int32_t countHits(const Ray3d& ray) const
+        {
+            int32_t hits = 0;
+            traverse(ray, [&hits](const TShape* shape, const Ray3d& ray)
+                     { hits += shape->preliminaryHit(ray).isValid() ? 1 : 0; return true; });
+            return hits;
+        }
+
+        /**
+         * @brief Visits the shapes in all leaves whose bounding box overlaps the given box. The shapes themselves are not tested against the box.
+         * @tparam TVisitor Function that receives a shape and returns false to stop the traversal.
+         * @param box Box to test against, in the space of the shapes.
+         * @param visitor Function to call for each shape of an overlapped leaf.
+         */
+        template <typename TVisitor>
+        void overlap(const Eigen::AlignedBox3d& box, TVisitor&& visitor) const
+        {
+            if (mNodes.empty() || box.isEmpty())
+                return;
+
+            float boxMin[3], boxMax[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                boxMin[k] = roundDown(box.min()[k]);
+                boxMax[k] = roundUp(box.max()[k]);
+            }
+            uint32_t stack[MaxDepth];
+            int stackSize    = 0;
+            uint32_t current = 0;
+            while (true)
+            {
+                const Node& node = mNodes[current];
+                bool overlaps    = true;
+                for (int k = 0; k < 3; ++k)
+                    overlaps &= node.min[k] <= boxMax[k] && boxMin[k] <= node.max[k];
+                if (overlaps)
+                {
+                    if (node.isLeaf())
+                    {
+                        for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                            if (!visitor(mOrderedShapes[i]))
+                                return;
+                    }
+                    else
+                    {
+                        stack[stackSize++] = node.offset;
+                        current            = current + 1;
+                        continue;
+                    }
+                }
+                if (stackSize == 0)
+                    break;
+                current = stack[--stackSize];
+            }
+        }
+
+    private:
+        /**
+         * @brief Cached information about a shape during the construction.
+         */
+        struct BuildPrimitive
+        {
+            /**
+             * @brief Bounding box, rounded outwards to single precision. The fourth coordinate is zero and only pads the box for vectorized operations.
+             */
+            Eigen::AlignedBox4f bounds;
+
+            /**
+             * @brief Center of the bounding box.
+             */
+            Eigen::Vector4f centroid;
+
+            /**
+             * @brief Index of the shape.
+             */
+            uint32_t index;
+        };
+
+        /**
+         * @brief Node of the temporary tree that is built before the nodes are linearized. The members are not initialized, since each node is written once during the construction.
+         */
+        struct BuildNode
+        {
+            /**
+             * @brief Lower corner of the bounding box of the node.
+             */
+            Eigen::Vector4f min;
+
+            /**
+             * @brief Upper corner of the bounding box of the node.
+             */
+            Eigen::Vector4f max;
+
+            /**
+             * @brief Indices of the two children, or zero for leaves.
+             */
+            uint32_t children[2];
+
+            /**
+             * @brief First primitive of the node.
+             */
+            uint32_t begin;
+
+            /**
+             * @brief Number of primitives below the node.
+             */
+            uint32_t count;
+
+            /**
+             * @brief Number of nodes in the subtree, including this node.
+             */
+            uint32_t size;
+
+            /**
+             * @brief Split axis of inner nodes.
+             */
+            uint8_t axis;
+        };
+
+        /**
+         * @brief Bin of the surface area heuristic. The members are not initialized, since only the bins that are used are cleared.
+         */
+        struct Bin
+        {
+            /**
+             * @brief Clears the bin.
+             */
+            void clear()
+            {
+                min         = Eigen::Array4f::Constant(std::numeric_limits<float>::max());
+                max         = Eigen::Array4f::Constant(std::numeric_limits<float>::lowest());
+                centroidMin = min;
+                centroidMax = max;
+                count       = 0;
+            }
+
+            /**
+             * @brief Lower corner of the bounding box of the primitives in the bin.
+             */
+            Eigen::Array4f min;
+
+            /**
+             * @brief Upper corner of the bounding box of the primitives in the bin.
+             */
+            Eigen::Array4f max;
+
+            /**
+             * @brief Lower corner of the bounding box of the centroids in the bin.
+             */
+            Eigen::Array4f centroidMin;
+
+            /**
+             * @brief Upper corner of the bounding box of the centroids in the bin.
+             */
+            Eigen::Array4f centroidMax;
+
+            /**
+             * @brief Number of primitives in the bin.
+             */
+            uint32_t count;
+        };
+
+        /**
+         * @brief Number of bins per axis that split candidates are evaluated for.
+         */
+        static constexpr int NumBins = 16;
+
+        /**
+         * @brief Cost of an inner node relative to the cost of a primitive intersection.
+         */
+        static constexpr float TraversalCost = 1.f;
+
+        /**
+         * @brief Subtrees with more primitives than this are built as separate tasks.
+         */
+        static constexpr uint32_t ParallelThreshold = 4096;
+
+        /**
+         * @brief Ray in single precision with precomputed reciprocal direction.
+         */
+        struct TraversalRay
+        {
+            /**
+             * @brief Constructor.
+             * @param ray Ray to convert.
+             */
+            explicit TraversalRay(const Ray3d& ray)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    origin[i]           = (float)ray.origin[i];
+                    inverseDirection[i] = (float)(1. / ray.direction[i]);
+                    negative[i]         = inverseDirection[i] < 0;
+                }
+                tMin = roundDown(ray.tMin);
+            }
+
+            /**
+             * @brief Origin of the ray.
+             */
+            float origin[3];
+
+            /**
+             * @brief Reciprocal of the ray direction.
+             */
+            float inverseDirection[3];
+
+            /**
+             * @brief Flags that determine for each axis whether the direction is negative.
+             */
+            bool negative[3];
+
+            /**
+             * @brief Minimal ray parameter.
+             */
+            float tMin;
+        };
+
+        /**
+         * @brief Conservative slab test of a ray against the bounding box of a node.
+         * @param node Node to test.
+         * @param ray Ray to test.
+         * @param tMax Maximal ray parameter.
+         * @return True if the ray intersects the box within its parameter range.
+         */
+        static bool intersect(const Node& node, const TraversalRay& ray, float tMax)
+        {
+            // enlarge the exit distance to compensate for rounding errors, see Pharr et al., Physically Based Rendering, Sec. 3.9
+            const float gamma3 = 3 * std::numeric_limits<float>::epsilon() * 0.5f / (1 - 3 * std::numeric_limits<float>::epsilon() * 0.5f);
+            float tNear        = ray.tMin;
+            float tFar         = tMax;
+            for (int i = 0; i < 3; ++i)
+            {
+                float t0 = ((ray.negative[i] ? node.max[i] : node.min[i]) - ray.origin[i]) * ray.inverseDirection[i];
+                float t1 = ((ray.negative[i] ? node.min[i] : node.max[i]) - ray.origin[i]) * ray.inverseDirection[i];
+                t1 *= 1 + 2 * gamma3;
+
+                // written such that NaNs (ray in the plane of a slab) keep the previous value
+                tNear = t0 > tNear ? t0 : tNear;
+                tFar  = t1 < tFar ? t1 : tFar;
+                if (tNear > tFar)
+                    return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Visits all shapes in leaves whose bounding box is intersected by the ray.
+         * @tparam TVisitor Function that receives the shape and the ray and returns false to stop the traversal.
+         * @param ray Ray to test against.
+         * @param visitor Function to call for each shape.
+         */
+        template <typename TVisitor>
+        void traverse(const Ray3d& ray, TVisitor&& visitor) const
+        {
+            if (mNodes.empty())
+                return;
+
+            TraversalRay traversalRay(ray);
+            float tMax = roundUp(ray.tMax);
+            uint32_t stack[MaxDepth];
+            int stackSize    = 0;
+            uint32_t current = 0;
+            while (true)
+            {
+                const Node& node = mNodes[current];
+                if (intersect(node, traversalRay, tMax))
+                {
+                    if (node.isLeaf())
+                    {
+                        for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                            if (!visitor(mOrderedShapes[i], ray))
+                                return;
+                    }
+                    else
+                    {
+                        stack[stackSize++] = node.offset;
+                        current            = current + 1;
+                        continue;
+                    }
+                }
+                if (stackSize == 0)
+                    break;
+                current = stack[--stackSize];
+            }
+        }
+
+        /**
+         * @brief Computes the bounding box of a range of primitives and of their centroids.
+         * @param primitives Primitives.
+         * @param begin First primitive of the range.
+         * @param end One past the last primitive of the range.
+         * @param bounds Bounding box of the primitives.
+         * @param centroidBounds Bounding box of the centroids.
+         */
+        static void computeBounds(const BuildPrimitive* primitives, uint32_t begin, uint32_t end, Eigen::AlignedBox4f& bounds, Eigen::AlignedBox4f& centroidBounds)
+        {
+            bounds.setEmpty();
+            centroidBounds.setEmpty();
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                bounds.extend(primitives[i].bounds);
+                centroidBounds.extend(primitives[i].centroid);
+            }
+        }
+
+        /**
+         * @brief Recursively splits a range of primitives and creates the nodes of the temporary tree.
+         * @param primitives Primitives, which are reordered such that each leaf references a contiguous range.
+         * @param nodes Storage of the temporary tree.
+         * @param numNodes Number of allocated nodes in the temporary tree.
+         * @param nodeIndex Index of the node to fill. Its bounding box is already set.
+         * @param begin First primitive of the range.
+         * @param end One past the last primitive of the range.
+         * @param centroidBounds Bounding box of the centroids in the range.
+         * @param depth Depth of the node.
+         */
+        static void buildRecursive(BuildPrimitive* primitives, BuildNode* nodes, std::atomic<uint32_t>* numNodes, uint32_t nodeIndex, uint32_t begin, uint32_t end, const Eigen::AlignedBox4f& centroidBounds, int depth)
+        {
+            BuildNode& node  = nodes[nodeIndex];
+            uint32_t count   = end - begin;
+            node.children[0] = 0;
+            node.children[1] = 0;
+            node.begin       = begin;
+            node.count       = count;
+            node.size        = 1;
+            node.axis        = 0;
+            if (count == 1)
+                return;
+
+            // splits at the object median guarantee that the maximum depth is not exceeded
+            int levelsToLeaf = 0;
+            while ((1u << levelsToLeaf) < count)
+                levelsToLeaf++;
+            bool medianSplit = depth + levelsToLeaf + 1 >= MaxDepth;
+
+            int axis;
+            Eigen::Vector4f extent = centroidBounds.sizes();
+            extent.head<3>().maxCoeff(&axis);
+            uint32_t mid = begin + count / 2;
+            Eigen::AlignedBox4f childBounds[2], childCentroidBounds[2];
+            if (extent[axis] <= 0 || medianSplit)
+            {
+                // if all centroids coincide, any partition is as good as another
+                if (extent[axis] <= 0 && count <= (uint32_t)MaxLeafSize)
+                    return;
+                std::nth_element(primitives + begin, primitives + mid, primitives + end,
+                                 [axis](const BuildPrimitive& a, const BuildPrimitive& b)
+                                 { return a.centroid[axis] < b.centroid[axis]; });
+                computeBounds(primitives, begin, mid, childBounds[0], childCentroidBounds[0]);
+                computeBounds(primitives, mid, end, childBounds[1], childCentroidBounds[1]);
+            }
+            else
+            {
+                // fill the bins of all axes in one pass over the primitives, small ranges need fewer bins
+                int numBins          = (int)std::min<uint32_t>(NumBins, count);
+                Eigen::Array4f scale = Eigen::Array4f::Zero();
+                for (int k = 0; k < 3; ++k)
+                    if (extent[k] > 0)
+                        scale[k] = numBins / extent[k];
+                Eigen::Array4f origin = centroidBounds.min().array();
+                auto binIndex         = [&origin, &scale, numBins](const Eigen::Vector4f& centroid)
+                { return ((centroid.array() - origin) * scale).cast<int>().min(numBins - 1); };
+
+                Bin bins[3][NumBins];
+                for (int k = 0; k < 3; ++k)
+                    for (int b = 0; b < numBins; ++b)
+                        bins[k][b].clear();
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    const BuildPrimitive& primitive = primitives[i];
+                    Eigen::Array4i index            = binIndex(primitive.centroid);
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        Bin& bin        = bins[k][index[k]];
+                        bin.min         = bin.min.min(primitive.bounds.min().array());
+                        bin.max         = bin.max.max(primitive.bounds.max().array());
+                        bin.centroidMin = bin.centroidMin.min(primitive.centroid.array());
+                        bin.centroidMax = bin.centroidMax.max(primitive.centroid.array());
+                        bin.count++;
+                    }
+                }
+
+                // sweep from the right to accumulate the cost of the right side, then from the left to evaluate the splits between the bins
+                float bestCost = std::numeric_limits<float>::infinity();
+                int bestBin    = -1;
+                for (int k = 0; k < 3; ++k)
+                {
+                    if (extent[k] <= 0)
+                        continue;
+                    float rightCost[NumBins];
+                    Eigen::Array4f min  = bins[k][numBins - 1].min;
+                    Eigen::Array4f max  = bins[k][numBins - 1].max;
+                    uint32_t rightCount = 0;
+                    for (int b = numBins - 1; b > 0; --b)
+                    {
+                        min = min.min(bins[k][b].min);
+                        max = max.max(bins[k][b].max);
+                        rightCount += bins[k][b].count;
+                        rightCost[b] = rightCount == 0 ? 0 : rightCount * surfaceArea(max - min);
+                    }
+                    min                = bins[k][0].min;
+                    max                = bins[k][0].max;
+                    uint32_t leftCount = 0;
+                    for (int b = 0; b < numBins - 1; ++b)
+                    {
+                        min = min.min(bins[k][b].min);
+                        max = max.max(bins[k][b].max);
+                        leftCount += bins[k][b].count;
+                        if (leftCount == 0 || leftCount == count)
+                            continue;
+                        float cost = leftCount * surfaceArea(max - min) + rightCost[b + 1];
+                        if (cost < bestCost)
+                        {
+                            bestCost = cost;
+                            bestBin  = b;
+                            axis     = k;
+                        }
+                    }
+                }
+
+                // keep small ranges as leaf if that is cheaper than the best split
+                float splitCost = TraversalCost + bestCost / surfaceArea((node.max - node.min).array());
+                if (count <= (uint32_t)MaxLeafSize && count <= splitCost)
+                    return;
+
+                if (bestBin < 0)
+                {
+                    // degenerate bins, e.g., due to a tiny extent
+                    std::nth_element(primitives + begin, primitives + mid, primitives + end,
+                                     [axis](const BuildPrimitive& a, const BuildPrimitive& b)
+                                     { return a.centroid[axis] < b.centroid[axis]; });
+                    computeBounds(primitives, begin, mid, childBounds[0], childCentroidBounds[0]);
+                    computeBounds(primitives, mid, end, childBounds[1], childCentroidBounds[1]);
+                }
+                else
+                {
+                    // the children are the unions of the bins on either side of the split
+                    for (int c = 0; c < 2; ++c)
+                    {
+                        childBounds[c].setEmpty();
+                        childCentroidBounds[c].setEmpty();
+                    }
+                    for (int b = 0; b < numBins; ++b)
+                    {
+                        const Bin& bin = bins[axis][b];
+                        int c          = b <= bestBin ? 0 : 1;
+                        if (bin.count == 0)
+                            continue;
+                        childBounds[c].extend(Eigen::AlignedBox4f(bin.min.matrix(), bin.max.matrix()));
+                        childCentroidBounds[c].extend(Eigen::AlignedBox4f(bin.centroidMin.matrix(), bin.centroidMax.matrix()));
+                    }
+                    auto middle = std::partition(primitives + begin, primitives + end,
+                                                 [&binIndex, axis, bestBin](const BuildPrimitive& primitive)
+                                                 { return binIndex(primitive.centroid)[axis] <= bestBin; });
+                    mid         = (uint32_t)(middle - primitives);
+                }
+            }
+
+            uint32_t left    = numNodes->fetch_add(2);
+            uint32_t right   = left + 1;
+            node.children[0] = left;
+            node.children[1] = right;
+            node.axis        = (uint8_t)axis;
+            nodes[left].min  = childBounds[0].min();
+            nodes[left].max  = childBounds[0].max();
+            nodes[right].min = childBounds[1].min();
+            nodes[right].max = childBounds[1].max();
+            if (count > ParallelThreshold)
+            {
+#ifndef _DEBUG
+#pragma omp task
+#endif
+                buildRecursive(primitives, nodes, numNodes, left, begin, mid, childCentroidBounds[0], depth + 1);
+                buildRecursive(primitives, nodes, numNodes, right, mid, end, childCentroidBounds[1], depth + 1);
+#ifndef _DEBUG
+#pragma omp taskwait
+#endif
+            }
+            else
+            {
+                buildRecursive(primitives, nodes, numNodes, left, begin, mid, childCentroidBounds[0], depth + 1);
+                buildRecursive(primitives, nodes, numNodes, right, mid, end, childCentroidBounds[1], depth + 1);
+            }
+            node.size = 1 + nodes[left].size + nodes[right].size;
+        }
+
+        /**
+         * @brief Copies a subtree of the temporary tree into the linearized nodes in depth-first order.
+         * @param buildNodes Temporary tree.
+         * @param buildIndex Root of the subtree in the temporary tree.
+         * @param nodeIndex Index in the linearized nodes that the root is written to.
+         */
+        void flatten(const BuildNode* buildNodes, uint32_t buildIndex, uint32_t nodeIndex)
+        {
+            const BuildNode& buildNode = buildNodes[buildIndex];
+            Node& node                 = mNodes[nodeIndex];
+            for (int k = 0; k < 3; ++k)
+            {
+                node.min[k] = buildNode.min[k];
+                node.max[k] = buildNode.max[k];
+            }
+            node.axis    = buildNode.axis;
+            node.padding = 0;
+            if (buildNode.children[0] == 0)
+            {
+                node.offset = buildNode.begin;
+                node.count  = (uint16_t)buildNode.count;
+                return;
+            }
+
+            // the second child follows after the subtree of the first child
+            uint32_t second = nodeIndex + 1 + buildNodes[buildNode.children[0]].size;
+            node.offset     = second;
+            node.count      = 0;
+            if (buildNode.size > ParallelThreshold)
+            {
+#ifndef _DEBUG
+#pragma omp task
+#endif
+                flatten(buildNodes, buildNode.children[0], nodeIndex + 1);
+                flatten(buildNodes, buildNode.children[1], second);
+#ifndef _DEBUG
+#pragma omp taskwait
+#endif
+            }
+            else
+            {
+                flatten(buildNodes, buildNode.children[0], nodeIndex + 1);
+                flatten(buildNodes, buildNode.children[1], second);
+            }
+        }
+
+        /**
+         * @brief Recomputes the bounding boxes of a subtree from the current bounds of its shapes.
+         * @param nodeIndex Root of the subtree.
+         * @param end One past the last node of the subtree.
+         * @return Sum of the surface areas of the nodes in the subtree, weighted by their cost.
+         */
+        double refitRecursive(uint32_t nodeIndex, uint32_t end)
+        {
+            Node& node = mNodes[nodeIndex];
+            if (node.isLeaf())
+            {
+                Eigen::AlignedBox3d bounds;
+                bounds.setEmpty();
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                    bounds.extend(mOrderedShapes[i]->worldBounds());
+                for (int k = 0; k < 3; ++k)
+                {
+                    node.min[k] = roundDown(bounds.min()[k]);
+                    node.max[k] = roundUp(bounds.max()[k]);
+                }
+                return node.count * surfaceArea(node);
+            }
+
+            // the first child spans the nodes up to the second child
+            uint32_t first = nodeIndex + 1, second = node.offset;
+            double firstCost, secondCost;
+            if (end - nodeIndex > ParallelThreshold)
+            {
+#ifndef _DEBUG
+#pragma omp task shared(firstCost)
+#endif
+                firstCost  = refitRecursive(first, second);
+                secondCost = refitRecursive(second, end);
+#ifndef _DEBUG
+#pragma omp taskwait
+#endif
+            }
+            else
+            {
+                firstCost  = refitRecursive(first, second);
+                secondCost = refitRecursive(second, end);
+            }
+            for (int k = 0; k < 3; ++k)
+            {
+                node.min[k] = std::min(mNodes[first].min[k], mNodes[second].min[k]);
+                node.max[k] = std::max(mNodes[first].max[k], mNodes[second].max[k]);
+            }
+            return TraversalCost * surfaceArea(node) + firstCost + secondCost;
+        }
+
+        /**
+         * @brief Computes the expected cost of a ray query according to the surface area heuristic.
+         * @return Cost relative to the cost of a primitive intersection.
+         */
+        double computeCost() const
+        {
+            if (mNodes.empty())
+                return 0;
+            double cost = 0;
+            for (const Node& node : mNodes)
+                cost += (node.isLeaf() ? node.count : TraversalCost) * surfaceArea(node);
+            return cost / surfaceArea(mNodes[0]);
+        }
+
+        /**
+         * @brief Computes the surface area of the bounding box of a node.
+         * @param node Node to compute the surface area for.
+         * @return Surface area.
+         */
+        static double surfaceArea(const Node& node)
+        {
+            double dx = node.max[0] - node.min[0];
+            double dy = node.max[1] - node.min[1];
+            double dz = node.max[2] - node.min[2];
+            return 2 * (dx * dy + dx * dz + dy * dz);
+        }
+
+        /**
+         * @brief Computes the surface area of a bounding box.
+         * @param size Extent of the bounding box. The fourth coordinate is ignored.
+         * @return Surface area.
+         */
+        static float surfaceArea(const Eigen::Array4f& size)
+        {
+            return 2 * (size.x() * size.y() + size.x() * size.z() + size.y() * size.z());
+        }
+
+        /**
+         * @brief Converts to single precision, rounding towards negative infinity.
+         * @param value Value to convert.
+         * @return Largest float that is not greater than the value.
+         */
+        static float roundDown(double value)
+        {
+            float result = (float)value;
+            return result > value ? std::nextafter(result, -std::numeric_limits<float>::infinity()) : result;
+        }
+
+        /**
+         * @brief Converts to single precision, rounding towards positive infinity.
+         * @param value Value to convert.
+         * @return Smallest float that is not less than the value.
+         */
+        static float roundUp(double value)
+        {
+            float result = (float)value;
+            return result < value ? std::nextafter(result, std::numeric_limits<float>::infinity()) : result;
+        }
+
+        /**
+         * @brief Expected cost of a ray query in the current tree.
+         */
+        double mCost;
+
+        /**
+         * @brief Expected cost of a ray query right after the last build.
+         */
+        double mBuildCost;
+
+        /**
+         * @brief Shapes to add into the tree.
+         */
+        std::vector<TShape*> mShapes;
+
+        /**
+         * @brief Shapes in the order in which the leaves reference them.
+         */
+        std::vector<TShape*> mOrderedShapes;
+
+        /**
+         * @brief Nodes in depth-first order.
+         */
+        std::vector<Node> mNodes;
+    };
+}
@@ -1,7 +1,10 @@
 #pragma once
 
-#include "bounding_volume_hierarchy.hpp"
+#include "acceleration_tree_type.hpp"
+#include "flat_bounding_volume_hierarchy.hpp"
+#include "packed_triangles.hpp"
 #include "shape.hpp"
+#include "wide_bounding_volume_hierarchy.hpp"
 
 #include <vislab/core/array_fwd.hpp>
 
@@ -59,6 +62,13 @@ namespace vislab
          */
         PreliminaryIntersection preliminaryHit(const Ray3d& ray) const;
 
+        /**
+         * @brief Counts the number of triangles that are intersected by the ray within [tMin, tMax].
+         * @param ray Ray to test against.
+         * @return Number of intersections with the mesh.
+         */
+        int32_t countHits(const Ray3d& ray) const;
+
         /**
          * @brief Compute and return detailed information related to a surface interaction.
          * @param ray Ray to test against.
@@ -93,6 +103,11 @@ namespace vislab
          */
         void recomputeVertexNormals();
 
+        /**
+         * @brief Recomputes the list of unique edges, their adjacent faces and the edges of each face from the index buffer.
+         */
+        void recomputeEdges();
+
         /**
          * @brief Mesh vertex positions in object space.
          */
@@ -114,15 +129,59 @@ namespace vislab
         std::shared_ptr<Array3ui> indices;
 
         /**
-         * @brief Event that can be raised when the positions changed.
+         * @brief Unique undirected edges with the smaller vertex index first. Computed by recomputeEdges().
+         */
+        std::shared_ptr<Array2ui> edges;
+
+        /**
+         * @brief Indices of the two faces adjacent to each edge. Boundary edges store their only face twice.
+         */
+        std::shared_ptr<Array2ui> edgeFaces;
+
+        /**
+         * @brief Indices of the three edges of each face. Edge j connects the corners j and (j+1)%3. Computed by recomputeEdges().
+         */
+        std::shared_ptr<Array3ui> faceEdges;
+
+        /**
+         * @brief Event that can be raised when the positions changed. The mesh refits its acceleration data structure in response.
          */
         TEvent<Mesh, void> positionsChanged;
 
+        /**
+         * @brief Layout of the ray traversal acceleration data structure. Takes effect with the next call to buildAccelerationTree().
+         */
+        EAccelerationTreeType accelerationTreeType;
+
+        /**
+         * @brief If true, the acceleration data structure stores copies of the triangles in single precision in the order of the tree leaves, which are intersected with a watertight SIMD test. This is faster, but the intersections are less precise than the default test in double precision. Takes effect with the next call to buildAccelerationTree().
+         */
+        bool packTriangles;
+
         /**
          * @brief Rebuilds the ray traversal acceleration data structure.
          */
         void buildAccelerationTree();
 
+        /**
+         * @brief Refits the ray traversal acceleration data structure to the current positions, if it was built. It is rebuilt if the tree quality degraded too much or the number of triangles changed.
+         * @return True if the tree was rebuilt.
+         */
+        bool updateAccelerationTree();
+
+        /**
+         * @brief Checks whether the ray traversal acceleration data structure was built.
+         * @return True if buildAccelerationTree() was called.
+         */
+        bool hasAccelerationTree() const;
+
+        /**
+         * @brief Collects the faces whose bounding boxes overlap a box. Uses the acceleration data structure if it was built and tests all faces otherwise.
+         * @param box Box in object space.
+         * @param faces Receives the indices of the overlapping faces. The vector is cleared first.
+         */
+        void findOverlappingFaces(const Eigen::AlignedBox3d& box, std::vector<uint32_t>& faces) const;
+
     private:
         /**
          * @brief Triangle leaf element in the bounding volume hierarchy.
@@ -164,14 +223,39 @@ namespace vislab
             Eigen::AlignedBox3d worldBoundingBox;
         };
 
+        /**
+         * @brief Recomputes the bounding boxes of all triangles and of the mesh from the positions.
+         */
+        void updateTriangleBounds();
+
+        /**
+         * @brief Copies the triangles in the order of the tree leaves, if packTriangles is set.
+         */
+        void updatePackedTriangles();
+
         /**
          * @brief Bounding volume hierarchy for fast ray traversal.
          */
-        std::shared_ptr<BoundingVolumeHierarchy<Triangle, 3>> mBoundingVolumeHierarchy;
+        std::shared_ptr<FlatBoundingVolumeHierarchy<Triangle>> mBoundingVolumeHierarchy;
+
+        /**
+         * @brief Four-wide bounding volume hierarchy that is collapsed from the binary one, if selected by accelerationTreeType.
+         */
+        std::shared_ptr<WideBoundingVolumeHierarchy<Triangle>> mWideBoundingVolumeHierarchy;
 
         /**
          * @brief Storage of all the triangles in the bounding volume hierarchy.
          */
         std::vector<Triangle> mTriangles;
+
+        /**
+         * @brief Triangles in single precision in the order of the tree leaves. Empty if packTriangles was not set.
+         */
+        PackedTriangles mPackedTriangles;
+
+        /**
+         * @brief Object-space bounding box of the positions, which is updated together with the acceleration tree.
+         */
+        Eigen::AlignedBox3d mObjectBounds;
     };
 }
@@ -1,14 +1,24 @@
 #pragma once
 
+#include "accumulation_buffer.hpp"
 #include "radiance_integrator.hpp"
 #include "spectrum.hpp"
 
+#include <vislab/core/event.hpp>
+
+#include <Eigen/Geometry>
+
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace vislab
 {
+    class Camera;
     class Sampler;
     class RayDifferential3d;
+    class SurfaceInteraction;
 
     /**
      * @brief Base class for Monte Carlo based integrators.
@@ -24,7 +34,7 @@ namespace vislab
         MonteCarloRadianceIntegrator();
 
         /**
-         * @brief Renders a scene onto a given sensor.
+         * @brief Renders a scene onto a given sensor. If a relative error threshold or a time budget is set, the rendering is progressive: after a first pass that takes the samples per pixel everywhere, further passes take the same number of samples again in those pixels whose relative error exceeds the threshold, until all pixels converged, reached the maximum number of samples, or the time budget is used up.
          * @param scene Scene to render.
          * @param sensor Sensor to render scene for.
          * @param image Image to render into.
@@ -33,31 +43,78 @@ namespace vislab
         bool render(Scene* scene, Image3d* image) override;
 
         /**
-         * @brief Gets the number of samples per pixel.
+         * @brief Gets the number of samples per pixel, which is the number of samples per pass in progressive rendering.
          * @return Samples per pixel.
          */
         const size_t& getSamplesPerPixel() const;
 
         /**
-         * @brief Sets the number of samples per pixel.
+         * @brief Sets the number of samples per pixel, which is the number of samples per pass in progressive rendering.
          * @param spp Samples per pixel.
          */
         void setSamplesPerPixel(const size_t& spp);
 
+        /**
+         * @brief Gets the samples of the last rendering in linear radiance, with their per-pixel variance.
+         * @return Accumulation buffer.
+         */
+        const AccumulationBuffer& getAccumulationBuffer() const;
+
         /**
          * @brief Sampler that is cloned for each rendering worker thread.
          */
         std::shared_ptr<Sampler> sampler;
 
+        /**
+         * @brief If true, the primary rays of blocks of PacketTileSize x PacketTileSize pixels are traced together as packets, which is faster for coherent first hits. The image is the same as without packets.
+         */
+        bool packetTracing;
+
+        /**
+         * @brief Relative error that progressive rendering aims for in each pixel. Zero disables the adaptive sampling.
+         */
+        double relativeErrorThreshold;
+
+        /**
+         * @brief Time in seconds after which progressive rendering stops. The first pass is always completed. Zero means no limit.
+         */
+        double timeBudget;
+
+        /**
+         * @brief Maximum number of samples per pixel in progressive rendering.
+         */
+        size_t maxSamplesPerPixel;
+
+        /**
+         * @brief Raised after each pass of the rendering, when the image contains the current estimate. The argument is the index of the pass.
+         */
+        TEvent<MonteCarloRadianceIntegrator, size_t> passCompleted;
+
+        /**
+         * @brief Raised by the worker threads after a tile was written to the image. The argument is the pixel range of the tile, with exclusive maximum. Notifications are serialized, but the order of the tiles is not deterministic.
+         */
+        TEvent<MonteCarloRadianceIntegrator, Eigen::AlignedBox2i> tileCompleted;
+
+        /**
+         * @brief Edge length of the screen tiles that the worker threads render. The tiles are scheduled dynamically in the order of a Hilbert curve.
+         */
+        static constexpr int TileSize = 16;
+
+        /**
+         * @brief Edge length of the blocks of a tile whose primary rays are traced together.
+         */
+        static constexpr int PacketTileSize = 8;
+
     protected:
         /**
          * @brief Renders a Monte Carlo sample.
          * @param scene Scene to render.
          * @param sampler Sampler used to generate random numbers.
          * @param ray Ray to trace.
+         * @param si First intersection of the ray with the scene.
          * @return Radiance and true if the sample was valid.
          */
-        virtual std::pair<Spectrum, bool> sample(const Scene* scene, Sampler* sampler, const RayDifferential3d& ray) const = 0;
+        virtual std::pair<Spectrum, bool> sample(const Scene* scene, Sampler* sampler, const RayDifferential3d& ray, const SurfaceInteraction& si) const = 0;
 
         /**
          * @brief Computes a multiple importance sampling weight using the balance heuristic.
@@ -67,9 +124,47 @@ namespace vislab
          */
         double misWeight(double pdf_a, double pdf_b) const;
 
+        /**
+         * @brief Takes samples in the active pixels of all tiles and writes the updated pixels into the image.
+         * @param scene Scene to render.
+         * @param image Image to render into.
+         * @param tiles Pixel ranges of the tiles, with exclusive maximum.
+         * @param active Flag for each pixel whether it receives samples.
+         * @param pass Index of the pass, which selects the random sequences.
+         * @param deadline Time after which the remaining tiles are skipped, unless it is the first pass.
+         */
+        void renderPass(const Scene* scene, Image3d* image, const std::vector<Eigen::AlignedBox2i>& tiles, const std::vector<uint8_t>& active, size_t pass, std::chrono::steady_clock::time_point deadline);
+
+        /**
+         * @brief Renders the active pixels of a tile one by one.
+         * @param scene Scene to render.
+         * @param camera Camera to render from.
+         * @param tile Pixel range of the tile, with exclusive maximum.
+         * @param active Flag for each pixel whether it receives samples.
+         * @param pass Index of the pass, which selects the random sequences.
+         * @param sampler Sampler of the worker thread, which is reseeded for each pixel.
+         */
+        void renderTile(const Scene* scene, const Camera* camera, const Eigen::AlignedBox2i& tile, const std::vector<uint8_t>& active, size_t pass, Sampler* sampler);
+
+        /**
+         * @brief Renders the active pixels of a tile with packets of primary rays.
+         * @param scene Scene to render.
+         * @param camera Camera to render from.
+         * @param tile Pixel range of the tile, with exclusive maximum.
+         * @param active Flag for each pixel whether it receives samples.
+         * @param pass Index of the pass, which selects the random sequences.
+         * @param samplers Samplers of the worker thread, one per pixel of a tile, which are reseeded for each tile.
+         */
+        void renderTilePackets(const Scene* scene, const Camera* camera, const Eigen::AlignedBox2i& tile, const std::vector<uint8_t>& active, size_t pass, std::vector<std::unique_ptr<Sampler>>& samplers);
+
         /**
          * @brief Number of samples per pixel.
          */
         size_t mSamplesPerPixel;
+
+        /**
+         * @brief Samples of the last rendering.
+         */
+        AccumulationBuffer mAccumulationBuffer;
     };
 }
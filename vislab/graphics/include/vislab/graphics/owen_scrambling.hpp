@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+
+namespace vislab
+{
+    /**
+     * @brief Hash-based Owen scrambling of base-2 digits after Burley, "Practical Hash-based Owen Scrambling", JCGT 2020. Values are 32-bit fixed point numbers in [0,1), with the most significant bit as first digit.
+     */
+    class OwenScrambling
+    {
+    public:
+        /**
+         * @brief Hashes an integer (lowbias32 by Chris Wellons).
+         * @param x Integer to hash.
+         * @return Hash value.
+         */
+        static uint32_t hash(uint32_t x)
+        {
+            x ^= x >> 16;
+            x *= 0x7feb352dU;
+            x ^= x >> 15;
+            x *= 0x846ca68bU;
+            x ^= x >> 16;
+            return x;
+        }
+
+        /**
+         * @brief Combines a seed with another value into a new seed.
+         * @param seed Seed.
+         * @param value Value to combine with.
+         * @return Combined seed.
+         */
+        static uint32_t hashCombine(uint32_t seed, uint32_t value)
+        {
+            return seed ^ (hash(value) + 0x9e3779b9U + (seed << 6) + (seed >> 2));
+        }
+
+        /**
+         * @brief Reverses the order of the bits.
+         * @param x Integer to reverse.
+         * @return Reversed integer.
+         */
+        static uint32_t reverseBits(uint32_t x)
+        {
+            x = ((x >> 1) & 0x55555555U) | ((x & 0x55555555U) << 1);
+            x = ((x >> 2) & 0x33333333U) | ((x & 0x33333333U) << 2);
+            x = ((x >> 4) & 0x0f0f0f0fU) | ((x & 0x0f0f0f0fU) << 4);
+            x = ((x >> 8) & 0x00ff00ffU) | ((x & 0x00ff00ffU) << 8);
+            return (x >> 16) | (x << 16);
+        }
+
+        /**
+         * @brief Owen scrambles a value: each digit is flipped depending on the seed and on all preceding digits. Applied to a sample index, it shuffles the order of a (0,2)-sequence such that each prefix of power-of-two length is still stratified.
+         * @param x Value to scramble.
+         * @param seed Seed of the scrambling.
+         * @return Scrambled value.
+         */
+        static uint32_t nestedUniformScramble(uint32_t x, uint32_t seed)
+        {
+            // Laine-Karras permutation on the reversed bits, in which carries propagate from the first digit to the later ones
+            x = reverseBits(x);
+            x += seed;
+            x ^= x * 0x6c50b47cU;
+            x ^= x * 0xb82f1e52U;
+            x ^= x * 0xc7afe638U;
+            x ^= x * 0x8d22f6e6U;
+            return reverseBits(x);
+        }
+
+        /**
+         * @brief Converts a 32-bit fixed point number to a double in [0,1).
+         * @param x Fixed point number.
+         * @return Double in [0,1).
+         */
+        static double toUnitInterval(uint32_t x)
+        {
+            return x * (1. / 4294967296.);
+        }
+    };
+}
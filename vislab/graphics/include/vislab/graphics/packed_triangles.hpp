@@ -0,0 +1,119 @@
+#pragma once
+
+#include "preliminary_interaction.hpp"
+#include "ray_fwd.hpp"
+
+#include <vislab/core/array_fwd.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vislab
+{
+    /**
+     * @brief Triangles in single precision, stored in blocks of four in structure-of-arrays layout, such that the triangles of a bounding volume hierarchy leaf are contiguous in memory. The intersection test is watertight and tests a whole block at once with SIMD instructions.
+     */
+    class PackedTriangles
+    {
+    public:
+        /**
+         * @brief Number of triangles per block.
+         */
+        static constexpr int BlockSize = 4;
+
+        /**
+         * @brief Block of triangles.
+         */
+        struct alignas(16) Block
+        {
+            /**
+             * @brief Vertex positions, indexed by vertex, coordinate and triangle.
+             */
+            float vertices[3][3][BlockSize];
+
+            /**
+             * @brief Face index of each triangle in the mesh.
+             */
+            uint32_t face[BlockSize];
+        };
+
+        /**
+         * @brief Ray that is prepared for the watertight test by Woop et al., "Watertight Ray/Triangle Intersection", JCGT 2013. The coordinate system is permuted such that the largest direction component is z, and a shear maps the direction to the z-axis.
+         */
+        struct TraversalRay
+        {
+            /**
+             * @brief Constructor.
+             * @param ray Ray to prepare.
+             */
+            explicit TraversalRay(const Ray3d& ray);
+
+            /**
+             * @brief Origin of the ray.
+             */
+            float origin[3];
+
+            /**
+             * @brief Permutation of the coordinates.
+             */
+            int kx, ky, kz;
+
+            /**
+             * @brief Shear and scale that map the direction to the z-axis.
+             */
+            float shear[3];
+        };
+
+        /**
+         * @brief Constructor of an empty set.
+         */
+        PackedTriangles();
+
+        /**
+         * @brief Packs the triangles in the given order.
+         * @param positions Vertex positions.
+         * @param indices Index buffer.
+         * @param faces Face indices in the order in which they are stored.
+         */
+        void build(const Array3f& positions, const Array3ui& indices, const std::vector<uint32_t>& faces);
+
+        /**
+         * @brief Removes all triangles.
+         */
+        void clear();
+
+        /**
+         * @brief Gets the number of triangles.
+         * @return Number of triangles.
+         */
+        uint32_t getSize() const;
+
+        /**
+         * @brief Gets the blocks. The last block is padded with degenerate triangles.
+         * @return Vector of blocks.
+         */
+        const std::vector<Block>& getBlocks() const;
+
+        /**
+         * @brief Intersects a ray with a range of triangles. Hits closer than the current result replace it and shorten the ray.
+         * @param offset Index of the first triangle.
+         * @param count Number of triangles.
+         * @param traversalRay Prepared ray.
+         * @param ray Ray to test against, whose maximal parameter is updated.
+         * @param result Closest intersection found so far.
+         */
+        void intersect(uint32_t offset, uint32_t count, const TraversalRay& traversalRay, Ray3d& ray, PreliminaryIntersection& result) const;
+
+    private:
+        /**
+         * @brief Blocks of triangles.
+         */
+        std::vector<Block> mBlocks;
+
+        /**
+         * @brief Number of triangles.
+         */
+        uint32_t mSize;
+    };
+}
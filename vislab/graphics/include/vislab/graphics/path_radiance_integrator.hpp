@@ -22,9 +22,10 @@ namespace vislab
          * @param scene Scene to render.
          * @param sampler Sampler used to generate random numbers.
          * @param ray Ray to trace.
+         * @param si First intersection of the ray with the scene.
          * @return Radiance and true if the sample was valid.
          */
-        std::pair<Spectrum, bool> sample(const Scene* scene, Sampler* sampler, const RayDifferential3d& ray) const override;
+        std::pair<Spectrum, bool> sample(const Scene* scene, Sampler* sampler, const RayDifferential3d& ray, const SurfaceInteraction& si) const override;
 
         /**
          * @brief Maximum recursive path tracing depth.
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "sampler.hpp"
+
+namespace vislab
+{
+    /**
+     * @brief Independent uniform sampler based on the PCG32 random number generator by O'Neill, "PCG: A Family of Simple Fast Space-Efficient Statistically Good Algorithms for Random Number Generation", 2014. Each seed offset selects its own stream and initial state.
+     */
+    class PCGSampler : public Sampler
+    {
+        VISLAB_OBJECT(PCGSampler, Sampler)
+
+    public:
+        /**
+         * @brief Constructor.
+         */
+        PCGSampler();
+
+        /**
+         * @brief Copy-Constructor.
+         * @param other Sampler to copy from.
+         */
+        PCGSampler(const PCGSampler& other);
+
+        /**
+         * @brief Seeds the random number sequence.
+         * @param seed_offset Seed offset, which selects the stream.
+         */
+        void seed(uint64_t seed_offset = 0) override;
+
+        /**
+         * @brief Generates a random 32-bit integer.
+         * @return Random integer.
+         */
+        uint32_t next_uint32();
+
+        /**
+         * @brief Generates a random number between [0,1].
+         * @return Random number.
+         */
+        double next_1d() override;
+
+        /**
+         * @brief Generates two random numbers between [0,1].
+         * @return Two random numbers.
+         */
+        Eigen::Vector2d next_2d() override;
+
+    private:
+        /**
+         * @brief State of the generator.
+         */
+        uint64_t mState;
+
+        /**
+         * @brief Increment of the generator, which selects the stream. Always odd.
+         */
+        uint64_t mIncrement;
+    };
+}
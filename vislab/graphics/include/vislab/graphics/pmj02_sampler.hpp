@@ -0,0 +1,55 @@
+#pragma once
+
+#include "sampler.hpp"
+
+namespace vislab
+{
+    /**
+     * @brief Progressive multi-jittered (0,2) sampler after Christensen et al., "Progressive Multi-Jittered Sample Sequences", EGSR 2018. The samples are read from a precomputed table of 4096 points, whose prefixes of power-of-two length are stratified in all elementary intervals. Each call of next_1d() or next_2d() reads the table in its own shuffled order with its own random digital shift.
+     */
+    class PMJ02Sampler : public Sampler
+    {
+        VISLAB_OBJECT(PMJ02Sampler, Sampler)
+
+    public:
+        /**
+         * @brief Number of points in the table. Sample indices beyond this wrap around.
+         */
+        static constexpr uint32_t TableSize = 4096;
+
+        /**
+         * @brief Constructor.
+         */
+        PMJ02Sampler();
+
+        /**
+         * @brief Copy-Constructor.
+         * @param other Sampler to copy from.
+         */
+        PMJ02Sampler(const PMJ02Sampler& other);
+
+        /**
+         * @brief Seeds the random number sequence.
+         * @param seed_offset Seed offset, which selects the randomization.
+         */
+        void seed(uint64_t seed_offset = 0) override;
+
+        /**
+         * @brief Generates the next dimension of the current sample.
+         * @return Number in [0,1).
+         */
+        double next_1d() override;
+
+        /**
+         * @brief Generates the next two dimensions of the current sample.
+         * @return Two numbers in [0,1).
+         */
+        Eigen::Vector2d next_2d() override;
+
+    private:
+        /**
+         * @brief Seed of the randomization, derived from the base seed and the seed offset.
+         */
+        uint32_t mScramblingSeed;
+    };
+}
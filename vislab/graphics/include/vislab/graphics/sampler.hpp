@@ -15,13 +15,13 @@ namespace vislab
 
     public:
         /**
-         * @brief Seeds the random number sequence.
+         * @brief Seeds the random number sequence. This starts the first sample of a pixel.
          * @param seed_offset Seed offset of the sequence.
          */
         virtual void seed(uint64_t seed_offset);
 
         /**
-         * @brief Advances the sample index.
+         * @brief Advances the sample index and starts again with the first dimension.
          */
         void advance();
 
@@ -37,6 +37,18 @@ namespace vislab
          */
         uint32_t getSampleCount() const;
 
+        /**
+         * @brief Sets the total number of samples.
+         * @param sampleCount Total number of samples.
+         */
+        void setSampleCount(uint32_t sampleCount);
+
+        /**
+         * @brief Gets the number of dimensions that were drawn for the current sample. Each call of next_1d() or next_2d() counts as one dimension.
+         * @return Dimension index.
+         */
+        uint32_t getDimensionIndex() const;
+
         /**
          * @brief Gets the base seed of the sequence.
          * @return Base seed of sequence.
@@ -87,5 +99,10 @@ namespace vislab
          * @brief Index of the current sample.
          */
         uint32_t mSampleIndex;
+
+        /**
+         * @brief Index of the next dimension of the current sample.
+         */
+        uint32_t mDimensionIndex;
     };
 }
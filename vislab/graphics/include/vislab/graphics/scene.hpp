@@ -1,10 +1,12 @@
 #pragma once
 
-#include "bounding_volume_hierarchy.hpp"
+#include "acceleration_tree_type.hpp"
+#include "flat_bounding_volume_hierarchy.hpp"
 #include "direction_sample.hpp"
 #include "ray_fwd.hpp"
 #include "spectrum.hpp"
 #include "surface_interaction.hpp"
+#include "wide_bounding_volume_hierarchy.hpp"
 
 #include <vislab/core/data.hpp>
 
@@ -25,6 +27,11 @@ namespace vislab
         VISLAB_OBJECT(Scene, Data)
 
     public:
+        /**
+         * @brief Constructor.
+         */
+        Scene();
+
         /**
          * @brief Computes the ray intersection with the shapes in the scene.
          * @param ray Ray to compute intersection with.
@@ -39,6 +46,22 @@ namespace vislab
          */
         bool anyHit(const Ray3d& ray) const;
 
+        /**
+         * @brief Computes the ray intersections of coherent rays, such as the primary rays of a screen tile. With the wide acceleration data structure, the rays traverse the tree together as packets.
+         * @param rays Rays to compute intersections with.
+         * @param count Number of rays.
+         * @param results Receives the surface interaction of each ray.
+         */
+        void intersect(const Ray3d* rays, size_t count, SurfaceInteraction* results) const;
+
+        /**
+         * @brief Determines for coherent rays, such as shadow rays from one point, whether they hit any shape. With the wide acceleration data structure, the rays traverse the tree together as packets.
+         * @param rays Rays to compute intersections with.
+         * @param count Number of rays.
+         * @param hits Receives for each ray whether it hit a shape.
+         */
+        void anyHit(const Ray3d* rays, size_t count, bool* hits) const;
+
         /**
          * @brief Given an arbitrary reference point in the scene, this method samples a direction from the reference point to towards an emitter.
          * @param it Interaction to start the ray towards the light from.
@@ -56,6 +79,16 @@ namespace vislab
          */
         double pdfLightDirection(const Interaction& it, const DirectionSample& ds) const;
 
+        /**
+         * @brief Samples several directions from one reference point towards emitters, like sampleLightDirection(). The visibility of all samples is tested with one batch of shadow rays.
+         * @param it Interaction to start the rays towards the lights from.
+         * @param samples Uniformly distributed random numbers in [0,1]^2, one per direction.
+         * @param count Number of directions to sample.
+         * @param ds Receives the direction samples.
+         * @param spec Receives the evaluations of the lights, which are zero for occluded samples.
+         */
+        void sampleLightDirections(const Interaction& it, const Eigen::Vector2d* samples, size_t count, DirectionSample* ds, Spectrum* spec) const;
+
         /**
          * @brief Collection of shapes in the scene.
          */
@@ -77,14 +110,30 @@ namespace vislab
         std::shared_ptr<Camera> camera;
 
         /**
-         * @brief Rebuilds the ray traversal acceleration data structure.
+         * @brief Layout of the ray traversal acceleration data structure over the shapes. Takes effect with the next call to buildAccelerationTree().
+         */
+        EAccelerationTreeType accelerationTreeType;
+
+        /**
+         * @brief Rebuilds the top-level ray traversal acceleration data structure over the shapes. The bottom-level trees of the shapes are only built if they do not exist yet, such that instances of a shared mesh reuse its tree.
          */
         void buildAccelerationTree();
 
+        /**
+         * @brief Refits the ray traversal acceleration data structure to shapes that moved. The tree is rebuilt if it was not built yet, the shapes were exchanged, or the tree quality degraded too much. Meshes refit their own trees when their positionsChanged event is raised.
+         * @return True if the tree was rebuilt.
+         */
+        bool updateAccelerationTree();
+
     private:
         /**
          * @brief Bounding volume hierarchy for fast ray traversal.
          */
-        std::shared_ptr<BoundingVolumeHierarchy<Shape, 3>> mBoundingVolumeHierarchy;
+        std::shared_ptr<FlatBoundingVolumeHierarchy<Shape>> mBoundingVolumeHierarchy;
+
+        /**
+         * @brief Four-wide bounding volume hierarchy that is collapsed from the binary one, if selected by accelerationTreeType.
+         */
+        std::shared_ptr<WideBoundingVolumeHierarchy<Shape>> mWideBoundingVolumeHierarchy;
     };
 }
@@ -76,7 +76,7 @@ namespace vislab
          * @param ray Ray to test against.
          * @return Number of intersections with the shape.
          */
-        int32_t countHits(const Ray3d& ray) const;
+        virtual int32_t countHits(const Ray3d& ray) const;
 
         /**
          * @brief Compute and return detailed information related to a surface interaction.
@@ -118,6 +118,12 @@ namespace vislab
          */
         virtual void buildAccelerationTree();
 
+        /**
+         * @brief Checks whether the ray traversal acceleration data structure was built. Shapes that share their geometry with other shapes also share the acceleration data structure.
+         * @return True if the acceleration data structure was built or the shape does not need one.
+         */
+        virtual bool hasAccelerationTree() const;
+
         /**
          * @brief Transformation of a shape from object space to world space.
          */
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "sampler.hpp"
+
+namespace vislab
+{
+    /**
+     * @brief Low-discrepancy sampler based on the first two dimensions of the Sobol sequence, which form a (0,2)-sequence, with hash-based Owen scrambling (Burley, "Practical Hash-based Owen Scrambling", JCGT 2020). Each call of next_1d() or next_2d() draws from its own randomization of the sequence, whose order is shuffled to decorrelate the dimensions. All prefixes of power-of-two length are stratified in each pair of dimensions.
+     */
+    class SobolSampler : public Sampler
+    {
+        VISLAB_OBJECT(SobolSampler, Sampler)
+
+    public:
+        /**
+         * @brief Constructor.
+         */
+        SobolSampler();
+
+        /**
+         * @brief Copy-Constructor.
+         * @param other Sampler to copy from.
+         */
+        SobolSampler(const SobolSampler& other);
+
+        /**
+         * @brief Seeds the random number sequence.
+         * @param seed_offset Seed offset, which selects the randomization.
+         */
+        void seed(uint64_t seed_offset = 0) override;
+
+        /**
+         * @brief Generates the next dimension of the current sample.
+         * @return Number in [0,1).
+         */
+        double next_1d() override;
+
+        /**
+         * @brief Generates the next two dimensions of the current sample.
+         * @return Two numbers in [0,1).
+         */
+        Eigen::Vector2d next_2d() override;
+
+    private:
+        /**
+         * @brief Seed of the randomization, derived from the base seed and the seed offset.
+         */
+        uint32_t mScramblingSeed;
+    };
+}
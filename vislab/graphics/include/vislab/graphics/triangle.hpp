@@ -58,6 +58,13 @@ namespace vislab
          */
         PreliminaryIntersection preliminaryHit(const Ray3d& ray) const override;
 
+        /**
+         * @brief Counts the number of hits. The ray is transformed once into object space and traverses the mesh.
+         * @param ray Ray to test against.
+         * @return Number of intersections with the shape.
+         */
+        int32_t countHits(const Ray3d& ray) const override;
+
         /**
          * @brief Compute and return detailed information related to a surface interaction.
          * @param ray Ray to test against.
@@ -84,6 +91,12 @@ namespace vislab
          */
         void buildAccelerationTree() override;
 
+        /**
+         * @brief Checks whether the ray traversal acceleration data structure of the mesh was built, possibly by another shape that references the same mesh.
+         * @return True if the acceleration data structure was built.
+         */
+        bool hasAccelerationTree() const override;
+
         /**
          * @brief Mesh
          */
@@ -0,0 +1,820 @@
+#pragma once
+
+#include "flat_bounding_volume_hierarchy.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VISLAB_WIDE_BVH_SSE
+#include <emmintrin.h>
+#endif
+
+namespace vislab
+{
+    /**
+     * @brief Bounding volume hierarchy with four children per node, which is collapsed from a binary FlatBoundingVolumeHierarchy. The bounding boxes of the children are stored per coordinate, such that one SIMD slab test intersects the ray with all of them.
+     * @tparam TShape Type of shapes stored in the hierarchy. Needs the functions worldBounds(), preliminaryHit() and anyHit().
+     */
+    template <class TShape>
+    class WideBoundingVolumeHierarchy
+    {
+    public:
+        /**
+         * @brief Number of children per node.
+         */
+        static constexpr int Width = 4;
+
+        /**
+         * @brief Maximum number of rays that traverse the tree together. Larger batches are split into several packets.
+         */
+        static constexpr int MaxPacketSize = 64;
+
+        /**
+         * @brief Node with the bounding boxes of its children in structure-of-arrays layout.
+         */
+        struct alignas(64) Node
+        {
+            /**
+             * @brief Lower corners of the child bounding boxes, indexed by coordinate and child. Unused children have an empty box.
+             */
+            float min[3][Width];
+
+            /**
+             * @brief Upper corners of the child bounding boxes, indexed by coordinate and child.
+             */
+            float max[3][Width];
+
+            /**
+             * @brief Index of the child node for inner children, or index of the first primitive for leaves.
+             */
+            uint32_t offset[Width];
+
+            /**
+             * @brief Number of primitives of leaf children. Zero for inner and unused children.
+             */
+            uint16_t count[Width];
+        };
+        static_assert(sizeof(Node) == 128, "Nodes are expected to fill two cache lines.");
+
+        /**
+         * @brief Constructor of an empty tree.
+         */
+        WideBoundingVolumeHierarchy() {}
+
+        /**
+         * @brief Gets the nodes. The root is the first node.
+         * @return Vector of nodes.
+         */
+        const std::vector<Node>& getNodes() const { return mNodes; }
+
+        /**
+         * @brief Collapses a binary tree. Inner children with the largest surface area are opened until a node has four children. Needs to be called again after the binary tree was rebuilt. After a refit of the binary tree, refit() suffices.
+         * @param tree Binary tree, which has to outlive this tree since its shapes are referenced.
+         */
+        void build(const FlatBoundingVolumeHierarchy<TShape>& tree)
+        {
+            mNodes.clear();
+            mBinaryChildren.clear();
+            mShapes = tree.getOrderedShapes().data();
+            if (tree.getNodes().empty())
+                return;
+            mNodes.reserve(tree.getNodes().size() / 2 + 1);
+            mBinaryChildren.reserve(mNodes.capacity());
+            collapse(tree.getNodes(), 0);
+        }
+
+        /**
+         * @brief Copies the bounding boxes of a refitted binary tree into the nodes, without reallocating them. The binary tree must have the topology it had in the last call to build().
+         * @param tree Binary tree that was refitted.
+         */
+        void refit(const FlatBoundingVolumeHierarchy<TShape>& tree)
+        {
+            const auto& binaryNodes = tree.getNodes();
+            for (size_t n = 0; n < mNodes.size(); ++n)
+                for (int c = 0; c < Width; ++c)
+                {
+                    uint32_t binaryIndex = mBinaryChildren[n][c];
+                    if (binaryIndex == UnusedChild)
+                        continue;
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        mNodes[n].min[i][c] = binaryNodes[binaryIndex].min[i];
+                        mNodes[n].max[i][c] = binaryNodes[binaryIndex].max[i];
+                    }
+                }
+        }
+
+        /**
+         * @brief Fast ray intersection test. To obtain further information about the intersection, use ComputeSurfaceInteraction().
+         * @param ray Ray to test against.
+         * @return Intersection result.
+         */
+        PreliminaryIntersection preliminaryHit(const Ray3d& ray) const
+        {
+            return preliminaryHit(ray, [this](uint32_t offset, uint32_t count, Ray3d& ray, PreliminaryIntersection& result)
+                                  {
+                                      for (uint32_t i = offset; i < offset + count; ++i)
+                                      {
+                                          PreliminaryIntersection pi = mShapes[i]->preliminaryHit(ray);
+                                          if (pi.isValid() && pi.t < result.t)
+                                          {
+                                              result   = pi;
+                                              ray.tMax = pi.t;
+                                          }
+                                      }
+                                  });
+        }
+
+        /**
+         * @brief Fast ray intersection test with a custom test for the primitives of the leaves, e.g., for primitives that are stored in the order of FlatBoundingVolumeHierarchy::getOrderedShapes().
+         * @tparam TLeafIntersector Function that receives the offset and count of the leaf primitives, the ray and the closest intersection so far. Closer hits replace the intersection and shorten the ray.
+         * @param ray Ray to test against.
+         * @param intersectLeaf Function to call for each intersected leaf.
+         * @return Intersection result.
+         */
+        template <typename TLeafIntersector>
+        PreliminaryIntersection preliminaryHit(const Ray3d& ray, TLeafIntersector&& intersectLeaf) const
+        {
+            PreliminaryIntersection result;
+            if (mNodes.empty())
+                return result;
+
+            Ray3d ray_ = ray;
+            TraversalRay traversalRay(ray);
+            float tMax = roundUp(ray_.tMax);
+            StackEntry stack[StackSize];
+            int stackSize = 0;
+            stack[stackSize++] = { 0, 0, traversalRay.tMin };
+            while (stackSize > 0)
+            {
+                StackEntry entry = stack[--stackSize];
+                if (entry.t > tMax)
+                    continue;
+
+                if (entry.count > 0)
+                {
+                    intersectLeaf(entry.offset, entry.count, ray_, result);
+                    tMax = roundUp(ray_.tMax);
+                    continue;
+                }
+
+                // push the intersected children from far to near, such that the nearest one is visited next
+                const Node& node = mNodes[entry.offset];
+                float tNear[Width];
+                int hits[Width];
+                int numHits = sortedHits(intersect(node, traversalRay, tMax, tNear), tNear, hits);
+                for (int i = numHits - 1; i >= 0; --i)
+                    stack[stackSize++] = { node.offset[hits[i]], node.count[hits[i]], tNear[hits[i]] };
+            }
+            return result;
+        }
+
+        /**
+         * @brief Fast ray shadow test.
+         * @param ray Ray to test against.
+         * @return True if there was a hit.
+         */
+        bool anyHit(const Ray3d& ray) const
+        {
+            bool hit = false;
+            traverse(ray, [&hit](const TShape* shape, const Ray3d& ray)
+                     { hit = shape->anyHit(ray); return !hit; });
+            return hit;
+        }
+
+        /**
+         * @brief Counts the number of shapes that are intersected by the ray within [tMin, tMax].
+         * @param ray Ray to test against.
+         * @return Number of intersected shapes.
+         */
+        int32_t countHits(const Ray3d& ray) const
+        {
+            int32_t hits = 0;
+            traverse(ray, [&hits](const TShape* shape, const Ray3d& ray)
+                     { hits += shape->preliminaryHit(ray).isValid() ? 1 : 0; return true; });
+            return hits;
+        }
+
+        /**
+         * @brief Fast ray intersection test for coherent rays, such as the primary rays of a screen tile. The rays traverse the tree together, which culls nodes that no ray of the packet can intersect with one test.
+         * @param rays Rays to test against.
+         * @param count Number of rays.
+         * @param results Receives the intersection result of each ray.
+         */
+        void preliminaryHit(const Ray3d* rays, int count, PreliminaryIntersection* results) const
+        {
+            Ray3d packet[MaxPacketSize];
+            for (int begin = 0; begin < count; begin += MaxPacketSize)
+            {
+                int size = std::min(count - begin, MaxPacketSize);
+                for (int r = 0; r < size; ++r)
+                {
+                    packet[r]          = rays[begin + r];
+                    results[begin + r] = PreliminaryIntersection();
+                }
+                PreliminaryIntersection* packetResults = results + begin;
+                traversePacket(packet, size, [&packet, packetResults](const TShape* shape, int r)
+                               {
+                                   PreliminaryIntersection pi = shape->preliminaryHit(packet[r]);
+                                   if (pi.isValid() && pi.t < packetResults[r].t)
+                                   {
+                                       packetResults[r] = pi;
+                                       packet[r].tMax   = pi.t;
+                                   }
+                               });
+            }
+        }
+
+        /**
+         * @brief Fast shadow test for coherent rays, such as shadow rays from one point towards a light source.
+         * @param rays Rays to test against.
+         * @param count Number of rays.
+         * @param hits Receives for each ray whether there was a hit.
+         */
+        void anyHit(const Ray3d* rays, int count, bool* hits) const
+        {
+            Ray3d packet[MaxPacketSize];
+            for (int begin = 0; begin < count; begin += MaxPacketSize)
+            {
+                int size = std::min(count - begin, MaxPacketSize);
+                for (int r = 0; r < size; ++r)
+                {
+                    packet[r]       = rays[begin + r];
+                    hits[begin + r] = false;
+                }
+                bool* packetHits = hits + begin;
+                traversePacket(packet, size, [&packet, packetHits](const TShape* shape, int r)
+                               {
+                                   // an empty ray interval retires the ray from the traversal
+                                   if (shape->anyHit(packet[r]))
+                                   {
+                                       packetHits[r]  = true;
+                                       packet[r].tMax = -std::numeric_limits<double>::infinity();
+                                   }
+                               });
+            }
+        }
+
+        /**
+         * @brief Slab test of a ray against the bounding boxes of all children of a node.
+         * @param node Node whose children are tested.
+         * @param origin Origin of the ray.
+         * @param inverseDirection Reciprocal of the ray direction.
+         * @param tMin Minimal ray parameter.
+         * @param tMax Maximal ray parameter.
+         * @param tNear Receives the entry distance of each child.
+         * @return Bit mask of the intersected children.
+         */
+        static int intersect(const Node& node, const Eigen::Vector3f& origin, const Eigen::Vector3f& inverseDirection, float tMin, float tMax, float tNear[Width])
+        {
+            TraversalRay ray;
+            for (int k = 0; k < 3; ++k)
+            {
+                ray.origin[k]           = origin[k];
+                ray.inverseDirection[k] = inverseDirection[k];
+                ray.negative[k]         = inverseDirection[k] < 0;
+            }
+            ray.tMin = tMin;
+            return intersect(node, ray, tMax, tNear);
+        }
+
+    private:
+        /**
+         * @brief Ray in single precision with precomputed reciprocal direction.
+         */
+        struct TraversalRay
+        {
+            /**
+             * @brief Constructor of an uninitialized ray.
+             */
+            TraversalRay() {}
+
+            /**
+             * @brief Constructor.
+             * @param ray Ray to convert.
+             */
+            explicit TraversalRay(const Ray3d& ray)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    origin[i]           = (float)ray.origin[i];
+                    inverseDirection[i] = (float)(1. / ray.direction[i]);
+                    negative[i]         = inverseDirection[i] < 0;
+                }
+                tMin = roundDown(ray.tMin);
+            }
+
+            /**
+             * @brief Origin of the ray.
+             */
+            float origin[3];
+
+            /**
+             * @brief Reciprocal of the ray direction.
+             */
+            float inverseDirection[3];
+
+            /**
+             * @brief Flags that determine for each axis whether the direction is negative.
+             */
+            bool negative[3];
+
+            /**
+             * @brief Minimal ray parameter.
+             */
+            float tMin;
+        };
+
+        /**
+         * @brief Postponed child on the traversal stack.
+         */
+        struct StackEntry
+        {
+            /**
+             * @brief Index of the node, or of the first primitive for leaves.
+             */
+            uint32_t offset;
+
+            /**
+             * @brief Number of primitives of a leaf. Zero for inner nodes.
+             */
+            uint32_t count;
+
+            /**
+             * @brief Entry distance of the ray into the bounding box.
+             */
+            float t;
+        };
+
+        /**
+         * @brief Bounds of the origins and reciprocal directions of a ray packet, which give conservative bounds for the entry and exit distances of all rays.
+         */
+        struct Frustum
+        {
+            /**
+             * @brief Constructor.
+             * @param packet Rays of the packet.
+             * @param tMax Maximal ray parameter of each ray.
+             * @param count Number of rays.
+             */
+            Frustum(const TraversalRay* packet, const float* tMax, int count)
+            {
+                tMin       = packet[0].tMin;
+                this->tMax = tMax[0];
+                for (int i = 0; i < 3; ++i)
+                {
+                    originMin[i]  = packet[0].origin[i];
+                    originMax[i]  = packet[0].origin[i];
+                    inverseMin[i] = packet[0].inverseDirection[i];
+                    inverseMax[i] = packet[0].inverseDirection[i];
+                    negative[i]   = packet[0].negative[i];
+                    valid[i]      = std::isfinite(packet[0].inverseDirection[i]);
+                }
+                for (int r = 1; r < count; ++r)
+                {
+                    tMin       = std::min(tMin, packet[r].tMin);
+                    this->tMax = std::max(this->tMax, tMax[r]);
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        originMin[i]  = std::min(originMin[i], packet[r].origin[i]);
+                        originMax[i]  = std::max(originMax[i], packet[r].origin[i]);
+                        inverseMin[i] = std::min(inverseMin[i], packet[r].inverseDirection[i]);
+                        inverseMax[i] = std::max(inverseMax[i], packet[r].inverseDirection[i]);
+                        valid[i]      = valid[i] && packet[r].negative[i] == negative[i] && std::isfinite(packet[r].inverseDirection[i]);
+                    }
+                }
+            }
+
+            /**
+             * @brief Conservative test whether any ray of the packet intersects the children of a node. Axes along which the directions change their sign do not cull.
+             * @param node Node whose children are tested.
+             * @return Bit mask of the children that may be intersected.
+             */
+            int intersect(const Node& node) const
+            {
+                // the interval products bound the slab distances of each ray, since the rounding is monotonic
+                const float gamma3 = 3 * std::numeric_limits<float>::epsilon() * 0.5f / (1 - 3 * std::numeric_limits<float>::epsilon() * 0.5f);
+#ifdef VISLAB_WIDE_BVH_SSE
+                __m128 entry = _mm_set1_ps(tMin);
+                __m128 exit  = _mm_set1_ps(tMax);
+                for (int i = 0; i < 3; ++i)
+                {
+                    if (!valid[i])
+                        continue;
+                    __m128 near       = _mm_load_ps(negative[i] ? node.max[i] : node.min[i]);
+                    __m128 far        = _mm_load_ps(negative[i] ? node.min[i] : node.max[i]);
+                    __m128 inverseMin = _mm_set1_ps(this->inverseMin[i]);
+                    __m128 inverseMax = _mm_set1_ps(this->inverseMax[i]);
+                    __m128 near0      = _mm_sub_ps(near, _mm_set1_ps(originMax[i]));
+                    __m128 near1      = _mm_sub_ps(near, _mm_set1_ps(originMin[i]));
+                    __m128 far0       = _mm_sub_ps(far, _mm_set1_ps(originMax[i]));
+                    __m128 far1       = _mm_sub_ps(far, _mm_set1_ps(originMin[i]));
+                    __m128 t0         = _mm_min_ps(_mm_min_ps(_mm_mul_ps(near0, inverseMin), _mm_mul_ps(near0, inverseMax)), _mm_min_ps(_mm_mul_ps(near1, inverseMin), _mm_mul_ps(near1, inverseMax)));
+                    __m128 t1         = _mm_max_ps(_mm_max_ps(_mm_mul_ps(far0, inverseMin), _mm_mul_ps(far0, inverseMax)), _mm_max_ps(_mm_mul_ps(far1, inverseMin), _mm_mul_ps(far1, inverseMax)));
+                    entry             = _mm_max_ps(t0, entry);
+                    exit              = _mm_min_ps(_mm_mul_ps(t1, _mm_set1_ps(1 + 2 * gamma3)), exit);
+                }
+                return _mm_movemask_ps(_mm_cmple_ps(entry, exit));
+#else
+                int mask = 0;
+                for (int c = 0; c < Width; ++c)
+                {
+                    float entry = tMin;
+                    float exit  = tMax;
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        if (!valid[i])
+                            continue;
+                        float near  = negative[i] ? node.max[i][c] : node.min[i][c];
+                        float far   = negative[i] ? node.min[i][c] : node.max[i][c];
+                        float near0 = near - originMax[i];
+                        float near1 = near - originMin[i];
+                        float far0  = far - originMax[i];
+                        float far1  = far - originMin[i];
+                        float t0    = std::min(std::min(near0 * inverseMin[i], near0 * inverseMax[i]), std::min(near1 * inverseMin[i], near1 * inverseMax[i]));
+                        float t1    = std::max(std::max(far0 * inverseMin[i], far0 * inverseMax[i]), std::max(far1 * inverseMin[i], far1 * inverseMax[i]));
+                        t1 *= 1 + 2 * gamma3;
+                        entry = t0 > entry ? t0 : entry;
+                        exit  = t1 < exit ? t1 : exit;
+                    }
+                    if (entry <= exit)
+                        mask |= 1 << c;
+                }
+                return mask;
+#endif
+            }
+
+            /**
+             * @brief Bounds of the ray origins.
+             */
+            float originMin[3], originMax[3];
+
+            /**
+             * @brief Bounds of the reciprocal ray directions.
+             */
+            float inverseMin[3], inverseMax[3];
+
+            /**
+             * @brief Common sign of the directions along each axis.
+             */
+            bool negative[3];
+
+            /**
+             * @brief Flags that determine for each axis whether all directions have the same sign and are not parallel to the axis.
+             */
+            bool valid[3];
+
+            /**
+             * @brief Smallest minimal and largest maximal ray parameter.
+             */
+            float tMin, tMax;
+        };
+
+        /**
+         * @brief Postponed child on the packet traversal stack.
+         */
+        struct PacketStackEntry
+        {
+            /**
+             * @brief Index of the parent node, or of the root if the slot is negative.
+             */
+            uint32_t node;
+
+            /**
+             * @brief Index of the child in the parent node.
+             */
+            int slot;
+
+            /**
+             * @brief Index of the first ray of the packet that intersects the child. Rays before it miss the child.
+             */
+            int first;
+        };
+
+        /**
+         * @brief Size of the traversal stack. Each visited node replaces its entry by at most four.
+         */
+        static constexpr int StackSize = (Width - 1) * FlatBoundingVolumeHierarchy<TShape>::MaxDepth + 1;
+
+        /**
+         * @brief Conservative slab test of a ray against the bounding boxes of all children of a node.
+         * @param node Node whose children are tested.
+         * @param ray Ray to test.
+         * @param tMax Maximal ray parameter.
+         * @param tNear Receives the entry distance of each child.
+         * @return Bit mask of the intersected children.
+         */
+        static int intersect(const Node& node, const TraversalRay& ray, float tMax, float tNear[Width])
+        {
+            // enlarge the exit distance to compensate for rounding errors, see Pharr et al., Physically Based Rendering, Sec. 3.9
+            const float gamma3 = 3 * std::numeric_limits<float>::epsilon() * 0.5f / (1 - 3 * std::numeric_limits<float>::epsilon() * 0.5f);
+#ifdef VISLAB_WIDE_BVH_SSE
+            __m128 near = _mm_set1_ps(ray.tMin);
+            __m128 far  = _mm_set1_ps(tMax);
+            for (int i = 0; i < 3; ++i)
+            {
+                __m128 origin           = _mm_set1_ps(ray.origin[i]);
+                __m128 inverseDirection = _mm_set1_ps(ray.inverseDirection[i]);
+                __m128 t0               = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(ray.negative[i] ? node.max[i] : node.min[i]), origin), inverseDirection);
+                __m128 t1               = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(ray.negative[i] ? node.min[i] : node.max[i]), origin), inverseDirection);
+                t1                      = _mm_mul_ps(t1, _mm_set1_ps(1 + 2 * gamma3));
+
+                // the second operand is returned for NaNs (ray in the plane of a slab), which keeps the previous value
+                near = _mm_max_ps(t0, near);
+                far  = _mm_min_ps(t1, far);
+            }
+            _mm_storeu_ps(tNear, near);
+            return _mm_movemask_ps(_mm_cmple_ps(near, far));
+#else
+            int mask = 0;
+            for (int c = 0; c < Width; ++c)
+            {
+                float near = ray.tMin;
+                float far  = tMax;
+                for (int i = 0; i < 3; ++i)
+                {
+                    float t0 = ((ray.negative[i] ? node.max[i][c] : node.min[i][c]) - ray.origin[i]) * ray.inverseDirection[i];
+                    float t1 = ((ray.negative[i] ? node.min[i][c] : node.max[i][c]) - ray.origin[i]) * ray.inverseDirection[i];
+                    t1 *= 1 + 2 * gamma3;
+
+                    // written such that NaNs (ray in the plane of a slab) keep the previous value
+                    near = t0 > near ? t0 : near;
+                    far  = t1 < far ? t1 : far;
+                }
+                tNear[c] = near;
+                if (near <= far)
+                    mask |= 1 << c;
+            }
+            return mask;
+#endif
+        }
+
+        /**
+         * @brief Lists the intersected children ordered by their entry distance.
+         * @param mask Bit mask of the intersected children.
+         * @param tNear Entry distance of each child.
+         * @param hits Receives the indices of the intersected children, nearest first.
+         * @return Number of intersected children.
+         */
+        static int sortedHits(int mask, const float tNear[Width], int hits[Width])
+        {
+            int numHits = 0;
+            for (int c = 0; c < Width; ++c)
+            {
+                if (!(mask & (1 << c)))
+                    continue;
+
+                // insertion sort, since there are at most four entries
+                int i = numHits++;
+                while (i > 0 && tNear[hits[i - 1]] > tNear[c])
+                {
+                    hits[i] = hits[i - 1];
+                    i--;
+                }
+                hits[i] = c;
+            }
+            return numHits;
+        }
+
+        /**
+         * @brief Visits all shapes in leaves whose bounding box is intersected by the ray.
+         * @tparam TVisitor Function that receives the shape and the ray and returns false to stop the traversal.
+         * @param ray Ray to test against.
+         * @param visitor Function to call for each shape.
+         */
+        template <typename TVisitor>
+        void traverse(const Ray3d& ray, TVisitor&& visitor) const
+        {
+            if (mNodes.empty())
+                return;
+
+            TraversalRay traversalRay(ray);
+            float tMax = roundUp(ray.tMax);
+            StackEntry stack[StackSize];
+            int stackSize = 0;
+            stack[stackSize++] = { 0, 0, traversalRay.tMin };
+            while (stackSize > 0)
+            {
+                StackEntry entry = stack[--stackSize];
+                if (entry.count > 0)
+                {
+                    for (uint32_t i = entry.offset; i < entry.offset + entry.count; ++i)
+                        if (!visitor(mShapes[i], ray))
+                            return;
+                    continue;
+                }
+
+                const Node& node = mNodes[entry.offset];
+                float tNear[Width];
+                int mask = intersect(node, traversalRay, tMax, tNear);
+                for (int c = 0; c < Width; ++c)
+                    if (mask & (1 << c))
+                        stack[stackSize++] = { node.offset[c], node.count[c], tNear[c] };
+            }
+        }
+
+        /**
+         * @brief Traverses the tree with a packet of rays. For each child only the rays from the first one that intersects it onwards are considered, and children are culled for the whole packet if the frustum misses them.
+         * @tparam TLeafTest Function that receives a shape and the index of a ray whose interval overlaps the leaf. It shortens the ray on a hit, or empties the interval to retire the ray.
+         * @param rays Rays of the packet. Their maximal parameter is updated by the leaf test.
+         * @param count Number of rays, at most MaxPacketSize.
+         * @param leafTest Function to call for each shape in an intersected leaf.
+         */
+        template <typename TLeafTest>
+        void traversePacket(Ray3d* rays, int count, TLeafTest&& leafTest) const
+        {
+            if (mNodes.empty() || count == 0)
+                return;
+
+            TraversalRay packet[MaxPacketSize];
+            float tMax[MaxPacketSize];
+            for (int r = 0; r < count; ++r)
+            {
+                packet[r] = TraversalRay(rays[r]);
+                tMax[r]   = roundUp(rays[r].tMax);
+            }
+            Frustum frustum(packet, tMax, count);
+
+            PacketStackEntry stack[StackSize];
+            int stackSize      = 0;
+            stack[stackSize++] = { 0, -1, 0 };
+            while (stackSize > 0)
+            {
+                PacketStackEntry entry = stack[--stackSize];
+                uint32_t nodeIndex     = entry.node;
+                if (entry.slot >= 0)
+                {
+                    const Node& parent = mNodes[entry.node];
+                    if (parent.count[entry.slot] > 0)
+                    {
+                        // each remaining ray that intersects the leaf tests its shapes
+                        uint32_t begin = parent.offset[entry.slot];
+                        uint32_t end   = begin + parent.count[entry.slot];
+                        for (int r = entry.first; r < count; ++r)
+                        {
+                            float tNear[Width];
+                            if (!(intersect(parent, packet[r], tMax[r], tNear) & (1 << entry.slot)))
+                                continue;
+                            for (uint32_t i = begin; i < end && rays[r].tMin <= rays[r].tMax; ++i)
+                                leafTest(mShapes[i], r);
+                            tMax[r] = roundUp(rays[r].tMax);
+                        }
+                        continue;
+                    }
+                    nodeIndex = parent.offset[entry.slot];
+                }
+
+                // find the first ray that intersects each child, starting with the children that the frustum may intersect
+                const Node& node = mNodes[nodeIndex];
+                int remaining    = frustum.intersect(node);
+                int mask         = 0;
+                int first[Width];
+                float tFirst[Width];
+                for (int r = entry.first; r < count && remaining != 0; ++r)
+                {
+                    float tNear[Width];
+                    int hit = intersect(node, packet[r], tMax[r], tNear) & remaining;
+                    for (int c = 0; c < Width; ++c)
+                        if (hit & (1 << c))
+                        {
+                            first[c]  = r;
+                            tFirst[c] = tNear[c];
+                        }
+                    remaining &= ~hit;
+                    mask |= hit;
+                }
+
+                // visit the children in the order in which their first ray enters them
+                int hits[Width];
+                int numHits = sortedHits(mask, tFirst, hits);
+                for (int i = numHits - 1; i >= 0; --i)
+                    stack[stackSize++] = { nodeIndex, hits[i], first[hits[i]] };
+            }
+        }
+
+        /**
+         * @brief Recursively creates the wide node for a binary inner node.
+         * @param binaryNodes Nodes of the binary tree.
+         * @param binaryIndex Index of the binary node. It may be a leaf only for the root.
+         * @return Index of the created node.
+         */
+        uint32_t collapse(const std::vector<typename FlatBoundingVolumeHierarchy<TShape>::Node>& binaryNodes, uint32_t binaryIndex)
+        {
+            uint32_t nodeIndex = (uint32_t)mNodes.size();
+            mNodes.emplace_back();
+            mBinaryChildren.emplace_back();
+
+            // open the inner child with the largest surface area until the node is full
+            uint32_t children[Width];
+            int numChildren = 0;
+            if (binaryNodes[binaryIndex].isLeaf())
+                children[numChildren++] = binaryIndex;
+            else
+            {
+                children[numChildren++] = binaryIndex + 1;
+                children[numChildren++] = binaryNodes[binaryIndex].offset;
+            }
+            while (numChildren < Width)
+            {
+                int largest     = -1;
+                float largestArea = -1;
+                for (int c = 0; c < numChildren; ++c)
+                {
+                    const auto& child = binaryNodes[children[c]];
+                    if (child.isLeaf())
+                        continue;
+                    float dx   = child.max[0] - child.min[0];
+                    float dy   = child.max[1] - child.min[1];
+                    float dz   = child.max[2] - child.min[2];
+                    float area = dx * dy + dx * dz + dy * dz;
+                    if (area > largestArea)
+                    {
+                        largest     = c;
+                        largestArea = area;
+                    }
+                }
+                if (largest < 0)
+                    break;
+                uint32_t opened         = children[largest];
+                children[largest]       = opened + 1;
+                children[numChildren++] = binaryNodes[opened].offset;
+            }
+
+            // children are created recursively, which may reallocate the nodes
+            Node node;
+            for (int c = 0; c < Width; ++c)
+            {
+                if (c >= numChildren)
+                {
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        node.min[i][c] = std::numeric_limits<float>::infinity();
+                        node.max[i][c] = -std::numeric_limits<float>::infinity();
+                    }
+                    node.offset[c]                = 0;
+                    node.count[c]                 = 0;
+                    mBinaryChildren[nodeIndex][c] = UnusedChild;
+                    continue;
+                }
+                const auto& child             = binaryNodes[children[c]];
+                mBinaryChildren[nodeIndex][c] = children[c];
+                for (int i = 0; i < 3; ++i)
+                {
+                    node.min[i][c] = child.min[i];
+                    node.max[i][c] = child.max[i];
+                }
+                node.offset[c] = child.isLeaf() ? child.offset : collapse(binaryNodes, children[c]);
+                node.count[c]  = child.count;
+            }
+            mNodes[nodeIndex] = node;
+            return nodeIndex;
+        }
+
+        /**
+         * @brief Converts to single precision, rounding towards negative infinity.
+         * @param value Value to convert.
+         * @return Largest float that is not greater than the value.
+         */
+        static float roundDown(double value)
+        {
+            float result = (float)value;
+            return result > value ? std::nextafter(result, -std::numeric_limits<float>::infinity()) : result;
+        }
+
+        /**
+         * @brief Converts to single precision, rounding towards positive infinity.
+         * @param value Value to convert.
+         * @return Smallest float that is not less than the value.
+         */
+        static float roundUp(double value)
+        {
+            float result = (float)value;
+            return result < value ? std::nextafter(result, std::numeric_limits<float>::infinity()) : result;
+        }
+
+        /**
+         * @brief Shapes of the binary tree in the order in which the leaves reference them.
+         */
+        TShape* const* mShapes = nullptr;
+
+        /**
+         * @brief Nodes of the tree.
+         */
+        std::vector<Node> mNodes;
+
+        /**
+         * @brief Marks unused children in mBinaryChildren.
+         */
+        static constexpr uint32_t UnusedChild = std::numeric_limits<uint32_t>::max();
+
+        /**
+         * @brief Index of the binary node from which each child of each node was collapsed, used to refit the boxes.
+         */
+        std::vector<std::array<uint32_t, Width>> mBinaryChildren;
+    };
+}
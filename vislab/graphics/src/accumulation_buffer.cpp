@@ -0,0 +1,117 @@
+#include <vislab/graphics/accumulation_buffer.hpp>
+
+#include <vislab/graphics/image.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vislab
+{
+    /**
+     * @brief Computes the luminance of linear sRGB radiance.
+     * @param radiance Radiance.
+     * @return Luminance.
+     */
+    static double luminance(const Spectrum& radiance)
+    {
+        return 0.2126 * radiance.x() + 0.7152 * radiance.y() + 0.0722 * radiance.z();
+    }
+
+    AccumulationBuffer::AccumulationBuffer()
+        : mResolution(0, 0)
+    {
+    }
+
+    void AccumulationBuffer::setResolution(const Eigen::Vector2i& resolution)
+    {
+        mResolution = resolution;
+        mPixels.resize((size_t)resolution.x() * resolution.y());
+        clear();
+    }
+
+    const Eigen::Vector2i& AccumulationBuffer::getResolution() const
+    {
+        return mResolution;
+    }
+
+    void AccumulationBuffer::clear()
+    {
+        for (Pixel& pixel : mPixels)
+        {
+            pixel.sum        = Spectrum::Zero();
+            pixel.mean       = 0;
+            pixel.m2         = 0;
+            pixel.numValid   = 0;
+            pixel.numSamples = 0;
+        }
+    }
+
+    void AccumulationBuffer::addSample(int64_t pixel, const Spectrum& radiance, bool isValid)
+    {
+        Pixel& p = mPixels[pixel];
+        p.numSamples++;
+        if (!isValid)
+            return;
+
+        p.sum += radiance;
+        p.numValid++;
+        double l     = luminance(radiance);
+        double delta = l - p.mean;
+        p.mean += delta / p.numValid;
+        p.m2 += delta * (l - p.mean);
+    }
+
+    uint32_t AccumulationBuffer::getSampleCount(int64_t pixel) const
+    {
+        return mPixels[pixel].numSamples;
+    }
+
+    Spectrum AccumulationBuffer::getRadiance(int64_t pixel) const
+    {
+        const Pixel& p = mPixels[pixel];
+        if (p.numValid == 0)
+            return Spectrum::Zero();
+        return p.sum / p.numValid;
+    }
+
+    double AccumulationBuffer::getVariance(int64_t pixel) const
+    {
+        const Pixel& p = mPixels[pixel];
+        if (p.numValid < 2)
+            return 0;
+        return p.m2 / (p.numValid - 1);
+    }
+
+    double AccumulationBuffer::getRelativeError(int64_t pixel) const
+    {
+        const Pixel& p = mPixels[pixel];
+        if (p.numValid == 0)
+            return 0;
+        if (p.numValid == 1)
+            return std::numeric_limits<double>::infinity();
+        return std::sqrt(getVariance(pixel) / p.numValid) / std::max(std::abs(p.mean), MinLuminance);
+    }
+
+    void AccumulationBuffer::resolve(Image3d* image, int64_t pixel, bool gammaCorrect) const
+    {
+        const Pixel& p = mPixels[pixel];
+        if (p.numValid == 0)
+            return;
+
+        Spectrum radiance = p.sum / p.numValid;
+        if (gammaCorrect)
+        {
+            radiance.x() = std::min(std::max(0., std::pow(radiance.x(), 1. / 2.2)), 1.);
+            radiance.y() = std::min(std::max(0., std::pow(radiance.y(), 1. / 2.2)), 1.);
+            radiance.z() = std::min(std::max(0., std::pow(radiance.z(), 1. / 2.2)), 1.);
+        }
+        image->setValue(pixel, radiance);
+    }
+
+    void AccumulationBuffer::resolve(Image3d* image, bool gammaCorrect) const
+    {
+        for (int64_t i = 0; i < (int64_t)mPixels.size(); ++i)
+            resolve(image, i, gammaCorrect);
+    }
+}
@@ -7,6 +7,8 @@
 #include <vislab/graphics/sampler.hpp>
 #include <vislab/graphics/scene.hpp>
 
+#include <algorithm>
+
 namespace vislab
 {
     DirectRadianceIntegrator::DirectRadianceIntegrator()
@@ -15,10 +17,9 @@ namespace vislab
     {
     }
 
-    std::pair<Spectrum, bool> DirectRadianceIntegrator::sample(const Scene* scene, Sampler* sampler, const RayDifferential3d& ray) const
+    std::pair<Spectrum, bool> DirectRadianceIntegrator::sample(const Scene* scene, Sampler* sampler, const RayDifferential3d& ray, const SurfaceInteraction& si_) const
     {
-        // shoot ray into the scene
-        auto si = scene->intersect(ray);
+        SurfaceInteraction si = si_;
 
         Spectrum result = Spectrum::Zero();
 
@@ -47,23 +48,34 @@ namespace vislab
 
         if (sampleEmitter)
         {
-            for (int i = 0; i < lightSamples; ++i)
+            // sample the light sources in packets on the stack, such that the shadow rays can be traced together
+            constexpr int64_t PacketSize = WideBoundingVolumeHierarchy<Shape>::MaxPacketSize;
+            Eigen::Vector2d samples[PacketSize];
+            DirectionSample directions[PacketSize];
+            Spectrum emitter_vals[PacketSize];
+            for (int64_t begin = 0; begin < lightSamples; begin += PacketSize)
             {
-                // sample the light source
-                DirectionSample ds;
-                Spectrum emitter_val;
-                std::tie(ds, emitter_val) = scene->sampleLightDirection(si, sampler->next_2d(), true);
-                if (ds.pdf == 0)
-                    continue;
-
-                // Query the BSDF for that emitter-sampled direction
-                Eigen::Vector3d wo = si.toLocal(ds.direction);
-
-                // Determine BSDF value and probability of having sampled that same direction using BSDF sampling.
-                auto [bsdf_val, bsdf_pdf] = bsdf->evaluate_pdf(si, wo);
-
-                double mis = ds.delta ? 1. : misWeight(ds.pdf * lightFrac, bsdf_pdf * bsdfFrac) * lightWeight;
-                result += mis * bsdf_val.cwiseProduct(emitter_val);
+                int64_t size = std::min(lightSamples - begin, PacketSize);
+                for (int64_t i = 0; i < size; ++i)
+                    samples[i] = sampler->next_2d();
+                scene->sampleLightDirections(si, samples, size, directions, emitter_vals);
+
+                for (int64_t i = 0; i < size; ++i)
+                {
+                    const DirectionSample& ds   = directions[i];
+                    const Spectrum& emitter_val = emitter_vals[i];
+                    if (ds.pdf == 0)
+                        continue;
+
+                    // Query the BSDF for that emitter-sampled direction
+                    Eigen::Vector3d wo = si.toLocal(ds.direction);
+
+                    // Determine BSDF value and probability of having sampled that same direction using BSDF sampling.
+                    auto [bsdf_val, bsdf_pdf] = bsdf->evaluate_pdf(si, wo);
+
+                    double mis = ds.delta ? 1. : misWeight(ds.pdf * lightFrac, bsdf_pdf * bsdfFrac) * lightWeight;
+                    result += mis * bsdf_val.cwiseProduct(emitter_val);
+                }
             }
         }
 
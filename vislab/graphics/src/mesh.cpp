@@ -5,14 +5,25 @@
 
 #include <vislab/core/array.hpp>
 
+#include <algorithm>
+
 namespace vislab
 {
     Mesh::Mesh()
+        : accelerationTreeType(EAccelerationTreeType::Wide)
+        , packTriangles(false)
     {
+        // keep the acceleration tree in sync with deforming geometry
+        positionsChanged += [this](Mesh*, const void*)
+        { updateAccelerationTree(); };
     }
 
     Eigen::AlignedBox3d Mesh::objectBounds() const
     {
+        // cached while the acceleration tree is kept in sync, which spares the instances of a shared mesh a pass over the positions
+        if (mBoundingVolumeHierarchy)
+            return mObjectBounds;
+
         Eigen::AlignedBox3d bounds;
         bounds.setEmpty();
         if (positions)
@@ -68,7 +79,21 @@ namespace vislab
 
     PreliminaryIntersection Mesh::preliminaryHit(const Ray3d& _ray) const
     {
-        if (mBoundingVolumeHierarchy)
+        if (mPackedTriangles.getSize() > 0)
+        {
+            // the leaves reference the packed triangles directly
+            PackedTriangles::TraversalRay traversalRay(_ray);
+            auto intersectLeaf = [this, &traversalRay](uint32_t offset, uint32_t count, Ray3d& ray, PreliminaryIntersection& result)
+            { mPackedTriangles.intersect(offset, count, traversalRay, ray, result); };
+            if (mWideBoundingVolumeHierarchy)
+                return mWideBoundingVolumeHierarchy->preliminaryHit(_ray, intersectLeaf);
+            return mBoundingVolumeHierarchy->preliminaryHit(_ray, intersectLeaf);
+        }
+        else if (mWideBoundingVolumeHierarchy)
+        {
+            return mWideBoundingVolumeHierarchy->preliminaryHit(_ray);
+        }
+        else if (mBoundingVolumeHierarchy)
         {
             return mBoundingVolumeHierarchy->preliminaryHit(_ray);
         }
@@ -93,6 +118,22 @@ namespace vislab
         }
     }
 
+    int32_t Mesh::countHits(const Ray3d& ray) const
+    {
+        if (mWideBoundingVolumeHierarchy)
+            return mWideBoundingVolumeHierarchy->countHits(ray);
+        if (mBoundingVolumeHierarchy)
+            return mBoundingVolumeHierarchy->countHits(ray);
+
+        int32_t hits = 0;
+        for (Eigen::Index i = 0; i < indices->getSize(); ++i)
+        {
+            if (rayTriangleIntersection(i, ray).isValid())
+                hits++;
+        }
+        return hits;
+    }
+
     SurfaceInteraction Mesh::computeSurfaceInteraction(const Ray3d& ray, const PreliminaryIntersection& pi, EHitComputeFlag flags) const
     {
         bool active = pi.isValid();
@@ -264,7 +305,55 @@ namespace vislab
         {
             mTriangles[i].face = i;
             mTriangles[i].mesh = this;
+        }
+        updateTriangleBounds();
+        mBoundingVolumeHierarchy = std::make_shared<FlatBoundingVolumeHierarchy<Triangle>>();
+        mBoundingVolumeHierarchy->getShapes().resize(indices->getSize());
+        for (Eigen::Index i = 0; i < indices->getSize(); ++i)
+            mBoundingVolumeHierarchy->getShapes()[i] = &mTriangles[i];
+        mBoundingVolumeHierarchy->build();
+
+        mWideBoundingVolumeHierarchy.reset();
+        if (accelerationTreeType == EAccelerationTreeType::Wide)
+        {
+            mWideBoundingVolumeHierarchy = std::make_shared<WideBoundingVolumeHierarchy<Triangle>>();
+            mWideBoundingVolumeHierarchy->build(*mBoundingVolumeHierarchy);
+        }
+        updatePackedTriangles();
+    }
+
+    bool Mesh::updateAccelerationTree()
+    {
+        if (!mBoundingVolumeHierarchy)
+            return false;
 
+        // a changed topology invalidates the tree
+        if (!indices || (size_t)indices->getSize() != mTriangles.size())
+        {
+            buildAccelerationTree();
+            return true;
+        }
+        updateTriangleBounds();
+        bool rebuilt = mBoundingVolumeHierarchy->update();
+        if (mWideBoundingVolumeHierarchy)
+        {
+            if (rebuilt)
+                mWideBoundingVolumeHierarchy->build(*mBoundingVolumeHierarchy);
+            else
+                mWideBoundingVolumeHierarchy->refit(*mBoundingVolumeHierarchy);
+        }
+        updatePackedTriangles();
+        return rebuilt;
+    }
+
+    void Mesh::updateTriangleBounds()
+    {
+        int64_t numTriangles = (int64_t)mTriangles.size();
+#ifndef _DEBUG
+#pragma omp parallel for
+#endif
+        for (int64_t i = 0; i < numTriangles; ++i)
+        {
             Eigen::Vector3u fi = indices->getValue(i);
             Eigen::Vector3d p0 = positions->getValue(fi[0]).cast<double>();
             Eigen::Vector3d p1 = positions->getValue(fi[1]).cast<double>();
@@ -274,11 +363,111 @@ namespace vislab
             mTriangles[i].worldBoundingBox.extend(p1);
             mTriangles[i].worldBoundingBox.extend(p2);
         }
-        mBoundingVolumeHierarchy = std::make_shared<BoundingVolumeHierarchy<Triangle, 3>>();
-        mBoundingVolumeHierarchy->getShapes().resize(indices->getSize());
-        for (size_t i = 0; i < indices->getSize(); ++i)
-            mBoundingVolumeHierarchy->getShapes()[i] = &mTriangles[i];
-        mBoundingVolumeHierarchy->build();
+
+        mObjectBounds.setEmpty();
+        for (Eigen::Index i = 0; i < positions->getSize(); ++i)
+            mObjectBounds.extend(positions->getValue(i).cast<double>());
+    }
+
+    void Mesh::updatePackedTriangles()
+    {
+        if (!packTriangles)
+        {
+            mPackedTriangles.clear();
+            return;
+        }
+
+        const std::vector<Triangle*>& orderedTriangles = mBoundingVolumeHierarchy->getOrderedShapes();
+        std::vector<uint32_t> faces(orderedTriangles.size());
+        for (size_t i = 0; i < faces.size(); ++i)
+            faces[i] = orderedTriangles[i]->face;
+        mPackedTriangles.build(*positions, *indices, faces);
+    }
+
+    void Mesh::recomputeEdges()
+    {
+        if (!indices)
+            return;
+
+        // collect the edges of all faces as (sorted vertex pair, 3 * face + corner) and sort them such that shared edges are adjacent
+        std::vector<std::pair<uint64_t, uint32_t>> halfEdges;
+        halfEdges.reserve(3 * indices->getSize());
+        for (Eigen::Index i = 0; i < indices->getSize(); ++i)
+        {
+            Eigen::Vector3u fi = indices->getValue(i);
+            for (int j = 0; j < 3; ++j)
+            {
+                uint64_t v0 = std::min(fi[j], fi[(j + 1) % 3]);
+                uint64_t v1 = std::max(fi[j], fi[(j + 1) % 3]);
+                halfEdges.push_back(std::make_pair((v0 << 32) | v1, uint32_t(3 * i + j)));
+            }
+        }
+        std::sort(halfEdges.begin(), halfEdges.end());
+
+        // count the unique edges to allocate the buffers once
+        Eigen::Index numEdges = 0;
+        for (size_t i = 0; i < halfEdges.size(); ++i)
+            if (i == 0 || halfEdges[i].first != halfEdges[i - 1].first)
+                numEdges++;
+
+        if (!edges)
+            edges = std::make_shared<Array2ui>();
+        if (!edgeFaces)
+            edgeFaces = std::make_shared<Array2ui>();
+        if (!faceEdges)
+            faceEdges = std::make_shared<Array3ui>();
+        edges->setSize(numEdges);
+        edgeFaces->setSize(numEdges);
+        faceEdges->setSize(indices->getSize());
+
+        Eigen::Index edge = 0;
+        for (size_t i = 0; i < halfEdges.size();)
+        {
+            // the first two faces that share the edge are stored
+            size_t j = i + 1;
+            while (j < halfEdges.size() && halfEdges[j].first == halfEdges[i].first)
+                j++;
+            uint32_t f0 = halfEdges[i].second / 3;
+            uint32_t f1 = j - i > 1 ? halfEdges[i + 1].second / 3 : f0;
+            edges->setValue(edge, Eigen::Vector2u(uint32_t(halfEdges[i].first >> 32), uint32_t(halfEdges[i].first & 0xffffffff)));
+            edgeFaces->setValue(edge, Eigen::Vector2u(f0, f1));
+            for (size_t k = i; k < j; ++k)
+                faceEdges->getData()(halfEdges[k].second % 3, halfEdges[k].second / 3) = uint32_t(edge);
+            edge++;
+            i = j;
+        }
+    }
+
+    bool Mesh::hasAccelerationTree() const
+    {
+        return mBoundingVolumeHierarchy != nullptr;
+    }
+
+    void Mesh::findOverlappingFaces(const Eigen::AlignedBox3d& box, std::vector<uint32_t>& faces) const
+    {
+        faces.clear();
+        if (mBoundingVolumeHierarchy)
+        {
+            mBoundingVolumeHierarchy->overlap(box, [&box, &faces](const Triangle* triangle)
+                                              {
+                                                  if (triangle->worldBoundingBox.intersects(box))
+                                                      faces.push_back(triangle->face);
+                                                  return true; });
+            return;
+        }
+
+        if (!indices || !positions)
+            return;
+        for (Eigen::Index i = 0; i < indices->getSize(); ++i)
+        {
+            Eigen::Vector3u fi = indices->getValue(i);
+            Eigen::AlignedBox3d bounds;
+            bounds.setEmpty();
+            for (int j = 0; j < 3; ++j)
+                bounds.extend(positions->getValueDouble(fi[j]));
+            if (bounds.intersects(box))
+                faces.push_back(uint32_t(i));
+        }
     }
 
     Mesh::Triangle::Triangle()
@@ -7,76 +7,287 @@
 #include <vislab/graphics/sampler.hpp>
 #include <vislab/graphics/scene.hpp>
 #include <vislab/graphics/spectrum.hpp>
+#include <vislab/graphics/surface_interaction.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace vislab
 {
+    /**
+     * @brief Generates a primary ray through a random position inside a pixel.
+     * @param camera Camera to generate the ray with.
+     * @param sampler Sampler of the pixel.
+     * @param pixelIndex Index of the pixel.
+     * @param resolution Resolution of the image.
+     * @return Primary ray.
+     */
+    static RayDifferential3d generatePrimaryRay(const Camera* camera, Sampler* sampler, const Eigen::Vector2d& pixelIndex, const Eigen::Vector2i& resolution)
+    {
+        // generate a random sample inside the pixel
+        Eigen::Vector2d s = (pixelIndex + sampler->next_2d()).cwiseQuotient(resolution.cast<double>());
+
+        // generate the ray
+        RayDifferential3d ray;
+        Spectrum spec_weight;
+        std::tie(ray, spec_weight) = camera->sampleRayDifferential(s);
+        ray.medium                 = camera->medium.get();
+        return ray;
+    }
+
+    /**
+     * @brief Maps a distance along a Hilbert curve to the cell it passes through.
+     * @param n Edge length of the grid that the curve fills, which is a power of two.
+     * @param d Distance along the curve.
+     * @return Cell of the grid.
+     */
+    static Eigen::Vector2i hilbertCurve(int n, int d)
+    {
+        int x = 0, y = 0;
+        for (int s = 1; s < n; s *= 2)
+        {
+            int rx = 1 & (d / 2);
+            int ry = 1 & (d ^ rx);
+            if (ry == 0)
+            {
+                // rotate the quadrant
+                if (rx == 1)
+                {
+                    x = s - 1 - x;
+                    y = s - 1 - y;
+                }
+                std::swap(x, y);
+            }
+            x += s * rx;
+            y += s * ry;
+            d /= 4;
+        }
+        return Eigen::Vector2i(x, y);
+    }
+
+    /**
+     * @brief Splits an image into tiles, ordered along a Hilbert curve such that consecutive tiles are adjacent.
+     * @param resolution Resolution of the image.
+     * @return Pixel ranges of the tiles, with exclusive maximum.
+     */
+    static std::vector<Eigen::AlignedBox2i> createTiles(const Eigen::Vector2i& resolution)
+    {
+        const int tileSize       = MonteCarloRadianceIntegrator::TileSize;
+        Eigen::Vector2i numTiles = (resolution.array() + tileSize - 1) / tileSize;
+        int n                    = 1;
+        while (n < numTiles.maxCoeff())
+            n *= 2;
+
+        // walk along the curve through the smallest power of two grid and skip the cells outside of the image
+        std::vector<Eigen::AlignedBox2i> tiles;
+        tiles.reserve(numTiles.prod());
+        for (int d = 0; d < n * n; ++d)
+        {
+            Eigen::Vector2i cell = hilbertCurve(n, d);
+            if ((cell.array() >= numTiles.array()).any())
+                continue;
+            Eigen::Vector2i tileMin = cell * tileSize;
+            Eigen::Vector2i tileMax = (tileMin.array() + tileSize).min(resolution.array());
+            tiles.push_back(Eigen::AlignedBox2i(tileMin, tileMax));
+        }
+        return tiles;
+    }
+
     MonteCarloRadianceIntegrator::MonteCarloRadianceIntegrator()
         : mSamplesPerPixel(1)
         , sampler(std::make_shared<IndependentSampler>())
+        , packetTracing(false)
+        , relativeErrorThreshold(0)
+        , timeBudget(0)
+        , maxSamplesPerPixel(1024)
     {
     }
 
     bool MonteCarloRadianceIntegrator::render(Scene* scene, Image3d* image)
     {
-        // get the camera to render from
-        auto camera = scene->camera;
+        // split the image into tiles, which the worker threads take one at a time
+        Eigen::Vector2i resolution             = image->getResolution();
+        std::vector<Eigen::AlignedBox2i> tiles = createTiles(resolution);
+        mAccumulationBuffer.setResolution(resolution);
 
-        // for each pixel in the image
+        // the first pass takes samples in all pixels
+        bool progressive = relativeErrorThreshold > 0 || timeBudget > 0;
+        auto deadline    = std::chrono::steady_clock::time_point::max();
+        if (timeBudget > 0)
+            deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeBudget));
+        std::vector<uint8_t> active((size_t)resolution.x() * resolution.y(), 1);
+        for (size_t pass = 0;; ++pass)
+        {
+            renderPass(scene, image, tiles, active, pass, deadline);
+            passCompleted.notify(this, &pass);
+            if (!progressive || std::chrono::steady_clock::now() >= deadline)
+                break;
+
+            // continue in the pixels that did not converge yet and in their neighbors, since a pixel whose few samples all missed a rare contribution appears converged
+            std::vector<uint8_t> unconverged(active.size());
+            for (int64_t i = 0; i < (int64_t)active.size(); ++i)
+                unconverged[i] = relativeErrorThreshold <= 0 || mAccumulationBuffer.getRelativeError(i) > relativeErrorThreshold;
+            bool anyActive = false;
+            for (int y = 0; y < resolution.y(); ++y)
+                for (int x = 0; x < resolution.x(); ++x)
+                {
+                    int64_t i = (int64_t)y * resolution.x() + x;
+                    active[i] = 0;
+                    if (mAccumulationBuffer.getSampleCount(i) + mSamplesPerPixel > maxSamplesPerPixel)
+                        continue;
+                    for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, resolution.y() - 1); ++ny)
+                        for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, resolution.x() - 1); ++nx)
+                            active[i] |= unconverged[(int64_t)ny * resolution.x() + nx];
+                    anyActive |= active[i] != 0;
+                }
+            if (!anyActive)
+                break;
+        }
+        return true;
+    }
+
+    const AccumulationBuffer& MonteCarloRadianceIntegrator::getAccumulationBuffer() const { return mAccumulationBuffer; }
+
+    void MonteCarloRadianceIntegrator::renderPass(const Scene* scene, Image3d* image, const std::vector<Eigen::AlignedBox2i>& tiles, const std::vector<uint8_t>& active, size_t pass, std::chrono::steady_clock::time_point deadline)
+    {
+        // get the camera to render from
+        const Camera* camera       = scene->camera.get();
         Eigen::Vector2i resolution = image->getResolution();
 
 #ifndef _DEBUG
-#pragma omp parallel for
+#pragma omp parallel
 #endif
-        for (int64_t i = 0; i < (int64_t)resolution.x() * resolution.y(); ++i)
         {
-            // make a copy of the random sampler, such that each pixel has its own
-            std::shared_ptr<Sampler> sampler(sampler->clone());
-            sampler->seed(i);
-
-            // determine the pixel index
-            Eigen::Vector2d pixelIndex = Eigen::Vector2d(
-                i % resolution.x(),
-                i / resolution.x());
-
-            // iterate to obtain the requested number of samples per pixel
-            size_t numSamples = 0;
-            Spectrum radiance = Spectrum::Zero();
-            for (size_t spp = 0; spp < mSamplesPerPixel; ++spp)
+            // each worker has its own copies of the random sampler, which are reseeded for each pixel and advanced for each sample
+            std::unique_ptr<Sampler> sampler;
+            std::vector<std::unique_ptr<Sampler>> samplers;
+            if (packetTracing)
+            {
+                samplers.resize(TileSize * TileSize);
+                for (auto& pixelSampler : samplers)
+                {
+                    pixelSampler.reset(this->sampler->clone());
+                    pixelSampler->setSampleCount((uint32_t)mSamplesPerPixel);
+                }
+            }
+            else
             {
-                // generate a random sample inside the pixel
-                Eigen::Vector2d s = (pixelIndex + sampler->next_2d()).cwiseQuotient(resolution.cast<double>());
+                sampler.reset(this->sampler->clone());
+                sampler->setSampleCount((uint32_t)mSamplesPerPixel);
+            }
 
-                // generate the ray
-                RayDifferential3d ray;
-                Spectrum spec_weight;
-                std::tie(ray, spec_weight) = camera->sampleRayDifferential(s);
-                ray.medium                 = camera->medium.get();
+#ifndef _DEBUG
+#pragma omp for schedule(dynamic, 1)
+#endif
+            for (int64_t t = 0; t < (int64_t)tiles.size(); ++t)
+            {
+                if (pass > 0 && std::chrono::steady_clock::now() >= deadline)
+                    continue;
 
-                // let the integrator compute the radiance
-                Spectrum spectrum;
-                bool isValid;
-                std::tie(spectrum, isValid) = this->sample(scene, sampler.get(), ray);
+                const Eigen::AlignedBox2i& tile = tiles[t];
+                if (packetTracing)
+                    renderTilePackets(scene, camera, tile, active, pass, samplers);
+                else
+                    renderTile(scene, camera, tile, active, pass, sampler.get());
+
+                // write the updated pixels into the image
+                for (int y = tile.min().y(); y < tile.max().y(); ++y)
+                    for (int x = tile.min().x(); x < tile.max().x(); ++x)
+                    {
+                        int64_t i = (int64_t)y * resolution.x() + x;
+                        if (active[i])
+                            mAccumulationBuffer.resolve(image, i);
+                    }
+
+#ifndef _DEBUG
+#pragma omp critical(vislab_tile_completed)
+#endif
+                tileCompleted.notify(this, &tile);
+            }
+        }
+    }
+
+    void MonteCarloRadianceIntegrator::renderTile(const Scene* scene, const Camera* camera, const Eigen::AlignedBox2i& tile, const std::vector<uint8_t>& active, size_t pass, Sampler* sampler)
+    {
+        Eigen::Vector2i resolution = mAccumulationBuffer.getResolution();
+        for (int y = tile.min().y(); y < tile.max().y(); ++y)
+            for (int x = tile.min().x(); x < tile.max().x(); ++x)
+            {
+                int64_t i = (int64_t)y * resolution.x() + x;
+                if (!active[i])
+                    continue;
+
+                // reseed the sampler, such that the image does not depend on the tile order
+                sampler->seed((uint64_t)pass * active.size() + i);
 
-                // if valid sample
-                if (isValid)
+                // iterate to obtain the requested number of samples per pixel
+                for (size_t spp = 0; spp < mSamplesPerPixel; ++spp)
                 {
-                    // add the color to the buffer
-                    radiance += spectrum;
-                    numSamples++;
+                    RayDifferential3d ray = generatePrimaryRay(camera, sampler, Eigen::Vector2d(x, y), resolution);
+
+                    // let the integrator compute the radiance
+                    Spectrum spectrum;
+                    bool isValid;
+                    std::tie(spectrum, isValid) = this->sample(scene, sampler, ray, scene->intersect(ray));
+                    mAccumulationBuffer.addSample(i, spectrum, isValid);
+                    sampler->advance();
                 }
             }
-            // divide by the total number of samples
-            if (numSamples > 0)
+    }
+
+    void MonteCarloRadianceIntegrator::renderTilePackets(const Scene* scene, const Camera* camera, const Eigen::AlignedBox2i& tile, const std::vector<uint8_t>& active, size_t pass, std::vector<std::unique_ptr<Sampler>>& samplers)
+    {
+        // collect the active pixels of the tile block by block, such that the pixels of a packet are consecutive
+        Eigen::Vector2i resolution = mAccumulationBuffer.getResolution();
+        std::vector<int64_t> pixels;
+        std::vector<size_t> blocks;
+        pixels.reserve(TileSize * TileSize);
+        for (int by = tile.min().y(); by < tile.max().y(); by += PacketTileSize)
+            for (int bx = tile.min().x(); bx < tile.max().x(); bx += PacketTileSize)
             {
-                radiance /= numSamples;
-                // apply gamma correction
-                radiance.x() = std::min(std::max(0., std::pow(radiance.x(), 1. / 2.2)), 1.);
-                radiance.y() = std::min(std::max(0., std::pow(radiance.y(), 1. / 2.2)), 1.);
-                radiance.z() = std::min(std::max(0., std::pow(radiance.z(), 1. / 2.2)), 1.);
-                image->setValue(i, radiance);
+                blocks.push_back(pixels.size());
+                for (int y = by; y < std::min(by + PacketTileSize, tile.max().y()); ++y)
+                    for (int x = bx; x < std::min(bx + PacketTileSize, tile.max().x()); ++x)
+                    {
+                        int64_t i = (int64_t)y * resolution.x() + x;
+                        if (active[i])
+                            pixels.push_back(i);
+                    }
+            }
+        blocks.push_back(pixels.size());
+
+        // each pixel has its own sampler, seeded as without packets, such that the images are the same
+        for (size_t p = 0; p < pixels.size(); ++p)
+            samplers[p]->seed((uint64_t)pass * active.size() + pixels[p]);
+
+        std::vector<RayDifferential3d> rays(pixels.size());
+        std::vector<Ray3d> packet(pixels.size());
+        std::vector<SurfaceInteraction> si(pixels.size());
+        for (size_t spp = 0; spp < mSamplesPerPixel; ++spp)
+        {
+            // trace the primary rays of each block together
+            for (size_t p = 0; p < pixels.size(); ++p)
+            {
+                Eigen::Vector2d pixelIndex = Eigen::Vector2d(
+                    pixels[p] % resolution.x(),
+                    pixels[p] / resolution.x());
+                rays[p]   = generatePrimaryRay(camera, samplers[p].get(), pixelIndex, resolution);
+                packet[p] = rays[p];
+            }
+            for (size_t b = 0; b + 1 < blocks.size(); ++b)
+                scene->intersect(packet.data() + blocks[b], blocks[b + 1] - blocks[b], si.data() + blocks[b]);
+
+            // let the integrator compute the radiance
+            for (size_t p = 0; p < pixels.size(); ++p)
+            {
+                Spectrum spectrum;
+                bool isValid;
+                std::tie(spectrum, isValid) = this->sample(scene, samplers[p].get(), rays[p], si[p]);
+                mAccumulationBuffer.addSample(pixels[p], spectrum, isValid);
+                samplers[p]->advance();
             }
         }
-        return true;
     }
 
     const size_t& MonteCarloRadianceIntegrator::getSamplesPerPixel() const { return mSamplesPerPixel; }
@@ -0,0 +1,213 @@
+#include <vislab/graphics/packed_triangles.hpp>
+
+#include <vislab/graphics/ray.hpp>
+
+#include <vislab/core/array.hpp>
+
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VISLAB_PACKED_TRIANGLES_SSE
+#include <emmintrin.h>
+#endif
+
+namespace vislab
+{
+    /**
+     * @brief Watertight intersection test of a single triangle of a block. Edge functions that are exactly zero in single precision are recomputed in double precision from the same sheared vertices, which makes the test consistent for triangles that share an edge.
+     * @param block Block that contains the triangle.
+     * @param lane Index of the triangle in the block.
+     * @param ray Prepared ray.
+     * @param t Receives the ray parameter of the hit.
+     * @param u Receives the barycentric coordinate of the second vertex.
+     * @param v Receives the barycentric coordinate of the third vertex.
+     * @return True if the ray intersects the plane of the triangle inside the triangle.
+     */
+    static bool intersectTriangle(const PackedTriangles::Block& block, int lane, const PackedTriangles::TraversalRay& ray, float& t, float& u, float& v)
+    {
+        // vertices relative to the ray origin in the sheared coordinate system, in which the ray is the z-axis
+        float x[3], y[3], z[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            float dz = block.vertices[i][ray.kz][lane] - ray.origin[ray.kz];
+            float dx = block.vertices[i][ray.kx][lane] - ray.origin[ray.kx];
+            float dy = block.vertices[i][ray.ky][lane] - ray.origin[ray.ky];
+            x[i]     = dx - ray.shear[0] * dz;
+            y[i]     = dy - ray.shear[1] * dz;
+            z[i]     = ray.shear[2] * dz;
+        }
+
+        // scaled barycentric coordinates, which all have the same sign if the ray passes through the triangle
+        float U = x[2] * y[1] - y[2] * x[1];
+        float V = x[0] * y[2] - y[0] * x[2];
+        float W = x[1] * y[0] - y[1] * x[0];
+        if (U == 0 || V == 0 || W == 0)
+        {
+            // products of floats are exact in double precision
+            U = (float)((double)x[2] * y[1] - (double)y[2] * x[1]);
+            V = (float)((double)x[0] * y[2] - (double)y[0] * x[2]);
+            W = (float)((double)x[1] * y[0] - (double)y[1] * x[0]);
+        }
+        if ((U < 0 || V < 0 || W < 0) && (U > 0 || V > 0 || W > 0))
+            return false;
+        float det = U + V + W;
+        if (det == 0)
+            return false;
+
+        float invDet = 1 / det;
+        t            = (U * z[0] + V * z[1] + W * z[2]) * invDet;
+        u            = V * invDet;
+        v            = W * invDet;
+        return true;
+    }
+
+    PackedTriangles::TraversalRay::TraversalRay(const Ray3d& ray)
+    {
+        // the largest direction component becomes z, and x and y are swapped to keep the winding if it is negative
+        kz = 0;
+        for (int i = 1; i < 3; ++i)
+            if (std::abs(ray.direction[i]) > std::abs(ray.direction[kz]))
+                kz = i;
+        kx = (kz + 1) % 3;
+        ky = (kx + 1) % 3;
+        if (ray.direction[kz] < 0)
+            std::swap(kx, ky);
+
+        for (int i = 0; i < 3; ++i)
+            origin[i] = (float)ray.origin[i];
+        shear[0] = (float)(ray.direction[kx] / ray.direction[kz]);
+        shear[1] = (float)(ray.direction[ky] / ray.direction[kz]);
+        shear[2] = (float)(1. / ray.direction[kz]);
+    }
+
+    PackedTriangles::PackedTriangles()
+        : mSize(0)
+    {
+    }
+
+    void PackedTriangles::build(const Array3f& positions, const Array3ui& indices, const std::vector<uint32_t>& faces)
+    {
+        mSize = (uint32_t)faces.size();
+        mBlocks.resize((faces.size() + BlockSize - 1) / BlockSize);
+        int64_t numBlocks = (int64_t)mBlocks.size();
+#ifndef _DEBUG
+#pragma omp parallel for
+#endif
+        for (int64_t b = 0; b < numBlocks; ++b)
+        {
+            Block& block = mBlocks[b];
+            for (int lane = 0; lane < BlockSize; ++lane)
+            {
+                // the padding of the last block is degenerate and never hit
+                size_t i           = b * BlockSize + lane;
+                Eigen::Vector3u fi = Eigen::Vector3u::Zero();
+                if (i < faces.size())
+                    fi = indices.getValue(faces[i]);
+                for (int v = 0; v < 3; ++v)
+                {
+                    Eigen::Vector3f p = Eigen::Vector3f::Zero();
+                    if (i < faces.size())
+                        p = positions.getValue(fi[v]);
+                    for (int k = 0; k < 3; ++k)
+                        block.vertices[v][k][lane] = p[k];
+                }
+                block.face[lane] = i < faces.size() ? faces[i] : 0;
+            }
+        }
+    }
+
+    void PackedTriangles::clear()
+    {
+        mBlocks.clear();
+        mSize = 0;
+    }
+
+    uint32_t PackedTriangles::getSize() const
+    {
+        return mSize;
+    }
+
+    const std::vector<PackedTriangles::Block>& PackedTriangles::getBlocks() const
+    {
+        return mBlocks;
+    }
+
+    void PackedTriangles::intersect(uint32_t offset, uint32_t count, const TraversalRay& traversalRay, Ray3d& ray, PreliminaryIntersection& result) const
+    {
+        uint32_t end = offset + count;
+        for (uint32_t b = offset / BlockSize; b * BlockSize < end; ++b)
+        {
+            const Block& block = mBlocks[b];
+
+            // lanes of the block that belong to the range
+            int rangeMask = 0;
+            for (int lane = 0; lane < BlockSize; ++lane)
+            {
+                uint32_t i = b * BlockSize + lane;
+                if (offset <= i && i < end)
+                    rangeMask |= 1 << lane;
+            }
+
+            float t[BlockSize], u[BlockSize], v[BlockSize];
+            int hitMask = 0;
+#ifdef VISLAB_PACKED_TRIANGLES_SSE
+            __m128 x[3], y[3], z[3];
+            for (int i = 0; i < 3; ++i)
+            {
+                __m128 dz = _mm_sub_ps(_mm_load_ps(block.vertices[i][traversalRay.kz]), _mm_set1_ps(traversalRay.origin[traversalRay.kz]));
+                __m128 dx = _mm_sub_ps(_mm_load_ps(block.vertices[i][traversalRay.kx]), _mm_set1_ps(traversalRay.origin[traversalRay.kx]));
+                __m128 dy = _mm_sub_ps(_mm_load_ps(block.vertices[i][traversalRay.ky]), _mm_set1_ps(traversalRay.origin[traversalRay.ky]));
+                x[i]      = _mm_sub_ps(dx, _mm_mul_ps(_mm_set1_ps(traversalRay.shear[0]), dz));
+                y[i]      = _mm_sub_ps(dy, _mm_mul_ps(_mm_set1_ps(traversalRay.shear[1]), dz));
+                z[i]      = _mm_mul_ps(_mm_set1_ps(traversalRay.shear[2]), dz);
+            }
+            __m128 U = _mm_sub_ps(_mm_mul_ps(x[2], y[1]), _mm_mul_ps(y[2], x[1]));
+            __m128 V = _mm_sub_ps(_mm_mul_ps(x[0], y[2]), _mm_mul_ps(y[0], x[2]));
+            __m128 W = _mm_sub_ps(_mm_mul_ps(x[1], y[0]), _mm_mul_ps(y[1], x[0]));
+
+            __m128 zero     = _mm_setzero_ps();
+            __m128 negative = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(U, zero), _mm_cmplt_ps(V, zero)), _mm_cmplt_ps(W, zero));
+            __m128 positive = _mm_or_ps(_mm_or_ps(_mm_cmpgt_ps(U, zero), _mm_cmpgt_ps(V, zero)), _mm_cmpgt_ps(W, zero));
+            __m128 det      = _mm_add_ps(_mm_add_ps(U, V), W);
+            __m128 valid    = _mm_andnot_ps(_mm_and_ps(negative, positive), _mm_cmpneq_ps(det, zero));
+            hitMask         = _mm_movemask_ps(valid) & rangeMask;
+
+            // triangles with edge functions that are exactly zero are tested again with the double precision fallback
+            int edgeMask = _mm_movemask_ps(_mm_or_ps(_mm_or_ps(_mm_cmpeq_ps(U, zero), _mm_cmpeq_ps(V, zero)), _mm_cmpeq_ps(W, zero))) & rangeMask;
+
+            __m128 invDet = _mm_div_ps(_mm_set1_ps(1.f), det);
+            __m128 T      = _mm_add_ps(_mm_add_ps(_mm_mul_ps(U, z[0]), _mm_mul_ps(V, z[1])), _mm_mul_ps(W, z[2]));
+            _mm_storeu_ps(t, _mm_mul_ps(T, invDet));
+            _mm_storeu_ps(u, _mm_mul_ps(V, invDet));
+            _mm_storeu_ps(v, _mm_mul_ps(W, invDet));
+            for (int lane = 0; lane < BlockSize; ++lane)
+            {
+                if (!(edgeMask & (1 << lane)))
+                    continue;
+                hitMask &= ~(1 << lane);
+                if (intersectTriangle(block, lane, traversalRay, t[lane], u[lane], v[lane]))
+                    hitMask |= 1 << lane;
+            }
+#else
+            for (int lane = 0; lane < BlockSize; ++lane)
+                if ((rangeMask & (1 << lane)) && intersectTriangle(block, lane, traversalRay, t[lane], u[lane], v[lane]))
+                    hitMask |= 1 << lane;
+#endif
+
+            // keep the closest hit within the ray segment
+            for (int lane = 0; lane < BlockSize; ++lane)
+            {
+                if (!(hitMask & (1 << lane)))
+                    continue;
+                double tLane = t[lane];
+                if (tLane >= ray.tMin && tLane <= ray.tMax && tLane < result.t)
+                {
+                    result.t          = tLane;
+                    result.prim_uv    = Eigen::Vector2d(u[lane], v[lane]);
+                    result.prim_index = block.face[lane];
+                    ray.tMax          = tLane;
+                }
+            }
+        }
+    }
+}
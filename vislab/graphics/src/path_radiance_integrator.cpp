@@ -15,7 +15,7 @@ namespace vislab
     {
     }
 
-    std::pair<Spectrum, bool> PathRadianceIntegrator::sample(const Scene* scene, Sampler* sampler, const RayDifferential3d& ray_) const
+    std::pair<Spectrum, bool> PathRadianceIntegrator::sample(const Scene* scene, Sampler* sampler, const RayDifferential3d& ray_, const SurfaceInteraction& si_) const
     {
         RayDifferential3d ray = ray_;
 
@@ -30,7 +30,7 @@ namespace vislab
 
         // ---------------------- First intersection ----------------------
 
-        SurfaceInteraction si = scene->intersect(ray);
+        SurfaceInteraction si = si_;
         bool valid_ray        = si.isValid();
         const Light* light    = si.light(scene);
         bool active           = true;
@@ -0,0 +1,67 @@
+#include <vislab/graphics/pcg_sampler.hpp>
+
+#include <vislab/graphics/owen_scrambling.hpp>
+
+namespace vislab
+{
+    /**
+     * @brief Mixes the bits of a 64-bit integer (finalizer of SplitMix64).
+     * @param x Integer to mix.
+     * @return Mixed integer.
+     */
+    static uint64_t mix64(uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    PCGSampler::PCGSampler()
+        : Sampler()
+    {
+        seed();
+    }
+
+    PCGSampler::PCGSampler(const PCGSampler& other)
+        : Sampler(other)
+        , mState(other.mState)
+        , mIncrement(other.mIncrement)
+    {
+    }
+
+    void PCGSampler::seed(uint64_t seed_offset)
+    {
+        Sampler::seed(seed_offset);
+
+        // consecutive offsets select streams with consecutive increments, which are correlated unless the initial states differ as well
+        mState     = 0;
+        mIncrement = (seed_offset << 1) | 1;
+        next_uint32();
+        mState += mBaseSeed + mix64(seed_offset);
+        next_uint32();
+    }
+
+    uint32_t PCGSampler::next_uint32()
+    {
+        // linear congruential step, with a permuted output of the old state
+        uint64_t oldState   = mState;
+        mState              = oldState * 6364136223846793005ULL + mIncrement;
+        uint32_t xorShifted = (uint32_t)(((oldState >> 18) ^ oldState) >> 27);
+        uint32_t rotation   = (uint32_t)(oldState >> 59);
+        return (xorShifted >> rotation) | (xorShifted << ((~rotation + 1) & 31));
+    }
+
+    double PCGSampler::next_1d()
+    {
+        mDimensionIndex++;
+        return OwenScrambling::toUnitInterval(next_uint32());
+    }
+
+    Eigen::Vector2d PCGSampler::next_2d()
+    {
+        mDimensionIndex++;
+        double x = OwenScrambling::toUnitInterval(next_uint32());
+        double y = OwenScrambling::toUnitInterval(next_uint32());
+        return Eigen::Vector2d(x, y);
+    }
+}
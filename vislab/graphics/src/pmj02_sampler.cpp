@@ -0,0 +1,93 @@
+#include <vislab/graphics/pmj02_sampler.hpp>
+
+#include <vislab/graphics/owen_scrambling.hpp>
+
+#include <random>
+#include <vector>
+
+namespace vislab
+{
+    /**
+     * @brief Generates the table of pmj02 points as 32-bit fixed point coordinates, interleaved in x and y. The greedy construction by Christensen et al. runs into dead ends for large tables. Instead, the points are drawn from the equivalent distribution of a randomly Owen scrambled 2D Sobol sequence (Helmer et al., "Stochastic Generation of (t, s) Sample Sequences", EGSR 2021), which is constructed once with a fixed seed.
+     * @return Table of points.
+     */
+    static const std::vector<uint32_t>& pmj02Table()
+    {
+        static const std::vector<uint32_t> table = []()
+        {
+            constexpr uint32_t numDigits = 12;
+            static_assert((1U << numDigits) == PMJ02Sampler::TableSize, "Table size must match the number of digits.");
+
+            // random flips for each node of the binary tree of digit prefixes, stored in heap order
+            std::mt19937 rng(0x706d6a30);
+            std::vector<uint8_t> flips[2];
+            for (auto& f : flips)
+            {
+                f.resize(PMJ02Sampler::TableSize);
+                for (auto& flip : f)
+                    flip = rng() & 1;
+            }
+
+            std::vector<uint32_t> result(2 * PMJ02Sampler::TableSize);
+            for (uint32_t i = 0; i < PMJ02Sampler::TableSize; ++i)
+            {
+                uint32_t coords[2] = { OwenScrambling::reverseBits(i), 0 };
+                for (uint32_t index = i, v = 1U << 31; index != 0; index >>= 1, v ^= v >> 1)
+                    if (index & 1)
+                        coords[1] ^= v;
+
+                for (int c = 0; c < 2; ++c)
+                {
+                    // flip each digit depending on the preceding ones, and jitter within the finest strata
+                    uint32_t x = coords[c];
+                    for (uint32_t d = 0; d < numDigits; ++d)
+                    {
+                        uint32_t node = (1U << d) + (d == 0 ? 0 : (coords[c] >> (32 - d)));
+                        if (flips[c][node])
+                            x ^= 1U << (31 - d);
+                    }
+                    x                 = (x & ~((1U << (32 - numDigits)) - 1)) | (rng() >> numDigits);
+                    result[2 * i + c] = x;
+                }
+            }
+            return result;
+        }();
+        return table;
+    }
+
+    PMJ02Sampler::PMJ02Sampler()
+        : Sampler()
+    {
+        pmj02Table();
+        seed();
+    }
+
+    PMJ02Sampler::PMJ02Sampler(const PMJ02Sampler& other)
+        : Sampler(other)
+        , mScramblingSeed(other.mScramblingSeed)
+    {
+    }
+
+    void PMJ02Sampler::seed(uint64_t seed_offset)
+    {
+        Sampler::seed(seed_offset);
+        uint32_t baseSeed = OwenScrambling::hashCombine((uint32_t)mBaseSeed, (uint32_t)(mBaseSeed >> 32));
+        mScramblingSeed   = OwenScrambling::hashCombine(OwenScrambling::hashCombine(baseSeed, (uint32_t)seed_offset), (uint32_t)(seed_offset >> 32));
+    }
+
+    double PMJ02Sampler::next_1d()
+    {
+        return next_2d().x();
+    }
+
+    Eigen::Vector2d PMJ02Sampler::next_2d()
+    {
+        // shuffle the table, such that the dimensions are decorrelated, and apply a random digital shift, which keeps the stratification
+        const std::vector<uint32_t>& table = pmj02Table();
+        uint32_t seed                      = OwenScrambling::hashCombine(mScramblingSeed, mDimensionIndex++);
+        uint32_t index                     = OwenScrambling::nestedUniformScramble(mSampleIndex, seed) % TableSize;
+        uint32_t x                         = table[2 * index] ^ OwenScrambling::hashCombine(seed, 1);
+        uint32_t y                         = table[2 * index + 1] ^ OwenScrambling::hashCombine(seed, 2);
+        return Eigen::Vector2d(OwenScrambling::toUnitInterval(x), OwenScrambling::toUnitInterval(y));
+    }
+}
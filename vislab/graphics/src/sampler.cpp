@@ -6,6 +6,7 @@ namespace vislab
         : mSampleCount(4)
         , mSampleIndex(0)
         , mBaseSeed(0)
+        , mDimensionIndex(0)
     {
     }
 
@@ -13,22 +14,27 @@ namespace vislab
         : mSampleCount(other.mSampleCount)
         , mSampleIndex(other.mSampleIndex)
         , mBaseSeed(other.mBaseSeed)
+        , mDimensionIndex(other.mDimensionIndex)
     {
     }
 
     void Sampler::seed(uint64_t seed_offset)
     {
-        mSampleIndex = 0;
+        mSampleIndex    = 0;
+        mDimensionIndex = 0;
     }
 
     void Sampler::advance()
     {
         assert(mSampleIndex < mSampleCount);
         mSampleIndex++;
+        mDimensionIndex = 0;
     }
 
     uint32_t Sampler::getSampleIndex() const { return mSampleIndex; }
     uint32_t Sampler::getSampleCount() const { return mSampleCount; }
+    void Sampler::setSampleCount(uint32_t sampleCount) { mSampleCount = sampleCount; }
+    uint32_t Sampler::getDimensionIndex() const { return mDimensionIndex; }
     uint64_t Sampler::getBaseSeed() const { return mBaseSeed; }
     void Sampler::setBaseSeed(uint64_t baseSeed) { mBaseSeed = baseSeed; }
 }
@@ -6,13 +6,59 @@
 #include <vislab/graphics/preliminary_interaction.hpp>
 #include <vislab/graphics/shape.hpp>
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 namespace vislab
 {
+    /**
+     * @brief Computes the detailed surface interaction of the closest hit.
+     * @param ray Ray that was intersected.
+     * @param pi Preliminary intersection result.
+     * @return Surface interaction, which is invalid if there was no hit.
+     */
+    static SurfaceInteraction computeSurfaceInteraction(const Ray3d& ray, PreliminaryIntersection& pi)
+    {
+        // if there was no hit, return invalid surface interaction.
+        if (!pi.isValid())
+        {
+            SurfaceInteraction si;
+            si.wi = -ray.direction;
+            si.t  = std::numeric_limits<double>::infinity();
+            return si;
+        }
+
+        // compute detailed surface interaction for the closest hit (if there is one)
+        return pi.computeSurfaceInteraction(ray, EHitComputeFlag::All);
+    }
+
+    /**
+     * @brief Creates the ray for the visibility test of a light sample.
+     * @param it Interaction the ray starts from.
+     * @param ds Direction sample towards the light.
+     * @return Shadow ray.
+     */
+    static Ray3d shadowRay(const Interaction& it, const DirectionSample& ds)
+    {
+        return Ray3d(it.position, ds.direction, rayEpsilon() * (1. + it.position.cwiseAbs().maxCoeff()),
+                     ds.dist * (1. - shadowEpsilon()));
+    }
+
+    Scene::Scene()
+        : accelerationTreeType(EAccelerationTreeType::Wide)
+    {
+    }
+
     SurfaceInteraction Scene::intersect(const Ray3d& ray) const
     {
         // test all objects (linear for now...)
         PreliminaryIntersection pi;
-        if (mBoundingVolumeHierarchy)
+        if (mWideBoundingVolumeHierarchy)
+        {
+            pi = mWideBoundingVolumeHierarchy->preliminaryHit(ray);
+        }
+        else if (mBoundingVolumeHierarchy)
         {
             pi = mBoundingVolumeHierarchy->preliminaryHit(ray);
         }
@@ -27,23 +73,35 @@ namespace vislab
                 }
             }
         }
+        return computeSurfaceInteraction(ray, pi);
+    }
 
-        // if there was no hit, return invalid surface interaction.
-        if (!pi.isValid())
+    void Scene::intersect(const Ray3d* rays, size_t count, SurfaceInteraction* results) const
+    {
+        if (!mWideBoundingVolumeHierarchy)
         {
-            SurfaceInteraction si;
-            si.wi = -ray.direction;
-            si.t  = std::numeric_limits<double>::infinity();
-            return si;
+            for (size_t i = 0; i < count; ++i)
+                results[i] = intersect(rays[i]);
+            return;
         }
 
-        // compute detailed surface interaction for the closest hit (if there is one)
-        return pi.computeSurfaceInteraction(ray, EHitComputeFlag::All);
+        PreliminaryIntersection pi[WideBoundingVolumeHierarchy<Shape>::MaxPacketSize];
+        for (size_t begin = 0; begin < count; begin += WideBoundingVolumeHierarchy<Shape>::MaxPacketSize)
+        {
+            int size = (int)std::min(count - begin, (size_t)WideBoundingVolumeHierarchy<Shape>::MaxPacketSize);
+            mWideBoundingVolumeHierarchy->preliminaryHit(rays + begin, size, pi);
+            for (int i = 0; i < size; ++i)
+                results[begin + i] = computeSurfaceInteraction(rays[begin + i], pi[i]);
+        }
     }
 
     bool Scene::anyHit(const Ray3d& ray) const
     {
-        if (mBoundingVolumeHierarchy)
+        if (mWideBoundingVolumeHierarchy)
+        {
+            return mWideBoundingVolumeHierarchy->anyHit(ray);
+        }
+        else if (mBoundingVolumeHierarchy)
         {
             return mBoundingVolumeHierarchy->anyHit(ray);
         }
@@ -59,6 +117,17 @@ namespace vislab
         }
     }
 
+    void Scene::anyHit(const Ray3d* rays, size_t count, bool* hits) const
+    {
+        if (!mWideBoundingVolumeHierarchy)
+        {
+            for (size_t i = 0; i < count; ++i)
+                hits[i] = anyHit(rays[i]);
+            return;
+        }
+        mWideBoundingVolumeHierarchy->anyHit(rays, (int)count, hits);
+    }
+
     std::pair<DirectionSample, Spectrum> Scene::sampleLightDirection(const Interaction& it, const Eigen::Vector2d& sample_, bool test_visibility) const
     {
         Eigen::Vector2d sample(sample_);
@@ -97,10 +166,7 @@ namespace vislab
             // Perform a visibility test if requested
             if (test_visibility && ds.pdf != 0.f)
             {
-                Ray ray(it.position, ds.direction, rayEpsilon() * (1. + it.position.cwiseAbs().maxCoeff()),
-                        ds.dist * (1. - shadowEpsilon()));
-
-                if (anyHit(ray))
+                if (anyHit(shadowRay(it, ds)))
                     spec.setZero();
             }
         }
@@ -113,6 +179,41 @@ namespace vislab
         return { ds, spec };
     }
 
+    void Scene::sampleLightDirections(const Interaction& it, const Eigen::Vector2d* samples, size_t count, DirectionSample* ds, Spectrum* spec) const
+    {
+        if (count == 1)
+        {
+            std::tie(ds[0], spec[0]) = sampleLightDirection(it, samples[0], true);
+            return;
+        }
+
+        // sample the directions of one packet first, such that their shadow rays can be traced together without allocations
+        constexpr size_t PacketSize = WideBoundingVolumeHierarchy<Shape>::MaxPacketSize;
+        Ray3d rays[PacketSize];
+        size_t indices[PacketSize];
+        bool hits[PacketSize];
+        for (size_t begin = 0; begin < count; begin += PacketSize)
+        {
+            size_t end     = std::min(count, begin + PacketSize);
+            size_t numRays = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                std::tie(ds[i], spec[i]) = sampleLightDirection(it, samples[i], false);
+                if (ds[i].pdf != 0.f)
+                {
+                    rays[numRays]    = shadowRay(it, ds[i]);
+                    indices[numRays] = i;
+                    numRays++;
+                }
+            }
+
+            anyHit(rays, numRays, hits);
+            for (size_t i = 0; i < numRays; ++i)
+                if (hits[i])
+                    spec[indices[i]].setZero();
+        }
+    }
+
     double Scene::pdfLightDirection(const Interaction& ref, const DirectionSample& ds) const
     {
         double light_pdf = 1. / lights.size();
@@ -121,13 +222,50 @@ namespace vislab
 
     void Scene::buildAccelerationTree()
     {
-        mBoundingVolumeHierarchy = std::make_shared<BoundingVolumeHierarchy<Shape, 3>>();
+        mBoundingVolumeHierarchy = std::make_shared<FlatBoundingVolumeHierarchy<Shape>>();
         mBoundingVolumeHierarchy->getShapes().resize(shapes.size());
         for (size_t i = 0; i < shapes.size(); ++i)
         {
-            shapes[i]->buildAccelerationTree();
+            // shapes that share a mesh share its tree, which is built once and kept in sync through the positionsChanged event
+            if (!shapes[i]->hasAccelerationTree())
+                shapes[i]->buildAccelerationTree();
             mBoundingVolumeHierarchy->getShapes()[i] = shapes[i].get();
         }
         mBoundingVolumeHierarchy->build();
+
+        mWideBoundingVolumeHierarchy.reset();
+        if (accelerationTreeType == EAccelerationTreeType::Wide)
+        {
+            mWideBoundingVolumeHierarchy = std::make_shared<WideBoundingVolumeHierarchy<Shape>>();
+            mWideBoundingVolumeHierarchy->build(*mBoundingVolumeHierarchy);
+        }
+    }
+
+    bool Scene::updateAccelerationTree()
+    {
+        // a different set of shapes invalidates the tree
+        bool sameShapes = mBoundingVolumeHierarchy && mBoundingVolumeHierarchy->getShapes().size() == shapes.size();
+        for (size_t i = 0; sameShapes && i < shapes.size(); ++i)
+            sameShapes = mBoundingVolumeHierarchy->getShapes()[i] == shapes[i].get();
+        if (!sameShapes)
+        {
+            buildAccelerationTree();
+            return true;
+        }
+
+        // shapes may have received a new mesh, e.g., an animated level of detail, which needs its own tree
+        for (const auto& shape : shapes)
+            if (!shape->hasAccelerationTree())
+                shape->buildAccelerationTree();
+
+        bool rebuilt = mBoundingVolumeHierarchy->update();
+        if (mWideBoundingVolumeHierarchy)
+        {
+            if (rebuilt)
+                mWideBoundingVolumeHierarchy->build(*mBoundingVolumeHierarchy);
+            else
+                mWideBoundingVolumeHierarchy->refit(*mBoundingVolumeHierarchy);
+        }
+        return rebuilt;
     }
 }
@@ -79,4 +79,9 @@ namespace vislab
     void Shape::buildAccelerationTree()
     {
     }
+
+    bool Shape::hasAccelerationTree() const
+    {
+        return true;
+    }
 }
@@ -0,0 +1,69 @@
+#include <vislab/graphics/sobol_sampler.hpp>
+
+#include <vislab/graphics/owen_scrambling.hpp>
+
+#include <array>
+
+namespace vislab
+{
+    /**
+     * @brief Computes the second dimension of the Sobol sequence, whose generator matrix is the Pascal matrix modulo two. The matrix-vector product is linear in the digits, such that it is evaluated byte by byte from precomputed tables.
+     * @param index Index of the sample.
+     * @return Fixed point coordinate.
+     */
+    static uint32_t sobolSecondDimension(uint32_t index)
+    {
+        static const std::array<std::array<uint32_t, 256>, 4> tables = []()
+        {
+            std::array<std::array<uint32_t, 256>, 4> result;
+            for (uint32_t byte = 0; byte < 4; ++byte)
+                for (uint32_t value = 0; value < 256; ++value)
+                {
+                    uint32_t entry = 0;
+                    uint32_t bits  = value << (8 * byte);
+                    for (uint32_t v = 1U << 31; bits != 0; bits >>= 1, v ^= v >> 1)
+                        if (bits & 1)
+                            entry ^= v;
+                    result[byte][value] = entry;
+                }
+            return result;
+        }();
+        return tables[0][index & 0xff] ^ tables[1][(index >> 8) & 0xff] ^ tables[2][(index >> 16) & 0xff] ^ tables[3][index >> 24];
+    }
+
+    SobolSampler::SobolSampler()
+        : Sampler()
+    {
+        seed();
+    }
+
+    SobolSampler::SobolSampler(const SobolSampler& other)
+        : Sampler(other)
+        , mScramblingSeed(other.mScramblingSeed)
+    {
+    }
+
+    void SobolSampler::seed(uint64_t seed_offset)
+    {
+        Sampler::seed(seed_offset);
+        uint32_t baseSeed = OwenScrambling::hashCombine((uint32_t)mBaseSeed, (uint32_t)(mBaseSeed >> 32));
+        mScramblingSeed   = OwenScrambling::hashCombine(OwenScrambling::hashCombine(baseSeed, (uint32_t)seed_offset), (uint32_t)(seed_offset >> 32));
+    }
+
+    double SobolSampler::next_1d()
+    {
+        uint32_t seed  = OwenScrambling::hashCombine(mScramblingSeed, mDimensionIndex++);
+        uint32_t index = OwenScrambling::nestedUniformScramble(mSampleIndex, seed);
+        return OwenScrambling::toUnitInterval(OwenScrambling::nestedUniformScramble(OwenScrambling::reverseBits(index), OwenScrambling::hashCombine(seed, 1)));
+    }
+
+    Eigen::Vector2d SobolSampler::next_2d()
+    {
+        // shuffle the sample index, such that the dimensions are decorrelated, and scramble both coordinates
+        uint32_t seed  = OwenScrambling::hashCombine(mScramblingSeed, mDimensionIndex++);
+        uint32_t index = OwenScrambling::nestedUniformScramble(mSampleIndex, seed);
+        uint32_t x     = OwenScrambling::nestedUniformScramble(OwenScrambling::reverseBits(index), OwenScrambling::hashCombine(seed, 1));
+        uint32_t y     = OwenScrambling::nestedUniformScramble(sobolSecondDimension(index), OwenScrambling::hashCombine(seed, 2));
+        return Eigen::Vector2d(OwenScrambling::toUnitInterval(x), OwenScrambling::toUnitInterval(y));
+    }
+}
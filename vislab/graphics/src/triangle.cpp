@@ -60,6 +60,12 @@ namespace vislab
         return pi;
     }
 
+    int32_t Triangle::countHits(const Ray3d& ray_) const
+    {
+        Ray3d ray = transform.transformRayInverse(ray_);
+        return mesh->countHits(ray);
+    }
+
     SurfaceInteraction Triangle::computeSurfaceInteraction(const Ray3d& ray_, const PreliminaryIntersection& pi, EHitComputeFlag flags) const
     {
         Ray3d ray             = transform.transformRayInverse(ray_);
@@ -74,4 +80,9 @@ namespace vislab
     {
         mesh->buildAccelerationTree();
     }
+
+    bool Triangle::hasAccelerationTree() const
+    {
+        return !mesh || mesh->hasAccelerationTree();
+    }
 }
@@ -0,0 +1,57 @@
+#include "vislab/graphics/accumulation_buffer.hpp"
+#include "vislab/graphics/image.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+#include <random>
+
+namespace vislab
+{
+    TEST(graphics, accumulation_buffer)
+    {
+        AccumulationBuffer buffer;
+        buffer.setResolution(Eigen::Vector2i(2, 1));
+
+        // the running statistics agree with the two-pass estimates
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> uniform(0, 1);
+        std::vector<Spectrum> samples;
+        for (int i = 0; i < 100; ++i)
+        {
+            samples.push_back(Spectrum(uniform(rng), uniform(rng), uniform(rng)));
+            buffer.addSample(0, samples.back(), true);
+        }
+        buffer.addSample(0, Spectrum(100, 100, 100), false);
+
+        Spectrum mean = Spectrum::Zero();
+        for (const Spectrum& s : samples)
+            mean += s;
+        mean /= samples.size();
+        double meanLuminance = 0.2126 * mean.x() + 0.7152 * mean.y() + 0.0722 * mean.z();
+        double variance      = 0;
+        for (const Spectrum& s : samples)
+            variance += std::pow(0.2126 * s.x() + 0.7152 * s.y() + 0.0722 * s.z() - meanLuminance, 2);
+        variance /= samples.size() - 1;
+
+        EXPECT_EQ(buffer.getSampleCount(0), 101);
+        EXPECT_LT((buffer.getRadiance(0) - mean).norm(), 1E-12);
+        EXPECT_NEAR(buffer.getVariance(0), variance, 1E-12);
+        EXPECT_NEAR(buffer.getRelativeError(0), std::sqrt(variance / samples.size()) / meanLuminance, 1E-12);
+
+        // pixels without valid samples are not refined and not written
+        buffer.addSample(1, Spectrum::Zero(), false);
+        EXPECT_EQ(buffer.getRelativeError(1), 0);
+        Image3d image;
+        image.setResolution(2, 1);
+        image.setValue(1, Eigen::Vector3d(0.5, 0.5, 0.5));
+        buffer.resolve(&image, false);
+        EXPECT_LT((image.getValue(0) - mean).norm(), 1E-12);
+        EXPECT_EQ(image.getValue(1), Eigen::Vector3d(0.5, 0.5, 0.5));
+
+        // a single valid sample does not tell the error yet
+        buffer.clear();
+        buffer.addSample(0, Spectrum::Ones(), true);
+        EXPECT_EQ(buffer.getRelativeError(0), std::numeric_limits<double>::infinity());
+    }
+}
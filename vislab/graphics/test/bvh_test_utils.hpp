@@ -0,0 +1,163 @@
+#pragma once
+
+#include "vislab/graphics/mesh.hpp"
+#include "vislab/graphics/preliminary_interaction.hpp"
+#include "vislab/graphics/ray.hpp"
+
+#include "vislab/core/array.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace vislab
+{
+    /**
+     * @brief Axis-aligned box that can be stored in a bounding volume hierarchy.
+     */
+    struct TestBox
+    {
+        Eigen::AlignedBox3d worldBounds() const { return box; }
+
+        PreliminaryIntersection preliminaryHit(const Ray3d& ray) const
+        {
+            // slab test, returns the entry point or the exit point if the ray starts inside
+            Eigen::Vector3d t0 = (box.min() - ray.origin).cwiseQuotient(ray.direction);
+            Eigen::Vector3d t1 = (box.max() - ray.origin).cwiseQuotient(ray.direction);
+            double tNear       = t0.cwiseMin(t1).maxCoeff();
+            double tFar        = t0.cwiseMax(t1).minCoeff();
+            double tHit        = tNear >= ray.tMin ? tNear : tFar;
+
+            PreliminaryIntersection pi;
+            if (tNear <= tFar && ray.tMin <= tHit && tHit <= ray.tMax)
+            {
+                pi.t          = tHit;
+                pi.prim_index = index;
+            }
+            return pi;
+        }
+
+        bool anyHit(const Ray3d& ray) const { return preliminaryHit(ray).isValid(); }
+
+        Eigen::AlignedBox3d box;
+        uint32_t index;
+    };
+
+    /**
+     * @brief Creates a closed cube with corners at -1 and 1.
+     * @return Cube mesh with two triangles per side.
+     */
+    inline std::shared_ptr<Mesh> createUnitCube()
+    {
+        auto mesh       = std::make_shared<Mesh>();
+        mesh->positions = std::make_shared<Array3f>();
+        mesh->indices   = std::make_shared<Array3ui>();
+        mesh->positions->setSize(8);
+        for (uint32_t i = 0; i < 8; ++i)
+            mesh->positions->setValue(i, Eigen::Vector3f(i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1));
+        mesh->indices->setValues({ Eigen::Vector3u(0, 2, 1), Eigen::Vector3u(1, 2, 3),
+                                   Eigen::Vector3u(4, 5, 6), Eigen::Vector3u(5, 7, 6),
+                                   Eigen::Vector3u(0, 1, 4), Eigen::Vector3u(1, 5, 4),
+                                   Eigen::Vector3u(2, 6, 3), Eigen::Vector3u(3, 6, 7),
+                                   Eigen::Vector3u(0, 4, 2), Eigen::Vector3u(2, 4, 6),
+                                   Eigen::Vector3u(1, 3, 5), Eigen::Vector3u(3, 7, 5) });
+        return mesh;
+    }
+
+    /**
+     * @brief Creates rays from random points on a sphere towards random points in a cube.
+     * @param count Number of rays.
+     * @param rng Random number generator.
+     * @param scale Half size of the target cube. The sphere has three times this radius.
+     * @return Rays that are long enough to pass the cube.
+     */
+    inline std::vector<Ray3d> createTestRays(int count, std::mt19937& rng, double scale = 1)
+    {
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        std::vector<Ray3d> rays(count);
+        for (Ray3d& ray : rays)
+        {
+            Eigen::Vector3d origin = Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)).normalized() * 3 * scale;
+            Eigen::Vector3d target = Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)) * scale;
+            ray                    = Ray3d(origin, (target - origin).normalized(), 0, 10 * scale);
+        }
+        return rays;
+    }
+
+    /**
+     * @brief Creates rays towards [-1,1]^3 with a fixed seed.
+     * @param count Number of rays.
+     * @return Rays that are long enough to pass the cube.
+     */
+    inline std::vector<Ray3d> createTestRays(int count)
+    {
+        std::mt19937 rng(1);
+        return createTestRays(count, rng);
+    }
+
+    /**
+     * @brief Gives access to a shape that is stored by value.
+     */
+    template <class TShape>
+    const TShape& dereference(const TShape& shape) { return shape; }
+
+    /**
+     * @brief Gives access to a shape that is stored by a shared pointer.
+     */
+    template <class TShape>
+    const TShape& dereference(const std::shared_ptr<TShape>& shape) { return *shape; }
+
+    /**
+     * @brief Intersects a ray with each shape, which is the reference for the acceleration data structures.
+     * @tparam TShapes Container of shapes or of pointers to shapes.
+     * @param shapes Shapes to test.
+     * @param ray Ray to test against.
+     * @param hits Receives the number of intersected shapes.
+     * @return Closest intersection.
+     */
+    template <class TShapes>
+    PreliminaryIntersection linearSearch(const TShapes& shapes, const Ray3d& ray, int32_t& hits)
+    {
+        PreliminaryIntersection closest;
+        hits = 0;
+        for (const auto& shape : shapes)
+        {
+            PreliminaryIntersection pi = dereference(shape).preliminaryHit(ray);
+            if (pi.isValid())
+                hits++;
+            if (pi.t < closest.t)
+                closest = pi;
+        }
+        return closest;
+    }
+
+    /**
+     * @brief Checks that a tree over test boxes finds the same closest hits, shadow hits and hit counts as a linear search.
+     * @tparam TTree Bounding volume hierarchy over TestBox.
+     * @param bvh Tree to check.
+     * @param boxes Boxes in the tree.
+     * @param rays Rays to test.
+     */
+    template <class TTree>
+    void expectSameHitsAsLinearSearch(const TTree& bvh, const std::vector<TestBox>& boxes, const std::vector<Ray3d>& rays = createTestRays(1000))
+    {
+        for (const Ray3d& ray : rays)
+        {
+            int32_t expectedHits;
+            PreliminaryIntersection expected = linearSearch(boxes, ray, expectedHits);
+
+            PreliminaryIntersection pi = bvh.preliminaryHit(ray);
+            EXPECT_EQ(pi.isValid(), expected.isValid());
+            if (expected.isValid())
+            {
+                EXPECT_EQ(pi.t, expected.t);
+                EXPECT_EQ(pi.prim_index, expected.prim_index);
+            }
+            EXPECT_EQ(bvh.anyHit(ray), expected.isValid());
+            EXPECT_EQ(bvh.countHits(ray), expectedHits);
+        }
+    }
+}
@@ -0,0 +1,299 @@
+#include "vislab/graphics/flat_bounding_volume_hierarchy.hpp"
+#include "vislab/graphics/mesh.hpp"
+#include "vislab/graphics/ray.hpp"
+
+#include "vislab/core/array.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+#include "bvh_test_utils.hpp"
+
+#include <random>
+
+namespace vislab
+{
+    static std::vector<Ray3d> createAxisParallelTestRays(int count)
+    {
+        // directions with negative zero components, whose inverse is negative infinity
+        const Eigen::Vector3d directions[] = {
+            Eigen::Vector3d(-0., 0., 1.),
+            Eigen::Vector3d(0., -0., -1.),
+            -Eigen::Vector3d::UnitZ(),
+            -Eigen::Vector3d::UnitX(),
+            Eigen::Vector3d(-0., -1., -0.),
+        };
+        std::mt19937 rng(2);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        std::vector<Ray3d> rays(count);
+        for (int i = 0; i < count; ++i)
+        {
+            const Eigen::Vector3d& direction = directions[i % 5];
+            Eigen::Vector3d origin           = Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)) - 3 * direction;
+            rays[i]                          = Ray3d(origin, direction, 0, 10);
+        }
+        return rays;
+    }
+
+    static void expectChildrenInsideParents(const FlatBoundingVolumeHierarchy<TestBox>& bvh)
+    {
+        const auto& nodes = bvh.getNodes();
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            if (nodes[i].isLeaf())
+                continue;
+            for (size_t child : { i + 1, (size_t)nodes[i].offset })
+                for (int k = 0; k < 3; ++k)
+                {
+                    EXPECT_LE(nodes[i].min[k], nodes[child].min[k]);
+                    EXPECT_GE(nodes[i].max[k], nodes[child].max[k]);
+                }
+        }
+    }
+
+    static int treeDepth(const FlatBoundingVolumeHierarchy<TestBox>& bvh)
+    {
+        const auto& nodes = bvh.getNodes();
+        std::vector<int> depth(nodes.size(), 0);
+        int maxDepth = 0;
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            maxDepth = std::max(maxDepth, depth[i]);
+            if (!nodes[i].isLeaf())
+                depth[i + 1] = depth[nodes[i].offset] = depth[i] + 1;
+        }
+        return maxDepth;
+    }
+
+    static void expectValidTree(const FlatBoundingVolumeHierarchy<TestBox>& bvh, size_t numShapes)
+    {
+        // depth-first layout: the first child follows its parent, each primitive is in exactly one small leaf, children are inside their parent, and the depth is bounded
+        const auto& nodes = bvh.getNodes();
+        std::vector<int> referenced(numShapes, 0);
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            if (nodes[i].isLeaf())
+            {
+                EXPECT_LE(nodes[i].count, FlatBoundingVolumeHierarchy<TestBox>::MaxLeafSize);
+                for (uint32_t j = nodes[i].offset; j < nodes[i].offset + nodes[i].count; ++j)
+                    referenced[j]++;
+                continue;
+            }
+            ASSERT_GT(nodes[i].offset, i + 1);
+            ASSERT_LT(nodes[i].offset, nodes.size());
+        }
+        for (int count : referenced)
+            EXPECT_EQ(count, 1);
+        expectChildrenInsideParents(bvh);
+        EXPECT_LE(treeDepth(bvh), FlatBoundingVolumeHierarchy<TestBox>::MaxDepth);
+    }
+
+    TEST(graphics, flat_bounding_volume_hierarchy)
+    {
+        // random boxes in [-1,1]^3
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        std::vector<TestBox> boxes(500);
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+        {
+            Eigen::Vector3d center(uniform(rng), uniform(rng), uniform(rng));
+            Eigen::Vector3d size = Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)).cwiseAbs() * 0.1;
+            boxes[i].box         = Eigen::AlignedBox3d(center - size, center + size);
+            boxes[i].index       = i;
+        }
+
+        FlatBoundingVolumeHierarchy<TestBox> bvh;
+        for (TestBox& box : boxes)
+            bvh.getShapes().push_back(&box);
+        bvh.build();
+        expectValidTree(bvh, boxes.size());
+
+        // same results as a linear search, also for axis-parallel rays with negative zero components
+        expectSameHitsAsLinearSearch(bvh, boxes);
+        expectSameHitsAsLinearSearch(bvh, boxes, createAxisParallelTestRays(1000));
+        Ray3d ray(Eigen::Vector3d(boxes[0].box.center().x(), boxes[0].box.center().y(), 3), Eigen::Vector3d(-0., 0., -1.), 0, 10);
+        EXPECT_TRUE(bvh.preliminaryHit(ray).isValid());
+        EXPECT_TRUE(bvh.anyHit(ray));
+    }
+
+    TEST(graphics, flat_bounding_volume_hierarchy_refit)
+    {
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        std::vector<TestBox> boxes(500);
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+        {
+            Eigen::Vector3d center(uniform(rng), uniform(rng), uniform(rng));
+            boxes[i].box   = Eigen::AlignedBox3d(center.array() - 0.05, center.array() + 0.05);
+            boxes[i].index = i;
+        }
+
+        FlatBoundingVolumeHierarchy<TestBox> bvh;
+        for (TestBox& box : boxes)
+            bvh.getShapes().push_back(&box);
+        bvh.build();
+        size_t numNodes  = bvh.getNodes().size();
+        double buildCost = bvh.getCost();
+        EXPECT_GT(buildCost, 0);
+
+        // small motion keeps the topology and the tree stays correct
+        for (TestBox& box : boxes)
+            box.box.translate(Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)) * 0.02);
+        EXPECT_FALSE(bvh.update());
+        EXPECT_EQ(bvh.getNodes().size(), numNodes);
+        expectChildrenInsideParents(bvh);
+        expectSameHitsAsLinearSearch(bvh, boxes);
+
+        // growing all boxes increases the cost of the refitted tree
+        for (TestBox& box : boxes)
+            box.box = Eigen::AlignedBox3d(box.box.min().array() - 0.01, box.box.max().array() + 0.01);
+        bvh.refit();
+        EXPECT_GT(bvh.getCost(), buildCost);
+        expectSameHitsAsLinearSearch(bvh, boxes);
+
+        // shuffling the boxes degrades the refitted tree, which triggers a rebuild
+        buildCost = bvh.getCost();
+        std::shuffle(boxes.begin(), boxes.end(), rng);
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+            boxes[i].index = i;
+        EXPECT_TRUE(bvh.update());
+        EXPECT_LT(bvh.getCost(), 1.5 * buildCost);
+        expectChildrenInsideParents(bvh);
+        expectSameHitsAsLinearSearch(bvh, boxes);
+    }
+
+    TEST(graphics, flat_bounding_volume_hierarchy_build)
+    {
+        using BVH = FlatBoundingVolumeHierarchy<TestBox>;
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        auto build = [](BVH& bvh, std::vector<TestBox>& boxes)
+        {
+            bvh.getShapes().clear();
+            for (TestBox& box : boxes)
+                bvh.getShapes().push_back(&box);
+            bvh.build();
+        };
+
+        // boxes with coincident centroids cannot be separated by a split plane, yet the leaves stay small
+        std::vector<TestBox> boxes(100);
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+        {
+            Eigen::Vector3d size = Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)).cwiseAbs() * 0.5;
+            boxes[i].box         = Eigen::AlignedBox3d(-size, size);
+            boxes[i].index       = i;
+        }
+        BVH bvh;
+        build(bvh, boxes);
+        expectValidTree(bvh, boxes.size());
+        expectSameHitsAsLinearSearch(bvh, boxes);
+
+        // tight clusters that the surface area heuristic would keep in one leaf are split until the leaves are small enough
+        boxes.resize(400);
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+        {
+            Eigen::Vector3d center = Eigen::Vector3d(i / 40, i / 40 % 2, 0) * 0.2 + Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)) * 1E-4;
+            boxes[i].box           = Eigen::AlignedBox3d(center.array() - 0.05, center.array() + 0.05);
+            boxes[i].index         = i;
+        }
+        build(bvh, boxes);
+        expectValidTree(bvh, boxes.size());
+        expectSameHitsAsLinearSearch(bvh, boxes);
+
+        // boxes that shrink geometrically along alternating axes make the heuristic split off one box per level, until median splits bound the depth
+        boxes.resize(180);
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+        {
+            double size            = std::pow(4., -(double)i / 3);
+            Eigen::Vector3d center = Eigen::Vector3d::Unit(i % 3) * 0.9 * size;
+            boxes[i].box           = Eigen::AlignedBox3d(center.array() - 0.15 * size, center.array() + 0.15 * size);
+            boxes[i].index         = i;
+        }
+        build(bvh, boxes);
+        expectValidTree(bvh, boxes.size());
+        EXPECT_GE(treeDepth(bvh), BVH::MaxDepth - 2);
+        expectSameHitsAsLinearSearch(bvh, boxes);
+
+        // ranges above 4096 primitives are built in parallel, smaller ones serially
+        for (size_t count : { 1000, 20000 })
+        {
+            boxes.resize(count);
+            for (uint32_t i = 0; i < boxes.size(); ++i)
+            {
+                Eigen::Vector3d center(uniform(rng), uniform(rng), uniform(rng));
+                boxes[i].box   = Eigen::AlignedBox3d(center.array() - 0.01, center.array() + 0.01);
+                boxes[i].index = i;
+            }
+            build(bvh, boxes);
+            expectValidTree(bvh, boxes.size());
+            expectSameHitsAsLinearSearch(bvh, boxes);
+        }
+    }
+
+    TEST(graphics, flat_bounding_volume_hierarchy_mesh)
+    {
+        // latitude-longitude sphere
+        const int numTheta = 24, numPhi = 48;
+        auto mesh          = std::make_shared<Mesh>();
+        mesh->positions    = std::make_shared<Array3f>();
+        mesh->indices      = std::make_shared<Array3ui>();
+        for (int i = 0; i <= numTheta; ++i)
+            for (int j = 0; j <= numPhi; ++j)
+            {
+                double theta = EIGEN_PI * i / numTheta, phi = 2 * EIGEN_PI * j / numPhi;
+                mesh->positions->append(Eigen::Vector3f(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)));
+            }
+        for (uint32_t i = 0; i < numTheta; ++i)
+            for (uint32_t j = 0; j < numPhi; ++j)
+            {
+                uint32_t v = i * (numPhi + 1) + j;
+                mesh->indices->append(Eigen::Vector3u(v, v + numPhi + 1, v + numPhi + 2));
+                mesh->indices->append(Eigen::Vector3u(v, v + numPhi + 2, v + 1));
+            }
+
+        // linear search before the tree is built
+        std::vector<Ray3d> rays = createTestRays(500);
+        std::vector<PreliminaryIntersection> expected;
+        std::vector<int32_t> expectedHits;
+        for (const Ray3d& ray : rays)
+        {
+            expected.push_back(mesh->preliminaryHit(ray));
+            expectedHits.push_back(mesh->countHits(ray));
+        }
+
+        mesh->buildAccelerationTree();
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            PreliminaryIntersection pi = mesh->preliminaryHit(rays[i]);
+            EXPECT_EQ(pi.isValid(), expected[i].isValid());
+            if (expected[i].isValid())
+            {
+                EXPECT_EQ(pi.t, expected[i].t);
+                EXPECT_EQ(pi.prim_index, expected[i].prim_index);
+            }
+            EXPECT_EQ(mesh->countHits(rays[i]), expectedHits[i]);
+        }
+
+        // deform the sphere into an ellipsoid, the tree follows the positions through the event
+        for (Eigen::Index i = 0; i < mesh->positions->getSize(); ++i)
+            mesh->positions->setValue(i, mesh->positions->getValue(i).cwiseProduct(Eigen::Vector3f(1.5f, 0.5f, 1.0f)));
+        mesh->positionsChanged.notify(mesh.get());
+        for (const Ray3d& ray : rays)
+        {
+            PreliminaryIntersection expected;
+            for (uint32_t face = 0; face < mesh->indices->getSize(); ++face)
+            {
+                PreliminaryIntersection pi = mesh->rayTriangleIntersection(face, ray);
+                if (pi.isValid() && ray.tMin < pi.t && pi.t <= ray.tMax && pi.t < expected.t)
+                    expected = pi;
+            }
+            PreliminaryIntersection pi = mesh->preliminaryHit(ray);
+            EXPECT_EQ(pi.isValid(), expected.isValid());
+            if (expected.isValid())
+            {
+                EXPECT_EQ(pi.t, expected.t);
+                EXPECT_EQ(pi.prim_index, expected.prim_index);
+            }
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#include "vislab/graphics/mesh.hpp"
+#include "vislab/graphics/ray.hpp"
+
+#include "vislab/core/array.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+#include "bvh_test_utils.hpp"
+
+#include <algorithm>
+
+namespace vislab
+{
+    TEST(graphics, mesh_edges)
+    {
+        auto mesh = createUnitCube();
+        mesh->recomputeEdges();
+
+        // 12 edges of the cube and one diagonal per side
+        ASSERT_EQ(mesh->edges->getSize(), 18);
+        ASSERT_EQ(mesh->edgeFaces->getSize(), 18);
+        for (Eigen::Index i = 0; i < mesh->edges->getSize(); ++i)
+        {
+            Eigen::Vector2u edge  = mesh->edges->getValue(i);
+            Eigen::Vector2u faces = mesh->edgeFaces->getValue(i);
+            EXPECT_LT(edge.x(), edge.y());
+
+            // closed mesh, hence each edge is shared by two distinct faces that both contain the edge
+            EXPECT_NE(faces.x(), faces.y());
+            for (int j = 0; j < 2; ++j)
+            {
+                Eigen::Vector3u face = mesh->indices->getValue(faces[j]);
+                EXPECT_TRUE((face.array() == edge.x()).any());
+                EXPECT_TRUE((face.array() == edge.y()).any());
+            }
+        }
+
+        // edge j of each face connects its corners j and j+1
+        ASSERT_EQ(mesh->faceEdges->getSize(), mesh->indices->getSize());
+        for (Eigen::Index i = 0; i < mesh->indices->getSize(); ++i)
+        {
+            Eigen::Vector3u face = mesh->indices->getValue(i);
+            for (int j = 0; j < 3; ++j)
+            {
+                Eigen::Vector2u edge = mesh->edges->getValue(mesh->faceEdges->getValue(i)[j]);
+                EXPECT_EQ(edge.x(), std::min(face[j], face[(j + 1) % 3]));
+                EXPECT_EQ(edge.y(), std::max(face[j], face[(j + 1) % 3]));
+            }
+        }
+    }
+
+    TEST(graphics, mesh_count_hits)
+    {
+        auto mesh = createUnitCube();
+
+        // through the cube, starting inside, and missing it
+        Ray3d through(Eigen::Vector3d(-3, 0.1, 0.2), Eigen::Vector3d(1, 0, 0), 0, 10);
+        Ray3d inside(Eigen::Vector3d(0.1, 0.2, 0.3), Eigen::Vector3d(0, 1, 0), 0, 10);
+        Ray3d miss(Eigen::Vector3d(-3, 2, 0), Eigen::Vector3d(1, 0, 0), 0, 10);
+        Ray3d shortRay(Eigen::Vector3d(-3, 0.1, 0.2), Eigen::Vector3d(1, 0, 0), 0, 1);
+
+        // linear search
+        EXPECT_EQ(mesh->countHits(through), 2);
+        EXPECT_EQ(mesh->countHits(inside), 1);
+        EXPECT_EQ(mesh->countHits(miss), 0);
+        EXPECT_EQ(mesh->countHits(shortRay), 0);
+
+        // acceleration tree has to give the same result
+        mesh->buildAccelerationTree();
+        EXPECT_TRUE(mesh->hasAccelerationTree());
+        EXPECT_EQ(mesh->countHits(through), 2);
+        EXPECT_EQ(mesh->countHits(inside), 1);
+        EXPECT_EQ(mesh->countHits(miss), 0);
+        EXPECT_EQ(mesh->countHits(shortRay), 0);
+    }
+
+    TEST(graphics, mesh_overlapping_faces)
+    {
+        auto mesh = createUnitCube();
+
+        // a box around the corner x=y=z=1 overlaps the faces of the three sides at that corner, a box next to the cube none
+        Eigen::AlignedBox3d corner(Eigen::Vector3d(0.9, 0.9, 0.9), Eigen::Vector3d(2, 2, 2));
+        Eigen::AlignedBox3d outside(Eigen::Vector3d(1.5, -0.5, -0.5), Eigen::Vector3d(2, 0.5, 0.5));
+        std::vector<uint32_t> linear, tree;
+        mesh->findOverlappingFaces(corner, linear);
+        mesh->findOverlappingFaces(outside, tree);
+        EXPECT_EQ(linear.size(), 6);
+        EXPECT_TRUE(tree.empty());
+
+        // acceleration tree has to give the same result
+        mesh->buildAccelerationTree();
+        mesh->findOverlappingFaces(corner, tree);
+        std::sort(tree.begin(), tree.end());
+        EXPECT_EQ(tree, linear);
+        mesh->findOverlappingFaces(outside, tree);
+        EXPECT_TRUE(tree.empty());
+    }
+}
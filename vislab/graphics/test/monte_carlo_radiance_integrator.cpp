@@ -0,0 +1,169 @@
+#include "vislab/graphics/area_light.hpp"
+#include "vislab/graphics/const_texture.hpp"
+#include "vislab/graphics/diffuse_bsdf.hpp"
+#include "vislab/graphics/direct_radiance_integrator.hpp"
+#include "vislab/graphics/image.hpp"
+#include "vislab/graphics/path_radiance_integrator.hpp"
+#include "vislab/graphics/perspective_camera.hpp"
+#include "vislab/graphics/rectangle.hpp"
+#include "vislab/graphics/scene.hpp"
+#include "vislab/graphics/sphere.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+namespace vislab
+{
+    static std::shared_ptr<Scene> createIntegratorTestScene(const Eigen::Vector2i& resolution)
+    {
+        auto scene  = std::make_shared<Scene>();
+        auto camera = std::make_shared<PerspectiveCamera>();
+        camera->setLookAt(Eigen::Vector3d(1, 0, 0));
+        camera->setPosition(Eigen::Vector3d(-3.5, 0, 0));
+        camera->setUp(Eigen::Vector3d(0, 0, 1));
+        camera->setNear(0.01);
+        camera->setFar(10);
+        camera->setWidth(resolution.x());
+        camera->setHeight(resolution.y());
+        scene->camera = camera;
+
+        // area light at the ceiling
+        auto lightShape             = std::make_shared<Rectangle>();
+        lightShape->bsdf            = std::make_shared<DiffuseBSDF>(std::make_shared<ConstTexture>(Spectrum(0, 0, 0)));
+        Eigen::Matrix4d transform   = Eigen::Matrix4d::Identity();
+        transform.block(0, 0, 3, 3) = Eigen::Quaterniond(Eigen::AngleAxisd(EIGEN_PI, Eigen::Vector3d(1, 0, 0))).toRotationMatrix() * 0.3;
+        transform.block(0, 3, 3, 1) = Eigen::Vector3d(0, 0, 0.9999);
+        lightShape->transform.setMatrix(transform);
+        scene->shapes.push_back(lightShape);
+        auto light        = std::make_shared<AreaLight>();
+        light->radiance   = Eigen::Vector3d(1, 1, 1) * 10;
+        light->shape      = lightShape;
+        lightShape->light = light;
+        scene->lights.push_back(light);
+
+        // floor, back wall and a sphere that casts a shadow
+        auto floor  = std::make_shared<Rectangle>();
+        floor->bsdf = std::make_shared<DiffuseBSDF>(std::make_shared<ConstTexture>(Spectrum(1, 1, 1)));
+        floor->transform.setMatrix(Eigen::Matrix4d::translate(Eigen::Vector3d(0, 0, -1)));
+        scene->shapes.push_back(floor);
+        auto back                   = std::make_shared<Rectangle>();
+        back->bsdf                  = std::make_shared<DiffuseBSDF>(std::make_shared<ConstTexture>(Spectrum(1, 0.3, 0.3)));
+        transform                   = Eigen::Matrix4d::Identity();
+        transform.block(0, 0, 3, 3) = Eigen::Quaterniond(Eigen::AngleAxisd(-EIGEN_PI / 2, Eigen::Vector3d(0, 1, 0))).toRotationMatrix();
+        transform.block(0, 3, 3, 1) = Eigen::Vector3d(1, 0, 0);
+        back->transform.setMatrix(transform);
+        scene->shapes.push_back(back);
+        auto sphere  = std::make_shared<Sphere>();
+        sphere->bsdf = std::make_shared<DiffuseBSDF>(std::make_shared<ConstTexture>(Spectrum(0.3, 1, 0.3)));
+        sphere->transform.setMatrix(Eigen::Matrix4d::translate(Eigen::Vector3d(0, 0.2, -0.6)) * Eigen::Matrix4d::scale(Eigen::Vector3d(0.4, 0.4, 0.4)));
+        scene->shapes.push_back(sphere);
+
+        scene->buildAccelerationTree();
+        return scene;
+    }
+
+    static void expectSameImageWithPackets(MonteCarloRadianceIntegrator& integrator)
+    {
+        // the resolution is not a multiple of the tile sizes, such that the border tiles are partial
+        Eigen::Vector2i resolution(37, 21);
+        auto scene = createIntegratorTestScene(resolution);
+        Image3d expected, packets;
+        expected.setResolution(resolution);
+        expected.setZero();
+        packets.setResolution(resolution);
+        packets.setZero();
+
+        integrator.setSamplesPerPixel(4);
+        integrator.packetTracing = false;
+        std::vector<int> covered(resolution.prod(), 0);
+        auto handle = integrator.tileCompleted.registerCallback([&covered, &resolution](MonteCarloRadianceIntegrator*, const Eigen::AlignedBox2i* tile)
+                                                                {
+                                                                    for (int y = tile->min().y(); y < tile->max().y(); ++y)
+                                                                        for (int x = tile->min().x(); x < tile->max().x(); ++x)
+                                                                            covered[y * resolution.x() + x]++;
+                                                                });
+        integrator.render(scene.get(), &expected);
+        integrator.tileCompleted.deregisterCallback(handle);
+
+        // the tiles cover each pixel exactly once
+        for (int count : covered)
+            EXPECT_EQ(count, 1);
+
+        integrator.packetTracing = true;
+        integrator.render(scene.get(), &packets);
+
+        bool anyLit = false;
+        for (Eigen::Index i = 0; i < (Eigen::Index)resolution.x() * resolution.y(); ++i)
+        {
+            EXPECT_EQ(packets.getValue(i), expected.getValue(i));
+            anyLit |= expected.getValue(i).maxCoeff() > 0;
+        }
+        EXPECT_TRUE(anyLit);
+    }
+
+    TEST(graphics, monte_carlo_radiance_integrator_packets)
+    {
+        // the packet traversal renders the same image as single rays
+        DirectRadianceIntegrator direct;
+        direct.lightSamples = 4;
+        expectSameImageWithPackets(direct);
+
+        PathRadianceIntegrator path;
+        path.maxDepth = 3;
+        expectSameImageWithPackets(path);
+    }
+
+    TEST(graphics, monte_carlo_radiance_integrator_progressive)
+    {
+        Eigen::Vector2i resolution(24, 16);
+        auto scene = createIntegratorTestScene(resolution);
+        Image3d image;
+        image.setResolution(resolution);
+        image.setZero();
+
+        DirectRadianceIntegrator integrator;
+        integrator.setSamplesPerPixel(4);
+        integrator.relativeErrorThreshold = 0.05;
+        integrator.maxSamplesPerPixel     = 64;
+        size_t numPasses                  = 0;
+        integrator.passCompleted.registerCallback([&numPasses](MonteCarloRadianceIntegrator*, const size_t* pass)
+                                                  { EXPECT_EQ(*pass, numPasses++); });
+        integrator.render(scene.get(), &image);
+
+        // each pixel converged or reached the maximum, and the easy pixels received fewer samples
+        const AccumulationBuffer& buffer = integrator.getAccumulationBuffer();
+        size_t totalSamples              = 0;
+        for (int64_t i = 0; i < (int64_t)resolution.prod(); ++i)
+        {
+            uint32_t count = buffer.getSampleCount(i);
+            EXPECT_GE(count, 4);
+            EXPECT_LE(count, 64);
+            EXPECT_EQ(count % 4, 0);
+            if (count < 64)
+            {
+                EXPECT_LE(buffer.getRelativeError(i), 0.05);
+            }
+            totalSamples += count;
+        }
+        EXPECT_GT(numPasses, 1);
+        EXPECT_LT(totalSamples, 64 * resolution.prod());
+        EXPECT_GT(totalSamples, 4 * resolution.prod());
+
+        // the image shows the accumulated radiance
+        Image3d expected;
+        expected.setResolution(resolution);
+        expected.setZero();
+        buffer.resolve(&expected);
+        for (int64_t i = 0; i < (int64_t)resolution.prod(); ++i)
+            EXPECT_EQ(image.getValue(i), expected.getValue(i));
+
+        // an exhausted time budget stops after the first pass
+        integrator.relativeErrorThreshold = 0;
+        integrator.timeBudget             = 1E-9;
+        numPasses                         = 0;
+        integrator.render(scene.get(), &image);
+        EXPECT_EQ(numPasses, 1);
+        for (int64_t i = 0; i < (int64_t)resolution.prod(); ++i)
+            EXPECT_EQ(integrator.getAccumulationBuffer().getSampleCount(i), 4);
+    }
+}
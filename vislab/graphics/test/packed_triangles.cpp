@@ -0,0 +1,125 @@
+#include "vislab/graphics/packed_triangles.hpp"
+#include "vislab/graphics/mesh.hpp"
+#include "vislab/graphics/ray.hpp"
+
+#include "vislab/core/array.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+#include <random>
+
+namespace vislab
+{
+    TEST(graphics, packed_triangles_watertight)
+    {
+        // regular grid in the plane z=0, whose vertices and edges are shared by several triangles
+        const int resolution = 16;
+        auto mesh            = std::make_shared<Mesh>();
+        mesh->positions      = std::make_shared<Array3f>();
+        mesh->indices        = std::make_shared<Array3ui>();
+        for (int i = 0; i <= resolution; ++i)
+            for (int j = 0; j <= resolution; ++j)
+                mesh->positions->append(Eigen::Vector3f(2.f * j / resolution - 1, 2.f * i / resolution - 1, 0));
+        for (uint32_t i = 0; i < resolution; ++i)
+            for (uint32_t j = 0; j < resolution; ++j)
+            {
+                uint32_t v = i * (resolution + 1) + j;
+                mesh->indices->append(Eigen::Vector3u(v, v + 1, v + resolution + 2));
+                mesh->indices->append(Eigen::Vector3u(v, v + resolution + 2, v + resolution + 1));
+            }
+        mesh->packTriangles = true;
+        for (EAccelerationTreeType type : { EAccelerationTreeType::Binary, EAccelerationTreeType::Wide })
+        {
+            mesh->accelerationTreeType = type;
+            mesh->buildAccelerationTree();
+
+            // rays through interior vertices and edge midpoints never slip through the surface
+            std::mt19937 rng(0);
+            std::uniform_real_distribution<double> uniform(-1, 1);
+            for (int i = 1; i < resolution; ++i)
+                for (int j = 1; j < resolution; ++j)
+                    for (int k = 0; k < 4; ++k)
+                    {
+                        Eigen::Vector3d target(2. * j / resolution - 1, 2. * i / resolution - 1, 0);
+                        if (k == 1)
+                            target.x() += 1. / resolution;
+                        else if (k == 2)
+                            target.y() += 1. / resolution;
+                        else if (k == 3)
+                            target += Eigen::Vector3d(1. / resolution, 1. / resolution, 0);
+                        Eigen::Vector3d origin(uniform(rng), uniform(rng), 1 + uniform(rng) * 0.5);
+                        Ray3d ray(origin, (target - origin).normalized(), 0, 10);
+                        PreliminaryIntersection pi = mesh->preliminaryHit(ray);
+                        ASSERT_TRUE(pi.isValid());
+                        EXPECT_NEAR(pi.t, (target - origin).norm(), 1E-5);
+                    }
+        }
+    }
+
+    TEST(graphics, packed_triangles_mesh)
+    {
+        // latitude-longitude sphere
+        const int numTheta = 24, numPhi = 48;
+        auto mesh          = std::make_shared<Mesh>();
+        mesh->positions    = std::make_shared<Array3f>();
+        mesh->indices      = std::make_shared<Array3ui>();
+        for (int i = 0; i <= numTheta; ++i)
+            for (int j = 0; j <= numPhi; ++j)
+            {
+                double theta = EIGEN_PI * i / numTheta, phi = 2 * EIGEN_PI * j / numPhi;
+                mesh->positions->append(Eigen::Vector3f(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)));
+            }
+        for (uint32_t i = 0; i < numTheta; ++i)
+            for (uint32_t j = 0; j < numPhi; ++j)
+            {
+                uint32_t v = i * (numPhi + 1) + j;
+                mesh->indices->append(Eigen::Vector3u(v, v + numPhi + 1, v + numPhi + 2));
+                mesh->indices->append(Eigen::Vector3u(v, v + numPhi + 2, v + 1));
+            }
+
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        std::vector<Ray3d> rays(500);
+        for (Ray3d& ray : rays)
+        {
+            Eigen::Vector3d origin = Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)).normalized() * 3;
+            Eigen::Vector3d target = Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)) * 0.25;
+            ray                    = Ray3d(origin, (target - origin).normalized(), 0, 10);
+        }
+
+        // the single precision test agrees with the double precision test up to rounding, also after a refit
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            if (pass == 1)
+            {
+                for (Eigen::Index i = 0; i < mesh->positions->getSize(); ++i)
+                    mesh->positions->setValue(i, mesh->positions->getValue(i).cwiseProduct(Eigen::Vector3f(1.5f, 0.5f, 1.0f)));
+                mesh->positionsChanged.notify(mesh.get());
+            }
+            for (EAccelerationTreeType type : { EAccelerationTreeType::Binary, EAccelerationTreeType::Wide })
+            {
+                mesh->accelerationTreeType = type;
+                mesh->packTriangles        = false;
+                mesh->buildAccelerationTree();
+                std::vector<PreliminaryIntersection> expected;
+                for (const Ray3d& ray : rays)
+                    expected.push_back(mesh->preliminaryHit(ray));
+
+                mesh->packTriangles = true;
+                mesh->buildAccelerationTree();
+                for (size_t i = 0; i < rays.size(); ++i)
+                {
+                    PreliminaryIntersection pi = mesh->preliminaryHit(rays[i]);
+                    ASSERT_TRUE(expected[i].isValid());
+                    ASSERT_TRUE(pi.isValid());
+                    EXPECT_NEAR(pi.t, expected[i].t, 1E-5);
+
+                    // the barycentric coordinates reproduce the hit point
+                    SurfaceInteraction si = mesh->computeSurfaceInteraction(rays[i], pi);
+                    EXPECT_LT((si.position - rays[i].origin - pi.t * rays[i].direction).norm(), 1E-5);
+                }
+            }
+        }
+    }
+}
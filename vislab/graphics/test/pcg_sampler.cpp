@@ -0,0 +1,51 @@
+#include "vislab/graphics/pcg_sampler.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+#include <memory>
+
+namespace vislab
+{
+    TEST(graphics, pcg_sampler)
+    {
+        // the same seed gives the same sequence, also in a copy
+        PCGSampler sampler;
+        sampler.seed(7);
+        Eigen::Vector2d first = sampler.next_2d();
+        EXPECT_EQ(sampler.getDimensionIndex(), 1);
+        std::unique_ptr<Sampler> copy(sampler.clone());
+        EXPECT_EQ(copy->next_2d(), sampler.next_2d());
+        sampler.seed(7);
+        EXPECT_EQ(sampler.next_2d(), first);
+        EXPECT_EQ(sampler.getDimensionIndex(), 1);
+        sampler.advance();
+        EXPECT_EQ(sampler.getDimensionIndex(), 0);
+
+        // the numbers are uniformly distributed
+        constexpr int numBins    = 16;
+        constexpr int numSamples = 1 << 16;
+        int histogram[numBins]   = {};
+        sampler.seed(0);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            double x = sampler.next_1d();
+            ASSERT_GE(x, 0);
+            ASSERT_LT(x, 1);
+            histogram[(int)(x * numBins)]++;
+        }
+        double chiSquared = 0;
+        for (int b = 0; b < numBins; ++b)
+            chiSquared += std::pow(histogram[b] - numSamples / numBins, 2) / (numSamples / numBins);
+        EXPECT_LT(chiSquared, 37.7); // 99.9% quantile for 15 degrees of freedom
+
+        // the streams of neighboring seed offsets are uncorrelated
+        PCGSampler other;
+        sampler.seed(1);
+        other.seed(2);
+        double covariance = 0;
+        for (int i = 0; i < numSamples; ++i)
+            covariance += (sampler.next_1d() - 0.5) * (other.next_1d() - 0.5);
+        EXPECT_LT(std::abs(covariance / numSamples) * 12, 0.02);
+    }
+}
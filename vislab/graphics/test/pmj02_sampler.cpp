@@ -0,0 +1,30 @@
+#include "vislab/graphics/pmj02_sampler.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+#include "sampler_test_utils.hpp"
+
+#include <memory>
+
+namespace vislab
+{
+    TEST(graphics, pmj02_sampler)
+    {
+        PMJ02Sampler sampler;
+        sampler.setSampleCount(PMJ02Sampler::TableSize);
+
+        // each prefix of power-of-two length is stratified in all elementary intervals, in each pixel and each dimension
+        expectNetPrefixes(sampler, PMJ02Sampler::TableSize);
+
+        // the same seed gives the same sequence, also in a copy
+        sampler.seed(3);
+        Eigen::Vector2d first = sampler.next_2d();
+        sampler.seed(3);
+        EXPECT_EQ(sampler.next_2d(), first);
+        std::unique_ptr<Sampler> copy(sampler.clone());
+        EXPECT_EQ(copy->next_2d(), sampler.next_2d());
+        sampler.seed(4);
+        EXPECT_NE(sampler.next_2d(), first);
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "vislab/graphics/sampler.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace vislab
+{
+    /**
+     * @brief Tests whether each elementary interval of volume 1/n contains exactly one point.
+     * @param points Points, whose number is a power of two.
+     * @return True if the points form a (0,m,2)-net.
+     */
+    inline bool isNet(const std::vector<Eigen::Vector2d>& points)
+    {
+        int m = 0;
+        while ((size_t)1 << m < points.size())
+            m++;
+        for (int a = 0; a <= m; ++a)
+        {
+            std::vector<int> counts((size_t)1 << m, 0);
+            for (const Eigen::Vector2d& p : points)
+            {
+                size_t x = (size_t)(p.x() * (1 << a));
+                size_t y = (size_t)(p.y() * (1 << (m - a)));
+                if (++counts[(y << a) + x] > 1)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks that each prefix of power-of-two length of the 2D samples is a (0,m,2)-net, in the first pixels and dimensions.
+     * @param sampler Sampler whose sample count is at least count.
+     * @param count Number of samples to check per pixel and dimension.
+     */
+    inline void expectNetPrefixes(Sampler& sampler, uint32_t count)
+    {
+        for (uint64_t pixel = 0; pixel < 4; ++pixel)
+            for (uint32_t dimension = 0; dimension < 4; ++dimension)
+            {
+                sampler.seed(pixel);
+                std::vector<Eigen::Vector2d> points;
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    for (uint32_t d = 0; d < dimension; ++d)
+                        sampler.next_2d();
+                    points.push_back(sampler.next_2d());
+                    ASSERT_GE(points.back().minCoeff(), 0);
+                    ASSERT_LT(points.back().maxCoeff(), 1);
+                    if ((points.size() & (points.size() - 1)) == 0)
+                    {
+                        EXPECT_TRUE(isNet(points)) << "pixel " << pixel << ", dimension " << dimension << ", " << points.size() << " points";
+                    }
+                    sampler.advance();
+                }
+            }
+    }
+}
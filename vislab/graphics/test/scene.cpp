@@ -0,0 +1,167 @@
+#include "vislab/graphics/scene.hpp"
+#include "vislab/graphics/mesh.hpp"
+#include "vislab/graphics/point_light.hpp"
+#include "vislab/graphics/ray.hpp"
+#include "vislab/graphics/triangle.hpp"
+
+#include "vislab/core/array.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+#include "bvh_test_utils.hpp"
+
+#include <random>
+
+namespace vislab
+{
+    static void expectSameHitsAsLinearSearch(const Scene& scene, std::mt19937& rng)
+    {
+        for (const Ray3d& ray : createTestRays(500, rng, 10))
+        {
+            int32_t hits;
+            PreliminaryIntersection expected = linearSearch(scene.shapes, ray, hits);
+            EXPECT_EQ(scene.intersect(ray).t, expected.t);
+            EXPECT_EQ(scene.anyHit(ray), expected.isValid());
+        }
+
+        // rays from a common origin traced together as packets
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        std::vector<Ray3d> rays;
+        Eigen::Vector3d origin(-30, uniform(rng), uniform(rng));
+        for (int y = 0; y < 10; ++y)
+            for (int x = 0; x < 10; ++x)
+            {
+                Eigen::Vector3d target(0, 2. * x - 10, 2. * y - 10);
+                rays.push_back(Ray3d(origin, (target - origin).normalized(), 0, 100));
+            }
+        std::vector<SurfaceInteraction> si(rays.size());
+        std::unique_ptr<bool[]> hits(new bool[rays.size()]);
+        scene.intersect(rays.data(), rays.size(), si.data());
+        scene.anyHit(rays.data(), rays.size(), hits.get());
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            SurfaceInteraction expected = scene.intersect(rays[i]);
+            EXPECT_EQ(si[i].t, expected.t);
+            EXPECT_EQ(si[i].position, expected.position);
+            EXPECT_EQ(hits[i], expected.isValid());
+        }
+    }
+
+    TEST(graphics, scene_instanced_meshes)
+    {
+        // many instances of one mesh at random positions
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> uniform(-10, 10);
+        auto mesh = createUnitCube();
+        Scene scene;
+        for (int i = 0; i < 200; ++i)
+        {
+            auto shape  = std::make_shared<Triangle>();
+            shape->mesh = mesh;
+            shape->transform.setMatrix(Eigen::Affine3d(Eigen::Translation3d(uniform(rng), uniform(rng), uniform(rng)) * Eigen::Scaling(0.3)).matrix());
+            scene.shapes.push_back(shape);
+        }
+
+        // the instances share the tree of the mesh
+        EXPECT_FALSE(scene.shapes[0]->hasAccelerationTree());
+        scene.buildAccelerationTree();
+        EXPECT_TRUE(mesh->hasAccelerationTree());
+        for (const auto& shape : scene.shapes)
+            EXPECT_TRUE(shape->hasAccelerationTree());
+        expectSameHitsAsLinearSearch(scene, rng);
+
+        // moving the instances only updates the top level
+        for (const auto& shape : scene.shapes)
+        {
+            Eigen::Matrix4d matrix = shape->transform.getMatrix();
+            matrix.block<3, 1>(0, 3) += Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)) * 0.1;
+            shape->transform.setMatrix(matrix);
+        }
+        scene.updateAccelerationTree();
+        expectSameHitsAsLinearSearch(scene, rng);
+
+        // adding an instance rebuilds the top level
+        auto shape  = std::make_shared<Triangle>();
+        shape->mesh = mesh;
+        scene.shapes.push_back(shape);
+        EXPECT_TRUE(scene.updateAccelerationTree());
+        expectSameHitsAsLinearSearch(scene, rng);
+    }
+
+    TEST(graphics, scene_swap_mesh)
+    {
+        // shapes whose mesh is exchanged between frames, e.g., by a level of detail
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> uniform(-10, 10);
+        Scene scene;
+        for (int i = 0; i < 20; ++i)
+        {
+            auto shape  = std::make_shared<Triangle>();
+            shape->mesh = createUnitCube();
+            shape->transform.setMatrix(Eigen::Affine3d(Eigen::Translation3d(uniform(rng), uniform(rng), uniform(rng))).matrix());
+            scene.shapes.push_back(shape);
+        }
+        scene.buildAccelerationTree();
+
+        // the new mesh receives its own tree, while the top level is only refitted
+        auto mesh = createUnitCube();
+        for (Eigen::Index i = 0; i < mesh->positions->getSize(); ++i)
+            mesh->positions->setValue(i, mesh->positions->getValue(i) * 1.5f);
+        std::static_pointer_cast<Triangle>(scene.shapes[0])->mesh = mesh;
+        EXPECT_FALSE(scene.shapes[0]->hasAccelerationTree());
+        EXPECT_FALSE(scene.updateAccelerationTree());
+        EXPECT_TRUE(mesh->hasAccelerationTree());
+        expectSameHitsAsLinearSearch(scene, rng);
+    }
+
+    TEST(graphics, scene_sample_light_directions)
+    {
+        // point lights inside a field of cubes, one of which occludes some of them
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> uniform(-10, 10);
+        auto mesh = createUnitCube();
+        Scene scene;
+        for (int i = 0; i < 50; ++i)
+        {
+            auto shape  = std::make_shared<Triangle>();
+            shape->mesh = mesh;
+            shape->transform.setMatrix(Eigen::Affine3d(Eigen::Translation3d(uniform(rng), uniform(rng), uniform(rng))).matrix());
+            scene.shapes.push_back(shape);
+        }
+        for (int i = 0; i < 8; ++i)
+        {
+            auto light       = std::make_shared<PointLight>();
+            light->intensity = Eigen::Vector3d(1, 1, 1);
+            light->transform.setMatrix(Eigen::Matrix4d::translate(Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)) * 0.3));
+            scene.lights.push_back(light);
+        }
+        auto occluder  = std::make_shared<Triangle>();
+        occluder->mesh = mesh;
+        occluder->transform.setMatrix(Eigen::Affine3d(Eigen::Translation3d(2, 0, 8) * Eigen::Scaling(1.5)).matrix());
+        scene.shapes.push_back(occluder);
+        scene.buildAccelerationTree();
+
+        // more samples than fit into one packet give the same results as sampling one after another
+        Interaction it(0, Eigen::Vector3d(0, 0, 15));
+        std::uniform_real_distribution<double> unit(0, 1);
+        std::vector<Eigen::Vector2d> samples(150);
+        for (Eigen::Vector2d& sample : samples)
+            sample = Eigen::Vector2d(unit(rng), unit(rng));
+        std::vector<DirectionSample> ds(samples.size());
+        std::vector<Spectrum> spec(samples.size());
+        scene.sampleLightDirections(it, samples.data(), samples.size(), ds.data(), spec.data());
+        bool anyOccluded = false, anyVisible = false;
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            auto [expectedDs, expectedSpec] = scene.sampleLightDirection(it, samples[i], true);
+            EXPECT_EQ(ds[i].direction, expectedDs.direction);
+            EXPECT_EQ(ds[i].pdf, expectedDs.pdf);
+            EXPECT_EQ(spec[i], expectedSpec);
+            anyOccluded |= expectedSpec.isZero();
+            anyVisible |= !expectedSpec.isZero();
+        }
+        EXPECT_TRUE(anyOccluded);
+        EXPECT_TRUE(anyVisible);
+    }
+}
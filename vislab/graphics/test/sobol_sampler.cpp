@@ -0,0 +1,33 @@
+#include "vislab/graphics/sobol_sampler.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+#include "sampler_test_utils.hpp"
+
+#include <memory>
+
+namespace vislab
+{
+    TEST(graphics, sobol_sampler)
+    {
+        SobolSampler sampler;
+        sampler.setSampleCount(1 << 10);
+
+        // each prefix of power-of-two length is stratified, in each pixel and each dimension
+        expectNetPrefixes(sampler, 1 << 10);
+
+        // the randomizations differ between pixels and dimensions
+        sampler.seed(0);
+        Eigen::Vector2d first = sampler.next_2d();
+        EXPECT_NE(sampler.next_2d(), first);
+        sampler.seed(1);
+        EXPECT_NE(sampler.next_2d(), first);
+
+        // the same seed gives the same sequence, also in a copy
+        sampler.seed(0);
+        EXPECT_EQ(sampler.next_2d(), first);
+        std::unique_ptr<Sampler> copy(sampler.clone());
+        EXPECT_EQ(copy->next_1d(), sampler.next_1d());
+    }
+}
@@ -0,0 +1,272 @@
+#include "vislab/graphics/wide_bounding_volume_hierarchy.hpp"
+#include "vislab/graphics/mesh.hpp"
+#include "vislab/graphics/ray.hpp"
+
+#include "vislab/core/array.hpp"
+
+#include "Eigen/Eigen"
+#include "gtest/gtest.h"
+
+#include "bvh_test_utils.hpp"
+
+#include <random>
+
+namespace vislab
+{
+    TEST(graphics, wide_bounding_volume_hierarchy)
+    {
+        // random boxes in [-1,1]^3
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        std::vector<TestBox> boxes(500);
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+        {
+            Eigen::Vector3d center(uniform(rng), uniform(rng), uniform(rng));
+            Eigen::Vector3d size = Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)).cwiseAbs() * 0.1;
+            boxes[i].box         = Eigen::AlignedBox3d(center - size, center + size);
+            boxes[i].index       = i;
+        }
+
+        FlatBoundingVolumeHierarchy<TestBox> binary;
+        for (TestBox& box : boxes)
+            binary.getShapes().push_back(&box);
+        binary.build();
+        WideBoundingVolumeHierarchy<TestBox> bvh;
+        bvh.build(binary);
+
+        // each primitive is in exactly one leaf, unused children are empty, and inner children are stored after their parent
+        using Node        = WideBoundingVolumeHierarchy<TestBox>::Node;
+        const auto& nodes = bvh.getNodes();
+        EXPECT_LT(nodes.size(), binary.getNodes().size() / 2);
+        std::vector<int> referenced(boxes.size(), 0);
+        for (size_t i = 0; i < nodes.size(); ++i)
+            for (int c = 0; c < WideBoundingVolumeHierarchy<TestBox>::Width; ++c)
+            {
+                const Node& node = nodes[i];
+                if (node.min[0][c] > node.max[0][c])
+                {
+                    EXPECT_EQ(node.count[c], 0);
+                    continue;
+                }
+                if (node.count[c] > 0)
+                {
+                    for (uint32_t j = node.offset[c]; j < node.offset[c] + node.count[c]; ++j)
+                        referenced[j]++;
+                    continue;
+                }
+                ASSERT_GT(node.offset[c], i);
+                ASSERT_LT(node.offset[c], nodes.size());
+            }
+        for (int count : referenced)
+            EXPECT_EQ(count, 1);
+
+        // the slab test agrees with the boxes of the children
+        const Node& root = nodes[0];
+        Eigen::Vector3f origin(0.1f, -3.f, 0.2f);
+        Eigen::Vector3f direction = Eigen::Vector3f(0.f, 1.f, 0.f);
+        float tNear[WideBoundingVolumeHierarchy<TestBox>::Width];
+        int mask = WideBoundingVolumeHierarchy<TestBox>::intersect(root, origin, direction.cwiseInverse(), 0.f, 10.f, tNear);
+        for (int c = 0; c < WideBoundingVolumeHierarchy<TestBox>::Width; ++c)
+        {
+            bool inside = root.min[0][c] <= origin.x() && origin.x() <= root.max[0][c] && root.min[2][c] <= origin.z() && origin.z() <= root.max[2][c] && root.min[1][c] <= root.max[1][c];
+            EXPECT_EQ((mask >> c) & 1, inside ? 1 : 0);
+            if (inside)
+            {
+                EXPECT_FLOAT_EQ(tNear[c], root.min[1][c] - origin.y());
+            }
+        }
+
+        // same results as a linear search
+        expectSameHitsAsLinearSearch(bvh, boxes);
+
+        // packets of coherent rays from a pinhole find the same hits as single rays, also when the packet exceeds the maximal size
+        std::vector<Ray3d> rays;
+        Eigen::Vector3d eye(-3, 0.1, 0.2);
+        for (int y = 0; y < 12; ++y)
+            for (int x = 0; x < 11; ++x)
+            {
+                Eigen::Vector3d target(0, 2. * x / 10 - 1, 2. * y / 11 - 1);
+                rays.push_back(Ray3d(eye, (target - eye).normalized(), 0, 10));
+            }
+        std::vector<PreliminaryIntersection> packetHits(rays.size());
+        std::unique_ptr<bool[]> packetAnyHits(new bool[rays.size()]);
+        bvh.preliminaryHit(rays.data(), (int)rays.size(), packetHits.data());
+        bvh.anyHit(rays.data(), (int)rays.size(), packetAnyHits.get());
+        int numHits = 0;
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            PreliminaryIntersection expected = bvh.preliminaryHit(rays[i]);
+            EXPECT_EQ(packetHits[i].isValid(), expected.isValid());
+            if (expected.isValid())
+            {
+                EXPECT_EQ(packetHits[i].t, expected.t);
+                EXPECT_EQ(packetHits[i].prim_index, expected.prim_index);
+                numHits++;
+            }
+            EXPECT_EQ(packetAnyHits[i], expected.isValid());
+        }
+        EXPECT_GT(numHits, 0);
+        EXPECT_LT(numHits, (int)rays.size());
+
+        // axis-parallel rays with negative zero components, whose inverse is negative infinity, hit the same boxes, also in packets
+        for (const Eigen::Vector3d& direction : { Eigen::Vector3d(-0., 0., 1.), Eigen::Vector3d(0., -0., -1.), Eigen::Vector3d(-Eigen::Vector3d::UnitZ()), Eigen::Vector3d(-0., -1., -0.) })
+        {
+            rays.clear();
+            for (int y = 0; y < 8; ++y)
+                for (int x = 0; x < 8; ++x)
+                {
+                    Eigen::Vector3d offset = Eigen::Vector3d(2. * x / 7 - 1, 2. * y / 7 - 1, 2. * (x + y) / 14 - 1) * 0.99;
+                    rays.push_back(Ray3d(offset.cwiseProduct(Eigen::Vector3d::Ones() - direction.cwiseAbs()) - 3 * direction, direction, 0, 10));
+                }
+            bvh.preliminaryHit(rays.data(), (int)rays.size(), packetHits.data());
+            bvh.anyHit(rays.data(), (int)rays.size(), packetAnyHits.get());
+            numHits = 0;
+            for (size_t i = 0; i < rays.size(); ++i)
+            {
+                PreliminaryIntersection expected;
+                for (const TestBox& box : boxes)
+                {
+                    PreliminaryIntersection pi = box.preliminaryHit(rays[i]);
+                    if (pi.t < expected.t)
+                        expected = pi;
+                }
+
+                PreliminaryIntersection pi = bvh.preliminaryHit(rays[i]);
+                EXPECT_EQ(pi.isValid(), expected.isValid());
+                EXPECT_EQ(packetHits[i].isValid(), expected.isValid());
+                if (expected.isValid())
+                {
+                    EXPECT_EQ(pi.t, expected.t);
+                    EXPECT_EQ(pi.prim_index, expected.prim_index);
+                    EXPECT_EQ(packetHits[i].t, expected.t);
+                    EXPECT_EQ(packetHits[i].prim_index, expected.prim_index);
+                    numHits++;
+                }
+                EXPECT_EQ(bvh.anyHit(rays[i]), expected.isValid());
+                EXPECT_EQ(packetAnyHits[i], expected.isValid());
+            }
+            EXPECT_GT(numHits, 0);
+        }
+    }
+
+    TEST(graphics, wide_bounding_volume_hierarchy_refit)
+    {
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> uniform(-1, 1);
+        std::vector<TestBox> boxes(500);
+        for (uint32_t i = 0; i < boxes.size(); ++i)
+        {
+            Eigen::Vector3d center(uniform(rng), uniform(rng), uniform(rng));
+            boxes[i].box   = Eigen::AlignedBox3d(center.array() - 0.05, center.array() + 0.05);
+            boxes[i].index = i;
+        }
+        FlatBoundingVolumeHierarchy<TestBox> binary;
+        for (TestBox& box : boxes)
+            binary.getShapes().push_back(&box);
+        binary.build();
+        WideBoundingVolumeHierarchy<TestBox> bvh;
+        bvh.build(binary);
+        const auto* nodes = bvh.getNodes().data();
+
+        // refitting in place keeps the nodes, which enclose their children and find the same hits as a linear search
+        for (TestBox& box : boxes)
+            box.box.translate(Eigen::Vector3d(uniform(rng), uniform(rng), uniform(rng)) * 0.02);
+        binary.refit();
+        bvh.refit(binary);
+        EXPECT_EQ(bvh.getNodes().data(), nodes);
+        for (const auto& node : bvh.getNodes())
+            for (int c = 0; c < WideBoundingVolumeHierarchy<TestBox>::Width; ++c)
+            {
+                if (node.min[0][c] > node.max[0][c])
+                    continue;
+                Eigen::AlignedBox3f enclosed;
+                if (node.count[c] > 0)
+                {
+                    for (uint32_t j = node.offset[c]; j < node.offset[c] + node.count[c]; ++j)
+                        enclosed.extend(binary.getOrderedShapes()[j]->box.cast<float>());
+                }
+                else
+                {
+                    const auto& child = bvh.getNodes()[node.offset[c]];
+                    for (int k = 0; k < WideBoundingVolumeHierarchy<TestBox>::Width; ++k)
+                        if (child.min[0][k] <= child.max[0][k])
+                            enclosed.extend(Eigen::AlignedBox3f(Eigen::Vector3f(child.min[0][k], child.min[1][k], child.min[2][k]), Eigen::Vector3f(child.max[0][k], child.max[1][k], child.max[2][k])));
+                }
+                for (int i = 0; i < 3; ++i)
+                {
+                    EXPECT_LE(node.min[i][c], enclosed.min()[i]);
+                    EXPECT_GE(node.max[i][c], enclosed.max()[i]);
+                }
+            }
+        expectSameHitsAsLinearSearch(bvh, boxes);
+    }
+
+    TEST(graphics, wide_bounding_volume_hierarchy_mesh)
+    {
+        // latitude-longitude sphere
+        const int numTheta = 24, numPhi = 48;
+        auto mesh          = std::make_shared<Mesh>();
+        mesh->positions    = std::make_shared<Array3f>();
+        mesh->indices      = std::make_shared<Array3ui>();
+        for (int i = 0; i <= numTheta; ++i)
+            for (int j = 0; j <= numPhi; ++j)
+            {
+                double theta = EIGEN_PI * i / numTheta, phi = 2 * EIGEN_PI * j / numPhi;
+                mesh->positions->append(Eigen::Vector3f(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)));
+            }
+        for (uint32_t i = 0; i < numTheta; ++i)
+            for (uint32_t j = 0; j < numPhi; ++j)
+            {
+                uint32_t v = i * (numPhi + 1) + j;
+                mesh->indices->append(Eigen::Vector3u(v, v + numPhi + 1, v + numPhi + 2));
+                mesh->indices->append(Eigen::Vector3u(v, v + numPhi + 2, v + 1));
+            }
+
+        // the binary and the wide tree find the same hits, also after the mesh deformed
+        std::vector<Ray3d> rays = createTestRays(500);
+        auto expectSameHits = [&mesh, &rays](const std::vector<PreliminaryIntersection>& expected, const std::vector<int32_t>& expectedHits)
+        {
+            for (size_t i = 0; i < rays.size(); ++i)
+            {
+                PreliminaryIntersection pi = mesh->preliminaryHit(rays[i]);
+                EXPECT_EQ(pi.isValid(), expected[i].isValid());
+                if (expected[i].isValid())
+                {
+                    EXPECT_EQ(pi.t, expected[i].t);
+                    EXPECT_EQ(pi.prim_index, expected[i].prim_index);
+                }
+                EXPECT_EQ(mesh->countHits(rays[i]), expectedHits[i]);
+            }
+        };
+        auto trace = [&mesh, &rays](std::vector<PreliminaryIntersection>& results, std::vector<int32_t>& hits)
+        {
+            results.clear();
+            hits.clear();
+            for (const Ray3d& ray : rays)
+            {
+                results.push_back(mesh->preliminaryHit(ray));
+                hits.push_back(mesh->countHits(ray));
+            }
+        };
+        std::vector<PreliminaryIntersection> expected;
+        std::vector<int32_t> expectedHits;
+
+        mesh->accelerationTreeType = EAccelerationTreeType::Binary;
+        mesh->buildAccelerationTree();
+        trace(expected, expectedHits);
+        mesh->accelerationTreeType = EAccelerationTreeType::Wide;
+        mesh->buildAccelerationTree();
+        expectSameHits(expected, expectedHits);
+
+        // deform the sphere into an ellipsoid, the refit has to update the wide tree as well
+        for (Eigen::Index i = 0; i < mesh->positions->getSize(); ++i)
+            mesh->positions->setValue(i, mesh->positions->getValue(i).cwiseProduct(Eigen::Vector3f(1.5f, 0.5f, 1.0f)));
+        mesh->positionsChanged.notify(mesh.get());
+        std::vector<PreliminaryIntersection> wide;
+        std::vector<int32_t> wideHits;
+        trace(wide, wideHits);
+        mesh->accelerationTreeType = EAccelerationTreeType::Binary;
+        mesh->buildAccelerationTree();
+        expectSameHits(wide, wideHits);
+    }
+}